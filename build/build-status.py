@@ -0,0 +1,8 @@
+#! /usr/bin/env python3
+
+# Programs that are runnable.
+ns3_runnable_programs = []
+
+# Scripts that are runnable.
+ns3_runnable_scripts = []
+
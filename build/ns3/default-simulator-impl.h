@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef DEFAULT_SIMULATOR_IMPL_H
+#define DEFAULT_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "event-impl.h"
+#include "event-injection-queue.h"
+#include "event-profiler.h"
+#include "system-thread.h"
+
+#include "ptr.h"
+
+#include <list>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::DefaultSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * The default single process simulator implementation.
+ *
+ * When the "EventProfiling" attribute is set, the cost of each event
+ * is recorded by an EventProfiler, per event type and context, and the
+ * profile is written to the "EventProfileFile" file, if any, at
+ * Simulator::Destroy().
+ */
+class DefaultSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DefaultSimulatorImpl ();
+  /** Destructor. */
+  ~DefaultSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * Get the counters of the events scheduled by other threads with
+   * Simulator::ScheduleWithContext.
+   *
+   * \returns The injection counters.
+   */
+  EventInjectionQueue::Stats GetInjectionStats (void) const;
+  /**
+   * Get the profile of the events run so far.
+   *
+   * The profile is empty unless the "EventProfiling" attribute is set.
+   *
+   * \returns The event profiler.
+   */
+  const EventProfiler & GetEventProfiler (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** Process the next event. */
+  void ProcessOneEvent (void);
+  /** Move events from a different context into the main event queue. */
+  void ProcessEventsWithContext (void);
+ 
+  /** The events scheduled by other threads. */
+  EventInjectionQueue m_eventsWithContext;
+  /** The last batch of events drained from #m_eventsWithContext. */
+  std::vector<EventInjectionQueue::Entry> m_eventsWithContextBatch;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** The event priority queue. */
+  Ptr<Scheduler> m_events;
+
+  /** Next event unique id. */
+  uint32_t m_uid;
+  /** Unique id of the current event. */
+  uint32_t m_currentUid;
+  /** Timestamp of the current event. */
+  uint64_t m_currentTs;
+  /** Execution context of the current event. */
+  uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
+  /**
+   * Number of events that have been inserted but not yet scheduled,
+   *  not counting the Destroy events; this is used for validation
+   */
+  int m_unscheduledEvents;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+
+  /** Flag \c true if the events are profiled. */
+  bool m_profiling;
+  /** The file the profile is written to at Destroy. */
+  std::string m_profileFile;
+  /** The format of the profile file. */
+  EventProfiler::Format m_profileFormat;
+  /** The event profile. */
+  EventProfiler m_profiler;
+};
+
+} // namespace ns3
+
+#endif /* DEFAULT_SIMULATOR_IMPL_H */
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007 University of Washington
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DROPTAIL_H
+#define DROPTAIL_H
+
+#include "ns3/queue.h"
+#include "ns3/boolean.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * By default, the packets are stored in a ring buffer, so that a queue
+ * which has reached its working size no longer allocates memory per
+ * packet.  Setting the RingBuffer attribute to false stores them in a
+ * list, as the other queues do.
+ */
+template <typename Item>
+class DropTailQueue : public Queue<Item>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DropTailQueue Constructor
+   *
+   * Creates a droptail queue with a maximum size of 100 packets by default
+   */
+  DropTailQueue ();
+
+  virtual ~DropTailQueue ();
+
+  virtual bool Enqueue (Ptr<Item> item);
+  virtual Ptr<Item> Dequeue (void);
+  virtual Ptr<Item> Remove (void);
+  virtual Ptr<const Item> Peek (void) const;
+
+private:
+  /**
+   * \brief Select the storage of the packets
+   * \param enable true to store the packets in a ring buffer
+   */
+  void SetRingBuffer (bool enable);
+  /**
+   * \brief Get the storage of the packets
+   * \return true if the packets are stored in a ring buffer
+   */
+  bool GetRingBuffer (void) const;
+
+  using Queue<Item>::DoEnqueue;
+  using Queue<Item>::DoDequeue;
+  using Queue<Item>::DoRemove;
+  using Queue<Item>::DoPeek;
+  using Queue<Item>::UseRingBuffer;
+  using Queue<Item>::IsRingBuffer;
+
+  NS_LOG_TEMPLATE_DECLARE;     //!< redefinition of the log component
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename Item>
+TypeId
+DropTailQueue<Item>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (("ns3::DropTailQueue<" + GetTypeParamName<DropTailQueue<Item> > () + ">").c_str ())
+    .SetParent<Queue<Item> > ()
+    .SetGroupName ("Network")
+    .template AddConstructor<DropTailQueue<Item> > ()
+    .AddAttribute ("RingBuffer",
+                   "Whether the packets are stored in a ring buffer rather than in a list. "
+                   "It can only be changed while the queue is empty.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DropTailQueue<Item>::SetRingBuffer,
+                                        &DropTailQueue<Item>::GetRingBuffer),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+template <typename Item>
+DropTailQueue<Item>::DropTailQueue () :
+  Queue<Item> (),
+  NS_LOG_TEMPLATE_DEFINE ("DropTailQueue")
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+DropTailQueue<Item>::~DropTailQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+bool
+DropTailQueue<Item>::Enqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  return DoEnqueue (item);
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailQueue<Item>::Dequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = DoDequeue ();
+
+  NS_LOG_LOGIC ("Popped " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailQueue<Item>::Remove (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = DoRemove ();
+
+  NS_LOG_LOGIC ("Removed " << item);
+
+  return item;
+}
+
+template <typename Item>
+void
+DropTailQueue<Item>::SetRingBuffer (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  UseRingBuffer (enable);
+}
+
+template <typename Item>
+bool
+DropTailQueue<Item>::GetRingBuffer (void) const
+{
+  return IsRingBuffer ();
+}
+
+template <typename Item>
+Ptr<const Item>
+DropTailQueue<Item>::Peek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  return DoPeek ();
+}
+
+// The following explicit template instantiation declarations prevent all the
+// translation units including this header file to implicitly instantiate the
+// DropTailQueue<Packet> class and the DropTailQueue<QueueDiscItem> class. The
+// unique instances of these classes are explicitly created through the macros
+// NS_OBJECT_TEMPLATE_CLASS_DEFINE (DropTailQueue,Packet) and
+// NS_OBJECT_TEMPLATE_CLASS_DEFINE (DropTailQueue,QueueDiscItem), which are included
+// in drop-tail-queue.cc
+extern template class DropTailQueue<Packet>;
+extern template class DropTailQueue<QueueDiscItem>;
+
+} // namespace ns3
+
+#endif /* DROPTAIL_H */
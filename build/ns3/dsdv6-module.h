@@ -0,0 +1,15 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_DSDV6
+    
+
+// Module headers:
+#include "dsdv6-helper.h"
+#include "dsdv6-packet-queue.h"
+#include "dsdv6-packet.h"
+#include "dsdv6-routing-protocol.h"
+#include "dsdv6-rtable.h"
+#endif
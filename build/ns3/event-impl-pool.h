@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_IMPL_POOL_H
+#define EVENT_IMPL_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventImplPool declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief Recycle the memory of EventImpl instances.
+ *
+ * Every Simulator::Schedule call allocates a new EventImpl subclass
+ * instance, which is released once the event has been invoked. To
+ * avoid going through the system allocator for each event, the
+ * EventImpl::operator new and EventImpl::operator delete forward to
+ * this pool, which keeps one free list of memory blocks per size
+ * class (a multiple of 16 bytes, up to 256 bytes).
+ *
+ * The free lists are not protected by any lock: they are only used
+ * by the simulation thread, as declared by the simulator implementation
+ * with Attach(). Events allocated or released by any other thread, such
+ * as the ones injected with Simulator::ScheduleWithContext by a
+ * foreign thread, go through the system allocator, and are only counted
+ * with relaxed atomic increments, without taking any lock. Memory blocks are
+ * always rounded up to their size class, so that an event can be
+ * released to the pool even if it was not allocated from it.
+ *
+ * The pool can be disabled with the "EventImplPoolEnabled" global
+ * value, which is read when the simulator implementation is created.
+ */
+class EventImplPool
+{
+public:
+  /**
+   * Allocate a memory block for an EventImpl subclass instance.
+   *
+   * \param [in] size The size of the instance.
+   * \returns The memory block.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Release the memory block of an EventImpl subclass instance.
+   *
+   * \param [in] p The memory block.
+   * \param [in] size The size of the instance.
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * Declare the calling thread as the simulation thread and read
+   * the "EventImplPoolEnabled" global value.
+   *
+   * This is called by the simulator implementations when they are
+   * created and when they start running.
+   */
+  static void Attach (void);
+  /**
+   * Disable the pool and release all the memory blocks it holds.
+   *
+   * This is called by the simulator implementations which run events
+   * from several threads: all the events then go through the system
+   * allocator, without any locking.
+   */
+  static void Detach (void);
+  /**
+   * Release all the memory blocks held by the pool to the system.
+   *
+   * This must be called from the simulation thread.
+   */
+  static void Purge (void);
+  /**
+   * \returns \c true if the pool is enabled.
+   */
+  static bool IsEnabled (void);
+  /**
+   * Get the number of EventImpl instances currently allocated.
+   *
+   * Only the events allocated and released while the pool is enabled
+   * are accounted for.
+   *
+   * \returns The number of live events.
+   */
+  static uint64_t GetLiveEvents (void);
+  /**
+   * \returns The number of memory blocks held by the pool, ready
+   * to be recycled.
+   */
+  static uint64_t GetPooledEvents (void);
+};
+
+} // namespace ns3
+
+#endif /* EVENT_IMPL_POOL_H */
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_INJECTION_QUEUE_H
+#define EVENT_INJECTION_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventInjectionQueue declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief A lock-free queue of the events scheduled by foreign threads.
+ *
+ * The threads other than the simulation thread, such as the reader
+ * threads of the FdNetDevice and the TapBridge, schedule events with
+ * Simulator::ScheduleWithContext. The simulator implementations push
+ * these events to this queue, which any number of threads can do
+ * concurrently without taking any lock, and the simulation thread
+ * moves them to its event list in batches with Drain().
+ *
+ * The queue is an intrusive stack: Push() links a new node at its
+ * head with a compare-and-swap, and Drain() detaches the whole stack
+ * with a single exchange and reverses it, so that the events are
+ * inserted in the event list in the order they were pushed.
+ */
+class EventInjectionQueue
+{
+public:
+  /** An event pushed by a foreign thread. */
+  struct Entry
+  {
+    /** The event context. */
+    uint32_t context;
+    /** Event timestamp, interpreted by the simulator implementation. */
+    uint64_t timestamp;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+
+  /** The injection counters. */
+  struct Stats
+  {
+    /** Number of events pushed. */
+    uint64_t injected;
+    /** Number of non-empty batches drained. */
+    uint64_t batches;
+    /** Largest number of events drained at once. */
+    uint64_t maxBatch;
+    /** Events pushed per second of wall-clock time since the queue creation. */
+    double injectionsPerSecond;
+  };
+
+  /** Constructor. */
+  EventInjectionQueue ();
+  /**
+   * Destructor.
+   *
+   * The events which have not been drained are released.
+   */
+  ~EventInjectionQueue ();
+
+  /**
+   * Push an event. This can be called by any thread.
+   *
+   * \param [in] context The event context.
+   * \param [in] timestamp The event timestamp.
+   * \param [in] event The event.
+   */
+  void Push (uint32_t context, uint64_t timestamp, EventImpl *event);
+  /**
+   * \returns \c true if no event has been pushed since the last Drain().
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Remove all the events of the queue. This must only be called by
+   * the simulation thread.
+   *
+   * \param [out] batch The events are appended to this container,
+   *             in the order they were pushed.
+   */
+  void Drain (std::vector<Entry> &batch);
+  /**
+   * \returns The injection counters.
+   */
+  Stats GetStats (void) const;
+
+private:
+  /** A node of the stack. */
+  struct Node
+  {
+    Entry entry; //!< The event.
+    Node *next;  //!< The node pushed before this one.
+  };
+
+  /**
+   * Copy constructor, not implemented.
+   * \param [in] o The queue to copy.
+   */
+  EventInjectionQueue (const EventInjectionQueue &o);
+  /**
+   * Assignment operator, not implemented.
+   * \param [in] o The queue to copy.
+   * \returns This queue.
+   */
+  EventInjectionQueue & operator = (const EventInjectionQueue &o);
+
+  /** The last node pushed. */
+  std::atomic<Node *> m_head;
+  /** Number of events pushed. */
+  std::atomic<uint64_t> m_injected;
+  /** Number of non-empty batches drained. */
+  uint64_t m_batches;
+  /** Largest batch drained. */
+  uint64_t m_maxBatch;
+  /** Creation time of the queue. */
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_INJECTION_QUEUE_H */
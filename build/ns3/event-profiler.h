@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Accumulate the cost of the simulation events, per event type
+ * and per context.
+ *
+ * The event type is the EventImpl subclass instantiated by MakeEvent,
+ * which is named after the signature of the function invoked by the
+ * event and the types of its bound arguments, such as
+ * <tt>void (ns3::PointToPointNetDevice::*)(), ns3::PointToPointNetDevice*</tt>.
+ * For each event type and context (the node id), the profiler records
+ * the number of invocations, the cumulative wall-clock time spent in
+ * them and the number of events they scheduled (their fan-out).
+ *
+ * Recording an event is a lookup in a hash table keyed by the
+ * \c std::type_index of the event, so that the names are only
+ * demangled when the profile is written.
+ *
+ * The profile is written either as a report sorted by decreasing
+ * cumulative time, or in the collapsed stack format read by the
+ * flamegraph tools, with one line per context and event type:
+ * \verbatim
+   node 3;void (ns3::Foo::*)(unsigned int), ns3::Foo*, unsigned int 123456
+   \endverbatim
+ * where the weight is the cumulative time in nanoseconds.
+ */
+class EventProfiler
+{
+public:
+  /** The output formats of Write(). */
+  enum Format
+  {
+    REPORT,    //!< Table sorted by decreasing cumulative time.
+    COLLAPSED  //!< Collapsed stacks, for the flamegraph tools.
+  };
+
+  /** The profile of an event type in a context. */
+  struct Entry
+  {
+    /** The event type name. */
+    std::string name;
+    /** The event context. */
+    uint32_t context;
+    /** Number of invocations. */
+    uint64_t count;
+    /** Cumulative wall-clock time of the invocations, in nanoseconds. */
+    uint64_t time;
+    /** Number of events scheduled by the invocations. */
+    uint64_t fanout;
+  };
+
+  /** Constructor. */
+  EventProfiler ();
+
+  /**
+   * Record an invocation of an event.
+   *
+   * \param [in] event The event.
+   * \param [in] context The event context.
+   * \param [in] time The wall-clock time of the invocation, in nanoseconds.
+   * \param [in] fanout The number of events scheduled by the invocation.
+   */
+  void Record (const EventImpl *event, uint32_t context, uint64_t time, uint64_t fanout);
+  /**
+   * Get the profile.
+   *
+   * \returns One entry per event type and context, sorted by
+   *          decreasing cumulative time.
+   */
+  std::vector<Entry> GetEntries (void) const;
+  /**
+   * Write the profile.
+   *
+   * \param [in,out] os The output stream.
+   * \param [in] format The output format.
+   */
+  void Write (std::ostream &os, enum Format format) const;
+  /** Discard all the recorded invocations. */
+  void Clear (void);
+
+  /**
+   * Get the name of an event type.
+   *
+   * \param [in] type The type of the EventImpl subclass.
+   * \returns The parameters of the MakeEvent instantiation which
+   *          created the event, or the demangled type name for the
+   *          events which were not created by MakeEvent.
+   */
+  static std::string GetEventName (const std::type_info &type);
+
+private:
+  /** The profile of an event type in a context. */
+  struct Counters
+  {
+    uint64_t count;  //!< Number of invocations.
+    uint64_t time;   //!< Cumulative time, in nanoseconds.
+    uint64_t fanout; //!< Number of events scheduled.
+  };
+  /** The key of the profile table: event type and context. */
+  typedef std::pair<std::type_index, uint32_t> Key;
+  /** Hash function of the keys. */
+  struct KeyHash
+  {
+    /**
+     * \param [in] key The key.
+     * \returns The hash of the key.
+     */
+    std::size_t operator () (const Key &key) const;
+  };
+  /** The profile table. */
+  typedef std::unordered_map<Key, Counters, KeyHash> Table;
+
+  /** The profile table. */
+  Table m_table;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2009 The Georgia Institute of Technology 
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Josh Pelkey <jpelkey@gatech.edu>
+ */
+
+#ifndef IPV4_NIX_VECTOR_ROUTING_H
+#define IPV4_NIX_VECTOR_ROUTING_H
+
+#include <unordered_map>
+
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/nix-vector.h"
+#include "ns3/nstime.h"
+#include "ns3/nix-vector-graph.h"
+
+namespace ns3 {
+
+/**
+ * \defgroup nix-vector-routing Nix-Vector Routing
+ *
+ * Nix-vector routing is a simulation specific routing protocol and is
+ * intended for large network topologies.
+ */
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief The nix-vector graph of the IPv4 nodes, and the index of their
+ * addresses.
+ *
+ * It is shared by the Ipv4NixVectorRouting of all the nodes.
+ */
+class Ipv4NixVectorGraph : public NixVectorGraph
+{
+public:
+  Ipv4NixVectorGraph ();
+
+  /**
+   * \brief Rebuild the graph and the index of the addresses before their
+   * next use.
+   */
+  virtual void Invalidate (void);
+
+  /**
+   * \brief Find the node which owns an address.
+   * \param dest the address
+   * \returns the node index, or NONE
+   */
+  uint32_t GetNodeByIp (Ipv4Address dest);
+
+protected:
+  virtual bool IsInterfaceUp (Ptr<NetDevice> device) const;
+
+private:
+  /** The node which owns each address */
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_addresses;
+  bool m_addressesValid; //!< Set to false to rebuild the index of the addresses
+};
+
+/**
+ * \ingroup nix-vector-routing
+ * Nix-vector routing protocol
+ *
+ * The topology and the shortest path trees are shared by the nodes (see
+ * Ipv4NixVectorGraph); each node caches the nix-vectors and routes to the
+ * destinations it uses.
+ */
+class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
+{
+public:
+  Ipv4NixVectorRouting ();
+  ~Ipv4NixVectorRouting ();
+  /**
+   * @brief The Interface ID of the Global Router interface.
+   * @return The Interface ID
+   * @see Object::GetObject ()
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * @brief Set the Node pointer of the node for which this
+   * routing protocol is to be placed
+   *
+   * @param node Node pointer
+   */
+  void SetNode (Ptr<Node> node);
+
+  /**
+   * @brief Called when run-time link topology change occurs
+   * which iterates through the node list and flushes any
+   * nix vector caches
+   *
+   * \internal
+   * \c const is used here due to need to potentially flush the cache
+   * in const methods such as PrintRoutingTable.  Caches are stored in
+   * mutable variables and flushed in const methods.
+   */
+  void FlushGlobalNixRoutingCache (void) const;
+
+private:
+  /** The nix-vector and the route to a destination, cached by a node */
+  struct CacheEntry
+  {
+    uint32_t node;             //!< The destination node index, or NONE
+    uint32_t version;          //!< The version of the routes to the destination node
+    Ptr<NixVector> nixVector;  //!< The nix-vector from this node, if built
+    Ptr<Ipv4Route> route;      //!< The route, if built
+    uint32_t neighbor;         //!< The neighbor index of the route
+  };
+
+  /// container of CacheEntry, by destination address
+  typedef std::unordered_map<Ipv4Address, CacheEntry, Ipv4AddressHash> Cache;
+
+  /**
+   * Flushes the cache which stores nix-vectors and routes
+   * based on destination IP
+   */
+  void FlushNixCache (void) const;
+
+  /**
+   * \returns The graph shared by all the nodes.
+   */
+  static Ipv4NixVectorGraph *GetGraph (void);
+
+  /**
+   * Checks the cache based on dest IP, and resets the entry
+   * if it is missing or if the routes to the destination changed
+   * \param address Address to check
+   * \returns The cache entry.
+   */
+  CacheEntry &GetCacheEntry (Ipv4Address address);
+
+  /**
+   * Takes in the source node and the dest node and
+   * builds the nix-vector, accounting for any output interface specified
+   *
+   * \param source Source node
+   * \param dest Destination node index
+   * \param oif Preferred output interface
+   * \returns The NixVector to be used in routing.
+   */
+  Ptr<NixVector> GetNixVector (Ptr<Node> source, uint32_t dest, Ptr<NetDevice> oif);
+
+  /**
+   * Builds the route to a neighbor
+   * \param dest Destination address
+   * \param nodeIndex Nix index of the neighbor
+   * \returns The route.
+   */
+  Ptr<Ipv4Route> BuildRoute (Ipv4Address dest, uint32_t nodeIndex);
+
+  void DoDispose (void);
+
+  /* From Ipv4RoutingProtocol */
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+
+  /** Cache stores nix-vectors and Ipv4Routes based on destination ip */
+  mutable Cache m_cache;
+
+  Ptr<Ipv4> m_ipv4; //!< IPv4 object
+  Ptr<Node> m_node; //!< Node object
+};
+} // namespace ns3
+
+#endif /* IPV4_NIX_VECTOR_ROUTING_H */
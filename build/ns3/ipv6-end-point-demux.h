@@ -0,0 +1,292 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2007-2009 Strasbourg University
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Sebastien Vincent <vincent@clarinet.u-strasbg.fr>
+ */
+
+#ifndef IPV6_END_POINT_DEMUX_H
+#define IPV6_END_POINT_DEMUX_H
+
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "ns3/ipv6-address.h"
+#include "ipv6-interface.h"
+
+namespace ns3 {
+
+class Ipv6EndPoint;
+
+/**
+ * \ingroup ipv6
+ *
+ * \brief Demultiplexer for end points.
+ *
+ * The end points whose peer address and port are both set are indexed by
+ * their four-tuple, and the other ones by their local port.
+ */
+class Ipv6EndPointDemux
+{
+public:
+  /**
+   * \brief Container of the IPv6 endpoints.
+   */
+  typedef std::list<Ipv6EndPoint *>EndPoints;
+
+  /**
+   * \brief Iterator to the container of the IPv6 endpoints.
+   */
+  typedef std::list<Ipv6EndPoint *>::iterator EndPointsI;
+
+  Ipv6EndPointDemux ();
+  ~Ipv6EndPointDemux ();
+
+  /**
+   * \brief Lookup for port local.
+   * \param port port to test
+   * \return true if a port local is in EndPoints, false otherwise
+   */
+  bool LookupPortLocal (uint16_t port);
+
+  /**
+   * \brief Lookup for address and port.
+   * \param boundNetDevice Bound NetDevice (if any)
+   * \param addr address to test
+   * \param port port to test
+   * \return true if there is a match in EndPoints, false otherwise
+   */
+  bool LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port);
+
+  /**
+   * \brief lookup for a match with all the parameters.
+   *
+   * The function will return a list of most-matching EndPoints, in this order:
+   *   -# Full match
+   *   -# All but local address
+   *   -# Only local port and local address match
+   *   -# Only local port match
+   *
+   * EndPoint with disabled Rx are skipped.
+   *
+   * \param dst destination address to test
+   * \param dport destination port to test
+   * \param src source address to test
+   * \param sport source port to test
+   * \param incomingInterface the incoming interface
+   * \return list of IPv6EndPoints (could be 0 element)
+   */
+  EndPoints Lookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport, Ptr<Ipv6Interface> incomingInterface);
+
+  /**
+   * \brief Simple lookup for a four-tuple match.
+   * \param dst destination address to test
+   * \param dport destination port to test
+   * \param src source address to test
+   * \param sport source port to test
+   * \return match or 0 if not found
+   */
+  Ipv6EndPoint* SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \return an empty Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (void);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param address IPv6 address
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ipv6Address address);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param boundNetDevice Bound NetDevice (if any)
+   * \param port local port
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ptr<NetDevice> boundNetDevice, uint16_t port);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param boundNetDevice Bound NetDevice (if any)
+   * \param address local address
+   * \param port local port
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Address address, uint16_t port);
+
+  /**
+   * \brief Allocate a Ipv6EndPoint.
+   * \param boundNetDevice Bound NetDevice (if any)
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return an Ipv6EndPoint instance
+   */
+  Ipv6EndPoint * Allocate (Ptr<NetDevice> boundNetDevice,
+                           Ipv6Address localAddress, uint16_t localPort,
+                           Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Remove a end point.
+   * \param endPoint the end point to remove
+   */
+  void DeAllocate (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Get the entire list of end points registered.
+   * \return list of Ipv6EndPoint
+   */
+  EndPoints GetEndPoints () const;
+
+private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of a connected end point.
+   */
+  struct Connection
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    Connection (Ipv6Address localAddress, uint16_t localPort,
+                Ipv6Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param o the other four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator== (const Connection &o) const;
+
+    Ipv6Address localAddress; //!< The local address
+    Ipv6Address peerAddress;  //!< The peer address
+    uint16_t localPort;       //!< The local port
+    uint16_t peerPort;        //!< The peer port
+  };
+
+  /**
+   * \brief Hash function class for the four-tuples.
+   */
+  struct ConnectionHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param connection the four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator() (const Connection &connection) const;
+  };
+
+  /**
+   * \brief Container of the connected end points, by four-tuple.
+   */
+  typedef std::unordered_multimap<Connection, Ipv6EndPoint *, ConnectionHash> Connections;
+
+  /**
+   * \brief Add an end point to the demux.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv6EndPoint * Add (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by four-tuple or by local port.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the indexes.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Tell whether an end point is indexed by four-tuple.
+   * \param endPoint the end point
+   * \return true if the peer address and port of the end point are set
+   */
+  static bool IsConnected (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add the connected end points with a four-tuple to a list.
+   * \param [in] connection the four-tuple
+   * \param [in,out] endPoints the list of end points
+   */
+  void FindConnections (const Connection &connection, std::vector<Ipv6EndPoint *> &endPoints) const;
+
+  /**
+   * \brief Allocate a ephemeral port.
+   * \return a port
+   */
+  uint16_t AllocateEphemeralPort ();
+
+  /**
+   * \brief The ephemeral port.
+   */
+  uint16_t m_ephemeral;
+
+  /**
+   * \brief The first ephemeral port.
+   */
+  uint16_t m_portFirst;
+
+  /**
+   * \brief The last ephemeral port.
+   */
+  uint16_t m_portLast;
+
+  /**
+   * \brief A list of IPv6 end points.
+   */
+  EndPoints m_endPoints;
+
+  /**
+   * \brief The position of each end point in m_endPoints.
+   */
+  std::unordered_map<Ipv6EndPoint *, EndPointsI> m_positions;
+
+  /**
+   * \brief The connected end points, by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The other end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_listeners;
+
+  /**
+   * \brief The number of end points of each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
+};
+
+} /* namespace ns3 */
+
+#endif /* IPV6_END_POINT_DEMUX_H */
+
@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV6_NIX_VECTOR_ROUTING_H
+#define IPV6_NIX_VECTOR_ROUTING_H
+
+#include <unordered_map>
+
+#include "ns3/ipv6-routing-protocol.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/nix-vector.h"
+#include "ns3/nstime.h"
+#include "ns3/nix-vector-graph.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief The nix-vector graph of the IPv6 nodes, and the index of their
+ * addresses.
+ *
+ * It is shared by the Ipv6NixVectorRouting of all the nodes.
+ */
+class Ipv6NixVectorGraph : public NixVectorGraph
+{
+public:
+  Ipv6NixVectorGraph ();
+
+  /**
+   * \brief Rebuild the graph and the index of the addresses before their
+   * next use.
+   */
+  virtual void Invalidate (void);
+
+  /**
+   * \brief Find the node which owns an address.
+   * \param dest the address
+   * \returns the node index, or NONE
+   */
+  uint32_t GetNodeByIp (Ipv6Address dest);
+
+protected:
+  virtual bool IsInterfaceUp (Ptr<NetDevice> device) const;
+
+private:
+  /** The node which owns each address */
+  std::unordered_map<Ipv6Address, uint32_t, Ipv6AddressHash> m_addresses;
+  bool m_addressesValid; //!< Set to false to rebuild the index of the addresses
+};
+
+/**
+ * \ingroup nix-vector-routing
+ * Nix-vector routing protocol for IPv6
+ *
+ * It routes the unicast packets to global addresses, like
+ * Ipv4NixVectorRouting.  The multicast and link-local destinations are
+ * left to the other routing protocols: it is meant to be used with
+ * Ipv6StaticRouting in an Ipv6ListRouting.
+ */
+class Ipv6NixVectorRouting : public Ipv6RoutingProtocol
+{
+public:
+  Ipv6NixVectorRouting ();
+  ~Ipv6NixVectorRouting ();
+  /**
+   * @brief The Interface ID of the Global Router interface.
+   * @return The Interface ID
+   * @see Object::GetObject ()
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * @brief Set the Node pointer of the node for which this
+   * routing protocol is to be placed
+   *
+   * @param node Node pointer
+   */
+  void SetNode (Ptr<Node> node);
+
+  /**
+   * @brief Called when run-time link topology change occurs
+   * which iterates through the node list and flushes any
+   * nix vector caches
+   */
+  void FlushGlobalNixRoutingCache (void) const;
+
+private:
+  /** The nix-vector and the route to a destination, cached by a node */
+  struct CacheEntry
+  {
+    uint32_t node;             //!< The destination node index, or NONE
+    uint32_t version;          //!< The version of the routes to the destination node
+    Ptr<NixVector> nixVector;  //!< The nix-vector from this node, if built
+    Ptr<Ipv6Route> route;      //!< The route, if built
+    uint32_t neighbor;         //!< The neighbor index of the route
+  };
+
+  /// container of CacheEntry, by destination address
+  typedef std::unordered_map<Ipv6Address, CacheEntry, Ipv6AddressHash> Cache;
+
+  /**
+   * Flushes the cache which stores nix-vectors and routes
+   * based on destination IP
+   */
+  void FlushNixCache (void) const;
+
+  /**
+   * \returns The graph shared by all the nodes.
+   */
+  static Ipv6NixVectorGraph *GetGraph (void);
+
+  /**
+   * Checks the cache based on dest IP, and resets the entry
+   * if it is missing or if the routes to the destination changed
+   * \param address Address to check
+   * \returns The cache entry.
+   */
+  CacheEntry &GetCacheEntry (Ipv6Address address);
+
+  /**
+   * Takes in the source node and the dest node and
+   * builds the nix-vector, accounting for any output interface specified
+   *
+   * \param source Source node
+   * \param dest Destination node index
+   * \param oif Preferred output interface
+   * \returns The NixVector to be used in routing.
+   */
+  Ptr<NixVector> GetNixVector (Ptr<Node> source, uint32_t dest, Ptr<NetDevice> oif);
+
+  /**
+   * Builds the route to a neighbor, whose link-local address is the gateway
+   * \param dest Destination address
+   * \param nodeIndex Nix index of the neighbor
+   * \returns The route.
+   */
+  Ptr<Ipv6Route> BuildRoute (Ipv6Address dest, uint32_t nodeIndex);
+
+  void DoDispose (void);
+
+  /* From Ipv6RoutingProtocol */
+  virtual Ptr<Ipv6Route> RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual bool RouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                           UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                           LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address);
+  virtual void NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
+  virtual void NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
+  virtual void SetIpv6 (Ptr<Ipv6> ipv6);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+
+  /** Cache stores nix-vectors and Ipv6Routes based on destination ip */
+  mutable Cache m_cache;
+
+  Ptr<Ipv6> m_ipv6; //!< IPv6 object
+  Ptr<Node> m_node; //!< Node object
+};
+} // namespace ns3
+
+#endif /* IPV6_NIX_VECTOR_ROUTING_H */
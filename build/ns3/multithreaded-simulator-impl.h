@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mpi
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+class PartitionBarrier;
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Shared-memory parallel simulator implementation using lookahead
+ *
+ * The simulation contexts (i.e., the node ids given to
+ * Simulator::ScheduleWithContext) are spread across partitions, and
+ * each partition is run by its own thread with its own event list.
+ * The partitions are synchronized with the same conservative
+ * algorithm as the DistributedSimulatorImpl: all the threads process
+ * the events of a time window [T, T + lookahead), where T is the
+ * smallest timestamp of all the pending events, and then wait for
+ * each other at a barrier before moving to the next window.
+ *
+ * An event scheduled for a context of another partition is simply
+ * handed over to that partition at the end of the window: the event,
+ * and the Ptr<Packet> it may hold, are never serialized. The channels
+ * use Packet::DeepCopy instead of Packet::Copy for the packets they
+ * deliver to such a context (see Simulator::IsLocalContext), so that
+ * the sender and the receiver never share the reference-counted
+ * storage of a packet. For this to
+ * be correct, such an event must not be earlier than the end of the
+ * current window, which is why the lookahead is the smallest delay of
+ * all the channels which connect nodes of different partitions, as
+ * given by their "Delay" attribute. Only a PointToPointChannel or a
+ * SimpleChannel can connect two partitions: the state of the other
+ * channels, e.g., the carrier sense of a CsmaChannel, is shared by all
+ * their devices, and running the simulation aborts when their devices
+ * are in different partitions. The lookahead can be further bounded with
+ * SetMaximumLookAhead, which is required when events are scheduled
+ * across partitions by anything else than a channel.
+ *
+ * By default, the nodes which exist when Run is first called are
+ * assigned to the partitions by blocks of contiguous node ids, and
+ * any other context is assigned round-robin. SetPartition can be used
+ * to provide a better assignment. The number of partitions is given
+ * by the "ThreadCount" attribute.
+ *
+ * The events scheduled without a context (Simulator::NO_CONTEXT) are
+ * run by the first partition. The events of a partition are always run
+ * in timestamp order, but the events of different partitions which
+ * share the same timestamp are run concurrently.
+ *
+ * \warning The models run by different partitions execute concurrently:
+ * an event may only access the state of the nodes of its own partition.
+ * A request to stop the simulation from an event takes effect at the
+ * end of the current window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+  virtual bool IsLocalContext (uint32_t context) const;
+
+  /**
+   * Bound the lookahead, i.e., the smallest delay of the events
+   * scheduled for a context of another partition.
+   *
+   * \param [in] lookAhead The maximum lookahead.
+   */
+  void SetMaximumLookAhead (const Time lookAhead);
+  /**
+   * Assign a context to a partition.
+   *
+   * This must be called before the simulation is first run.
+   *
+   * \param [in] context The context, usually a node id.
+   * \param [in] partition The partition index, modulo the number of
+   *            partitions.
+   */
+  void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \returns The number of partitions, i.e., of threads.
+   */
+  uint32_t GetPartitionCount (void) const;
+  /**
+   * \returns The lookahead used by the last run.
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \returns The number of time windows the simulation went through.
+   */
+  uint64_t GetWindowCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event handed over to another partition. */
+  struct Handover
+  {
+    uint64_t ts;      //!< Event timestamp.
+    uint32_t context; //!< Event context.
+    EventImpl *impl;  //!< The event.
+  };
+
+  /** The state of a partition. */
+  struct Partition
+  {
+    uint32_t index;           //!< Partition index.
+    Ptr<Scheduler> events;    //!< The event list.
+    uint32_t uid;             //!< Next event uid.
+    uint32_t currentUid;      //!< Uid of the current event.
+    uint64_t currentTs;       //!< Timestamp of the current event.
+    uint32_t currentContext;  //!< Context of the current event.
+    uint64_t eventCount;      //!< Number of events run.
+    int unscheduledEvents;    //!< Number of events inserted but not run yet.
+    uint64_t nextTs;          //!< Earliest event at the end of the window.
+    bool stop;                //!< Stop requested by an event.
+    uint64_t stopTs;          //!< Stop time requested by an event.
+    /** Events for the other partitions, indexed by partition. */
+    std::vector<std::vector<Handover> > outbox;
+    Ptr<SystemThread> thread; //!< The thread running this partition.
+  };
+
+  /** Create the partitions, if needed. */
+  void CreatePartitions (void);
+  /**
+   * Get the partition of a context.
+   *
+   * \param [in] context The context.
+   * \returns The partition index.
+   */
+  uint32_t GetPartitionIndex (uint32_t context) const;
+  /**
+   * Get the partition which holds an event.
+   *
+   * \param [in] id The event.
+   * \returns The partition, which must be the one of the calling
+   *          thread if the simulation is running.
+   */
+  Partition & GetOwner (const EventId &id) const;
+  /** Assign the nodes without an explicit partition to a partition. */
+  void AssignPartitions (void);
+  /** Compute the lookahead from the channel delays. */
+  void CalculateLookAhead (void);
+  /**
+   * Insert an event in a partition.
+   *
+   * \param [in] p The partition.
+   * \param [in] ts The event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event.
+   * \returns The event key.
+   */
+  Scheduler::EventKey Insert (Partition &p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Run the events of a partition until the end of the simulation.
+   *
+   * \param [in] p The partition.
+   */
+  void RunPartition (Partition *p);
+  /**
+   * Entry point of the threads of the partitions but the first one.
+   *
+   * \param [in] impl The simulator implementation.
+   * \param [in] p The partition run by the thread.
+   */
+  static void RunThread (MultithreadedSimulatorImpl *impl, Partition *p);
+  /**
+   * Run the next event of a partition.
+   *
+   * \param [in] p The partition.
+   */
+  void ProcessOneEvent (Partition &p);
+  /**
+   * Insert in a partition the events handed over by the other ones.
+   *
+   * \param [in] p The partition.
+   */
+  void Deliver (Partition &p);
+  /**
+   * Wait for all the partitions to reach this point. The last thread
+   * to arrive computes the next window if \p nextWindow is \c true.
+   *
+   * \param [in] nextWindow Whether to compute the next window.
+   */
+  void Barrier (bool nextWindow);
+  /** Compute the next time window from the state of the partitions. */
+  void NextWindow (void);
+
+  /** Marker of a context without an explicit partition. */
+  static const uint32_t NO_PARTITION = 0xffffffff;
+
+  /** Container type for the events to run at Simulator::Destroy(). */
+  typedef std::list<EventId> DestroyEvents;
+
+  /** The events to run at Simulator::Destroy(). */
+  DestroyEvents m_destroyEvents;
+  /** Mutex to control access to the destroy event list. */
+  mutable SystemMutex m_destroyMutex;
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** Requested stop time, or the maximum timestamp. */
+  uint64_t m_stopTs;
+  /** The event scheduler factory. */
+  ObjectFactory m_schedulerFactory;
+  /** Number of partitions to create. */
+  uint32_t m_threadCount;
+  /** The partitions. */
+  std::vector<Partition *> m_partitions;
+  /**
+   * Partition of the contexts, indexed by context, or NO_PARTITION
+   * if the context is assigned round-robin.
+   */
+  std::vector<uint32_t> m_partitionOf;
+  /** Whether the contexts have been assigned to their partition. */
+  bool m_partitioned;
+  /** Timestamp of the simulation while not running. */
+  uint64_t m_currentTs;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** Upper bound of the lookahead. */
+  Time m_maxLookAhead;
+  /** End of the current time window (excluded). */
+  uint64_t m_windowEnd;
+  /** Whether all the partitions are finished. */
+  bool m_finished;
+  /** Number of time windows. */
+  uint64_t m_windowCount;
+
+  /** The barrier which ends each phase of a window. */
+  PartitionBarrier *m_barrier;
+
+  /** The partition run by the current thread, if any. */
+  static thread_local Partition *m_current;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,83 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_NETWORK
+    
+
+// Module headers:
+#include "address-utils.h"
+#include "address.h"
+#include "application-container.h"
+#include "application.h"
+#include "ascii-file.h"
+#include "ascii-test.h"
+#include "buffer.h"
+#include "byte-tag-list.h"
+#include "channel-list.h"
+#include "channel.h"
+#include "chunk.h"
+#include "crc32.h"
+#include "data-rate.h"
+#include "delay-jitter-estimation.h"
+#include "drop-tail-queue.h"
+#include "dynamic-queue-limits.h"
+#include "error-channel.h"
+#include "error-model.h"
+#include "ethernet-header.h"
+#include "ethernet-trailer.h"
+#include "flow-id-tag.h"
+#include "generic-phy.h"
+#include "header.h"
+#include "inet-socket-address.h"
+#include "inet6-socket-address.h"
+#include "ipv4-address.h"
+#include "ipv6-address.h"
+#include "llc-snap-header.h"
+#include "mac16-address.h"
+#include "mac48-address.h"
+#include "mac64-address.h"
+#include "mac8-address.h"
+#include "net-device-container.h"
+#include "net-device-queue-interface.h"
+#include "net-device.h"
+#include "nix-vector.h"
+#include "node-container.h"
+#include "node-list.h"
+#include "node.h"
+#include "output-stream-wrapper.h"
+#include "packet-burst.h"
+#include "packet-data-calculators.h"
+#include "packet-metadata.h"
+#include "packet-probe.h"
+#include "packet-socket-address.h"
+#include "packet-socket-client.h"
+#include "packet-socket-factory.h"
+#include "packet-socket-helper.h"
+#include "packet-socket-server.h"
+#include "packet-socket.h"
+#include "packet-tag-list.h"
+#include "packet.h"
+#include "packetbb.h"
+#include "pcap-file-wrapper.h"
+#include "pcap-file.h"
+#include "pcap-test.h"
+#include "queue-item.h"
+#include "queue-limits.h"
+#include "queue-size.h"
+#include "queue.h"
+#include "radiotap-header.h"
+#include "sequence-number.h"
+#include "sgi-hashmap.h"
+#include "simple-channel.h"
+#include "simple-net-device-helper.h"
+#include "simple-net-device.h"
+#include "sll-header.h"
+#include "socket-factory.h"
+#include "socket.h"
+#include "tag-buffer.h"
+#include "tag.h"
+#include "trace-helper.h"
+#include "trailer.h"
+#endif
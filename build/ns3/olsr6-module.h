@@ -0,0 +1,15 @@
+
+#ifdef NS3_MODULE_COMPILATION
+# error "Do not include ns3 module aggregator headers from other modules; these are meant only for end user scripts."
+#endif
+
+#ifndef NS3_MODULE_OLSR6
+    
+
+// Module headers:
+#include "olsr6-header.h"
+#include "olsr6-helper.h"
+#include "olsr6-repositories.h"
+#include "olsr6-routing-protocol.h"
+#include "olsr6-state.h"
+#endif
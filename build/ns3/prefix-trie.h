@@ -0,0 +1,351 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "ns3/assert.h"
+
+/**
+ * \file
+ * \ingroup internet
+ * ns3::PrefixTrie declaration and implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief A path-compressed binary trie (Patricia trie) of address prefixes,
+ * used by the routing protocols for their longest prefix match lookups.
+ *
+ * Each prefix holds the values inserted for it, in insertion order.
+ * A lookup returns the values of all the prefixes which contain an
+ * address, from the longest prefix to the shortest, visiting at most
+ * one node per bit of the address whatever the number of prefixes.
+ *
+ * The addresses are arrays of N bytes in network byte order, as
+ * written by Ipv4Address::Serialize and Ipv6Address::GetBytes.  Only
+ * contiguous masks are supported: a prefix is the first \c length bits
+ * of its address.
+ *
+ * \tparam T \explicit The value type, which must be equality comparable.
+ * \tparam N \explicit The size of the addresses, in bytes.
+ */
+template <typename T, uint32_t N>
+class PrefixTrie
+{
+public:
+  /** The values of a prefix. */
+  typedef std::vector<T> Values;
+
+  /** The maximum number of prefixes matching an address. */
+  static const uint32_t MAX_MATCHES = N * 8 + 1;
+
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  /**
+   * Add a value to a prefix, after the values already held by the prefix.
+   * \param [in] prefix The prefix address; the bits after the prefix
+   *             length are ignored.
+   * \param [in] length The prefix length, in bits.
+   * \param [in] value The value.
+   */
+  void Insert (const uint8_t *prefix, uint32_t length, const T &value);
+  /**
+   * Remove the first occurrence of a value from a prefix.
+   * \param [in] prefix The prefix address; the bits after the prefix
+   *             length are ignored.
+   * \param [in] length The prefix length, in bits.
+   * \param [in] value The value.
+   * \returns \c true if the value was found and removed.
+   */
+  bool Remove (const uint8_t *prefix, uint32_t length, const T &value);
+  /** Remove all the prefixes. */
+  void Clear (void);
+  /**
+   * Find the prefixes which contain an address.
+   * \param [in] address The address.
+   * \param [out] matches The values of the matching prefixes, from the
+   *              longest prefix to the shortest; the array must hold at
+   *              least MAX_MATCHES elements.
+   * \returns The number of matching prefixes.
+   */
+  uint32_t Lookup (const uint8_t *address, const Values **matches) const;
+
+private:
+  /** A prefix of the trie. */
+  struct Node
+  {
+    uint8_t prefix[N];  //!< The prefix address, zero after the prefix length.
+    uint32_t length;    //!< The prefix length, in bits.
+    Node *child[2];     //!< The longer prefixes, by their next bit.
+    Values values;      //!< The values of the prefix; empty for a branch node.
+  };
+
+  /**
+   * Disable the copy.
+   * \param [in] o The trie to copy.
+   */
+  PrefixTrie (const PrefixTrie &o);
+  /**
+   * Disable the assignment.
+   * \param [in] o The trie to copy.
+   * \returns This trie.
+   */
+  PrefixTrie &operator= (const PrefixTrie &o);
+
+  /**
+   * Create a node.
+   * \param [in] prefix The prefix address.
+   * \param [in] length The prefix length, in bits.
+   * \returns The new node.
+   */
+  static Node *CreateNode (const uint8_t *prefix, uint32_t length);
+  /**
+   * Delete a node and all its descendants.
+   * \param [in] node The node.
+   */
+  static void DeleteNode (Node *node);
+  /**
+   * Get one bit of an address.
+   * \param [in] address The address.
+   * \param [in] i The bit index, from the most significant bit.
+   * \returns The bit.
+   */
+  static uint32_t GetBit (const uint8_t *address, uint32_t i);
+  /**
+   * Get the length of the common prefix of two addresses.
+   * \param [in] a The first address.
+   * \param [in] b The second address.
+   * \param [in] max The maximum length to compare, in bits.
+   * \returns The number of leading bits which are equal, up to max.
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max);
+
+  Node *m_root; //!< The zero length prefix, which is always present.
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::PrefixTrie ()
+{
+  uint8_t zero[N] = {};
+  m_root = CreateNode (zero, 0);
+}
+
+template <typename T, uint32_t N>
+PrefixTrie<T, N>::~PrefixTrie ()
+{
+  DeleteNode (m_root);
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Insert (const uint8_t *prefix, uint32_t length, const T &value)
+{
+  NS_ASSERT (length <= N * 8);
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      uint32_t bit = GetBit (prefix, node->length);
+      Node *child = node->child[bit];
+      if (child == 0)
+        {
+          child = CreateNode (prefix, length);
+          child->values.push_back (value);
+          node->child[bit] = child;
+          return;
+        }
+      uint32_t common = GetCommonLength (prefix, child->prefix, std::min (length, child->length));
+      if (common < child->length)
+        {
+          // The new prefix diverges from the child, or is a prefix of
+          // it: insert a node for the common part above the child.
+          Node *split = CreateNode (prefix, common);
+          split->child[GetBit (child->prefix, common)] = child;
+          node->child[bit] = split;
+          if (common == length)
+            {
+              split->values.push_back (value);
+            }
+          else
+            {
+              Node *leaf = CreateNode (prefix, length);
+              leaf->values.push_back (value);
+              split->child[GetBit (prefix, common)] = leaf;
+            }
+          return;
+        }
+      node = child;
+    }
+  node->values.push_back (value);
+}
+
+template <typename T, uint32_t N>
+bool
+PrefixTrie<T, N>::Remove (const uint8_t *prefix, uint32_t length, const T &value)
+{
+  Node *path[MAX_MATCHES];
+  uint32_t depth = 0;
+  Node *node = m_root;
+  path[depth++] = node;
+  while (node->length < length)
+    {
+      node = node->child[GetBit (prefix, node->length)];
+      if (node == 0 || node->length > length
+          || GetCommonLength (prefix, node->prefix, node->length) < node->length)
+        {
+          return false;
+        }
+      path[depth++] = node;
+    }
+  typename Values::iterator i = std::find (node->values.begin (), node->values.end (), value);
+  if (i == node->values.end ())
+    {
+      return false;
+    }
+  node->values.erase (i);
+
+  // Remove the nodes left without values and with less than two children.
+  for (uint32_t j = depth - 1; j > 0; j--)
+    {
+      node = path[j];
+      if (!node->values.empty () || (node->child[0] != 0 && node->child[1] != 0))
+        {
+          break;
+        }
+      Node *parent = path[j - 1];
+      Node *only = node->child[0] != 0 ? node->child[0] : node->child[1];
+      parent->child[GetBit (node->prefix, parent->length)] = only;
+      node->child[0] = 0;
+      node->child[1] = 0;
+      DeleteNode (node);
+      if (only != 0)
+        {
+          break;
+        }
+    }
+  return true;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::Clear (void)
+{
+  DeleteNode (m_root->child[0]);
+  DeleteNode (m_root->child[1]);
+  m_root->child[0] = 0;
+  m_root->child[1] = 0;
+  m_root->values.clear ();
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::Lookup (const uint8_t *address, const Values **matches) const
+{
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (node != 0 && GetCommonLength (address, node->prefix, node->length) == node->length)
+    {
+      if (!node->values.empty ())
+        {
+          matches[n++] = &node->values;
+        }
+      if (node->length == N * 8)
+        {
+          break;
+        }
+      node = node->child[GetBit (address, node->length)];
+    }
+  std::reverse (matches, matches + n);
+  return n;
+}
+
+template <typename T, uint32_t N>
+typename PrefixTrie<T, N>::Node *
+PrefixTrie<T, N>::CreateNode (const uint8_t *prefix, uint32_t length)
+{
+  Node *node = new Node;
+  std::memset (node->prefix, 0, N);
+  std::memcpy (node->prefix, prefix, length / 8);
+  if (length % 8 != 0)
+    {
+      node->prefix[length / 8] = prefix[length / 8] & (0xff << (8 - length % 8));
+    }
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+template <typename T, uint32_t N>
+void
+PrefixTrie<T, N>::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->child[0]);
+      DeleteNode (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetBit (const uint8_t *address, uint32_t i)
+{
+  return (address[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <typename T, uint32_t N>
+uint32_t
+PrefixTrie<T, N>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max)
+{
+  uint32_t length = 0;
+  for (uint32_t i = 0; length < max; i++, length += 8)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              length++;
+            }
+          break;
+        }
+    }
+  return std::min (length, max);
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
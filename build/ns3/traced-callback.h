@@ -0,0 +1,696 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2005,2006,2007 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+
+#ifndef TRACED_CALLBACK_H
+#define TRACED_CALLBACK_H
+
+#include <vector>
+#include "callback.h"
+
+/**
+ * \file
+ * \ingroup tracing
+ * ns3::TracedCallback declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup tracing
+ * \brief Forward calls to a chain of Callback
+ *
+ * An TracedCallback has almost exactly the same API as a normal
+ * Callback but instead of forwarding calls to a single function
+ * (as a Callback normally does), it forwards calls to a chain
+ * of Callback.  Connect adds a Callback at the end of the chain
+ * of callbacks.  Disconnect removes a Callback from the chain of callbacks.
+ *
+ * This is a functor: the chain of Callbacks is invoked by
+ * calling one of the \c operator() forms with the appropriate
+ * number of arguments.
+ *
+ * The chain is stored in a contiguous array, so that firing a trace
+ * source which has no Callback connected, the common case, costs a
+ * single comparison.  Callers which need to build the trace arguments
+ * can test IsEmpty() first to skip that work as well.
+ *
+ * When ns-3 is configured with \c --disable-tracing, which defines
+ * \c NS3_TRACING_DISABLE, the \c operator() forms do nothing and
+ * IsEmpty() always returns \c true: Callbacks can still be connected
+ * but are never invoked, and the compiler removes the trace calls
+ * entirely.  This disables all trace sources, including the ones used
+ * by the pcap and ascii trace helpers.
+ *
+ * \tparam T1 \explicit Type of the first argument to the functor.
+ * \tparam T2 \explicit Type of the second argument to the functor.
+ * \tparam T3 \explicit Type of the third argument to the functor.
+ * \tparam T4 \explicit Type of the fourth argument to the functor.
+ * \tparam T5 \explicit Type of the fifth argument to the functor.
+ * \tparam T6 \explicit Type of the sixth argument to the functor.
+ * \tparam T7 \explicit Type of the seventh argument to the functor.
+ * \tparam T8 \explicit Type of the eighth argument to the functor.
+ */
+template<typename T1 = empty, typename T2 = empty, 
+         typename T3 = empty, typename T4 = empty,
+         typename T5 = empty, typename T6 = empty,
+         typename T7 = empty, typename T8 = empty>
+class TracedCallback 
+{
+public:
+  /** Constructor. */
+  TracedCallback ();
+  /**
+   * Append a Callback to the chain (without a context).
+   *
+   * \param [in] callback Callback to add to chain.
+   */
+  void ConnectWithoutContext (const CallbackBase & callback);
+  /**
+   * Append a Callback to the chain with a context.
+   *
+   * The context string will be provided as the first argument
+   * to the Callback.
+   *
+   * \param [in] callback Callback to add to chain.
+   * \param [in] path Context string to provide when invoking the Callback.
+   */
+  void Connect (const CallbackBase & callback, std::string path);
+  /**
+   * Remove from the chain a Callback which was connected without a context.
+   *
+   * \param [in] callback Callback to remove from the chain.
+   */
+  void DisconnectWithoutContext (const CallbackBase & callback);
+  /**
+   * Remove from the chain a Callback which was connected with a context.
+   *
+   * \param [in] callback Callback to remove from the chain.
+   * \param [in] path Context path which was used to connect the Callback.
+   */
+  void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check if the chain of Callbacks is empty.
+   *
+   * \returns \c true if invoking the chain would not invoke any Callback.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * \name Functors taking various numbers of arguments.
+   *
+   * The version selected is determined by the number of arguments
+   * at the point where the Callback is invoked in the class
+   * which fires the Callback.
+   */
+  /**@{*/
+  /** Functor which invokes the chain of Callbacks. */
+  void operator() (void) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   */
+  void operator() (T1 a1) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   * \param [in] a3 The third argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2, T3 a3) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \tparam T4 \deduced Type of the fourth argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   * \param [in] a3 The third argument to the functor.
+   * \param [in] a4 The fourth argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2, T3 a3, T4 a4) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \tparam T4 \deduced Type of the fourth argument to the functor.
+   * \tparam T5 \deduced Type of the fifth argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   * \param [in] a3 The third argument to the functor.
+   * \param [in] a4 The fourth argument to the functor.
+   * \param [in] a5 The fifth argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \tparam T4 \deduced Type of the fourth argument to the functor.
+   * \tparam T5 \deduced Type of the fifth argument to the functor.
+   * \tparam T6 \deduced Type of the sixth argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   * \param [in] a3 The third argument to the functor.
+   * \param [in] a4 The fourth argument to the functor.
+   * \param [in] a5 The fifth argument to the functor.
+   * \param [in] a6 The sixth argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \tparam T4 \deduced Type of the fourth argument to the functor.
+   * \tparam T5 \deduced Type of the fifth argument to the functor.
+   * \tparam T6 \deduced Type of the sixth argument to the functor.
+   * \tparam T7 \deduced Type of the seventh argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   * \param [in] a3 The third argument to the functor.
+   * \param [in] a4 The fourth argument to the functor.
+   * \param [in] a5 The fifth argument to the functor.
+   * \param [in] a6 The sixth argument to the functor.
+   * \param [in] a7 The seventh argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const;
+  /**
+   * \copybrief operator()()
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \tparam T4 \deduced Type of the fourth argument to the functor.
+   * \tparam T5 \deduced Type of the fifth argument to the functor.
+   * \tparam T6 \deduced Type of the sixth argument to the functor.
+   * \tparam T7 \deduced Type of the seventh argument to the functor.
+   * \tparam T8 \deduced Type of the eighth argument to the functor.
+   * \param [in] a1 The first argument to the functor.
+   * \param [in] a2 The second argument to the functor.
+   * \param [in] a3 The third argument to the functor.
+   * \param [in] a4 The fourth argument to the functor.
+   * \param [in] a5 The fifth argument to the functor.
+   * \param [in] a6 The sixth argument to the functor.
+   * \param [in] a7 The seventh argument to the functor.
+   * \param [in] a8 The eighth argument to the functor.
+   */
+  void operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const;
+  /**@}*/
+
+  /**
+   *  TracedCallback signature for POD.
+   *
+   * \param [in] value Value of the traced variable.
+   * @{
+   */
+  // Uint32Callback appears to be the only one used at the moment.
+  // Feel free to add typedef's for any other POD you need.
+  typedef void (* Uint32Callback)(const uint32_t value);
+  /**@}*/
+
+  
+private:
+  /**
+   * \name Invoke the chain of Callbacks, which is not empty.
+   *
+   * The \c operator() forms are small enough to be inlined at the
+   * trace sources, so that the trace arguments are not even copied
+   * when the chain is empty.  They defer the invocation of the chain
+   * to these functions.
+   */
+  /**@{*/
+  /** \copydoc operator()() */
+  void Invoke (void) const;
+  /** \copydoc operator()(T1) */
+  void Invoke (const T1 &a1) const;
+  /** \copydoc operator()(T1,T2) */
+  void Invoke (const T1 &a1, const T2 &a2) const;
+  /** \copydoc operator()(T1,T2,T3) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3) const;
+  /** \copydoc operator()(T1,T2,T3,T4) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5,T6) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5,T6,T7) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5,T6,T7,T8) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7, const T8 &a8) const;
+  /**@}*/
+
+  /**
+   * End an invocation of the chain.
+   *
+   * While the chain is being invoked, the Callbacks which are
+   * disconnected are replaced by null Callbacks rather than erased, so
+   * that the index of the invocation in progress still designates the
+   * next Callback.  The outermost invocation erases them when it ends.
+   */
+  void EndInvoke (void) const;
+
+  /**
+   * Container type for holding the chain of Callbacks.
+   *
+   * \tparam T1 \deduced Type of the first argument to the functor.
+   * \tparam T2 \deduced Type of the second argument to the functor.
+   * \tparam T3 \deduced Type of the third argument to the functor.
+   * \tparam T4 \deduced Type of the fourth argument to the functor.
+   * \tparam T5 \deduced Type of the fifth argument to the functor.
+   * \tparam T6 \deduced Type of the sixth argument to the functor.
+   * \tparam T7 \deduced Type of the seventh argument to the functor.
+   * \tparam T8 \deduced Type of the eighth argument to the functor.
+   */
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /**
+   * The chain of Callbacks.  Mutable so that the Callbacks disconnected
+   * during an invocation are erased at its end.
+   */
+  mutable CallbackList m_callbackList;
+  /** The number of invocations of the chain in progress. */
+  mutable uint32_t m_invoking;
+  /** Whether Callbacks were disconnected during the invocations in progress. */
+  mutable bool m_disconnected;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
+  : m_callbackList (),
+    m_invoking (0),
+    m_disconnected (false)
+{
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBase & callback)
+{
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
+  if (!cb.Assign (callback))
+    NS_FATAL_ERROR_NO_MSG();
+  m_callbackList.push_back (cb);
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback, std::string path)
+{
+  Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
+  if (!cb.Assign (callback))
+    NS_FATAL_ERROR ("when connecting to " << path);
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
+  m_callbackList.push_back (realCb);
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
+{
+  for (typename CallbackList::iterator i = m_callbackList.begin ();
+       i != m_callbackList.end (); /* empty */)
+    {
+      if (!(*i).IsNull () && (*i).IsEqual (callback))
+        {
+          if (m_invoking > 0)
+            {
+              *i = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+              m_disconnected = true;
+              i++;
+            }
+          else
+            {
+              i = m_callbackList.erase (i);
+            }
+        }
+      else
+        {
+          i++;
+        }
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callback, std::string path)
+{
+  Callback<void,std::string,T1,T2,T3,T4,T5,T6,T7,T8> cb;
+  if (!cb.Assign (callback))
+    NS_FATAL_ERROR ("when disconnecting from " << path);
+  Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
+  DisconnectWithoutContext (realCb);
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+#ifdef NS3_TRACING_DISABLE
+  return true;
+#else
+  return m_callbackList.empty ();
+#endif
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndInvoke (void) const
+{
+  m_invoking--;
+  if (m_invoking > 0 || !m_disconnected)
+    {
+      return;
+    }
+  typename CallbackList::iterator j = m_callbackList.begin ();
+  for (typename CallbackList::iterator i = m_callbackList.begin ();
+       i != m_callbackList.end (); i++)
+    {
+      if (!i->IsNull ())
+        {
+          *j++ = *i;
+        }
+    }
+  m_callbackList.erase (j, m_callbackList.end ());
+  m_disconnected = false;
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke ();
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (void) const
+{
+  // Index the chain rather than iterate over it: a Callback may connect
+  // another one to this chain, which can reallocate the array.  The
+  // Callbacks disconnected meanwhile are only nulled (see EndInvoke).
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i]();
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2, a3);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2, a3, a4);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2, a3, a4, a5);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2, a3, a4, a5, a6);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2, a3, a4, a5, a6, a7);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke (a1, a2, a3, a4, a5, a6, a7, a8);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7, const T8 &a8) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7, a8);
+        }
+    }
+  EndInvoke ();
+}
+
+} // namespace ns3
+
+#endif /* TRACED_CALLBACK_H */
@@ -28,7 +28,10 @@
 #include "attribute.h"
 #include "attribute-helper.h"
 #include "simple-ref-count.h"
+#include "int-to-type.h"
 #include <typeinfo>
+#include <cstddef>
+#include <new>
 
 /**
  * \file
@@ -1096,23 +1099,193 @@ private:
   typename TypeTraits<TX3>::ReferencedType m_a3;  //!< third bound argument
 };
 
+/**
+ * \ingroup callbackimpl
+ * Tag selecting the Callback constructor which takes a CallbackImpl
+ * by value.
+ */
+struct CallbackImplTag
+{
+};
+
 /**
  * \ingroup callbackimpl
  * Base class for Callback class.
  * Provides pimpl abstraction.
+ *
+ * The implementations which are small enough, such as the ones built
+ * by MakeCallback from an object pointer and a member function pointer,
+ * or by MakeBoundCallback from a function pointer and a few pointer-sized
+ * arguments, are stored inline, in a buffer of this class, and copied
+ * with the Callback: building, copying and invoking them does not
+ * allocate memory or follow a pointer to the heap. The other
+ * implementations are allocated on the heap and shared by reference
+ * counting between the copies of the Callback.
  */
 class CallbackBase {
 public:
-  CallbackBase () : m_impl () {}
-  /** \return The impl pointer */
-  Ptr<CallbackImplBase> GetImpl (void) const { return m_impl; }
+  CallbackBase () : m_impl (0), m_copy (0) {}
+  /**
+   * Copy constructor
+   * \param [in] o The callback to copy
+   */
+  CallbackBase (const CallbackBase &o) : m_impl (0), m_copy (0)
+  {
+    DoCopy (o);
+  }
+  /**
+   * Assignment operator
+   * \param [in] o The callback to copy
+   * \returns This callback
+   */
+  CallbackBase & operator = (const CallbackBase &o)
+  {
+    if (this != &o)
+      {
+        DoRelease ();
+        DoCopy (o);
+      }
+    return *this;
+  }
+  ~CallbackBase ()
+  {
+    DoRelease ();
+  }
+  /**
+   * Get the implementation.
+   *
+   * An implementation stored inline is copied to the heap, so that
+   * the returned pointer does not depend on the lifetime of this
+   * callback.
+   *
+   * \return The impl pointer
+   */
+  Ptr<CallbackImplBase> GetImpl (void) const
+  {
+    if (m_copy != 0)
+      {
+        return Ptr<CallbackImplBase> (m_copy (m_impl, 0), false);
+      }
+    return Ptr<CallbackImplBase> (m_impl);
+  }
+  /**
+   * \return The impl pointer, which is only valid as long as this
+   *         callback is not modified or destroyed
+   */
+  CallbackImplBase * PeekImpl (void) const
+  {
+    return m_impl;
+  }
 protected:
   /**
    * Construct from a pimpl
    * \param [in] impl The CallbackImplBase Ptr
    */
-  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (impl) {}
-  Ptr<CallbackImplBase> m_impl;         //!< the pimpl
+  CallbackBase (Ptr<CallbackImplBase> impl) : m_impl (PeekPointer (impl)), m_copy (0)
+  {
+    if (m_impl != 0)
+      {
+        m_impl->Ref ();
+      }
+  }
+  /**
+   * Set the implementation, inline if it fits in the buffer.
+   *
+   * \tparam IMPL \deduced The CallbackImpl subclass
+   * \param [in] impl The implementation to copy
+   */
+  template <typename IMPL>
+  void DoSetImpl (IMPL const &impl)
+  {
+    DoRelease ();
+    DoSetImpl (impl, IntToType<(sizeof (IMPL) <= sizeof (Storage) &&
+                                alignof (IMPL) <= alignof (Storage))> ());
+  }
+  /** Discard the implementation */
+  void DoRelease (void)
+  {
+    if (m_copy != 0)
+      {
+        m_impl->~CallbackImplBase ();
+        m_copy = 0;
+      }
+    else if (m_impl != 0)
+      {
+        m_impl->Unref ();
+      }
+    m_impl = 0;
+  }
+private:
+  /**
+   * Store an implementation inline.
+   * \tparam IMPL \deduced The CallbackImpl subclass
+   * \param [in] impl The implementation to copy
+   */
+  template <typename IMPL>
+  void DoSetImpl (IMPL const &impl, IntToType<1>)
+  {
+    m_impl = new (&m_storage) IMPL (impl);
+    m_copy = &CallbackBase::DoCopyImpl<IMPL>;
+  }
+  /**
+   * Store an implementation on the heap.
+   * \tparam IMPL \deduced The CallbackImpl subclass
+   * \param [in] impl The implementation to copy
+   */
+  template <typename IMPL>
+  void DoSetImpl (IMPL const &impl, IntToType<0>)
+  {
+    m_impl = new IMPL (impl);
+  }
+  /**
+   * Copy an implementation stored inline.
+   * \tparam IMPL \explicit The CallbackImpl subclass
+   * \param [in] impl The implementation to copy
+   * \param [in] buffer The memory of the copy, or 0 to allocate it on the heap
+   * \return The copy
+   */
+  template <typename IMPL>
+  static CallbackImplBase * DoCopyImpl (const CallbackImplBase *impl, void *buffer)
+  {
+    IMPL const *src = static_cast<IMPL const *> (impl);
+    if (buffer == 0)
+      {
+        return new IMPL (*src);
+      }
+    return new (buffer) IMPL (*src);
+  }
+  /**
+   * Share or copy the implementation of another callback.
+   * \param [in] o The other callback
+   */
+  void DoCopy (const CallbackBase &o)
+  {
+    if (o.m_copy != 0)
+      {
+        m_impl = o.m_copy (o.m_impl, &m_storage);
+        m_copy = o.m_copy;
+      }
+    else
+      {
+        m_impl = o.m_impl;
+        if (m_impl != 0)
+          {
+            m_impl->Ref ();
+          }
+      }
+  }
+
+  /** Buffer of the implementations stored inline. */
+  union Storage
+  {
+    std::max_align_t align;          //!< the alignment
+    unsigned char data[48];          //!< the buffer
+  };
+
+  CallbackImplBase *m_impl;             //!< the pimpl, inline or on the heap
+  /** The copy function of the inline pimpl, or 0 if it is on the heap. */
+  CallbackImplBase * (*m_copy)(const CallbackImplBase *impl, void *buffer);
+  Storage m_storage;                    //!< the inline pimpl
 };
 
 /**
@@ -1188,8 +1361,9 @@ public:
    */
   template <typename FUNCTOR>
   Callback (FUNCTOR const &functor, bool, bool) 
-    : CallbackBase (Create<FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (functor))
-  {}
+  {
+    DoSetImpl (FunctorCallbackImpl<FUNCTOR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (functor));
+  }
 
   /**
    * Construct a member function pointer call back.
@@ -1199,8 +1373,9 @@ public:
    */
   template <typename OBJ_PTR, typename MEM_PTR>
   Callback (OBJ_PTR const &objPtr, MEM_PTR memPtr)
-    : CallbackBase (Create<MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> > (objPtr, memPtr))
-  {}
+  {
+    DoSetImpl (MemPtrCallbackImpl<OBJ_PTR,MEM_PTR,R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (objPtr, memPtr));
+  }
 
   /**
    * Construct from a CallbackImpl pointer
@@ -1211,6 +1386,18 @@ public:
     : CallbackBase (impl)
   {}
 
+  /**
+   * Construct from a CallbackImpl, stored inline if small enough
+   *
+   * \tparam IMPL \deduced The CallbackImpl subclass
+   * \param [in] impl The CallbackImpl to copy
+   */
+  template <typename IMPL>
+  Callback (IMPL const &impl, CallbackImplTag)
+  {
+    DoSetImpl (impl);
+  }
+
   /**
    * Bind the first arguments
    *
@@ -1219,12 +1406,10 @@ public:
    */
   template <typename T>
   Callback<R,T2,T3,T4,T5,T6,T7,T8,T9> Bind (T a) {
-    Ptr<CallbackImpl<R,T2,T3,T4,T5,T6,T7,T8,T9,empty> > impl =
-      Ptr<CallbackImpl<R,T2,T3,T4,T5,T6,T7,T8,T9,empty> > (
-        new BoundFunctorCallbackImpl<
-          Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
-          R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a), false);
-    return Callback<R,T2,T3,T4,T5,T6,T7,T8,T9> (impl);
+    return Callback<R,T2,T3,T4,T5,T6,T7,T8,T9> (
+      BoundFunctorCallbackImpl<
+        Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
+        R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a), CallbackImplTag ());
   }
 
   /**
@@ -1236,12 +1421,10 @@ public:
    */
   template <typename TX1, typename TX2>
   Callback<R,T3,T4,T5,T6,T7,T8,T9> TwoBind (TX1 a1, TX2 a2) {
-    Ptr<CallbackImpl<R,T3,T4,T5,T6,T7,T8,T9,empty,empty> > impl =
-      Ptr<CallbackImpl<R,T3,T4,T5,T6,T7,T8,T9,empty,empty> > (
-        new TwoBoundFunctorCallbackImpl<
-          Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
-          R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2), false);
-    return Callback<R,T3,T4,T5,T6,T7,T8,T9> (impl);
+    return Callback<R,T3,T4,T5,T6,T7,T8,T9> (
+      TwoBoundFunctorCallbackImpl<
+        Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
+        R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2), CallbackImplTag ());
   }
 
   /**
@@ -1254,12 +1437,10 @@ public:
    */
   template <typename TX1, typename TX2, typename TX3>
   Callback<R,T4,T5,T6,T7,T8,T9> ThreeBind (TX1 a1, TX2 a2, TX3 a3) {
-    Ptr<CallbackImpl<R,T4,T5,T6,T7,T8,T9,empty,empty,empty> > impl =
-      Ptr<CallbackImpl<R,T4,T5,T6,T7,T8,T9,empty,empty,empty> > (
-        new ThreeBoundFunctorCallbackImpl<
-          Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
-          R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2, a3), false);
-    return Callback<R,T4,T5,T6,T7,T8,T9> (impl);
+    return Callback<R,T4,T5,T6,T7,T8,T9> (
+      ThreeBoundFunctorCallbackImpl<
+        Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>,
+        R,T1,T2,T3,T4,T5,T6,T7,T8,T9> (*this, a1, a2, a3), CallbackImplTag ());
   }
 
   /**
@@ -1272,7 +1453,7 @@ public:
   }
   /** Discard the implementation, set it to null */
   void Nullify (void) {
-    m_impl = 0;
+    DoRelease ();
   }
 
   /**
@@ -1391,7 +1572,7 @@ public:
    * \return \c true if we are equal
    */
   bool IsEqual (const CallbackBase &other) const {
-    return m_impl->IsEqual (other.GetImpl ());
+    return PeekImpl ()->IsEqual (Ptr<const CallbackImplBase> (other.PeekImpl ()));
   }
 
   /**
@@ -1401,7 +1582,7 @@ public:
    * \return \c true if other can be dynamic_cast to my type
    */
   bool CheckType (const CallbackBase & other) const {
-    return DoCheckType (other.GetImpl ());
+    return DoCheckType (other.PeekImpl ());
   }
   /**
    * Adopt the other's implementation, if type compatible
@@ -1410,12 +1591,12 @@ public:
    * \returns \c true if \p other was type-compatible and could be adopted.
    */
   bool Assign (const CallbackBase &other) {
-    return DoAssign (other.GetImpl ());
+    return DoAssign (other);
   }
 private:
   /** \return The pimpl pointer */
   CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *DoPeekImpl (void) const {
-    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (m_impl));
+    return static_cast<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekImpl ());
   }
   /**
    * Check for compatible types
@@ -1423,9 +1604,9 @@ private:
    * \param [in] other Callback Ptr
    * \return \c true if other can be dynamic_cast to my type
    */
-  bool DoCheckType (Ptr<const CallbackImplBase> other) const {
+  bool DoCheckType (const CallbackImplBase *other) const {
     if (other != 0 &&
-        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (PeekPointer (other)) != 0)
+        dynamic_cast<const CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> *> (other) != 0)
       {
         return true;
       }
@@ -1439,17 +1620,17 @@ private:
       }
   }
   /** \copydoc Assign */
-  bool DoAssign (Ptr<const CallbackImplBase> other) {
-    if (!DoCheckType (other))
+  bool DoAssign (const CallbackBase &other) {
+    if (!DoCheckType (other.PeekImpl ()))
       {
-        std::string othTid = other->GetTypeid ();
+        std::string othTid = other.PeekImpl ()->GetTypeid ();
         std::string myTid = CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,T9>::DoGetTypeid ();
         NS_FATAL_ERROR_CONT ("Incompatible types. (feed to \"c++filt -t\" if needed)" << std::endl <<
                         "got=" << othTid << std::endl <<
                         "expected=" << myTid);
         return false;
       }
-    m_impl = const_cast<CallbackImplBase *> (PeekPointer (other));
+    CallbackBase::operator = (other);
     return true;
   }
 };
@@ -1684,65 +1865,56 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8,T9> MakeNullCallback (void) {
  */   
 template <typename R, typename TX, typename ARG>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX), ARG a1) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1);
-  return Callback<R> (impl);
+  return Callback<R> (BoundFunctorCallbackImpl<R (*)(TX),R,TX,empty,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1),
+                     CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX,T1), ARG a1) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (BoundFunctorCallbackImpl<R (*)(TX,T1),R,TX,T1,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1),
+                        CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG, 
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX,T1,T2), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2),R,TX,T1,T2,empty,empty,empty,empty,empty,empty> (fnPtr, a1),
+                           CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3),R,TX,T1,T2,T3,empty,empty,empty,empty,empty> (fnPtr, a1),
+                              CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4),R,TX,T1,T2,T3,T4,empty,empty,empty,empty> (fnPtr, a1),
+                                 CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5),R,TX,T1,T2,T3,T4,T5,empty,empty,empty> (fnPtr, a1),
+                                    CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6),R,TX,T1,T2,T3,T4,T5,T6,empty,empty> (fnPtr, a1),
+                                       CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7),R,TX,T1,T2,T3,T4,T5,T6,T7,empty> (fnPtr, a1),
+                                          CallbackImplTag ());
 }
 template <typename R, typename TX, typename ARG,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7, typename T8>
 Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4,T5,T6,T7,T8), ARG a1) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,T8,empty> > impl =
-    Create<BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> > (fnPtr, a1);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> (BoundFunctorCallbackImpl<R (*)(TX,T1,T2,T3,T4,T5,T6,T7,T8),R,TX,T1,T2,T3,T4,T5,T6,T7,T8> (fnPtr, a1),
+                                             CallbackImplTag ());
 }
 /**@}*/
 
@@ -1757,58 +1929,50 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7,T8> MakeBoundCallback (R (*fnPtr)(TX,T1,T2,T3,T4
  */
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2);
-  return Callback<R> (impl);
+  return Callback<R> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2),R,TX1,TX2,empty,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2),
+                     CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1),R,TX1,TX2,T1,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2),
+                        CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2),R,TX1,TX2,T1,T2,empty,empty,empty,empty,empty> (fnPtr, a1, a2),
+                           CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3),R,TX1,TX2,T1,T2,T3,empty,empty,empty,empty> (fnPtr, a1, a2),
+                              CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4),R,TX1,TX2,T1,T2,T3,T4,empty,empty,empty> (fnPtr, a1, a2),
+                                 CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5),R,TX1,TX2,T1,T2,T3,T4,T5,empty,empty> (fnPtr, a1, a2),
+                                    CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6),R,TX1,TX2,T1,T2,T3,T4,T5,T6,empty> (fnPtr, a1, a2),
+                                       CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename ARG1, typename ARG2,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6, typename T7>
 Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7), ARG1 a1, ARG2 a2) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,T7,empty,empty> > impl =
-    Create<TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> > (fnPtr, a1, a2);
-  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6,T7> (TwoBoundFunctorCallbackImpl<R (*)(TX1,TX2,T1,T2,T3,T4,T5,T6,T7),R,TX1,TX2,T1,T2,T3,T4,T5,T6,T7> (fnPtr, a1, a2),
+                                          CallbackImplTag ());
 }
 /**@}*/
 
@@ -1824,51 +1988,44 @@ Callback<R,T1,T2,T3,T4,T5,T6,T7> MakeBoundCallback (R (*fnPtr)(TX1,TX2,T1,T2,T3,
  */
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3>
 Callback<R> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,empty,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> >(fnPtr, a1, a2, a3);
-  return Callback<R> (impl);
+  return Callback<R> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3),R,TX1,TX2,TX3,empty,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3),
+                     CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1>
 Callback<R,T1> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,empty,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1> (impl);
+  return Callback<R,T1> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1),R,TX1,TX2,TX3,T1,empty,empty,empty,empty,empty> (fnPtr, a1, a2, a3),
+                        CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2>
 Callback<R,T1,T2> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,empty,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2> (impl);
+  return Callback<R,T1,T2> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2),R,TX1,TX2,TX3,T1,T2,empty,empty,empty,empty> (fnPtr, a1, a2, a3),
+                           CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3>
 Callback<R,T1,T2,T3> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,empty,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3> (impl);
+  return Callback<R,T1,T2,T3> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3),R,TX1,TX2,TX3,T1,T2,T3,empty,empty,empty> (fnPtr, a1, a2, a3),
+                              CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4>
 Callback<R,T1,T2,T3,T4> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,empty,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4> (impl);
+  return Callback<R,T1,T2,T3,T4> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4),R,TX1,TX2,TX3,T1,T2,T3,T4,empty,empty> (fnPtr, a1, a2, a3),
+                                 CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5>
 Callback<R,T1,T2,T3,T4,T5> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,empty,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5> (impl);
+  return Callback<R,T1,T2,T3,T4,T5> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,empty> (fnPtr, a1, a2, a3),
+                                    CallbackImplTag ());
 }
 template <typename R, typename TX1, typename TX2, typename TX3, typename ARG1, typename ARG2, typename ARG3,
           typename T1, typename T2,typename T3,typename T4,typename T5, typename T6>
 Callback<R,T1,T2,T3,T4,T5,T6> MakeBoundCallback (R (*fnPtr)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6), ARG1 a1, ARG2 a2, ARG3 a3) {
-  Ptr<CallbackImpl<R,T1,T2,T3,T4,T5,T6,empty,empty,empty> > impl =
-    Create<ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> > (fnPtr, a1, a2, a3);
-  return Callback<R,T1,T2,T3,T4,T5,T6> (impl);
+  return Callback<R,T1,T2,T3,T4,T5,T6> (ThreeBoundFunctorCallbackImpl<R (*)(TX1,TX2,TX3,T1,T2,T3,T4,T5,T6),R,TX1,TX2,TX3,T1,T2,T3,T4,T5,T6> (fnPtr, a1, a2, a3),
+                                       CallbackImplTag ());
 }
 /**@}*/
 
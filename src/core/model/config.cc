@@ -25,8 +25,12 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "trace-source-accessor.h"
 
+#include <chrono>
+#include <map>
 #include <sstream>
+#include <unordered_map>
 
 /**
  * \file
@@ -40,6 +44,139 @@ NS_LOG_COMPONENT_DEFINE ("Config");
 
 namespace Config {
 
+/**
+ * \ingroup config-impl
+ * Cache of the TypeId lookups made to resolve Config paths.
+ *
+ * Resolving a Config path looks up the attributes named by the path
+ * elements and the trace sources named by the last element in the
+ * TypeId of every object on the path.  These lookups compare the name
+ * with all the attributes or trace sources of the TypeId and its
+ * parents.  Since the attributes and trace sources of a TypeId do not
+ * change once it is registered, their results are kept in hash tables
+ * indexed by TypeId and name.
+ */
+class TypeIdCache : public Singleton<TypeIdCache>
+{
+public:
+  /** An attribute which holds objects which can be on a Config path. */
+  struct Attribute
+  {
+    /** The attribute name. */
+    std::string name;
+    /** The attribute accessor. */
+    Ptr<const AttributeAccessor> accessor;
+    /** \c true for an ObjectPtrContainerValue, \c false for a PointerValue. */
+    bool container;
+  };
+  /** The attributes which match a Config path element. */
+  typedef std::vector<struct Attribute> Attributes;
+
+  /**
+   * Find the attributes of a TypeId which match a Config path element.
+   *
+   * \param [in] tid The TypeId.
+   * \param [in] item The Config path element: an attribute name or "*".
+   * \returns The PointerValue and ObjectPtrContainerValue attributes
+   *          of \p tid and its parents which match \p item.
+   */
+  const Attributes & LookupAttributes (TypeId tid, const std::string &item);
+  /**
+   * Find a trace source of a TypeId.
+   *
+   * \param [in] tid The TypeId.
+   * \param [in] name The trace source name.
+   * \returns The trace source accessor, or 0 if \p tid has no such
+   *          trace source.
+   */
+  Ptr<const TraceSourceAccessor> LookupTraceSource (TypeId tid, const std::string &name);
+
+private:
+  /** The key of the caches: TypeId uid and name. */
+  typedef std::pair<uint16_t, std::string> Key;
+  /** Hash function of the keys. */
+  struct KeyHash
+  {
+    /**
+     * \param [in] key The key.
+     * \returns The hash of the key.
+     */
+    std::size_t operator () (const Key &key) const
+    {
+      return std::hash<std::string> () (key.second) ^ (key.first * 0x9e3779b97f4a7c15ULL);
+    }
+  };
+
+  /** The attributes found by LookupAttributes(). */
+  std::unordered_map<Key, Attributes, KeyHash> m_attributes;
+  /** The trace sources found by LookupTraceSource(). */
+  std::unordered_map<Key, Ptr<const TraceSourceAccessor>, KeyHash> m_traceSources;
+
+};  // class TypeIdCache
+
+const TypeIdCache::Attributes &
+TypeIdCache::LookupAttributes (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (this << tid << item);
+  Key key (tid.GetUid (), item);
+  std::unordered_map<Key, Attributes, KeyHash>::const_iterator found = m_attributes.find (key);
+  if (found != m_attributes.end ())
+    {
+      return found->second;
+    }
+
+  Attributes attributes;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          struct Attribute attribute;
+          attribute.name = info.name;
+          attribute.accessor = info.accessor;
+          // attempt to cast to a pointer checker or to an object vector.
+          // This could be anything else and we don't know what to do with
+          // it, so we just ignore it.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = false;
+              attributes.push_back (attribute);
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.container = true;
+              attributes.push_back (attribute);
+            }
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+
+  return m_attributes.insert (std::make_pair (key, attributes)).first->second;
+}
+
+Ptr<const TraceSourceAccessor>
+TypeIdCache::LookupTraceSource (TypeId tid, const std::string &name)
+{
+  NS_LOG_FUNCTION (this << tid << name);
+  Key key (tid.GetUid (), name);
+  std::unordered_map<Key, Ptr<const TraceSourceAccessor>, KeyHash>::const_iterator found =
+    m_traceSources.find (key);
+  if (found != m_traceSources.end ())
+    {
+      return found->second;
+    }
+  Ptr<const TraceSourceAccessor> accessor = tid.LookupTraceSourceByName (name);
+  m_traceSources[key] = accessor;
+  return accessor;
+}
+
 MatchContainer::MatchContainer ()
 {
   NS_LOG_FUNCTION (this);
@@ -109,7 +246,12 @@ MatchContainer::Connect (std::string name, const CallbackBase &cb)
     {
       Ptr<Object> object = m_objects[i];
       std::string ctx = m_contexts[i] + name;
-      object->TraceConnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeIdCache::Get ()->LookupTraceSource (object->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->Connect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
@@ -120,7 +262,12 @@ MatchContainer::ConnectWithoutContext (std::string name, const CallbackBase &cb)
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceConnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeIdCache::Get ()->LookupTraceSource (object->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->ConnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
 void 
@@ -132,7 +279,12 @@ MatchContainer::Disconnect (std::string name, const CallbackBase &cb)
     {
       Ptr<Object> object = m_objects[i];
       std::string ctx = m_contexts[i] + name;
-      object->TraceDisconnect (name, ctx, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeIdCache::Get ()->LookupTraceSource (object->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->Disconnect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
@@ -142,7 +294,12 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceDisconnectWithoutContext (name, cb);
+      Ptr<const TraceSourceAccessor> accessor =
+        TypeIdCache::Get ()->LookupTraceSource (object->GetInstanceTypeId (), name);
+      if (accessor != 0)
+        {
+          accessor->DisconnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
 
@@ -150,6 +307,8 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into a list of index ranges.
  */
 class ArrayMatcher
 {
@@ -167,7 +326,20 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (std::size_t i) const;
+  /**
+   * Test if the Config path specification matches a single index.
+   *
+   * \param [out] i The index.
+   * \returns \c true if only the index \p i matches the Config Path.
+   */
+  bool GetSingleIndex (std::size_t *i) const;
 private:
+  /**
+   * Add the index ranges matched by a Config path specification.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -178,79 +350,98 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether the Config path element matches all the indices. */
+  bool m_all;
+  /** The inclusive ranges of indices matched by the Config path element. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator range = m_ranges.begin ();
+       range != m_ranges.end (); ++range)
+    {
+      if (i >= range->first && i <= range->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
 
+bool
+ArrayMatcher::GetSingleIndex (std::size_t *i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all || m_ranges.size () != 1 || m_ranges[0].first != m_ranges[0].second)
+    {
+      return false;
+    }
+  *i = m_ranges[0].first;
+  return true;
+}
+
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 {
@@ -264,6 +455,13 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
+ *
+ * Several Config paths can be resolved together: the objects are
+ * visited once for all the paths, the containers are fetched once and
+ * the array indices are matched through a table of the paths which
+ * select a single index.  This makes the resolution of one path per
+ * node, such as <tt>/NodeList/N/DeviceList/0/Mac</tt>, linear in the
+ * number of nodes.
  */
 class Resolver
 {
@@ -274,42 +472,92 @@ public:
    * \param [in] path The Config path.
    */
   Resolver (std::string path);
+  /**
+   * Construct from several Config paths.
+   *
+   * \param [in] paths The Config paths.
+   */
+  Resolver (const std::vector<std::string> &paths);
   /** Destructor. */
   virtual ~Resolver ();
 
   /**
-   * Parse the stored Config path into an object reference,
+   * Parse the stored Config paths into object references,
    * beginning at the indicated root object.
    *
    * \param [in] root The object corresponding to the current position in
    *                  in the Config path.
    */
   void Resolve (Ptr<Object> root);
+  /**
+   * Get the number of objects visited by Resolve().
+   *
+   * \returns The number of objects visited.
+   */
+  uint64_t GetVisitedN (void) const;
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
+  /** The indices of the Config paths being resolved. */
+  typedef std::vector<uint32_t> PathList;
+
+  /**
+   * Split a Config path into its elements, after ensuring the Config
+   * path starts and ends with a '/'.
+   *
+   * \param [in] path The Config path.
+   */
+  void Canonicalize (std::string path);
   /**
-   * Parse the next element in the Config path.
+   * Parse the next element of the Config paths.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] paths The Config paths still being resolved.
+   * \param [in] depth The index of the next element of the Config paths.
    * \param [in] root The object corresponding to the current position
-   *                  in the Config path.
+   *                  in the Config paths.
+   */
+  void DoResolve (const PathList &paths, std::size_t depth, Ptr<Object> root);
+  /**
+   * Parse the next element of the Config paths, which is the same
+   * for all of them.
+   *
+   * \param [in] item The next element of the Config paths.
+   * \param [in] paths The Config paths still being resolved.
+   * \param [in] depth The index of the next element of the Config paths.
+   * \param [in] root The object corresponding to the current position
+   *                  in the Config paths.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolveItem (const std::string &item, const PathList &paths,
+                      std::size_t depth, Ptr<Object> root);
   /**
-   * Parse an index on the Config path.
+   * Parse an index on the Config paths.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] paths The Config paths still being resolved.
+   * \param [in] depth The index of the index element of the Config paths.
+   * \param [in] container The objects to match against the index.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (const PathList &paths, std::size_t depth,
+                       const ObjectPtrContainerValue &container);
   /**
-   * Handle one object found on the path.
+   * Parse an index on the Config paths, when each of them selects a
+   * single index, by getting only the selected elements of a container.
    *
+   * \param [in] paths The Config paths still being resolved.
+   * \param [in] depth The index of the index element of the Config paths.
+   * \param [in] root The object which holds the container.
+   * \param [in] accessor The accessor of the container.
+   * \returns \c false if the container must be obtained as a whole
+   *          and given to DoArrayResolve, in which case nothing was
+   *          resolved yet.
+   */
+  bool DoIndexResolve (const PathList &paths, std::size_t depth, Ptr<Object> root,
+                       Ptr<const AttributeAccessor> accessor);
+  /**
+   * Handle one object found on a path.
+   *
+   * \param [in] path The index of the Config path.
    * \param [in] object The current object on the Config path.
    */
-  void DoResolveOne (Ptr<Object> object);
+  void DoResolveOne (uint32_t path, Ptr<Object> object);
   /**
    * Get the current Config path.
    *
@@ -319,46 +567,70 @@ private:
   /**
    * Handle one found object.
    *
+   * \param [in] index The index of the Config path.
    * \param [in] object The found object.
    * \param [in] path The matching Config path context.
    */
-  virtual void DoOne (Ptr<Object> object, std::string path) = 0;
+  virtual void DoOne (uint32_t index, Ptr<Object> object, std::string path) = 0;
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The elements of the Config paths. */
+  std::vector<std::vector<std::string> > m_paths;
+  /** The number of objects visited. */
+  uint64_t m_visited;
 
 };  // class Resolver
 
 Resolver::Resolver (std::string path)
-  : m_path (path)
+  : m_visited (0)
 {
   NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  Canonicalize (path);
+}
+Resolver::Resolver (const std::vector<std::string> &paths)
+  : m_visited (0)
+{
+  NS_LOG_FUNCTION (this << paths.size ());
+  for (std::vector<std::string>::const_iterator i = paths.begin (); i != paths.end (); ++i)
+    {
+      Canonicalize (*i);
+    }
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
 void
-Resolver::Canonicalize (void)
+Resolver::Canonicalize (std::string path)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << path);
 
   // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
+  std::string::size_type tmp = path.find ("/");
   if (tmp != 0)
     {
       // no slash at start
-      m_path = "/" + m_path;
+      path = "/" + path;
     }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
     {
       // no slash at end
-      m_path = m_path + "/";
+      path = path + "/";
     }
+
+  // then split the path on the slashes
+  std::vector<std::string> items;
+  std::string::size_type cur = 0;
+  std::string::size_type next = path.find ("/", 1);
+  while (next != std::string::npos)
+    {
+      items.push_back (path.substr (cur + 1, next - cur - 1));
+      cur = next;
+      next = path.find ("/", cur + 1);
+    }
+  m_paths.push_back (items);
 }
 
 void 
@@ -366,7 +638,19 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  PathList paths;
+  for (uint32_t i = 0; i < m_paths.size (); i++)
+    {
+      paths.push_back (i);
+    }
+  DoResolve (paths, 0, root);
+}
+
+uint64_t
+Resolver::GetVisitedN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_visited;
 }
 
 std::string
@@ -383,39 +667,58 @@ Resolver::GetResolvedPath (void) const
 }
 
 void 
-Resolver::DoResolveOne (Ptr<Object> object)
+Resolver::DoResolveOne (uint32_t path, Ptr<Object> object)
 {
-  NS_LOG_FUNCTION (this << object);
+  NS_LOG_FUNCTION (this << path << object);
 
   NS_LOG_DEBUG ("resolved="<<GetResolvedPath ());
-  DoOne (object, GetResolvedPath ());
+  DoOne (path, object, GetResolvedPath ());
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (const PathList &paths, std::size_t depth, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << paths.size () << depth << root);
+  if (root)
+    {
+      m_visited++;
+    }
 
-  if (next == std::string::npos)
-    {
-      //
-      // If root is zero, we're beginning to see if we can use the object name 
-      // service to resolve this path.  It is impossible to have a object name 
-      // associated with the root of the object name service since that root
-      // is not an object.  This path must be referring to something in another
-      // namespace and it will have been found already since the name service
-      // is always consulted last.
-      // 
-      if (root)
+  // Group the paths by their next element, so that each element is
+  // looked up once on this object.
+  std::map<std::string, PathList> items;
+  for (PathList::const_iterator i = paths.begin (); i != paths.end (); ++i)
+    {
+      const std::vector<std::string> &path = m_paths[*i];
+      if (depth == path.size ())
         {
-          DoResolveOne (root);
+          //
+          // If root is zero, we're beginning to see if we can use the object name 
+          // service to resolve this path.  It is impossible to have a object name 
+          // associated with the root of the object name service since that root
+          // is not an object.  This path must be referring to something in another
+          // namespace and it will have been found already since the name service
+          // is always consulted last.
+          // 
+          if (root)
+            {
+              DoResolveOne (*i, root);
+            }
+          continue;
         }
-      return;
+      items[path[depth]].push_back (*i);
+    }
+  for (std::map<std::string, PathList>::const_iterator i = items.begin (); i != items.end (); ++i)
+    {
+      DoResolveItem (i->first, i->second, depth, root);
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+}
+
+void
+Resolver::DoResolveItem (const std::string &item, const PathList &paths,
+                         std::size_t depth, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << item << paths.size () << depth << root);
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -426,11 +729,11 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
+      std::string::size_type offset = item.find ("Names");
       if (offset == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (paths, depth + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -447,7 +750,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (paths, depth + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -477,69 +780,48 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (paths, depth + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const TypeIdCache::Attributes &attributes =
+        TypeIdCache::Get ()->LookupAttributes (root->GetInstanceTypeId (), item);
+      for (TypeIdCache::Attributes::const_iterator i = attributes.begin ();
+           i != attributes.end (); ++i)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!i->container)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<i->name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              i->accessor->Get (PeekPointer (root), pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
+              m_workStack.push_back (i->name);
+              DoResolve (paths, depth + 1, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<i->name<<" on path="<<GetResolvedPath ());
+              m_workStack.push_back (i->name);
+              if (!DoIndexResolve (paths, depth + 1, root, i->accessor))
                 {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
                   ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
+                  i->accessor->Get (PeekPointer (root), vector);
+                  DoArrayResolve (paths, depth + 1, vector);
                 }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
+        }
+      if (attributes.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -548,32 +830,117 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (const PathList &paths, std::size_t depth,
+                          const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << paths.size () << depth << &container);
+
+  // The paths which select a single index are found through a table,
+  // the others are matched against each index.
+  std::map<std::size_t, PathList> indices;
+  std::map<std::string, PathList> elements;
+  for (PathList::const_iterator i = paths.begin (); i != paths.end (); ++i)
     {
-      return;
+      const std::vector<std::string> &path = m_paths[*i];
+      if (depth == path.size ())
+        {
+          continue;
+        }
+      std::size_t index;
+      if (ArrayMatcher (path[depth]).GetSingleIndex (&index))
+        {
+          indices[index].push_back (*i);
+        }
+      else
+        {
+          elements[path[depth]].push_back (*i);
+        }
+    }
+  std::vector<std::pair<ArrayMatcher, PathList> > matchers;
+  for (std::map<std::string, PathList>::const_iterator i = elements.begin (); i != elements.end (); ++i)
+    {
+      matchers.push_back (std::make_pair (ArrayMatcher (i->first), i->second));
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
-      if (matcher.Matches ((*it).first))
+      PathList matched;
+      std::map<std::size_t, PathList>::const_iterator index = indices.find ((*it).first);
+      if (index != indices.end ())
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          matched = index->second;
+        }
+      for (std::vector<std::pair<ArrayMatcher, PathList> >::const_iterator i = matchers.begin ();
+           i != matchers.end (); ++i)
+        {
+          if (i->first.Matches ((*it).first))
+            {
+              matched.insert (matched.end (), i->second.begin (), i->second.end ());
+            }
+        }
+      if (matched.empty ())
+        {
+          continue;
+        }
+      std::ostringstream oss;
+      oss << (*it).first;
+      m_workStack.push_back (oss.str ());
+      DoResolve (matched, depth + 1, (*it).second);
+      m_workStack.pop_back ();
+    }
+}
+
+bool
+Resolver::DoIndexResolve (const PathList &paths, std::size_t depth, Ptr<Object> root,
+                          Ptr<const AttributeAccessor> accessor)
+{
+  NS_LOG_FUNCTION (this << paths.size () << depth << root << accessor);
+
+  const ObjectPtrContainerAccessor *container =
+    dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (accessor));
+  if (container == 0)
+    {
+      return false;
+    }
+  std::map<std::size_t, PathList> indices;
+  for (PathList::const_iterator i = paths.begin (); i != paths.end (); ++i)
+    {
+      const std::vector<std::string> &path = m_paths[*i];
+      if (depth == path.size ())
+        {
+          continue;
+        }
+      std::size_t index;
+      if (!ArrayMatcher (path[depth]).GetSingleIndex (&index))
+        {
+          return false;
+        }
+      indices[index].push_back (*i);
+    }
+  // get all the elements before resolving any of them, as the whole
+  // container is needed if one of them cannot be found by its index.
+  std::vector<Ptr<Object> > elements;
+  for (std::map<std::size_t, PathList>::const_iterator i = indices.begin (); i != indices.end (); ++i)
+    {
+      Ptr<Object> element;
+      if (!container->GetElement (PeekPointer (root), i->first, &element))
+        {
+          return false;
         }
+      elements.push_back (element);
+    }
+  std::vector<Ptr<Object> >::const_iterator element = elements.begin ();
+  for (std::map<std::size_t, PathList>::const_iterator i = indices.begin ();
+       i != indices.end (); ++i, ++element)
+    {
+      std::ostringstream oss;
+      oss << i->first;
+      m_workStack.push_back (oss.str ());
+      DoResolve (i->second, depth + 1, *element);
+      m_workStack.pop_back ();
     }
+  return true;
 }
 
 /**
@@ -593,8 +960,14 @@ public:
   void DisconnectWithoutContext (std::string path, const CallbackBase &cb);
   /** \copydoc Config::Disconnect() */
   void Disconnect (std::string path, const CallbackBase &cb);
-  /** \copydoc Config::LookupMatches() */
+  /** \copydoc Config::LookupMatches(std::string) */
   MatchContainer LookupMatches (std::string path);
+  /** \copydoc Config::LookupMatches(const std::vector<std::string>&) */
+  std::vector<MatchContainer> LookupMatches (const std::vector<std::string> &paths);
+  /** \copydoc Config::GetResolveStats() */
+  ResolveStats GetResolveStats (void) const;
+  /** \copydoc Config::ResetResolveStats() */
+  void ResetResolveStats (void);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -621,6 +994,8 @@ private:
 
   /** The list of Config path roots. */
   Roots m_roots;
+  /** The statistics of the Config path resolutions. */
+  ResolveStats m_stats;
 
 };  // class ConfigImpl
 
@@ -717,20 +1092,31 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  return LookupMatches (std::vector<std::string> (1, path))[0];
+}
+
+std::vector<MatchContainer>
+ConfigImpl::LookupMatches (const std::vector<std::string> &paths)
+{
+  NS_LOG_FUNCTION (this << paths.size ());
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const std::vector<std::string> &paths)
+      : Resolver (paths),
+        m_objects (paths.size ()),
+        m_contexts (paths.size ())
     {}
-    virtual void DoOne (Ptr<Object> object, std::string path)
+    virtual void DoOne (uint32_t index, Ptr<Object> object, std::string path)
     {
-      m_objects.push_back (object);
-      m_contexts.push_back (path);
+      m_objects[index].push_back (object);
+      m_contexts[index].push_back (path);
     }
-    std::vector<Ptr<Object> > m_objects;
-    std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+    std::vector<std::vector<Ptr<Object> > > m_objects;
+    std::vector<std::vector<std::string> > m_contexts;
+  } resolver (paths);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -743,7 +1129,39 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  std::vector<MatchContainer> containers;
+  containers.reserve (paths.size ());
+  uint64_t matches = 0;
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      containers.push_back (MatchContainer (resolver.m_objects[i], resolver.m_contexts[i], paths[i]));
+      matches += resolver.m_objects[i].size ();
+    }
+
+  double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  m_stats.lookups++;
+  m_stats.paths += paths.size ();
+  m_stats.objects += resolver.GetVisitedN ();
+  m_stats.matches += matches;
+  m_stats.seconds += seconds;
+  NS_LOG_INFO ("resolved " << paths.size () << " paths to " << matches
+               << " objects in " << seconds << " s, visiting "
+               << resolver.GetVisitedN () << " objects");
+  return containers;
+}
+
+ResolveStats
+ConfigImpl::GetResolveStats (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_stats;
+}
+
+void
+ConfigImpl::ResetResolveStats (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stats = ResolveStats ();
 }
 
 void 
@@ -884,6 +1302,21 @@ MatchContainer LookupMatches (std::string path)
   NS_LOG_FUNCTION (path);
   return ConfigImpl::Get ()->LookupMatches (path);
 }
+std::vector<MatchContainer> LookupMatches (const std::vector<std::string> &paths)
+{
+  NS_LOG_FUNCTION (paths.size ());
+  return ConfigImpl::Get ()->LookupMatches (paths);
+}
+ResolveStats GetResolveStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return ConfigImpl::Get ()->GetResolveStats ();
+}
+void ResetResolveStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  ConfigImpl::Get ()->ResetResolveStats ();
+}
 
 void RegisterRootNamespaceObject (Ptr<Object> obj)
 {
@@ -258,6 +258,52 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \param [in] paths The paths to perform a match against
+ * \returns One container per input path, in the same order, which
+ *          contains all the objects which match the path.
+ *
+ * All the paths are resolved in a single traversal of the object
+ * graph: the containers of objects such as /NodeList are fetched once
+ * and each of their elements is visited once, whatever the number of
+ * paths.  Wiring the trace sources of many objects, such as one path
+ * per node, is thus linear in the number of objects instead of
+ * quadratic.
+ */
+std::vector<MatchContainer> LookupMatches (const std::vector<std::string> &paths);
+
+/**
+ * \ingroup config
+ * The statistics of the Config path resolutions.
+ */
+struct ResolveStats
+{
+  /** Default constructor: all the statistics are zero. */
+  ResolveStats ()
+    : lookups (0), paths (0), objects (0), matches (0), seconds (0)
+  {}
+  uint64_t lookups; //!< Number of resolutions (single or batch).
+  uint64_t paths;   //!< Number of paths resolved.
+  uint64_t objects; //!< Number of objects visited.
+  uint64_t matches; //!< Number of objects matched.
+  double seconds;   //!< Wall-clock time spent resolving, in seconds.
+};
+
+/**
+ * \ingroup config
+ * \returns The statistics of all the path resolutions performed by
+ *          Config::Set, Config::Connect, Config::LookupMatches and the
+ *          related functions since the start of the program or the
+ *          last call to ResetResolveStats.
+ */
+ResolveStats GetResolveStats (void);
+/**
+ * \ingroup config
+ * Reset the statistics returned by GetResolveStats.
+ */
+void ResetResolveStats (void);
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
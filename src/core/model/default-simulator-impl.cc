@@ -22,6 +22,10 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-impl-pool.h"
+#include "boolean.h"
+#include "string.h"
+#include "enum.h"
 
 #include "ptr.h"
 #include "pointer.h"
@@ -29,6 +33,8 @@
 #include "log.h"
 
 #include <cmath>
+#include <chrono>
+#include <fstream>
 
 
 /**
@@ -53,6 +59,24 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventProfiling",
+                   "Record the invocation count, wall-clock time and fan-out "
+                   "of the events, per event type and context.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profiling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EventProfileFile",
+                   "The file the event profile is written to at Simulator::Destroy. "
+                   "No file is written if empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("EventProfileFormat",
+                   "The format of the event profile file.",
+                   EnumValue (EventProfiler::REPORT),
+                   MakeEnumAccessor (&DefaultSimulatorImpl::m_profileFormat),
+                   MakeEnumChecker (EventProfiler::REPORT, "Report",
+                                    EventProfiler::COLLAPSED, "Collapsed"))
   ;
   return tid;
 }
@@ -72,8 +96,10 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profiling = false;
+  m_profileFormat = EventProfiler::REPORT;
+  EventImplPool::Attach ();
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
@@ -93,6 +119,7 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  EventImplPool::Purge ();
   SimulatorImpl::DoDispose ();
 }
 void
@@ -109,6 +136,16 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiling && !m_profileFile.empty ())
+    {
+      std::ofstream os (m_profileFile.c_str ());
+      if (!os.is_open ())
+        {
+          NS_LOG_WARN ("Could not open the event profile file " << m_profileFile);
+          return;
+        }
+      m_profiler.Write (os, m_profileFormat);
+    }
 }
 
 void
@@ -148,7 +185,19 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiling && !next.impl->IsCancelled ())
+    {
+      // every event scheduled by this one takes a new uid.
+      uint32_t uid = m_uid;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now () - start;
+      m_profiler.Record (next.impl, next.key.m_context, elapsed.count (), m_uid - uid);
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -163,26 +212,20 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.IsEmpty ())
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  m_eventsWithContextBatch.clear ();
+  m_eventsWithContext.Drain (m_eventsWithContextBatch);
+  for (std::vector<EventInjectionQueue::Entry>::const_iterator i = m_eventsWithContextBatch.begin ();
+       i != m_eventsWithContextBatch.end (); ++i)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
        Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
+       ev.impl = i->event;
+       ev.key.m_ts = m_currentTs + i->timestamp;
+       ev.key.m_context = i->context;
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
@@ -196,6 +239,7 @@ DefaultSimulatorImpl::Run (void)
   NS_LOG_FUNCTION (this);
   // Set the current threadId as the main threadId
   m_main = SystemThread::Self();
+  EventImplPool::Attach ();
   ProcessEventsWithContext ();
   m_stop = false;
 
@@ -265,16 +309,8 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      m_eventsWithContext.Push (context, delay.GetTimeStep (), event);
     }
 }
 
@@ -419,4 +455,16 @@ DefaultSimulatorImpl::GetEventCount (void) const
   return m_eventCount;
 }
 
+EventInjectionQueue::Stats
+DefaultSimulatorImpl::GetInjectionStats (void) const
+{
+  return m_eventsWithContext.GetStats ();
+}
+
+const EventProfiler &
+DefaultSimulatorImpl::GetEventProfiler (void) const
+{
+  return m_profiler;
+}
+
 } // namespace ns3
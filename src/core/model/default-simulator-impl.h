@@ -24,12 +24,15 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-injection-queue.h"
+#include "event-profiler.h"
 #include "system-thread.h"
-#include "system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
 
 /**
  * \file
@@ -43,6 +46,11 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the "EventProfiling" attribute is set, the cost of each event
+ * is recorded by an EventProfiler, per event type and context, and the
+ * profile is written to the "EventProfileFile" file, if any, at
+ * Simulator::Destroy().
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -79,6 +87,22 @@ public:
   virtual uint32_t GetContext (void) const;
   virtual uint64_t GetEventCount (void) const;
 
+  /**
+   * Get the counters of the events scheduled by other threads with
+   * Simulator::ScheduleWithContext.
+   *
+   * \returns The injection counters.
+   */
+  EventInjectionQueue::Stats GetInjectionStats (void) const;
+  /**
+   * Get the profile of the events run so far.
+   *
+   * The profile is empty unless the "EventProfiling" attribute is set.
+   *
+   * \returns The event profiler.
+   */
+  const EventProfiler & GetEventProfiler (void) const;
+
 private:
   virtual void DoDispose (void);
 
@@ -87,26 +111,10 @@ private:
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
-  /** Wrap an event with its execution context. */
-  struct EventWithContext {
-    /** The event context. */
-    uint32_t context;
-    /** Event timestamp. */
-    uint64_t timestamp;
-    /** The event implementation. */
-    EventImpl *event;
-  };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
-  /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
-   */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  /** The events scheduled by other threads. */
+  EventInjectionQueue m_eventsWithContext;
+  /** The last batch of events drained from #m_eventsWithContext. */
+  std::vector<EventInjectionQueue::Entry> m_eventsWithContextBatch;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -135,6 +143,15 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Flag \c true if the events are profiled. */
+  bool m_profiling;
+  /** The file the profile is written to at Destroy. */
+  std::string m_profileFile;
+  /** The format of the profile file. */
+  EventProfiler::Format m_profileFormat;
+  /** The event profile. */
+  EventProfiler m_profiler;
 };
 
 } // namespace ns3
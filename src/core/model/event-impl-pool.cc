@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-impl-pool.h"
+#include "global-value.h"
+#include "boolean.h"
+#include "system-thread.h"
+#include "log.h"
+
+#include <atomic>
+#include <new>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventImplPool implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is avoided in the allocation functions
+// because they are called for every single event.
+NS_LOG_COMPONENT_DEFINE ("EventImplPool");
+
+/**
+ * \ingroup events
+ * Whether EventImpl instances are recycled by the EventImplPool.
+ */
+static GlobalValue g_eventImplPoolEnabled = GlobalValue
+  ("EventImplPoolEnabled",
+   "Recycle the memory of simulation events rather than releasing it to the system",
+   BooleanValue (true),
+   MakeBooleanChecker ());
+
+/**
+ * \ingroup events
+ * Unnamed namespace for the EventImplPool state.
+ *
+ * All this state is plain old data, so that it is valid before any
+ * static constructor and after all the static destructors have run.
+ */
+namespace {
+
+/** A released memory block, linked in a free list. */
+struct FreeBlock
+{
+  FreeBlock *next; //!< The next free block.
+};
+
+/** The size classes are multiples of this size. */
+const std::size_t GRANULARITY = 16;
+/** Number of size classes: larger blocks are never pooled. */
+const std::size_t N_SIZE_CLASSES = 16;
+
+/** One free list per size class. */
+FreeBlock *g_freeLists[N_SIZE_CLASSES];
+/** Whether the pool is enabled. */
+bool g_enabled = false;
+/** The simulation thread, valid when g_enabled is \c true. */
+SystemThread::ThreadId g_owner;
+/** Number of events allocated by the simulation thread. */
+uint64_t g_allocated = 0;
+/** Number of events released by the simulation thread. */
+uint64_t g_released = 0;
+/** Number of events allocated by any other thread. */
+std::atomic<uint64_t> g_foreignAllocated (0);
+/** Number of events released by any other thread. */
+std::atomic<uint64_t> g_foreignReleased (0);
+/** Number of blocks in the free lists. */
+uint64_t g_pooled = 0;
+
+/**
+ * Get the size class of a block.
+ *
+ * \param [in] size The block size.
+ * \returns The size class, which is N_SIZE_CLASSES or larger if
+ *          the block is too large to be pooled.
+ */
+inline std::size_t
+SizeClass (std::size_t size)
+{
+  return (size - 1) / GRANULARITY;
+}
+
+/**
+ * \returns \c true if the pool is enabled and the calling thread is
+ * the simulation thread.
+ */
+inline bool
+IsOwner (void)
+{
+  return g_enabled && SystemThread::Equals (g_owner);
+}
+
+}  // unnamed namespace
+
+void *
+EventImplPool::Allocate (std::size_t size)
+{
+  std::size_t c = SizeClass (size);
+  if (IsOwner ())
+    {
+      g_allocated++;
+      if (c < N_SIZE_CLASSES && g_freeLists[c] != 0)
+        {
+          FreeBlock *block = g_freeLists[c];
+          g_freeLists[c] = block->next;
+          g_pooled--;
+          return block;
+        }
+    }
+  else if (g_enabled)
+    {
+      g_foreignAllocated.fetch_add (1, std::memory_order_relaxed);
+    }
+  if (c < N_SIZE_CLASSES)
+    {
+      // always allocate the full size class to be able to recycle
+      // this block for any other event of the same class.
+      size = (c + 1) * GRANULARITY;
+    }
+  return ::operator new (size);
+}
+
+void
+EventImplPool::Deallocate (void *p, std::size_t size)
+{
+  std::size_t c = SizeClass (size);
+  if (IsOwner ())
+    {
+      g_released++;
+      if (c < N_SIZE_CLASSES)
+        {
+          FreeBlock *block = static_cast<FreeBlock *> (p);
+          block->next = g_freeLists[c];
+          g_freeLists[c] = block;
+          g_pooled++;
+          return;
+        }
+    }
+  else if (g_enabled)
+    {
+      g_foreignReleased.fetch_add (1, std::memory_order_relaxed);
+    }
+  ::operator delete (p);
+}
+
+void
+EventImplPool::Attach (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  BooleanValue enabled;
+  g_eventImplPoolEnabled.GetValue (enabled);
+  if (g_enabled && !enabled.Get ())
+    {
+      Purge ();
+    }
+  g_owner = SystemThread::Self ();
+  g_enabled = enabled.Get ();
+}
+
+void
+EventImplPool::Detach (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_enabled)
+    {
+      Purge ();
+    }
+  g_enabled = false;
+}
+
+void
+EventImplPool::Purge (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (std::size_t c = 0; c < N_SIZE_CLASSES; c++)
+    {
+      while (g_freeLists[c] != 0)
+        {
+          FreeBlock *block = g_freeLists[c];
+          g_freeLists[c] = block->next;
+          ::operator delete (block);
+        }
+    }
+  g_pooled = 0;
+}
+
+bool
+EventImplPool::IsEnabled (void)
+{
+  return g_enabled;
+}
+
+uint64_t
+EventImplPool::GetLiveEvents (void)
+{
+  uint64_t allocated = g_allocated + g_foreignAllocated.load (std::memory_order_relaxed);
+  uint64_t released = g_released + g_foreignReleased.load (std::memory_order_relaxed);
+  // events allocated before the pool was enabled are not accounted for.
+  return allocated > released ? allocated - released : 0;
+}
+
+uint64_t
+EventImplPool::GetPooledEvents (void)
+{
+  return g_pooled;
+}
+
+} // namespace ns3
@@ -19,6 +19,7 @@
  */
 
 #include "event-impl.h"
+#include "event-impl-pool.h"
 #include "log.h"
 
 /**
@@ -66,4 +67,16 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return EventImplPool::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  EventImplPool::Deallocate (p, size);
+}
+
 } // namespace ns3
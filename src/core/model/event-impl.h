@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -66,6 +67,23 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the memory of an EventImpl subclass instance
+   * from the EventImplPool.
+   *
+   * \param [in] size The size of the instance.
+   * \returns The memory block.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an EventImpl subclass instance
+   * to the EventImplPool.
+   *
+   * \param [in] p The memory block.
+   * \param [in] size The size of the instance.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-injection-queue.h"
+#include "event-impl.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventInjectionQueue implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventInjectionQueue");
+
+EventInjectionQueue::EventInjectionQueue ()
+  : m_head (0),
+    m_injected (0),
+    m_batches (0),
+    m_maxBatch (0),
+    m_start (std::chrono::steady_clock::now ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+EventInjectionQueue::~EventInjectionQueue ()
+{
+  NS_LOG_FUNCTION (this);
+  Node *node = m_head.exchange (0, std::memory_order_acquire);
+  while (node != 0)
+    {
+      Node *next = node->next;
+      node->entry.event->Unref ();
+      delete node;
+      node = next;
+    }
+}
+
+void
+EventInjectionQueue::Push (uint32_t context, uint64_t timestamp, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << timestamp << event);
+  Node *node = new Node;
+  node->entry.context = context;
+  node->entry.timestamp = timestamp;
+  node->entry.event = event;
+  node->next = m_head.load (std::memory_order_relaxed);
+  // on failure, node->next is updated with the current head.
+  while (!m_head.compare_exchange_weak (node->next, node,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed))
+    {
+    }
+  m_injected.fetch_add (1, std::memory_order_relaxed);
+}
+
+bool
+EventInjectionQueue::IsEmpty (void) const
+{
+  return m_head.load (std::memory_order_relaxed) == 0;
+}
+
+void
+EventInjectionQueue::Drain (std::vector<Entry> &batch)
+{
+  Node *node = m_head.exchange (0, std::memory_order_acquire);
+  if (node == 0)
+    {
+      return;
+    }
+  // the stack holds the last event first: reverse it.
+  Node *reversed = 0;
+  uint64_t n = 0;
+  while (node != 0)
+    {
+      Node *next = node->next;
+      node->next = reversed;
+      reversed = node;
+      node = next;
+      n++;
+    }
+  while (reversed != 0)
+    {
+      Node *next = reversed->next;
+      batch.push_back (reversed->entry);
+      delete reversed;
+      reversed = next;
+    }
+  m_batches++;
+  if (n > m_maxBatch)
+    {
+      m_maxBatch = n;
+    }
+  NS_LOG_LOGIC ("drained " << n << " events");
+}
+
+EventInjectionQueue::Stats
+EventInjectionQueue::GetStats (void) const
+{
+  Stats stats;
+  stats.injected = m_injected.load (std::memory_order_relaxed);
+  stats.batches = m_batches;
+  stats.maxBatch = m_maxBatch;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - m_start;
+  stats.injectionsPerSecond = elapsed.count () > 0 ? stats.injected / elapsed.count () : 0;
+  return stats;
+}
+
+} // namespace ns3
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "simulator.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <typeinfo>
+
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \ingroup simulator
+ * Order the profile entries by decreasing cumulative time.
+ *
+ * \param [in] a The first entry.
+ * \param [in] b The second entry.
+ * \returns \c true if \p a should be written before \p b.
+ */
+bool
+CompareEntries (const EventProfiler::Entry &a, const EventProfiler::Entry &b)
+{
+  if (a.time != b.time)
+    {
+      return a.time > b.time;
+    }
+  if (a.context != b.context)
+    {
+      return a.context < b.context;
+    }
+  return a.name < b.name;
+}
+
+/**
+ * \ingroup simulator
+ * Find the end of a bracketed sequence.
+ *
+ * \param [in] s The string.
+ * \param [in] start The position of the opening bracket in \p s.
+ * \param [in] open The opening bracket.
+ * \param [in] close The closing bracket.
+ * \returns The position of the matching closing bracket, or
+ *          \c std::string::npos.
+ */
+std::string::size_type
+FindClosing (const std::string &s, std::string::size_type start, char open, char close)
+{
+  int depth = 0;
+  for (std::string::size_type i = start; i < s.size (); i++)
+    {
+      if (s[i] == open)
+        {
+          depth++;
+        }
+      else if (s[i] == close)
+        {
+          depth--;
+          if (depth == 0)
+            {
+              return i;
+            }
+        }
+    }
+  return std::string::npos;
+}
+
+/**
+ * \ingroup simulator
+ * Get the name of an event type from its mangled name.
+ *
+ * \param [in] mangled The mangled name of the EventImpl subclass.
+ * \returns The parameters of the MakeEvent instantiation, or the
+ *          demangled name.
+ */
+std::string
+EventName (const char *mangled)
+{
+  std::string name = mangled;
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled, 0, 0, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // MakeEvent<MEM, OBJ, T1...>(MEM, OBJ, T1...)::EventMemberImpl1 or
+  // MakeEvent<U1, T1>(void (*)(U1), T1)::EventFunctionImpl1: keep the
+  // function parameters, which name the function and bound arguments.
+  std::string::size_type pos = name.find ("MakeEvent");
+  if (pos == std::string::npos)
+    {
+      return name;
+    }
+  pos += 9;
+  if (pos < name.size () && name[pos] == '<')
+    {
+      pos = FindClosing (name, pos, '<', '>');
+      if (pos == std::string::npos)
+        {
+          return name;
+        }
+      pos++;
+    }
+  if (pos < name.size () && name[pos] == '(')
+    {
+      std::string::size_type end = FindClosing (name, pos, '(', ')');
+      if (end != std::string::npos)
+        {
+          name = name.substr (pos + 1, end - pos - 1);
+        }
+    }
+  return name;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+std::size_t
+EventProfiler::KeyHash::operator () (const Key &key) const
+{
+  return key.first.hash_code () ^ (key.second * 0x9e3779b97f4a7c15ULL);
+}
+
+void
+EventProfiler::Record (const EventImpl *event, uint32_t context, uint64_t time, uint64_t fanout)
+{
+  Counters &counters = m_table[Key (std::type_index (typeid (*event)), context)];
+  counters.count++;
+  counters.time += time;
+  counters.fanout += fanout;
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetEntries (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::unordered_map<std::type_index, std::string> names;
+  std::vector<Entry> entries;
+  entries.reserve (m_table.size ());
+  for (Table::const_iterator i = m_table.begin (); i != m_table.end (); ++i)
+    {
+      std::unordered_map<std::type_index, std::string>::iterator name = names.find (i->first.first);
+      if (name == names.end ())
+        {
+          name = names.insert (std::make_pair (i->first.first, EventName (i->first.first.name ()))).first;
+        }
+      Entry entry;
+      entry.name = name->second;
+      entry.context = i->first.second;
+      entry.count = i->second.count;
+      entry.time = i->second.time;
+      entry.fanout = i->second.fanout;
+      entries.push_back (entry);
+    }
+  std::sort (entries.begin (), entries.end (), &CompareEntries);
+  return entries;
+}
+
+std::string
+EventProfiler::GetEventName (const std::type_info &type)
+{
+  return EventName (type.name ());
+}
+
+void
+EventProfiler::Write (std::ostream &os, enum Format format) const
+{
+  NS_LOG_FUNCTION (this << &os << format);
+  std::vector<Entry> entries = GetEntries ();
+  if (format == COLLAPSED)
+    {
+      for (std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+        {
+          if (i->context == Simulator::NO_CONTEXT)
+            {
+              os << "no context";
+            }
+          else
+            {
+              os << "node " << i->context;
+            }
+          os << ";" << i->name << " " << i->time << std::endl;
+        }
+      return;
+    }
+
+  uint64_t count = 0;
+  uint64_t time = 0;
+  for (std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      count += i->count;
+      time += i->time;
+    }
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "# " << count << " events, " << std::fixed << std::setprecision (6)
+     << time * 1e-9 << " s" << std::endl;
+  os << "#" << std::setw (11) << "time (s)"
+     << std::setw (8) << "%"
+     << std::setw (12) << "count"
+     << std::setw (12) << "mean (us)"
+     << std::setw (9) << "fan-out"
+     << std::setw (12) << "context"
+     << "  event" << std::endl;
+  for (std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      os << std::setw (12) << std::setprecision (6) << i->time * 1e-9
+         << std::setw (8) << std::setprecision (2) << (time > 0 ? 100.0 * i->time / time : 0.0)
+         << std::setw (12) << i->count
+         << std::setw (12) << std::setprecision (3) << i->time * 1e-3 / i->count
+         << std::setw (9) << std::setprecision (2) << static_cast<double> (i->fanout) / i->count
+         << std::setw (12);
+      if (i->context == Simulator::NO_CONTEXT)
+        {
+          os << "-";
+        }
+      else
+        {
+          os << i->context;
+        }
+      os << "  " << i->name << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_table.clear ();
+}
+
+} // namespace ns3
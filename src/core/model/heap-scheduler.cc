@@ -236,7 +236,16 @@ HeapScheduler::Remove (const Event &ev)
           NS_ASSERT (m_heap[i].impl == ev.impl);
           Exch (i, Last ());
           m_heap.pop_back ();
-          TopDown (i);
+          // the former last event might be earlier than the parent
+          // of its new position, in which case it must move up.
+          std::size_t index = i;
+          while (!IsBottom (index) && !IsRoot (index)
+                 && IsLessStrictly (index, Parent (index)))
+            {
+              Exch (index, Parent (index));
+              index = Parent (index);
+            }
+          TopDown (index);
           return;
         }
     }
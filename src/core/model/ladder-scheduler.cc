@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include <algorithm>
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+const uint32_t LadderScheduler::SPLIT_THRESHOLD;
+const uint32_t LadderScheduler::MAX_RUNGS;
+const uint32_t LadderScheduler::MAX_BUCKETS;
+
+/**
+ * \ingroup scheduler
+ * Compare (less than) two events by EventKey, for std::sort and friends.
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a < \c b
+ */
+static bool
+EventLess (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key < b.key;
+}
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  // allocate all the rungs upfront to keep references to them stable.
+  m_rungs.resize (MAX_RUNGS);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung) const
+{
+  if (rung.current < rung.nBuckets)
+    {
+      return rung.start + rung.current * rung.width;
+    }
+  return rung.end;
+}
+
+LadderScheduler::Bucket &
+LadderScheduler::GetBucket (Rung &rung, uint64_t ts)
+{
+  uint64_t i = (ts - rung.start) / rung.width;
+  if (i >= rung.nBuckets)
+    {
+      // the last bucket extends up to the end of the rung.
+      i = rung.nBuckets - 1;
+    }
+  return rung.buckets[i];
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  NS_LOG_FUNCTION (this << ts);
+  uint32_t i;
+  for (i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= CurrentStart (m_rungs[i]))
+        {
+          break;
+        }
+    }
+  return i;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::PushRung (Bucket &events, uint64_t start, uint64_t end, uint64_t maxTs)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end << maxTs);
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  NS_ASSERT (!events.empty ());
+  uint32_t nBuckets = std::min<std::size_t> (events.size (), MAX_BUCKETS);
+  uint64_t width = (maxTs - start) / nBuckets + 1;
+  if (end == 0)
+    {
+      end = start + nBuckets * width;
+    }
+  else
+    {
+      nBuckets = std::min<uint64_t> (nBuckets, (end - start + width - 1) / width);
+    }
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+  rung.nBuckets = nBuckets;
+  rung.start = start;
+  rung.end = end;
+  rung.width = width;
+  rung.current = 0;
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      GetBucket (rung, i->key.m_ts).push_back (*i);
+    }
+  events.clear ();
+  NS_LOG_LOGIC ("new rung " << m_nRungs - 1 << ", nBuckets=" << nBuckets <<
+                ", width=" << width << ", end=" << end);
+  return rung;
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottomHead == m_bottom.size ());
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          m_topStart = PushRung (m_top, m_topMin, 0, m_topMax).end;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.nBuckets
+             && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      uint64_t bucketStart = CurrentStart (rung);
+      Bucket &bucket = rung.buckets[rung.current];
+      rung.current++;
+      if (bucket.size () > SPLIT_THRESHOLD && m_nRungs < MAX_RUNGS)
+        {
+          uint64_t minTs = bucket.front ().key.m_ts;
+          uint64_t maxTs = minTs;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              minTs = std::min (minTs, i->key.m_ts);
+              maxTs = std::max (maxTs, i->key.m_ts);
+            }
+          if (minTs != maxTs)
+            {
+              // spread this bucket over a finer rung rather than sort it.
+              PushRung (bucket, bucketStart, CurrentStart (rung), maxTs);
+              continue;
+            }
+        }
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end (), EventLess);
+      NS_LOG_LOGIC ("refill bottom with " << m_bottom.size () << " events");
+      return;
+    }
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  Bucket::iterator i = std::upper_bound (m_bottom.begin () + m_bottomHead,
+                                         m_bottom.end (), ev, EventLess);
+  m_bottom.insert (i, ev);
+  if (m_bottom.size () - m_bottomHead > SPLIT_THRESHOLD
+      && m_nRungs < MAX_RUNGS
+      && m_bottom[m_bottomHead].key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // too many distinct timestamps to keep this array sorted:
+      // move them to a new rung which ends where the bottom tier ends.
+      uint64_t end = m_topStart;
+      if (m_nRungs > 0)
+        {
+          end = CurrentStart (m_rungs[m_nRungs - 1]);
+        }
+      m_bottom.erase (m_bottom.begin (), m_bottom.begin () + m_bottomHead);
+      m_bottomHead = 0;
+      PushRung (m_bottom, m_bottom.front ().key.m_ts, end, m_bottom.back ().key.m_ts);
+      Refill ();
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+    }
+  else
+    {
+      uint32_t r = FindRung (ts);
+      if (r < m_nRungs)
+        {
+          GetBucket (m_rungs[r], ts).push_back (ev);
+        }
+      else
+        {
+          InsertBottom (ev);
+        }
+    }
+  m_qSize++;
+  if (m_bottomHead == m_bottom.size ())
+    {
+      Refill ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_qSize--;
+  if (m_bottomHead == m_bottom.size ())
+    {
+      Refill ();
+    }
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t r = FindRung (ts);
+      if (r < m_nRungs)
+        {
+          bucket = &GetBucket (m_rungs[r], ts);
+        }
+      else
+        {
+          Bucket::iterator i = std::lower_bound (m_bottom.begin () + m_bottomHead,
+                                                 m_bottom.end (), ev, EventLess);
+          NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+          NS_ASSERT (ev.impl == i->impl);
+          m_bottom.erase (i);
+          m_qSize--;
+          if (m_bottomHead == m_bottom.size ())
+            {
+              Refill ();
+            }
+          return;
+        }
+    }
+
+  // unsorted bucket: swap with the last event.
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          *i = bucket->back ();
+          bucket->pop_back ();
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
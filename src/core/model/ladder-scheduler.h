@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the Ladder Queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The events are spread across three tiers:
+ *  - the \em top tier is an unsorted array which receives all the
+ *    events scheduled far in the future;
+ *  - the \em ladder is a small stack of rungs, each rung being an
+ *    array of buckets covering a contiguous time interval. The
+ *    buckets themselves are unsorted arrays. A bucket which holds
+ *    too many events when it is reached is split into a new, finer
+ *    rung instead of being sorted;
+ *  - the \em bottom tier is a sorted array which holds the events
+ *    which are about to be dequeued. If too many events are inserted
+ *    there, it is turned into a new rung.
+ *
+ * Contrary to the CalendarScheduler, there is no global resize:
+ * events are only ever sorted in small batches, when a bucket is
+ * moved to the bottom tier, which gives amortized O(1) insert and
+ * RemoveNext. All the storage is held in std::vector instances
+ * which are recycled across rungs so that a steady-state simulation
+ * does not allocate memory to schedule an event.
+ *
+ * Buckets are selected on the event timestamp only, so all the events
+ * which share a timestamp are always held in the same bucket and are
+ * finally ordered by Scheduler::EventKey, i.e., by timestamp and then
+ * by uid, exactly as with the other schedulers.
+ *
+ * \note Remove() looks up the tier which holds the event with the same
+ * logic as Insert() and then scans it: this is linear in the size of
+ * a bucket, but may be linear in the size of the top tier if the event
+ * has been scheduled far ahead of the current time.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Ladder bucket type: an unsorted array of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /**
+   * A rung of the ladder.
+   *
+   * The rung covers the time interval [start, end) with nBuckets
+   * buckets of the same width, except for the last one which extends
+   * up to the end of the rung.
+   */
+  struct Rung
+  {
+    std::vector<Bucket> buckets; //!< Bucket array, might be larger than nBuckets.
+    uint32_t nBuckets;           //!< Number of buckets in use.
+    uint64_t start;              //!< Timestamp of the start of the first bucket.
+    uint64_t end;                //!< Timestamp of the end of the last bucket.
+    uint64_t width;              //!< Duration of a bucket, in dimensionless time units.
+    uint32_t current;            //!< Index of the next bucket to dequeue.
+  };
+
+  /**
+   * Get the timestamp of the start of the current bucket of a rung.
+   *
+   * Events earlier than this timestamp are held by a lower rung or
+   * by the bottom tier.
+   *
+   * \param [in] rung The rung.
+   * \returns The start of the current bucket.
+   */
+  inline uint64_t CurrentStart (const Rung &rung) const;
+  /**
+   * Get the bucket of a rung which must hold an event.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ts The event timestamp.
+   * \returns The bucket.
+   */
+  inline Bucket & GetBucket (Rung &rung, uint64_t ts);
+  /**
+   * Find the rung which must hold an event.
+   *
+   * \param [in] ts The event timestamp.
+   * \returns The rung index, or m_nRungs if the event belongs to the
+   *          bottom tier.  The caller must check the top tier first.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Spread a set of events over a new rung at the bottom of the ladder.
+   *
+   * The bucket width is chosen to spread the events evenly between
+   * \p start and the largest timestamp of the events.
+   *
+   * \param [in] events The events, cleared on return.
+   * \param [in] start The start timestamp of the rung.
+   * \param [in] end The end timestamp of the rung, or zero to end the
+   *            rung right after the last event.
+   * \param [in] maxTs The largest timestamp of the events.
+   * \returns The new rung.
+   */
+  Rung & PushRung (Bucket &events, uint64_t start, uint64_t end, uint64_t maxTs);
+  /** Fill the (empty) bottom tier from the ladder or the top tier. */
+  void Refill (void);
+  /**
+   * Insert an event in the sorted bottom tier.
+   *
+   * If the bottom tier grows too large, it is moved to a new rung.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+
+  /**
+   * Number of events in a bucket above which it is split into
+   * a new rung rather than sorted into the bottom tier, and
+   * maximum number of events in the bottom tier.
+   */
+  static const uint32_t SPLIT_THRESHOLD = 50;
+  /** Maximum number of rungs in the ladder. */
+  static const uint32_t MAX_RUNGS = 8;
+  /** Maximum number of buckets in a rung. */
+  static const uint32_t MAX_BUCKETS = 1 << 16;
+
+  /** The top tier: unsorted events far in the future. */
+  Bucket m_top;
+  /** Smallest timestamp in the top tier. */
+  uint64_t m_topMin;
+  /** Largest timestamp in the top tier. */
+  uint64_t m_topMax;
+  /** Events with a timestamp larger or equal to this go to the top tier. */
+  uint64_t m_topStart;
+  /** The rungs, m_rungs[0] being the coarsest. Never shrinks. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The bottom tier: sorted events, starting at m_bottomHead. */
+  Bucket m_bottom;
+  /** Index of the earliest event in m_bottom. */
+  std::size_t m_bottomHead;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
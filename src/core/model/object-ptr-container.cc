@@ -127,6 +127,25 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     }
   return true;
 }
+bool
+ObjectPtrContainerAccessor::GetElement (const ObjectBase *object, std::size_t index,
+                                        Ptr<Object> *element) const
+{
+  NS_LOG_FUNCTION (this << object << index);
+  std::size_t n;
+  if (!DoGetN (object, &n) || index >= n)
+    {
+      return false;
+    }
+  std::size_t found;
+  Ptr<Object> o = DoGet (object, index, &found);
+  if (found != index)
+    {
+      return false;
+    }
+  *element = o;
+  return true;
+}
 bool 
 ObjectPtrContainerAccessor::HasGetter (void) const
 {
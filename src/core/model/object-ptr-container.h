@@ -220,6 +220,19 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * Get one element of the container, without getting all of them.
+   *
+   * This only succeeds when the element at position \p index of the
+   * container has the index \p index, as in the ObjectVector attributes.
+   *
+   * \param [in] object The object which holds the container.
+   * \param [in] index The index of the element.
+   * \param [out] element The element.
+   * \returns \c false if the element could not be found by its position,
+   *          in which case the whole container must be obtained with Get.
+   */
+  bool GetElement (const ObjectBase *object, std::size_t index, Ptr<Object> *element) const;
 private:
   /**
    * Get the number of instances in the container.
@@ -101,6 +101,7 @@ Object::Object ()
     m_getObjectCount (0)
 {
   NS_LOG_FUNCTION (this);
+  ClearCache (m_aggregates);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
@@ -120,6 +121,8 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the lookup cache may point to this object
+  ClearCache (m_aggregates);
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
@@ -135,6 +138,7 @@ Object::Object (const Object &o)
     m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
     m_getObjectCount (0)
 {
+  ClearCache (m_aggregates);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
@@ -151,6 +155,15 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  // first, look up the cache of the previous lookups
+  uint16_t uid = tid.GetUid ();
+  struct Aggregates::CacheEntry *entry =
+    &m_aggregates->cache[Aggregates::GetCacheIndex (uid)];
+  if (entry->uid == uid)
+    {
+      return entry->object;
+    }
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -173,10 +186,14 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
+          // finally, cache and return the match
+          entry->uid = uid;
+          entry->object = current;
           return const_cast<Object *> (current);
         }
     }
+  entry->uid = uid;
+  entry->object = 0;
   return 0;
 }
 void
@@ -248,6 +265,16 @@ Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
       j--;
     }
 }
+void
+Object::ClearCache (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  for (uint32_t i = 0; i < Aggregates::CACHE_SIZE; i++)
+    {
+      aggregates->cache[i].uid = 0;
+      aggregates->cache[i].object = 0;
+    }
+}
 void 
 Object::AggregateObject (Ptr<Object> o)
 {
@@ -262,6 +289,7 @@ Object::AggregateObject (Ptr<Object> o)
   uint32_t total = m_aggregates->n + other->m_aggregates->n;
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
+  ClearCache (aggregates);
   aggregates->n = total;
 
   // copy our buffer to the new buffer
@@ -340,6 +368,8 @@ Object::SetTypeId (TypeId tid)
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (Check ());
   m_tid = tid;
+  // the lookups made so far used the former TypeId
+  ClearCache (m_aggregates);
 }
 
 void
@@ -331,8 +331,36 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * \c n
+   *
+   * The structure also holds a small direct-mapped cache of the
+   * results of DoGetObject(), indexed by the TypeId uid, including
+   * the lookups which found nothing.  A new structure is allocated
+   * by AggregateObject(), so the cache is never stale.
    */
   struct Aggregates {
+    /** The number of entries of the lookup cache. */
+    static const uint32_t CACHE_SIZE = 16;
+    /**
+     * Get the cache entry of a TypeId.
+     *
+     * \param [in] uid The TypeId uid.
+     * \returns The index of the cache entry of \p uid.
+     */
+    static uint32_t GetCacheIndex (uint16_t uid)
+    {
+      // Fibonacci hashing of the 16-bit uid, keeping the 4 bits
+      // needed for CACHE_SIZE entries.
+      return ((uid * 40503U) & 0xffff) >> 12;
+    }
+    /** An entry of the lookup cache. */
+    struct CacheEntry {
+      /** The TypeId uid looked up, or 0 if the entry is empty. */
+      uint16_t uid;
+      /** The matching Object, or 0 if there is none. */
+      Object *object;
+    };
+    /** The lookup cache. */
+    struct CacheEntry cache[CACHE_SIZE];
     /** The number of entries in \c buffer. */
     uint32_t n;
     /** The array of Objects. */
@@ -393,6 +421,12 @@ private:
    * \param [in] i The most recently used entry in the list.
    */
   void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
+  /**
+   * Empty the lookup cache of a list of aggregates.
+   *
+   * \param [in,out] aggregates The list of aggregated Objects.
+   */
+  static void ClearCache (struct Aggregates *aggregates);
   /**
    * Attempt to delete this Object.
    *
@@ -458,15 +492,25 @@ template <typename T>
 Ptr<T> 
 Object::GetObject () const
 {
-  // This is an optimization: if the cast works (which is likely),
-  // things will be pretty fast.
+  // This is an optimization: if this type was looked up before
+  // (which is likely), the result is in the lookup cache.
+  TypeId tid = T::GetTypeId ();
+  struct Aggregates::CacheEntry &entry =
+    m_aggregates->cache[Aggregates::GetCacheIndex (tid.GetUid ())];
+  if (entry.uid == tid.GetUid ())
+    {
+      return Ptr<T> (static_cast<T *> (entry.object));
+    }
+  // Otherwise, if the cast works, things will be pretty fast too.
   T *result = dynamic_cast<T *> (m_aggregates->buffer[0]);
   if (result != 0)
     {
+      entry.uid = tid.GetUid ();
+      entry.object = m_aggregates->buffer[0];
       return Ptr<T> (result);
     }
   // if the cast does not work, we try to do a full type check.
-  Ptr<Object> found = DoGetObject (T::GetTypeId ());
+  Ptr<Object> found = DoGetObject (tid);
   if (found != 0)
     {
       return Ptr<T> (static_cast<T *> (PeekPointer (found)));
@@ -21,6 +21,7 @@
 #include "wall-clock-synchronizer.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-impl-pool.h"
 #include "synchronizer.h"
 
 #include "ptr.h"
@@ -34,6 +35,7 @@
 
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -93,6 +95,7 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_eventCount = 0;
 
   m_main = SystemThread::Self();
+  EventImplPool::Attach ();
 
   // Be very careful not to do anything that would cause a change or assignment
   // of the underlying reference counts of m_synchronizer or you will be sorry.
@@ -108,6 +111,10 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  {
+    CriticalSection cs (m_mutex);
+    ProcessEventsWithContext ();
+  }
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -115,6 +122,7 @@ RealtimeSimulatorImpl::DoDispose (void)
     }
   m_events = 0;
   m_synchronizer = 0;
+  EventImplPool::Purge ();
   SimulatorImpl::DoDispose ();
 }
 
@@ -229,7 +237,13 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         //
         // tsNext is the simulation time of the next event we want to execute.
         //
+        // The synchronizer condition is reset before the events pushed by other
+        // threads are moved to the event list: a push which is not seen here
+        // signals the synchronizer afterwards and interrupts the wait below.
+        //
+        m_synchronizer->SetCondition (false);
         tsNow = m_synchronizer->GetCurrentRealtime ();
+        ProcessEventsWithContext ();
         tsNext = NextTs ();
 
         //
@@ -254,10 +268,9 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         // We've figured out how long we need to delay in order to pace the 
         // simulation time with the real time.  We're going to sleep, but need
         // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
+        // external happens (like a packet is received).  The condition was reset
+        // above so that any future event will cause it to interrupt.
         //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -327,6 +340,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // event we're working on won't be on the list and so subsequent operations won't
     // mess with us.
     //
+    ProcessEventsWithContext ();
     NS_ASSERT_MSG (m_events->IsEmpty () == false, 
                    "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
     next = m_events->RemoveNext ();
@@ -348,7 +362,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // executing.  From the rest of the simulation's point of view, simulation time
     // is frozen until the next event is executed.
     //
-    m_currentTs = next.key.m_ts;
+    m_currentTs.store (next.key.m_ts, std::memory_order_relaxed);
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
 
@@ -419,6 +433,38 @@ RealtimeSimulatorImpl::NextTs (void) const
   return ev.key.m_ts;
 }
 
+//
+// Moves the events pushed by the other threads to the event list.  Should
+// be called by the simulation thread with critical section locked.
+//
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContext.IsEmpty ())
+    {
+      return;
+    }
+
+  m_eventsWithContextBatch.clear ();
+  m_eventsWithContext.Drain (m_eventsWithContextBatch);
+  for (std::vector<EventInjectionQueue::Entry>::const_iterator i = m_eventsWithContextBatch.begin ();
+       i != m_eventsWithContextBatch.end (); ++i)
+    {
+      Scheduler::Event ev;
+      ev.impl = i->event;
+      //
+      // The timestamp was computed from the real time when the event was
+      // pushed, and the simulation may have moved past it since.
+      //
+      ev.key.m_ts = std::max<uint64_t> (i->timestamp, m_currentTs);
+      ev.key.m_context = i->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+}
+
 void
 RealtimeSimulatorImpl::Run (void)
 {
@@ -429,10 +475,11 @@ RealtimeSimulatorImpl::Run (void)
 
   // Set the current threadId as the main threadId
   m_main = SystemThread::Self();
+  EventImplPool::Attach ();
 
   m_stop = false;
-  m_running = true;
   m_synchronizer->SetOrigin (m_currentTs);
+  m_running.store (true, std::memory_order_release);
 
   // Sleep until signalled
   uint64_t tsNow = 0;
@@ -444,6 +491,7 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        ProcessEventsWithContext ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -478,7 +526,7 @@ RealtimeSimulatorImpl::Run (void)
                    "RealtimeSimulatorImpl::Run(): Empty queue and unprocessed events");
   }
 
-  m_running = false;
+  m_running.store (false, std::memory_order_relaxed);
 }
 
 bool
@@ -544,24 +592,24 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped.
+      // The event is handed to the simulation thread without taking the lock.
+      // 
+      uint64_t ts = m_running.load (std::memory_order_acquire) ?
+        m_synchronizer->GetCurrentRealtime () : m_currentTs.load (std::memory_order_relaxed);
+      ts += delay.GetTimeStep ();
+      m_eventsWithContext.Push (context, ts, impl);
+      m_synchronizer->Signal ();
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
-
+    uint64_t ts = m_currentTs + delay.GetTimeStep ();
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
     ev.impl = impl;
@@ -610,14 +658,22 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
 {
   NS_LOG_FUNCTION (this << context << time << impl);
 
+  uint64_t ts = m_synchronizer->GetCurrentRealtime () + time.GetTimeStep ();
+  if (!SystemThread::Equals (m_main))
+    {
+      m_eventsWithContext.Push (context, ts, impl);
+      m_synchronizer->Signal ();
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
-    uint64_t ts = m_synchronizer->GetCurrentRealtime () + time.GetTimeStep ();
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
     ev.impl = impl;
     ev.key.m_ts = ts;
+    ev.key.m_context = context;
     ev.key.m_uid = m_uid;
     m_uid++;
     m_unscheduledEvents++;
@@ -637,14 +693,24 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *impl)
 {
   NS_LOG_FUNCTION (this << context << impl);
+
+  //
+  // If the simulator is running, we're pacing and have a meaningful 
+  // realtime clock.  If we're not, then m_currentTs is were we stopped.
+  // 
+  if (!SystemThread::Equals (m_main))
+    {
+      uint64_t ts = m_running.load (std::memory_order_acquire) ?
+        m_synchronizer->GetCurrentRealtime () : m_currentTs.load (std::memory_order_relaxed);
+      m_eventsWithContext.Push (context, ts, impl);
+      m_synchronizer->Signal ();
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
-    //
-    // If the simulator is running, we're pacing and have a meaningful 
-    // realtime clock.  If we're not, then m_currentTs is were we stopped.
-    // 
-    uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+    uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs.load ();
     NS_ASSERT_MSG (ts >= m_currentTs, 
                    "RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(): schedule for time < m_currentTs");
     Scheduler::Event ev;
@@ -666,6 +732,12 @@ RealtimeSimulatorImpl::ScheduleRealtimeNow (EventImpl *impl)
   ScheduleRealtimeNowWithContext (GetContext (), impl);
 }
 
+EventInjectionQueue::Stats
+RealtimeSimulatorImpl::GetInjectionStats (void) const
+{
+  return m_eventsWithContext.GetStats ();
+}
+
 Time
 RealtimeSimulatorImpl::RealtimeNow (void) const
 {
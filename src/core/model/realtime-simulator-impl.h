@@ -25,13 +25,16 @@
 #include "scheduler.h"
 #include "synchronizer.h"
 #include "event-impl.h"
+#include "event-injection-queue.h"
 
 #include "ptr.h"
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
 
+#include <atomic>
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -155,6 +158,14 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /**
+   * Get the counters of the events scheduled by other threads than
+   * the simulation thread.
+   *
+   * \returns The injection counters.
+   */
+  EventInjectionQueue::Stats GetInjectionStats (void) const;
+
 private:
   /**
    * Is the simulator running?
@@ -173,6 +184,11 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Move the events scheduled by other threads into the event list.
+   * Must be called by the simulation thread, with #m_mutex held.
+   */
+  void ProcessEventsWithContext (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -182,8 +198,13 @@ private:
   DestroyEvents m_destroyEvents;
   /** Has the stopping condition been reached? */
   bool m_stop;
-  /** Is the simulator currently running. */
-  bool m_running;
+  /**
+   * Is the simulator currently running.
+   *
+   * Read without the lock by the threads which schedule events, and
+   * set once the synchronizer origin is set.
+   */
+  std::atomic<bool> m_running;
 
   /**
    * \name Mutex-protected variables.
@@ -199,8 +220,12 @@ private:
   uint32_t m_uid;
   /**< Unique id of the current event. */
   uint32_t m_currentUid;
-  /**< Timestep of the current event. */
-  uint64_t m_currentTs;
+  /**
+   * Timestep of the current event. Only written by the simulation
+   * thread, but read without the lock by the threads which schedule
+   * events while the simulator is not running.
+   */
+  std::atomic<uint64_t> m_currentTs;
   /**< Execution context. */
   uint32_t m_currentContext;  
   /** The event count. */
@@ -210,6 +235,14 @@ private:
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
+  /**
+   * The events scheduled by other threads, with their absolute
+   * timestamp. They do not take #m_mutex.
+   */
+  EventInjectionQueue m_eventsWithContext;
+  /** The last batch of events drained from #m_eventsWithContext. */
+  std::vector<EventInjectionQueue::Entry> m_eventsWithContextBatch;
+
   /** The synchronizer in use to track real time. */
   Ptr<Synchronizer> m_synchronizer;
 
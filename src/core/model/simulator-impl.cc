@@ -42,4 +42,11 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+bool
+SimulatorImpl::IsLocalContext (uint32_t context) const
+{
+  NS_LOG_FUNCTION (this << context);
+  return true;
+}
+
 } // namespace ns3
@@ -101,6 +101,13 @@ public:
   virtual uint32_t GetContext (void) const = 0;
   /** \copydoc Simulator::GetEventCount */
   virtual uint64_t GetEventCount (void) const = 0;
+  /**
+   * \copydoc Simulator::IsLocalContext
+   *
+   * The default implementation runs all the events in the same thread
+   * and returns \c true.
+   */
+  virtual bool IsLocalContext (uint32_t context) const;
 
 };
 
@@ -345,6 +345,21 @@ Simulator::GetSystemId (void)
     }
 }
 
+bool
+Simulator::IsLocalContext (uint32_t context)
+{
+  NS_LOG_FUNCTION (context);
+
+  if (*PeekImpl () != 0)
+    {
+      return GetImpl ()->IsLocalContext (context);
+    }
+  else
+    {
+      return true;
+    }
+}
+
 void
 Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
 {
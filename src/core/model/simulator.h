@@ -1328,6 +1328,22 @@ public:
    * @return The system id for this simulator.
    */
   static uint32_t GetSystemId (void);
+
+  /**
+   * Check whether the events of a context are run by the thread of
+   * the current event.
+   *
+   * With a parallel simulator implementation which runs the contexts
+   * in several threads, the objects handed over to an event of another
+   * context, such as a packet received by a node, must not share any
+   * internal state with the objects kept by the sender when this
+   * returns \c false (see Packet::DeepCopy).
+   *
+   * @param [in] context The context of the events.
+   * @return \c true if the events of \p context are run by the
+   *         calling thread.
+   */
+  static bool IsLocalContext (uint32_t context);
   
 private:
   /** Default constructor. */
@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -46,6 +46,18 @@ namespace ns3 {
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
  *
+ * The chain is stored in a contiguous array, so that firing a trace
+ * source which has no Callback connected, the common case, costs a
+ * single comparison.  Callers which need to build the trace arguments
+ * can test IsEmpty() first to skip that work as well.
+ *
+ * When ns-3 is configured with \c --disable-tracing, which defines
+ * \c NS3_TRACING_DISABLE, the \c operator() forms do nothing and
+ * IsEmpty() always returns \c true: Callbacks can still be connected
+ * but are never invoked, and the compiler removes the trace calls
+ * entirely.  This disables all trace sources, including the ones used
+ * by the pcap and ascii trace helpers.
+ *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
  * \tparam T3 \explicit Type of the third argument to the functor.
@@ -93,6 +105,12 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check if the chain of Callbacks is empty.
+   *
+   * \returns \c true if invoking the chain would not invoke any Callback.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -222,6 +240,45 @@ public:
 
   
 private:
+  /**
+   * \name Invoke the chain of Callbacks, which is not empty.
+   *
+   * The \c operator() forms are small enough to be inlined at the
+   * trace sources, so that the trace arguments are not even copied
+   * when the chain is empty.  They defer the invocation of the chain
+   * to these functions.
+   */
+  /**@{*/
+  /** \copydoc operator()() */
+  void Invoke (void) const;
+  /** \copydoc operator()(T1) */
+  void Invoke (const T1 &a1) const;
+  /** \copydoc operator()(T1,T2) */
+  void Invoke (const T1 &a1, const T2 &a2) const;
+  /** \copydoc operator()(T1,T2,T3) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3) const;
+  /** \copydoc operator()(T1,T2,T3,T4) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5,T6) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5,T6,T7) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7) const;
+  /** \copydoc operator()(T1,T2,T3,T4,T5,T6,T7,T8) */
+  void Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7, const T8 &a8) const;
+  /**@}*/
+
+  /**
+   * End an invocation of the chain.
+   *
+   * While the chain is being invoked, the Callbacks which are
+   * disconnected are replaced by null Callbacks rather than erased, so
+   * that the index of the invocation in progress still designates the
+   * next Callback.  The outermost invocation erases them when it ends.
+   */
+  void EndInvoke (void) const;
+
   /**
    * Container type for holding the chain of Callbacks.
    *
@@ -234,9 +291,16 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /**
+   * The chain of Callbacks.  Mutable so that the Callbacks disconnected
+   * during an invocation are erased at its end.
+   */
+  mutable CallbackList m_callbackList;
+  /** The number of invocations of the chain in progress. */
+  mutable uint32_t m_invoking;
+  /** Whether Callbacks were disconnected during the invocations in progress. */
+  mutable bool m_disconnected;
 };
 
 } // namespace ns3
@@ -253,7 +317,9 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_callbackList (),
+    m_invoking (0),
+    m_disconnected (false)
 {
 }
 template<typename T1, typename T2,
@@ -291,9 +357,18 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const Callbac
   for (typename CallbackList::iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if (!(*i).IsNull () && (*i).IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          if (m_invoking > 0)
+            {
+              *i = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+              m_disconnected = true;
+              i++;
+            }
+          else
+            {
+              i = m_callbackList.erase (i);
+            }
         }
       else
         {
@@ -318,118 +393,302 @@ template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
-TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
+inline bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
+#ifdef NS3_TRACING_DISABLE
+  return true;
+#else
+  return m_callbackList.empty ();
+#endif
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndInvoke (void) const
+{
+  m_invoking--;
+  if (m_invoking > 0 || !m_disconnected)
+    {
+      return;
+    }
+  typename CallbackList::iterator j = m_callbackList.begin ();
+  for (typename CallbackList::iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); i++)
     {
-      (*i)();
+      if (!i->IsNull ())
+        {
+          *j++ = *i;
+        }
     }
+  m_callbackList.erase (j, m_callbackList.end ());
+  m_disconnected = false;
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+inline void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
+{
+  if (!IsEmpty ())
+    {
+      Invoke ();
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (void) const
+{
+  // Index the chain rather than iterate over it: a Callback may connect
+  // another one to this chain, which can reallocate the array.  The
+  // Callbacks disconnected meanwhile are only nulled (see EndInvoke).
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i]();
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1);
+      Invoke (a1);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2);
+      Invoke (a1, a2);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2, a3);
+      Invoke (a1, a2, a3);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2, a3, a4);
+      Invoke (a1, a2, a3, a4);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2, a3, a4, a5);
+      Invoke (a1, a2, a3, a4, a5);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      Invoke (a1, a2, a3, a4, a5, a6);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      Invoke (a1, a2, a3, a4, a5, a6, a7);
     }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
          typename T7, typename T8>
-void 
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7);
+        }
+    }
+  EndInvoke ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+inline void
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  if (!IsEmpty ())
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      Invoke (a1, a2, a3, a4, a5, a6, a7, a8);
+    }
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Invoke (const T1 &a1, const T2 &a2, const T3 &a3, const T4 &a4, const T5 &a5, const T6 &a6, const T7 &a7, const T8 &a8) const
+{
+  m_invoking++;
+  for (typename CallbackList::size_type i = 0; i < m_callbackList.size (); i++)
+    {
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7, a8);
+        }
     }
+  EndInvoke ();
 }
 
 } // namespace ns3
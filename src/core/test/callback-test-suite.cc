@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/callback.h"
 #include "ns3/unused.h"
+#include "ns3/simple-ref-count.h"
 #include <stdint.h>
 
 using namespace ns3;
@@ -578,6 +579,75 @@ NullifyCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (target1.IsNull (), true, "Nullified Callback reports not IsNull()");
 }
 
+// ===========================================================================
+// Test the storage of the Callback implementations
+// ===========================================================================
+class CallbackStorageTestCase : public TestCase
+{
+public:
+  CallbackStorageTestCase ();
+  virtual ~CallbackStorageTestCase () {}
+
+  /** A reference counted object bound to the callbacks. */
+  class Counted : public SimpleRefCount<Counted>
+  {
+  public:
+    int m_value; //!< value read by the callbacks
+  };
+
+  int Target1 (int a) { return a + 1; }
+  static int Target2 (Ptr<Counted> counted, int a) { return counted->m_value + a; }
+
+private:
+  virtual void DoRun (void);
+};
+
+CallbackStorageTestCase::CallbackStorageTestCase ()
+  : TestCase ("Check the copy and release of the Callback implementations")
+{
+}
+
+void
+CallbackStorageTestCase::DoRun (void)
+{
+  Ptr<Counted> counted = Create<Counted> ();
+  counted->m_value = 10;
+  {
+    Callback<int, int> a = MakeBoundCallback (&CallbackStorageTestCase::Target2, counted);
+    NS_TEST_ASSERT_MSG_EQ (counted->GetReferenceCount (), 2, "Bound argument not referenced");
+    Callback<int, int> b = a;
+    Callback<int, int> c;
+    c = b;
+    NS_TEST_ASSERT_MSG_EQ (counted->GetReferenceCount (), 4, "Bound argument not copied");
+    NS_TEST_ASSERT_MSG_EQ (c (5), 15, "Copied callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (a.IsEqual (c), true, "Copies should be equal");
+    c.Nullify ();
+    NS_TEST_ASSERT_MSG_EQ (counted->GetReferenceCount (), 3, "Bound argument not released");
+    Ptr<CallbackImplBase> impl = a.GetImpl ();
+    NS_TEST_ASSERT_MSG_EQ (counted->GetReferenceCount (), 4, "Implementation not copied");
+    c = Callback<int, int> (DynamicCast<CallbackImpl<int,int,empty,empty,empty,empty,empty,empty,empty,empty> > (impl));
+    NS_TEST_ASSERT_MSG_EQ (c (6), 16, "Callback built from implementation did not fire");
+    b = MakeCallback (&CallbackStorageTestCase::Target1, this);
+    NS_TEST_ASSERT_MSG_EQ (b (1), 2, "Reassigned callback did not fire");
+    NS_TEST_ASSERT_MSG_EQ (counted->GetReferenceCount (), 3, "Bound argument not released");
+    NS_TEST_ASSERT_MSG_EQ (a.IsEqual (b), false, "Callbacks should differ");
+
+    // callbacks bound to a callback.
+    Callback<int> d = a.Bind (7);
+    Callback<int> e = d;
+    NS_TEST_ASSERT_MSG_EQ (e (), 17, "Bound callback did not fire");
+    a = b;
+    NS_TEST_ASSERT_MSG_EQ (d (), 17, "Bound callback depends on its source");
+
+    CallbackBase base = b;
+    Callback<int, int> f;
+    NS_TEST_ASSERT_MSG_EQ (f.CheckType (base), true, "Incompatible types");
+    NS_TEST_ASSERT_MSG_EQ (f.Assign (base), true, "Assign failed");
+    NS_TEST_ASSERT_MSG_EQ (f (2), 3, "Assigned callback did not fire");
+  }
+  NS_TEST_ASSERT_MSG_EQ (counted->GetReferenceCount (), 1, "Bound argument leaked");
+}
+
 // ===========================================================================
 // Make sure that various MakeCallback template functions compile and execute.
 // Doesn't check an results of the execution.
@@ -725,6 +795,7 @@ CallbackTestSuite::CallbackTestSuite ()
   AddTestCase (new MakeCallbackTestCase, TestCase::QUICK);
   AddTestCase (new MakeBoundCallbackTestCase, TestCase::QUICK);
   AddTestCase (new NullifyCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new CallbackStorageTestCase, TestCase::QUICK);
   AddTestCase (new MakeCallbackTemplatesTestCase, TestCase::QUICK);
 }
 
@@ -830,6 +830,249 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test that a batch of paths is resolved like each path on its own.
+ */
+class BatchLookupMatchesTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  BatchLookupMatchesTestCase ();
+  /** Destructor. */
+  virtual ~BatchLookupMatchesTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+BatchLookupMatchesTestCase::BatchLookupMatchesTestCase ()
+  : TestCase ("Check that LookupMatches resolves a batch of paths like each path on its own")
+{
+}
+
+void
+BatchLookupMatchesTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  a->SetNodeB (b);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      b->AddNodeB (objects.back ());
+    }
+
+  std::vector<std::string> paths;
+  paths.push_back ("/NodeA/NodeB/NodesB/*");
+  paths.push_back ("/NodeA/NodeB/NodesB/0");
+  paths.push_back ("/NodeA/NodeB/NodesB/3");
+  paths.push_back ("/NodeA/NodeB/NodesB/[1-3]");
+  paths.push_back ("/NodeA/NodeB/NodesB/1|3");
+  paths.push_back ("/NodeA/NodeB/NodesB/|0|2|");
+  paths.push_back ("/NodeA/NodeB/NodesB/[0-1]|3");
+  paths.push_back ("/NodeA/NodeB/NodesB/7");
+  paths.push_back ("/NodeA/NodeB");
+  paths.push_back ("/*/NodeB");
+  paths.push_back ("/NodeA/NodeB/NodesB/0");
+  paths.push_back ("/NodeA/NodeB/NodesB/2/NodeA");
+
+  Config::ResetResolveStats ();
+  std::vector<Config::MatchContainer> batch = Config::LookupMatches (paths);
+  Config::ResolveStats stats = Config::GetResolveStats ();
+  NS_TEST_ASSERT_MSG_EQ (batch.size (), paths.size (), "One container per path expected");
+  NS_TEST_ASSERT_MSG_EQ (stats.lookups, 1, "One resolution expected");
+  NS_TEST_ASSERT_MSG_EQ (stats.paths, paths.size (), "All the paths should be counted");
+
+  uint64_t matches = 0;
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      Config::MatchContainer single = Config::LookupMatches (paths[i]);
+      NS_TEST_ASSERT_MSG_EQ (batch[i].GetPath (), paths[i], "Wrong path for " << paths[i]);
+      NS_TEST_ASSERT_MSG_EQ (batch[i].GetN (), single.GetN (), "Wrong number of matches for " << paths[i]);
+      for (uint32_t j = 0; j < single.GetN () && j < batch[i].GetN (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (batch[i].Get (j), single.Get (j), "Wrong match for " << paths[i]);
+          NS_TEST_ASSERT_MSG_EQ (batch[i].GetMatchedPath (j), single.GetMatchedPath (j),
+                                 "Wrong context for " << paths[i]);
+        }
+      matches += single.GetN ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (stats.matches, matches, "All the matches should be counted");
+
+  // The objects of this root must be found by the batch, whatever the
+  // objects registered by the other tests.
+  std::string expected[] = {"0", "1", "2", "3"};
+  for (uint32_t i = 0; i < objects.size (); i++)
+    {
+      bool found = false;
+      for (uint32_t j = 0; j < batch[0].GetN (); j++)
+        {
+          if (batch[0].Get (j) == objects[i])
+            {
+              NS_TEST_ASSERT_MSG_EQ (batch[0].GetMatchedPath (j), "/NodeA/NodeB/NodesB/" + expected[i] + "/",
+                                     "Wrong context for object " << i);
+              found = true;
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (found, true, "Object " << i << " not matched by " << paths[0]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (batch[7].GetN (), 0, "Out of range index should not match");
+  NS_TEST_ASSERT_MSG_EQ (batch[11].GetN (), 0, "Unset pointer should not match");
+
+  stats = Config::GetResolveStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.lookups, 1 + paths.size (), "Single resolutions should be counted");
+  Config::ResetResolveStats ();
+  stats = Config::GetResolveStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.lookups, 0, "Statistics not reset");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
+/**
+ * \ingroup config-tests
+ * An object whose container of objects counts the elements it gives.
+ */
+class ConfigIndexTestObject : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  ConfigIndexTestObject ();
+
+  /**
+   * Add an element to the container.
+   * \param element the element
+   */
+  void AddElement (Ptr<ConfigTestObject> element);
+  /**
+   * Get an element of the container.
+   * \param i the index of the element
+   * \returns the element
+   */
+  Ptr<ConfigTestObject> GetElement (uint32_t i) const;
+  /**
+   * Get the number of elements of the container.
+   * \returns the number of elements
+   */
+  uint32_t GetNElements (void) const;
+
+  mutable uint32_t m_gets; //!< Number of elements given by GetElement.
+
+private:
+  std::vector<Ptr<ConfigTestObject> > m_elements; //!< The container.
+};
+
+TypeId
+ConfigIndexTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ConfigIndexTestObject")
+    .SetParent<Object> ()
+    .AddAttribute ("Elements", "",
+                   ObjectVectorValue (),
+                   MakeObjectVectorAccessor (&ConfigIndexTestObject::GetElement,
+                                             &ConfigIndexTestObject::GetNElements),
+                   MakeObjectVectorChecker<ConfigTestObject> ())
+  ;
+  return tid;
+}
+
+ConfigIndexTestObject::ConfigIndexTestObject ()
+  : m_gets (0)
+{
+}
+
+void
+ConfigIndexTestObject::AddElement (Ptr<ConfigTestObject> element)
+{
+  m_elements.push_back (element);
+}
+
+Ptr<ConfigTestObject>
+ConfigIndexTestObject::GetElement (uint32_t i) const
+{
+  m_gets++;
+  return m_elements[i];
+}
+
+uint32_t
+ConfigIndexTestObject::GetNElements (void) const
+{
+  return m_elements.size ();
+}
+
+/**
+ * \ingroup config-tests
+ * Check that an index path gets only the selected element of a container.
+ */
+class IndexResolveTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  IndexResolveTestCase ();
+  /** Destructor. */
+  virtual ~IndexResolveTestCase () {}
+
+private:
+  virtual void DoRun (void);
+};
+
+IndexResolveTestCase::IndexResolveTestCase ()
+  : TestCase ("Check that an index path gets only the selected element of a container")
+{
+}
+
+void
+IndexResolveTestCase::DoRun (void)
+{
+  Ptr<ConfigIndexTestObject> root = CreateObject<ConfigIndexTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  std::vector<Ptr<ConfigTestObject> > elements;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      elements.push_back (CreateObject<ConfigTestObject> ());
+      root->AddElement (elements.back ());
+    }
+
+  root->m_gets = 0;
+  Config::MatchContainer matches = Config::LookupMatches ("/Elements/42");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "One match expected");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), elements[42], "Wrong element matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/Elements/42/", "Wrong context");
+  NS_TEST_ASSERT_MSG_EQ (root->m_gets, 1, "Only the selected element should be got");
+
+  std::vector<std::string> paths;
+  paths.push_back ("/Elements/3");
+  paths.push_back ("/Elements/7");
+  paths.push_back ("/Elements/3");
+  root->m_gets = 0;
+  std::vector<Config::MatchContainer> batch = Config::LookupMatches (paths);
+  NS_TEST_ASSERT_MSG_EQ (batch[0].Get (0), elements[3], "Wrong element matched");
+  NS_TEST_ASSERT_MSG_EQ (batch[1].Get (0), elements[7], "Wrong element matched");
+  NS_TEST_ASSERT_MSG_EQ (batch[2].Get (0), elements[3], "Wrong element matched");
+  NS_TEST_ASSERT_MSG_EQ (root->m_gets, 2, "Only the selected elements should be got");
+
+  // the other paths still get the whole container
+  root->m_gets = 0;
+  matches = Config::LookupMatches ("/Elements/[10-12]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 3, "Three matches expected");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (1), elements[11], "Wrong element matched");
+  NS_TEST_ASSERT_MSG_EQ (root->m_gets, elements.size (), "The whole container should be got");
+  matches = Config::LookupMatches ("/Elements/100");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0, "Out of range index should not match");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +1091,8 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new BatchLookupMatchesTestCase);
+  AddTestCase (new IndexResolveTestCase);
 }
 
 /**
@@ -398,6 +398,73 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+/**
+ * \ingroup object-tests
+ * Test the GetObject lookup cache is consistent with the aggregates.
+ */
+class GetObjectCacheTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  GetObjectCacheTestCase ();
+  /** Destructor. */
+  virtual ~GetObjectCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GetObjectCacheTestCase::GetObjectCacheTestCase ()
+  : TestCase ("Check the GetObject lookup cache")
+{
+}
+
+GetObjectCacheTestCase::~GetObjectCacheTestCase ()
+{
+}
+
+void
+GetObjectCacheTestCase::DoRun (void)
+{
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  Ptr<BaseB> baseB = CreateObject<BaseB> ();
+
+  //
+  // A failed lookup is cached, but the cache must be invalidated when the
+  // type is aggregated.
+  //
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  baseA->AggregateObject (baseB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), baseB, "Cannot GetObject (through baseA) for BaseB Object");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), baseB, "Cannot GetObject (through baseA) for BaseB Object");
+  NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<BaseA> (), baseA, "Cannot GetObject (through baseB) for BaseA Object");
+
+  //
+  // Look up every registered TypeId twice, so that the lookups share the
+  // cache entries: only the types of the aggregates may be found.
+  //
+  for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+    {
+      TypeId tid = TypeId::GetRegistered (i);
+      Ptr<Object> expected = 0;
+      if (tid == BaseA::GetTypeId ())
+        {
+          expected = baseA;
+        }
+      else if (tid == BaseB::GetTypeId ())
+        {
+          expected = baseB;
+        }
+      else if (tid == Object::GetTypeId ())
+        {
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<Object> (tid), expected, "Wrong lookup of " << tid.GetName ());
+      NS_TEST_ASSERT_MSG_EQ (baseB->GetObject<Object> (tid), expected, "Wrong cached lookup of " << tid.GetName ());
+    }
+}
+
 /**
  * \ingroup object-tests
  * Test an Object factory can create Objects
@@ -489,6 +556,7 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
+  AddTestCase (new GetObjectCacheTestCase);
   AddTestCase (new ObjectFactoryTestCase);
 }
 
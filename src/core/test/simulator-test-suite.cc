@@ -23,6 +23,16 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/event-impl-pool.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-profiler.h"
+#include <vector>
+#include <algorithm>
+#include <sstream>
 
 using namespace ns3;
 
@@ -170,6 +180,253 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorEventOrderTestCase : public TestCase
+{
+public:
+  SimulatorEventOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Event (uint32_t seq);
+  uint32_t Random (void);
+  void ScheduleOne (void);
+  uint64_t m_lastTs;
+  uint32_t m_lastSeq;
+  uint32_t m_nextSeq;
+  uint32_t m_nRun;
+  uint32_t m_nRemoved;
+  uint32_t m_rng;
+  bool m_ordered;
+  std::vector<EventId> m_ids;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorEventOrderTestCase::SimulatorEventOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that many events are run in order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+uint32_t
+SimulatorEventOrderTestCase::Random (void)
+{
+  // a simple LCG is enough, and keeps the test deterministic.
+  m_rng = m_rng * 1103515245 + 12345;
+  return (m_rng >> 16) & 0x7fff;
+}
+void
+SimulatorEventOrderTestCase::ScheduleOne (void)
+{
+  uint32_t r = Random ();
+  uint64_t delay;
+  switch (r % 4)
+    {
+    case 0:
+      // many events at the same time, to exercise uid ordering.
+      delay = 0;
+      break;
+    case 1:
+      delay = r % 8;
+      break;
+    case 2:
+      delay = r % 1000;
+      break;
+    default:
+      // a few events far in the future.
+      delay = r * 10000;
+      break;
+    }
+  m_ids.push_back (Simulator::Schedule (NanoSeconds (delay),
+                                        &SimulatorEventOrderTestCase::Event, this,
+                                        m_nextSeq));
+  m_nextSeq++;
+}
+void
+SimulatorEventOrderTestCase::Event (uint32_t seq)
+{
+  uint64_t ts = Simulator::Now ().GetTimeStep ();
+  if (ts < m_lastTs || (ts == m_lastTs && seq < m_lastSeq))
+    {
+      m_ordered = false;
+    }
+  m_lastTs = ts;
+  m_lastSeq = seq;
+  m_nRun++;
+  if (m_nextSeq < 20000)
+    {
+      ScheduleOne ();
+      if (Random () % 2 == 0)
+        {
+          ScheduleOne ();
+        }
+    }
+  if (Random () % 8 == 0)
+    {
+      EventId id = m_ids[Random () % m_ids.size ()];
+      if (!id.IsExpired ())
+        {
+          Simulator::Remove (id);
+          m_nRemoved++;
+        }
+    }
+}
+void
+SimulatorEventOrderTestCase::DoRun (void)
+{
+  m_lastTs = 0;
+  m_lastSeq = 0;
+  m_nextSeq = 0;
+  m_nRun = 0;
+  m_nRemoved = 0;
+  m_rng = 1;
+  m_ordered = true;
+  m_ids.clear ();
+
+  Simulator::SetScheduler (m_schedulerFactory);
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      ScheduleOne ();
+    }
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Events were not run in timestamp and uid order");
+  NS_TEST_EXPECT_MSG_EQ (m_nRun + m_nRemoved, m_nextSeq, "Some events were lost");
+  Simulator::Destroy ();
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event (uint32_t n);
+  uint64_t m_maxLive;
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that event memory is recycled by the EventImplPool")
+{
+}
+void
+SimulatorEventPoolTestCase::Event (uint32_t n)
+{
+  m_maxLive = std::max (m_maxLive, EventImplPool::GetLiveEvents ());
+  if (n > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Event, this, n - 1);
+    }
+}
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  // make sure the pool is attached before the first event is created.
+  Simulator::Now ();
+  NS_TEST_ASSERT_MSG_EQ (EventImplPool::IsEnabled (), true, "The pool should be enabled by default");
+  uint64_t live = EventImplPool::GetLiveEvents ();
+  m_maxLive = 0;
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &SimulatorEventPoolTestCase::Event, this, 100);
+    }
+  NS_TEST_EXPECT_MSG_EQ (EventImplPool::GetLiveEvents (), live + 10, "Scheduled events are not accounted for");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (EventImplPool::GetLiveEvents (), live, "Events were not released");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (m_maxLive, live + 11, "Too many live events");
+  NS_TEST_EXPECT_MSG_GT (EventImplPool::GetPooledEvents (), 0, "Released events were not pooled");
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (EventImplPool::GetPooledEvents (), 0, "The pool was not purged");
+
+  GlobalValue::Bind ("EventImplPoolEnabled", BooleanValue (false));
+  Simulator::Now ();
+  NS_TEST_EXPECT_MSG_EQ (EventImplPool::IsEnabled (), false, "The pool should be disabled");
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Event, this, 10);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (EventImplPool::GetPooledEvents (), 0, "Events were pooled by a disabled pool");
+  Simulator::Destroy ();
+  GlobalValue::Bind ("EventImplPoolEnabled", BooleanValue (true));
+}
+
+class SimulatorEventProfilerTestCase : public TestCase
+{
+public:
+  SimulatorEventProfilerTestCase ();
+  virtual void DoRun (void);
+  void Parent (uint32_t n);
+  void Child (void);
+};
+
+SimulatorEventProfilerTestCase::SimulatorEventProfilerTestCase ()
+  : TestCase ("Check the event profile of the DefaultSimulatorImpl")
+{
+}
+void
+SimulatorEventProfilerTestCase::Parent (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (MicroSeconds (1), &SimulatorEventProfilerTestCase::Child, this);
+    }
+}
+void
+SimulatorEventProfilerTestCase::Child (void)
+{
+}
+void
+SimulatorEventProfilerTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfiling", BooleanValue (true));
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_EQ ((impl != 0), true, "Not a DefaultSimulatorImpl");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::ScheduleWithContext (7, MicroSeconds (i), &SimulatorEventProfilerTestCase::Parent, this, 2);
+    }
+  Simulator::ScheduleWithContext (8, MicroSeconds (1), &SimulatorEventProfilerTestCase::Parent, this, 4);
+  EventId cancelled = Simulator::Schedule (MicroSeconds (1), &SimulatorEventProfilerTestCase::Child, this);
+  Simulator::Cancel (cancelled);
+  Simulator::Run ();
+
+  std::vector<EventProfiler::Entry> entries = impl->GetEventProfiler ().GetEntries ();
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 4, "Wrong number of event types and contexts");
+  std::string parent = "void (SimulatorEventProfilerTestCase::*)(unsigned int), SimulatorEventProfilerTestCase*, int";
+  std::string child = "void (SimulatorEventProfilerTestCase::*)(), SimulatorEventProfilerTestCase*";
+  for (std::vector<EventProfiler::Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      if (i != entries.begin ())
+        {
+          NS_TEST_EXPECT_MSG_LT_OR_EQ (i->time, (i - 1)->time, "Entries not sorted by decreasing time");
+        }
+      if (i->name == parent && i->context == 7)
+        {
+          NS_TEST_EXPECT_MSG_EQ (i->count, 3, "Wrong invocation count");
+          NS_TEST_EXPECT_MSG_EQ (i->fanout, 6, "Wrong fan-out");
+        }
+      else if (i->name == parent && i->context == 8)
+        {
+          NS_TEST_EXPECT_MSG_EQ (i->count, 1, "Wrong invocation count");
+          NS_TEST_EXPECT_MSG_EQ (i->fanout, 4, "Wrong fan-out");
+        }
+      else if (i->name == child && i->context == 7)
+        {
+          NS_TEST_EXPECT_MSG_EQ (i->count, 6, "Wrong invocation count");
+          NS_TEST_EXPECT_MSG_EQ (i->fanout, 0, "Wrong fan-out");
+        }
+      else if (i->name == child && i->context == 8)
+        {
+          NS_TEST_EXPECT_MSG_EQ (i->count, 4, "Wrong invocation count");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (true, false, "Unexpected entry " << i->name << " in context " << i->context);
+        }
+    }
+
+  std::ostringstream collapsed;
+  impl->GetEventProfiler ().Write (collapsed, EventProfiler::COLLAPSED);
+  NS_TEST_EXPECT_MSG_NE (collapsed.str ().find ("node 8;" + child + " "), std::string::npos,
+                         "Wrong collapsed stack format");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::EventProfiling", BooleanValue (false));
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -477,5 +734,20 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
+    AddTestCase (new SimulatorEventProfilerTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
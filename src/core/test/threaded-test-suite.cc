@@ -26,6 +26,8 @@
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/event-injection-queue.h"
+#include "ns3/make-event.h"
 
 #include <chrono>  // seconds, milliseconds
 #include <ctime>
@@ -226,6 +228,87 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class EventInjectionQueueTestCase : public TestCase
+{
+public:
+  EventInjectionQueueTestCase ();
+  static void Producer (std::pair<EventInjectionQueueTestCase *, uint32_t> context);
+  static void Nothing (void);
+
+  static const uint32_t N_PRODUCERS = 4;
+  static const uint32_t N_EVENTS = 10000;
+  EventInjectionQueue m_queue;
+  EventImpl *m_event;
+
+private:
+  virtual void DoRun (void);
+};
+
+EventInjectionQueueTestCase::EventInjectionQueueTestCase ()
+  : TestCase ("Check the EventInjectionQueue with concurrent producers")
+{
+}
+
+void
+EventInjectionQueueTestCase::Nothing (void)
+{
+}
+
+void
+EventInjectionQueueTestCase::Producer (std::pair<EventInjectionQueueTestCase *, uint32_t> context)
+{
+  EventInjectionQueueTestCase *me = context.first;
+  for (uint32_t i = 0; i < N_EVENTS; i++)
+    {
+      me->m_queue.Push (context.second, i, me->m_event);
+    }
+}
+
+void
+EventInjectionQueueTestCase::DoRun (void)
+{
+  m_event = MakeEvent (&EventInjectionQueueTestCase::Nothing);
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < N_PRODUCERS; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&EventInjectionQueueTestCase::Producer,
+                                                                  std::make_pair (this, i))));
+      threads.back ()->Start ();
+    }
+
+  // drain concurrently with the producers.
+  std::vector<uint64_t> next (N_PRODUCERS, 0);
+  std::vector<EventInjectionQueue::Entry> batch;
+  uint64_t received = 0;
+  bool ordered = true;
+  while (received < N_PRODUCERS * N_EVENTS)
+    {
+      batch.clear ();
+      m_queue.Drain (batch);
+      for (std::vector<EventInjectionQueue::Entry>::const_iterator i = batch.begin (); i != batch.end (); ++i)
+        {
+          ordered = ordered && i->context < N_PRODUCERS && i->timestamp == next[i->context]
+            && i->event == m_event;
+          next[i->context]++;
+        }
+      received += batch.size ();
+    }
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (ordered, true, "Events of a producer drained out of order");
+  NS_TEST_ASSERT_MSG_EQ (received, N_PRODUCERS * N_EVENTS, "Wrong number of events");
+  NS_TEST_ASSERT_MSG_EQ (m_queue.IsEmpty (), true, "Queue not empty");
+
+  EventInjectionQueue::Stats stats = m_queue.GetStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.injected, N_PRODUCERS * N_EVENTS, "Wrong injection count");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (stats.batches, 1, "No batch drained");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (stats.maxBatch, N_PRODUCERS * N_EVENTS, "Wrong largest batch");
+  NS_TEST_ASSERT_MSG_GT (stats.injectionsPerSecond, 0, "Wrong injection rate");
+  m_event->Unref ();
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -242,7 +325,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -263,5 +347,6 @@ public:
               }
           }
       }
+    AddTestCase (new EventInjectionQueueTestCase (), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
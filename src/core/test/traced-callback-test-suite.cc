@@ -113,6 +113,173 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class ConnectInCallbackTestCase : public TestCase
+{
+public:
+  ConnectInCallbackTestCase ();
+  virtual ~ConnectInCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbConnect (uint32_t a);
+  void CbCount (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_count;
+};
+
+ConnectInCallbackTestCase::ConnectInCallbackTestCase ()
+  : TestCase ("Check TracedCallback emptiness and connection from a Callback")
+{
+}
+
+void
+ConnectInCallbackTestCase::CbConnect (uint32_t a)
+{
+  //
+  // Grow the chain while it is being invoked, enough to move it in memory.
+  //
+  for (uint32_t i = 0; i < a; i++)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&ConnectInCallbackTestCase::CbCount, this));
+    }
+}
+
+void
+ConnectInCallbackTestCase::CbCount (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_count++;
+}
+
+void
+ConnectInCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New TracedCallback is not empty");
+
+  m_trace.ConnectWithoutContext (MakeCallback (&ConnectInCallbackTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "Connected TracedCallback is empty");
+
+  //
+  // The callbacks connected by CbConnect are appended to the chain being
+  // invoked, so they are called as well.
+  //
+  m_count = 0;
+  m_trace (100);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 100, "Callbacks connected during the invocation not called");
+
+  m_count = 0;
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 100, "Callbacks not called");
+
+  m_trace.DisconnectWithoutContext (MakeCallback (&ConnectInCallbackTestCase::CbCount, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&ConnectInCallbackTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback is not empty");
+  m_count = 0;
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 0, "Disconnected callbacks called");
+}
+
+class DisconnectInCallbackTestCase : public TestCase
+{
+public:
+  DisconnectInCallbackTestCase ();
+  virtual ~DisconnectInCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbSelf (uint32_t a);
+  void CbOther (uint32_t a);
+  void CbCount (uint32_t a);
+  void CbLast (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_self;
+  uint32_t m_other;
+  uint32_t m_count;
+  uint32_t m_last;
+};
+
+DisconnectInCallbackTestCase::DisconnectInCallbackTestCase ()
+  : TestCase ("Check TracedCallback disconnection from a Callback")
+{
+}
+
+void
+DisconnectInCallbackTestCase::CbSelf (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_self++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbSelf, this));
+}
+
+void
+DisconnectInCallbackTestCase::CbOther (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_other++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbLast, this));
+}
+
+void
+DisconnectInCallbackTestCase::CbCount (uint32_t a)
+{
+  m_count++;
+  if (a > 0)
+    {
+      //
+      // Invoke the chain again from a Callback: the Callbacks
+      // disconnected by the outer invocation are not called.
+      //
+      m_trace (a - 1);
+    }
+}
+
+void
+DisconnectInCallbackTestCase::CbLast (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_last++;
+}
+
+void
+DisconnectInCallbackTestCase::DoRun (void)
+{
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbSelf, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbCount, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbOther, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbLast, this));
+
+  //
+  // CbSelf disconnects itself, and the next Callback must still be
+  // called; CbOther disconnects CbLast, which must not be called.
+  //
+  m_self = 0;
+  m_other = 0;
+  m_count = 0;
+  m_last = 0;
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_self, 1, "Callback CbSelf not called once");
+  NS_TEST_ASSERT_MSG_EQ (m_count, 1, "Callback after a self-disconnecting Callback skipped");
+  NS_TEST_ASSERT_MSG_EQ (m_other, 1, "Callback CbOther not called once");
+  NS_TEST_ASSERT_MSG_EQ (m_last, 0, "Callback disconnected during the invocation called");
+
+  m_self = 0;
+  m_other = 0;
+  m_count = 0;
+  m_trace (2);
+  NS_TEST_ASSERT_MSG_EQ (m_self, 0, "Disconnected callback CbSelf called");
+  NS_TEST_ASSERT_MSG_EQ (m_count, 3, "Callback CbCount not called by the nested invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_other, 3, "Callback CbOther not called by the nested invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_last, 0, "Disconnected callback CbLast called");
+
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbCount, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectInCallbackTestCase::CbOther, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "Disconnected TracedCallback is not empty");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -123,6 +290,8 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ConnectInCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new DisconnectInCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
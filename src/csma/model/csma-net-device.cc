@@ -29,6 +29,7 @@
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "ns3/trace-source-accessor.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
@@ -997,6 +998,50 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   return true;
 }
 
+bool
+CsmaNetDevice::SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (burst << dest << protocolNumber);
+
+  NS_ASSERT (IsLinkUp ());
+
+  if (IsSendEnabled () == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return false;
+    }
+
+  //
+  // Queue the packets as SendFrom does, with the device state checked
+  // and the destination address converted once for the whole burst.
+  //
+  Mac48Address destination = Mac48Address::ConvertFrom (dest);
+  bool queued = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      Ptr<Packet> packet = *i;
+      AddHeader (packet, m_address, destination, protocolNumber);
+      m_macTxTrace (packet);
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+          queued = false;
+          continue;
+        }
+      if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+        {
+          m_currentPkt = m_queue->Dequeue ();
+          m_promiscSnifferTrace (m_currentPkt);
+          m_snifferTrace (m_currentPkt);
+          TransmitStart ();
+        }
+    }
+  return queued;
+}
+
 Ptr<Node>
 CsmaNetDevice::GetNode (void) const
 {
@@ -284,6 +284,18 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending a burst of packets down the channel.  The packets
+   * are queued in order and the transmission is started once, if the
+   * device is idle.
+   * \param burst packets to send
+   * \param dest layer 2 destination address
+   * \param protocolNumber protocol number
+   * \return true if all the packets were queued, false otherwise (drop, ...)
+   */
+  virtual bool SendBatch (Ptr<PacketBurst> burst, const Address& dest,
+                          uint16_t protocolNumber);
+
   /**
    * Get the node to which this device is attached.
    *
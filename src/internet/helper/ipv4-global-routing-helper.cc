@@ -64,11 +64,15 @@ Ipv4GlobalRoutingHelper::PopulateRoutingTables (void)
   GlobalRouteManager::InitializeRoutes ();
 }
 void 
-Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
+Ipv4GlobalRoutingHelper::PopulateRoutingTablesOnDemand (void)
 {
-  GlobalRouteManager::DeleteGlobalRoutes ();
   GlobalRouteManager::BuildGlobalRoutingDatabase ();
-  GlobalRouteManager::InitializeRoutes ();
+  GlobalRouteManager::InitializeRoutesOnDemand ();
+}
+void 
+Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
+{
+  GlobalRouteManager::RecomputeRoutes ();
 }
 
 
@@ -71,6 +71,21 @@ public:
    *
    */
   static void PopulateRoutingTables (void);
+  /**
+   * \brief Build a routing database and let the nodes compute their routes
+   * on demand.  Makes all nodes in the simulation into routers.
+   *
+   * Rather than computing the routes of every node to every destination,
+   * a node computes its routes to a destination when it looks the
+   * destination up for the first time, and caches them (see the
+   * Ipv4GlobalRouting::OnDemandCacheSize attribute).  This saves time and
+   * memory in large networks where each node sends to a few destinations.
+   *
+   * All this function does is call the functions
+   * BuildGlobalRoutingDatabase () and InitializeRoutesOnDemand ().
+   *
+   */
+  static void PopulateRoutingTablesOnDemand (void);
   /**
    * \brief Remove all routes that were previously installed in a prior call
    * to either PopulateRoutingTables() or RecomputeRoutingTables(), and 
@@ -82,6 +97,10 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routes of the routers connected to a Link State Advertisement
+   * which changed since the previous computation are recomputed; the other
+   * routers keep their routes.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
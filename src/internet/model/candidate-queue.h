@@ -22,7 +22,9 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +49,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap indexed by vertex, so that Push, Pop and
+ * Update are logarithmic in the number of candidates and Find is
+ * logarithmic in the number of candidates with distinct addresses.
+ * Vertices of equal priority are popped in the order in which they were
+ * pushed or last updated.
  */
 class CandidateQueue
 {
@@ -154,6 +162,20 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the order of the Candidate Queue after the distance of
+ * one of its vertices has changed.
+ *
+ * This is equivalent to, and much cheaper than, a call to Reorder () when
+ * only the distance of \p v has changed.  The vertex is then ordered after
+ * the other vertices of equal priority.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance has changed; it
+ * must be in the queue.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +206,49 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /**
+   * \brief A candidate stored in the heap
+   */
+  struct Candidate
+  {
+    SPFVertex *vertex; //!< the vertex
+    uint64_t order;    //!< order of the last push or update, to break ties
+  };
+
+  /**
+   * \brief return true if c1 should be popped before c2
+   * \param c1 first operand
+   * \param c2 second operand
+   * \return True if c1 should be popped before c2; false otherwise
+   */
+  static bool Before (const Candidate &c1, const Candidate &c2);
+
+  /**
+   * \brief Move the candidate at a position of the heap towards the top
+   * until the heap is ordered.
+   * \param i the position of the candidate
+   */
+  void SiftUp (uint32_t i);
+
+  /**
+   * \brief Move the candidate at a position of the heap towards the
+   * bottom until the heap is ordered.
+   * \param i the position of the candidate
+   */
+  void SiftDown (uint32_t i);
+
+  /**
+   * \brief Store a candidate at a position of the heap.
+   * \param i the position
+   * \param c the candidate
+   */
+  void Place (uint32_t i, const Candidate &c);
+
+  typedef std::vector<Candidate> CandidateHeap_t; //!< binary heap of candidates
+  CandidateHeap_t m_candidates;  //!< SPFVertex candidates
+  std::unordered_map<SPFVertex*, uint32_t> m_positions; //!< position of each vertex in the heap
+  std::multimap<Ipv4Address, SPFVertex*> m_addresses; //!< vertices by address
+  uint64_t m_order; //!< order of the next push or update
 
   /**
    * \brief Stream insertion operator.
@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 #include <queue>
+#include <functional>
 #include <algorithm>
 #include <iostream>
 #include "ns3/assert.h"
@@ -35,6 +36,8 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -446,6 +449,7 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_linkDataIndex.clear ();
 }
 
 void
@@ -470,7 +474,34 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      std::pair<LSDBMap_t::iterator, bool> inserted = m_database.insert (LSDBPair_t (addr, lsa));
+      if (!inserted.second)
+        {
+          return;
+        }
+//
+// Index the LSA by the Link Data of its TransitNetwork link records.  When
+// several LSAs have the same Link Data, the index refers to the first one in
+// the database, which is the one found by walking the database.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::map<Ipv4Address, LSDBMap_t::const_iterator>::iterator k =
+            m_linkDataIndex.find (lr->GetLinkData ());
+          if (k == m_linkDataIndex.end ())
+            {
+              m_linkDataIndex.insert (std::make_pair (lr->GetLinkData (), inserted.first));
+            }
+          else if (addr < k->second->first)
+            {
+              k->second = inserted.first;
+            }
+        }
     }
 }
 
@@ -495,13 +526,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,24 +539,379 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the Link Data of one of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  std::map<Ipv4Address, LSDBMap_t::const_iterator>::const_iterator i =
+    m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+      return i->second->second;
+    }
+  return 0;
+}
+
+/**
+ * \brief Compare the contents of two Link State Advertisements.
+ *
+ * \param a the first LSA
+ * \param b the second LSA
+ * \returns true if the LSAs advertise the same links
+ */
+static bool
+IsSameLSA (GlobalRoutingLSA *a, GlobalRoutingLSA *b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief A change of the metric of a link of a router to a transit vertex
+ * (a router or a transit network).
+ */
+struct MetricChange
+{
+  Ipv4Address from;   //!< the link state ID of the router
+  Ipv4Address to;     //!< the link state ID of the transit vertex
+  uint32_t oldMetric; //!< the metric of the link in the previous database
+  uint32_t newMetric; //!< the metric of the link in the new database
+};
+
+/**
+ * \brief Collect the changes of the metrics of the transit links of a
+ * Router-LSA.
+ *
+ * The metrics of the links to stub networks are not used by the routes.
+ *
+ * \param a the LSA in the new database
+ * \param b the LSA in the previous database
+ * \param changes the changes of the metrics of the transit links, to which
+ * those of the LSA are appended
+ * \returns true if the LSAs only differ by the metrics of their links
+ */
+static bool
+GetMetricChanges (GlobalRoutingLSA *a, GlobalRoutingLSA *b, std::vector<MetricChange> &changes)
+{
+  if (a->GetLSType () != GlobalRoutingLSA::RouterLSA
+      || b->GetLSType () != GlobalRoutingLSA::RouterLSA
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  std::vector<MetricChange> found;
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ())
+        {
+          return false;
+        }
+      if (la->GetMetric () != lb->GetMetric ()
+          && la->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
+        {
+          MetricChange change = { a->GetLinkStateId (), la->GetLinkId (), lb->GetMetric (), la->GetMetric () };
+          found.push_back (change);
+        }
+    }
+  changes.insert (changes.end (), found.begin (), found.end ());
+  return true;
+}
+
+/// The links followed by the SPF calculation to each vertex: the link state
+/// ID of the vertex at the other end of each link, and the metric of the link
+typedef std::map<Ipv4Address, std::vector<std::pair<Ipv4Address, uint32_t> > > IncomingLinks;
+
+/**
+ * \brief Compute the shortest distance to a vertex of the vertices which
+ * can reach it, by a Dijkstra calculation on the reversed links.
+ *
+ * \param incoming the links to each vertex
+ * \param to the link state ID of the vertex
+ * \returns the distance to the vertex of each vertex which can reach it
+ */
+static std::map<Ipv4Address, uint32_t>
+GetDistancesTo (const IncomingLinks &incoming, Ipv4Address to)
+{
+  typedef std::pair<uint32_t, Ipv4Address> Item;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+  std::map<Ipv4Address, uint32_t> distances;
+  queue.push (Item (0, to));
+  while (!queue.empty ())
+    {
+      Item item = queue.top ();
+      queue.pop ();
+      if (!distances.insert (std::make_pair (item.second, item.first)).second)
+        {
+          continue;
+        }
+      IncomingLinks::const_iterator i = incoming.find (item.second);
+      if (i == incoming.end ())
+        {
+          continue;
+        }
+      for (std::vector<std::pair<Ipv4Address, uint32_t> >::const_iterator j = i->second.begin ();
+           j != i->second.end (); j++)
         {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
+          if (distances.find (j->first) == distances.end ())
             {
-              return temp;
+              queue.push (Item (item.first + j->second, j->first));
             }
         }
     }
-  return 0;
+  return distances;
+}
+
+/**
+ * \brief Find the representative of the set of an address, in a union-find
+ * forest of addresses.
+ *
+ * \param sets the parent of each address in the forest
+ * \param addr the address, which is added to the forest if absent
+ * \returns the representative of the set of the address
+ */
+static Ipv4Address
+FindSet (std::map<Ipv4Address, Ipv4Address> &sets, Ipv4Address addr)
+{
+  Ipv4Address root = addr;
+  std::map<Ipv4Address, Ipv4Address>::iterator i = sets.insert (std::make_pair (addr, addr)).first;
+  while (i->second != root)
+    {
+      root = i->second;
+      i = sets.find (root);
+    }
+  // Compress the path from the address to the representative
+  while (addr != root)
+    {
+      i = sets.find (addr);
+      addr = i->second;
+      i->second = root;
+    }
+  return root;
+}
+
+std::set<Ipv4Address>
+GlobalRouteManagerLSDB::GetAffectedRouters (const GlobalRouteManagerLSDB& other) const
+{
+  NS_LOG_FUNCTION (this << &other);
+
+  bool sameExternals = m_extdatabase.size () == other.m_extdatabase.size ();
+  for (uint32_t j = 0; sameExternals && j < m_extdatabase.size (); j++)
+    {
+      sameExternals = IsSameLSA (m_extdatabase[j], other.m_extdatabase[j]);
+    }
+
+//
+// Group the LSAs connected in either database, and collect the groups of
+// the changed LSAs.  The Router-LSAs which only differ by the metrics of
+// their links are handled apart.
+//
+  std::map<Ipv4Address, Ipv4Address> sets;
+  std::set<Ipv4Address> changed;
+  std::vector<MetricChange> metricChanges;
+  const GlobalRouteManagerLSDB* databases[2] = { this, &other };
+  for (uint32_t d = 0; d < 2; d++)
+    {
+      const GlobalRouteManagerLSDB* db = databases[d];
+      const GlobalRouteManagerLSDB* peer = databases[1 - d];
+      for (LSDBMap_t::const_iterator i = db->m_database.begin (); i != db->m_database.end (); i++)
+        {
+          Ipv4Address id = FindSet (sets, i->first);
+          GlobalRoutingLSA* lsa = i->second;
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+              if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                  || lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  sets[id] = FindSet (sets, lr->GetLinkId ());
+                  id = FindSet (sets, id);
+                }
+            }
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              GlobalRoutingLSA* router = db->GetLSAByLinkData (lsa->GetAttachedRouter (j));
+              if (router)
+                {
+                  sets[id] = FindSet (sets, router->GetLinkStateId ());
+                  id = FindSet (sets, id);
+                }
+            }
+          GlobalRoutingLSA* peerLsa = peer->GetLSA (i->first);
+          if (peerLsa == 0
+              || (db == this && !IsSameLSA (lsa, peerLsa) && !GetMetricChanges (lsa, peerLsa, metricChanges)))
+            {
+              changed.insert (i->first);
+            }
+        }
+    }
+
+//
+// The routes of a router only change with the metric of a link which is on
+// one of its shortest paths, or which gives a path as short as them.  Both
+// are told by the distances from the router to the ends of the link in the
+// previous database, which the Dijkstra calculations from the ends on the
+// reversed links give for all the routers, unless there are so many ends
+// that recomputing the routes of all the routers is cheaper.
+//
+  std::map<Ipv4Address, std::map<Ipv4Address, uint32_t> > distancesTo;
+  if (sameExternals && !metricChanges.empty ())
+    {
+      std::set<Ipv4Address> ends;
+      for (std::vector<MetricChange>::const_iterator i = metricChanges.begin (); i != metricChanges.end (); i++)
+        {
+          ends.insert (i->from);
+          ends.insert (i->to);
+        }
+      if (ends.size () < other.m_database.size ())
+        {
+          IncomingLinks incoming;
+          for (LSDBMap_t::const_iterator i = other.m_database.begin (); i != other.m_database.end (); i++)
+            {
+              GlobalRoutingLSA* lsa = i->second;
+              for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+                {
+                  GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+                  if (lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                      || lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                    {
+                      incoming[lr->GetLinkId ()].push_back (std::make_pair (i->first, lr->GetMetric ()));
+                    }
+                }
+              for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+                {
+                  GlobalRoutingLSA* router = other.GetLSAByLinkData (lsa->GetAttachedRouter (j));
+                  if (router)
+                    {
+                      incoming[router->GetLinkStateId ()].push_back (std::make_pair (i->first, 0));
+                    }
+                }
+            }
+          for (std::set<Ipv4Address>::const_iterator i = ends.begin (); i != ends.end (); i++)
+            {
+              distancesTo[*i] = GetDistancesTo (incoming, *i);
+            }
+        }
+      else
+        {
+          for (std::vector<MetricChange>::const_iterator i = metricChanges.begin (); i != metricChanges.end (); i++)
+            {
+              changed.insert (i->from);
+            }
+          metricChanges.clear ();
+        }
+    }
+
+  std::set<Ipv4Address> changedSets;
+  for (std::set<Ipv4Address>::const_iterator i = changed.begin (); i != changed.end (); i++)
+    {
+      changedSets.insert (FindSet (sets, *i));
+    }
+
+  std::set<Ipv4Address> routers;
+  for (uint32_t d = 0; d < 2; d++)
+    {
+      const GlobalRouteManagerLSDB* db = databases[d];
+      for (LSDBMap_t::const_iterator i = db->m_database.begin (); i != db->m_database.end (); i++)
+        {
+          if (i->second->GetLSType () == GlobalRoutingLSA::RouterLSA
+              && (!sameExternals || changedSets.count (FindSet (sets, i->first))))
+            {
+              routers.insert (i->first);
+            }
+        }
+    }
+  for (std::vector<MetricChange>::const_iterator i = metricChanges.begin (); sameExternals && i != metricChanges.end (); i++)
+    {
+      const std::map<Ipv4Address, uint32_t> &toFrom = distancesTo[i->from];
+      const std::map<Ipv4Address, uint32_t> &toTo = distancesTo[i->to];
+      for (std::map<Ipv4Address, uint32_t>::const_iterator j = toFrom.begin (); j != toFrom.end (); j++)
+        {
+          GlobalRoutingLSA* lsa = other.GetLSA (j->first);
+          if (lsa == 0 || lsa->GetLSType () != GlobalRoutingLSA::RouterLSA)
+            {
+              continue;
+            }
+          // the router reaches the other end of the link through the link
+          std::map<Ipv4Address, uint32_t>::const_iterator k = toTo.find (j->first);
+          uint64_t oldDistance = static_cast<uint64_t> (j->second) + i->oldMetric;
+          uint64_t newDistance = static_cast<uint64_t> (j->second) + i->newMetric;
+          if (k == toTo.end () || oldDistance == k->second || newDistance <= k->second)
+            {
+              routers.insert (j->first);
+            }
+        }
+    }
+  NS_LOG_LOGIC (changed.size () << " changed LSAs and " << metricChanges.size ()
+                << " changed metrics affect " << routers.size () << " routers");
+  return routers;
+}
+
+std::set<Ipv4Address>
+GlobalRouteManagerLSDB::GetVerticesTo (Ipv4Address dest) const
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  std::set<Ipv4Address> vertices;
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      GlobalRoutingLSA* lsa = i->second;
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA
+          && lsa->GetNetworkLSANetworkMask ().IsMatch (dest, lsa->GetLinkStateId ()))
+        {
+          vertices.insert (i->first);
+        }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if ((lr->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+               && lr->GetLinkData () == dest)
+              || (lr->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork
+                  && Ipv4Mask (lr->GetLinkData ().Get ()).IsMatch (dest, lr->GetLinkId ())))
+            {
+              vertices.insert (i->first);
+            }
+        }
+    }
+  for (uint32_t j = 0; j < m_extdatabase.size (); j++)
+    {
+      GlobalRoutingLSA* extlsa = m_extdatabase[j];
+      if (extlsa->GetNetworkLSANetworkMask ().IsMatch (dest, extlsa->GetLinkStateId ()))
+        {
+          vertices.insert (extlsa->GetAdvertisingRouter ());
+        }
+    }
+  return vertices;
 }
 
 // ---------------------------------------------------------------------------
@@ -539,7 +922,9 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_onDemand (false),
+    m_destinationFilter (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -572,25 +957,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteGlobalRoutes (*i);
     }
   if (m_lsdb)
     {
@@ -600,6 +967,31 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteGlobalRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  gr->ClearOnDemandRoutes ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -700,6 +1092,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  m_onDemand = false;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -710,6 +1103,10 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       Ptr<GlobalRouter> rtr = 
         node->GetObject<GlobalRouter> ();
+      if (rtr)
+        {
+          rtr->GetRoutingProtocol ()->SetOnDemand (false);
+        }
 
       uint32_t systemId = MpiInterface::GetSystemId ();
       // Ignore nodes that are not assigned to our systemId (distributed sim)
@@ -730,6 +1127,100 @@ GlobalRouteManagerImpl::InitializeRoutes ()
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+//
+// The routes of a router only depend on the LSAs it can reach, so when the
+// database is rebuilt, only the routers connected to an LSA which changed
+// need their routes to be recomputed.  This makes the recomputation after a
+// link or interface event local to the part of the network where it happened
+// when the network is partitioned, and free when the event did not change
+// any LSA.  When only the metrics of links changed, only the routers whose
+// shortest paths may change are recomputed.
+//
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB* previous = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::set<Ipv4Address> affected = m_lsdb->GetAffectedRouters (*previous);
+  delete previous;
+
+  NS_LOG_INFO ("About to recompute the routes of " << affected.size () << " routers");
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0 || affected.count (rtr->GetRouterId ()) == 0)
+        {
+          continue;
+        }
+      DeleteGlobalRoutes (node);
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      // and the routes computed on demand
+      if (!m_onDemand && node->GetSystemId () == systemId && rtr->GetNumLSAs ())
+        {
+          SPFCalculate (rtr->GetRouterId ());
+        }
+    }
+  NS_LOG_INFO ("Finished recomputing the routes");
+}
+
+//
+// Most routers of a large network never send a packet to most destinations.
+// Rather than running the SPF calculation of every router, the routers
+// run it when they look up a destination for the first time, keeping only
+// the routes to that destination, which they cache.  The calculation stops
+// once the routers and networks advertising the destination are reached.
+//
+void
+GlobalRouteManagerImpl::InitializeRoutesOnDemand ()
+{
+  NS_LOG_FUNCTION (this);
+  m_onDemand = true;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr)
+        {
+          rtr->GetRoutingProtocol ()->SetOnDemand (true);
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::ComputeRoutesTo (Ptr<Node> node, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << node << dest);
+  // the SPF calculation updates the state of the whole database, which
+  // the nodes of the other partitions may be using concurrently.
+  Ptr<MultithreadedSimulatorImpl> mt =
+    DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (mt != 0 && mt->GetPartitionCount () > 1)
+    {
+      NS_FATAL_ERROR ("The global routes cannot be computed on demand with "
+                      "a MultithreadedSimulatorImpl running several partitions");
+    }
+  Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+  if (rtr == 0 || rtr->GetNumLSAs () == 0)
+    {
+      return;
+    }
+  m_destinationFilter = true;
+  m_destination = dest;
+  SPFCalculate (rtr->GetRouterId ());
+  m_destinationFilter = false;
+}
+
+bool
+GlobalRouteManagerImpl::IsFilteredOut (Ipv4Address network, Ipv4Mask mask) const
+{
+  return m_destinationFilter && !mask.IsMatch (m_destination, network);
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -960,7 +1451,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Update (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1366,6 +1857,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+  m_spfrootNode = FindRouterNode (root);
   v->SetDistanceFromRoot (0);
   v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
@@ -1381,11 +1873,36 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootNode = 0;
       return;
     }
 
+//
+// When the routes to a single destination are computed, the calculation
+// stops once the vertices from which the routes to the destination are
+// installed are in the tree: their root exit directions are final, and
+// the routes to the destination are the same as in a complete calculation.
+//
+  std::set<Ipv4Address> targets;
+  if (m_destinationFilter)
+    {
+      targets = m_lsdb->GetVerticesTo (m_destination);
+      targets.erase (root);
+    }
+
   for (;;)
     {
+      if (m_destinationFilter && targets.empty ())
+        {
+          NS_LOG_LOGIC ("The vertices with routes to " << m_destination << " are in the SPF tree");
+//
+// The candidates refer to their parents in the tree, which is deleted
+// below.
+//
+          candidate.Clear ();
+          break;
+        }
 //
 // The operations we need to do are given in the OSPF RFC which we reference
 // as we go along.
@@ -1477,6 +1994,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
         {
           NS_ASSERT_MSG (0, "illegal SPFVertex type");
         }
+      targets.erase (v->GetVertexId ());
 //
 // RFC2328 16.1. (5). 
 //
@@ -1502,6 +2020,37 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootNode = 0;
+}
+
+Ptr<Node>
+GlobalRouteManagerImpl::FindRouterNode (Ipv4Address root)
+{
+  NS_LOG_FUNCTION (this << root);
+//
+// The LSAs discovered by the routers know the node of their router, so look
+// there first rather than walking the list of nodes.
+//
+  GlobalRoutingLSA *lsa = m_lsdb->GetLSA (root);
+  if (lsa && NodeList::GetNNodes () > 0)
+    {
+      Ptr<Node> node = lsa->GetNode ();
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          return node;
+        }
+    }
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          return *i;
+        }
+    }
+  return 0;
 }
 
 void
@@ -1560,58 +2109,38 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node corresponding to the root vertex, which was found when the SPF
+// calculation started, is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2155,36 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0 && !IsFilteredOut (tempip, tempmask))
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1729,60 +2255,38 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node corresponding to the root vertex, which was found when the SPF
+// calculation started, is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to QI
 // for that interface.  If the node is acting as an IP version 4 router, it
 // should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "QI for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1797,39 +2301,36 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // which the packets should be send for forwarding.
 //
 
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0 && !IsFilteredOut (tempip, tempmask))
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1853,61 +2354,41 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 //
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// The node corresponding to the root vertex, which was found when the SPF
+// calculation started, is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+      return -1;
+    }
 //
 // This is the node we're building the routing table for.  We're going to need
 // the Ipv4 interface to look for the ipv4 interface index.  Since this node
 // is participating in routing IP version 4 packets, it certainly must have 
 // an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1944,60 +2425,38 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node corresponding to the root vertex, which was found when the SPF
+// calculation started, is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2465,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << node->GetId () <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,45 +2490,42 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+      NS_ASSERT (gr);
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0 && !IsFilteredOut (lr->GetLinkData (), Ipv4Mask::GetOnes ()))
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
+            }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
             }
+        } // for all routes from the root the vertex 'v'
+    }
 //
 // Done adding the routes for the selected node.
 //
-          return;
-        }
-    }
 }
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
@@ -2089,95 +2545,71 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node corresponding to the root vertex, which was found when the SPF
+// calculation started, is the one we're going to write the routing
+// information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Node> node = m_spfrootNode;
+  if (node == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("Can't find root node " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
 //
 // Routing information is updated using the Ipv4 interface.  We need to 
 // GetObject for that interface.  If the node is acting as an IP version 4 
 // router, it should absolutely have an Ipv4 interface.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "GetObject for <Ipv4> interface failed");
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0 && !IsFilteredOut (tempip, tempmask))
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
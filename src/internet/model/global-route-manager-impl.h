@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -674,12 +675,47 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Find the routers whose routes may differ between this database
+ * and another one.
+ *
+ * An LSA changed if it is in one database only or if its content differs
+ * between the databases.  The routes of a router can only change if its
+ * LSA is connected, in either database, to a changed LSA; this returns
+ * the IDs of these routers.  If a Router-LSA only differs by the metrics
+ * of its links, only the routers which have a shortest path through one
+ * of these links, or to which one of these links gives a path as short
+ * as their shortest paths, are returned for it.  All the routers are
+ * returned if the External Link State Advertisements differ.
+ *
+ * @param other The other database.
+ * @returns The router IDs of the routers whose routes may differ.
+ */
+  std::set<Ipv4Address> GetAffectedRouters (const GlobalRouteManagerLSDB& other) const;
+
+/**
+ * @brief Find the vertices from which the SPF calculation installs routes
+ * to an address.
+ *
+ * These are the routers with a point-to-point link of this address, or
+ * with a stub network or an External Link State Advertisement whose
+ * prefix matches it, and the transit networks whose prefix matches it.
+ *
+ * @param dest The address.
+ * @returns The Link State IDs of the vertices.
+ */
+  std::set<Ipv4Address> GetVerticesTo (Ipv4Address dest) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  /**
+   * Index of the LSAs by the Link Data of their TransitNetwork link records,
+   * which refers to the first such LSA of m_database.
+   */
+  std::map<Ipv4Address, LSDBMap_t::const_iterator> m_linkDataIndex;
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -735,6 +771,37 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * routers affected by the changes of the Link State Advertisements.
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes (), except that the routes of the routers that are
+ * not connected to a changed LSA are kept as they are.
+ */
+  virtual void RecomputeRoutes ();
+
+/**
+ * @brief Compute the routes of each router on demand, for each destination
+ * when the router first looks it up, instead of computing all the routes
+ * of all the routers.
+ *
+ * The routing database must have been built.
+ */
+  virtual void InitializeRoutesOnDemand ();
+
+/**
+ * @brief Compute the routes of a router to a destination, using a Dijkstra
+ * SPF computation, and add them to the routes computed on demand of the
+ * router.
+ *
+ * This is a fatal error with a MultithreadedSimulatorImpl running
+ * several partitions, as the SPF computation updates the shared database.
+ * @param node the node of the router
+ * @param dest the destination
+ */
+  virtual void ComputeRoutesTo (Ptr<Node> node, Ipv4Address dest);
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -767,7 +834,33 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot; //!< the root node
+  Ptr<Node> m_spfrootNode; //!< the node of the root router, whose routes are being computed
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_onDemand; //!< whether the routes are computed on demand
+  bool m_destinationFilter; //!< whether only the routes to m_destination are added
+  Ipv4Address m_destination; //!< the destination of the routes being computed on demand
+
+  /**
+   * \brief Test whether a route is not to be added because it does not
+   * lead to the destination whose routes are being computed.
+   * \param network the destination network of the route
+   * \param mask the destination network mask of the route
+   * \returns true if the route must not be added
+   */
+  bool IsFilteredOut (Ipv4Address network, Ipv4Mask mask) const;
+
+  /**
+   * \brief Delete the global routes of a node
+   * \param node the node
+   */
+  void DeleteGlobalRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Find the node of a router
+   * \param root the router ID
+   * \returns the node, or 0 if no node has this router ID
+   */
+  Ptr<Node> FindRouterNode (Ipv4Address root);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -58,6 +58,30 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::RecomputeRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  RecomputeRoutes ();
+}
+
+void
+GlobalRouteManager::InitializeRoutesOnDemand (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  InitializeRoutesOnDemand ();
+}
+
+void
+GlobalRouteManager::ComputeRoutesTo (Ptr<Node> node, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (node << dest);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  ComputeRoutesTo (node, dest);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -22,8 +22,13 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+
 namespace ns3 {
 
+class Node;
+
 /**
  * \ingroup globalrouting
  *
@@ -65,6 +70,43 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * routers affected by the changes since the last computation.
+ *
+ * The routers that are not connected to a changed Link State Advertisement
+ * keep their routes, and so do the routers whose shortest paths are not
+ * affected by the changes of the metrics of links.
+ */
+  static void RecomputeRoutes ();
+
+/**
+ * @brief Compute the routes of each router on demand, when the router
+ * looks up a destination for the first time, instead of computing the
+ * routes of all the routers to all the destinations.
+ *
+ * The routing database must have been built by BuildGlobalRoutingDatabase.
+ * The routes computed on demand are cached by each router, see the
+ * Ipv4GlobalRouting::OnDemandCacheSize attribute.
+ *
+ * The routes cannot be computed on demand by a simulation run by a
+ * MultithreadedSimulatorImpl with several partitions: the computation
+ * updates the routing database shared by all the routers, and aborts the
+ * simulation in that case.
+ */
+  static void InitializeRoutesOnDemand ();
+
+/**
+ * @brief Compute the routes of a router to a destination using a Dijkstra
+ * SPF computation.
+ *
+ * This is called by the routers when the routes are computed on demand.
+ *
+ * @param node the node of the router
+ * @param dest the destination
+ */
+  static void ComputeRoutesTo (Ptr<Node> node, Ipv4Address dest);
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
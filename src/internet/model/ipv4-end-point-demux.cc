@@ -22,6 +22,7 @@
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
 #include "ns3/log.h"
+#include <algorithm>
 
 
 namespace ns3 {
@@ -40,23 +41,21 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_positions.clear ();
+  m_connections.clear ();
+  m_listeners.clear ();
+  m_ports.clear ();
 }
 
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
@@ -85,10 +84,7 @@ Ipv4EndPointDemux::Allocate (void)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv4EndPoint (Ipv4Address::GetAny (), port));
 }
 
 Ipv4EndPoint *
@@ -101,10 +97,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -124,10 +117,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv4EndPoint (address, port));
 }
 
 Ipv4EndPoint *
@@ -136,7 +126,24 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  // the end points with the same four-tuple are in the same index
+  std::vector<Ipv4EndPoint *> endPoints;
+  if (IsConnected (endPoint))
+    {
+      FindConnections (Connection (localAddress, localPort, peerAddress, peerPort), endPoints);
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::const_iterator it = m_listeners.find (localPort);
+      if (it != m_listeners.end ())
+        {
+          endPoints.assign (it->second.begin (), it->second.end ());
+        }
+    }
+  for (std::vector<Ipv4EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -145,30 +152,26 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
+          delete endPoint;
           return 0;
         }
     }
-  Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
-  return endPoint;
+  return Add (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, EndPointsI>::iterator it = m_positions.find (endPoint);
+  if (it != m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      m_endPoints.erase (it->second);
+      m_positions.erase (it);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -208,7 +211,40 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+
+  // A connected endpoint can only match if its local address is the
+  // destination address, the any address or the network part of an address
+  // of the incoming interface; the other endpoints are found by local port.
+  std::vector<Ipv4Address> localAddresses;
+  localAddresses.push_back (daddr);
+  if (daddr != Ipv4Address::GetAny ())
+    {
+      localAddresses.push_back (Ipv4Address::GetAny ());
+    }
+  if (incomingInterface)
+    {
+      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+        {
+          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+          Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+          if (std::find (localAddresses.begin (), localAddresses.end (), addrNetpart) == localAddresses.end ())
+            {
+              localAddresses.push_back (addrNetpart);
+            }
+        }
+    }
+  std::vector<Ipv4EndPoint *> endPoints;
+  for (std::vector<Ipv4Address>::const_iterator i = localAddresses.begin (); i != localAddresses.end (); i++)
+    {
+      FindConnections (Connection (*i, dport, saddr, sport), endPoints);
+    }
+  std::unordered_map<uint16_t, EndPoints>::const_iterator listeners = m_listeners.find (dport);
+  if (listeners != m_listeners.end ())
+    {
+      endPoints.insert (endPoints.end (), listeners->second.begin (), listeners->second.end ());
+    }
+
+  for (std::vector<Ipv4EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
     {
       Ipv4EndPoint* endP = *i;
 
@@ -377,6 +413,115 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
     }
   return generic;
 }
+
+Ipv4EndPointDemux::Connection::Connection (Ipv4Address localAddress, uint16_t localPort,
+                                           Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    peerAddress (peerAddress),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::Connection::operator== (const Connection &o) const
+{
+  return localAddress == o.localAddress && peerAddress == o.peerAddress
+         && localPort == o.localPort && peerPort == o.peerPort;
+}
+
+size_t
+Ipv4EndPointDemux::ConnectionHash::operator() (const Connection &connection) const
+{
+  uint64_t addresses = (static_cast<uint64_t> (connection.localAddress.Get ()) << 32)
+    | connection.peerAddress.Get ();
+  uint64_t ports = (static_cast<uint64_t> (connection.localPort) << 16) | connection.peerPort;
+  uint64_t hash = (addresses ^ (ports << 24)) * 0x9e3779b97f4a7c15ULL;
+  return static_cast<size_t> (hash ^ (hash >> 32));
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Add (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_positions[endPoint] = m_endPoints.insert (m_endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  m_ports[port]++;
+  if (IsConnected (endPoint))
+    {
+      Connection connection (endPoint->GetLocalAddress (), port,
+                             endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      m_connections.insert (std::make_pair (connection, endPoint));
+    }
+  else
+    {
+      m_listeners[port].push_back (endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  std::unordered_map<uint16_t, uint32_t>::iterator count = m_ports.find (port);
+  NS_ASSERT (count != m_ports.end ());
+  if (--count->second == 0)
+    {
+      m_ports.erase (count);
+    }
+  if (IsConnected (endPoint))
+    {
+      Connection connection (endPoint->GetLocalAddress (), port,
+                             endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      std::pair<Connections::iterator, Connections::iterator> range = m_connections.equal_range (connection);
+      for (Connections::iterator i = range.first; i != range.second; i++)
+        {
+          if (i->second == endPoint)
+            {
+              m_connections.erase (i);
+              break;
+            }
+        }
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::iterator listeners = m_listeners.find (port);
+      NS_ASSERT (listeners != m_listeners.end ());
+      listeners->second.remove (endPoint);
+      if (listeners->second.empty ())
+        {
+          m_listeners.erase (listeners);
+        }
+    }
+}
+
+bool
+Ipv4EndPointDemux::IsConnected (Ipv4EndPoint *endPoint)
+{
+  return endPoint->GetPeerPort () != 0 && endPoint->GetPeerAddress () != Ipv4Address::GetAny ();
+}
+
+void
+Ipv4EndPointDemux::FindConnections (const Connection &connection, std::vector<Ipv4EndPoint *> &endPoints) const
+{
+  std::pair<Connections::const_iterator, Connections::const_iterator> range = m_connections.equal_range (connection);
+  for (Connections::const_iterator i = range.first; i != range.second; i++)
+    {
+      endPoints.push_back (i->second);
+    }
+}
+
 uint16_t
 Ipv4EndPointDemux::AllocateEphemeralPort (void)
 {
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints whose peer address and port are both set (e.g., the open
+ * TCP connections) are indexed by their four-tuple, and the other ones by
+ * their local port, so that the cost of a lookup does not grow with the
+ * number of connections.  The endpoints tell their demux when their
+ * addresses or ports change, to be indexed again.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +174,86 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of a connected end point.
+   */
+  struct Connection
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    Connection (Ipv4Address localAddress, uint16_t localPort,
+                Ipv4Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param o the other four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator== (const Connection &o) const;
+
+    Ipv4Address localAddress; //!< The local address
+    Ipv4Address peerAddress;  //!< The peer address
+    uint16_t localPort;       //!< The local port
+    uint16_t peerPort;        //!< The peer port
+  };
+
+  /**
+   * \brief Hash function class for the four-tuples.
+   */
+  struct ConnectionHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param connection the four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator() (const Connection &connection) const;
+  };
+
+  /**
+   * \brief Container of the connected end points, by four-tuple.
+   */
+  typedef std::unordered_multimap<Connection, Ipv4EndPoint *, ConnectionHash> Connections;
+
+  /**
+   * \brief Add an end point to the demux.
+   * \param endPoint the end point
+   * \returns the end point
+   */
+  Ipv4EndPoint *Add (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by four-tuple or by local port.
+   * \param endPoint the end point
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the indexes.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Tell whether an end point is indexed by four-tuple.
+   * \param endPoint the end point
+   * \returns true if the peer address and port of the end point are set
+   */
+  static bool IsConnected (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add the connected end points with a four-tuple to a list.
+   * \param [in] connection the four-tuple
+   * \param [in,out] endPoints the list of end points
+   */
+  void FindConnections (const Connection &connection, std::vector<Ipv4EndPoint *> &endPoints) const;
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +280,26 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The position of each end point in m_endPoints.
+   */
+  std::unordered_map<Ipv4EndPoint *, EndPointsI> m_positions;
+
+  /**
+   * \brief The connected end points, by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The other end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_listeners;
+
+  /**
+   * \brief The number of end points of each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } // namespace ns3
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \ingroup ipv4
@@ -183,6 +184,8 @@ public:
   bool IsRxEnabled (void);
 
 private:
+  friend class Ipv4EndPointDemux;
+
   /**
    * \brief The local address.
    */
@@ -227,6 +230,11 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  /**
+   * \brief The demux which indexes the endpoint (if any).
+   */
+  Ipv4EndPointDemux *m_demux;
 };
 
 } // namespace ns3
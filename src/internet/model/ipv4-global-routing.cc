@@ -20,6 +20,7 @@
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/simulator.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -27,6 +28,7 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -53,13 +55,22 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("OnDemandCacheSize",
+                   "The maximum number of destinations whose routes are cached when the routes are computed on demand. "
+                   "The routes cannot be computed on demand with a MultithreadedSimulatorImpl running several partitions.",
+                   UintegerValue (256),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_onDemandCacheSize),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_onDemand (false),
+    m_onDemandCacheSize (256),
+    m_onDemandComputing (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -79,7 +90,13 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   NS_LOG_FUNCTION (this << dest << nextHop << interface);
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
+  if (m_onDemandComputing != 0)
+    {
+      m_onDemandComputing->hostRoutes.push_back (route);
+      return;
+    }
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRoutesTrie, route);
 }
 
 void 
@@ -89,7 +106,13 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   NS_LOG_FUNCTION (this << dest << interface);
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
+  if (m_onDemandComputing != 0)
+    {
+      m_onDemandComputing->hostRoutes.push_back (route);
+      return;
+    }
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostRoutesTrie, route);
 }
 
 void 
@@ -104,7 +127,13 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
+  if (m_onDemandComputing != 0)
+    {
+      m_onDemandComputing->networkRoutes.push_back (route);
+      return;
+    }
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRoutesTrie, route);
 }
 
 void 
@@ -117,7 +146,13 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
+  if (m_onDemandComputing != 0)
+    {
+      m_onDemandComputing->networkRoutes.push_back (route);
+      return;
+    }
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkRoutesTrie, route);
 }
 
 void 
@@ -132,7 +167,13 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
+  if (m_onDemandComputing != 0)
+    {
+      m_onDemandComputing->ASexternalRoutes.push_back (route);
+      return;
+    }
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalRoutesTrie, route);
 }
 
 
@@ -147,70 +188,35 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   RouteVec_t allRoutes;
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
-    {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
-        {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
-        }
-    }
+  LookupPrefix (m_hostRoutesTrie, dest, oif, allRoutes);
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      LookupPrefix (m_networkRoutesTrie, dest, oif, allRoutes);
+    }
+  if (allRoutes.size () == 0)  // consider external if no host/network found
+    {
+      LookupPrefix (m_ASexternalRoutesTrie, dest, oif, allRoutes);
+      if (allRoutes.size () > 1)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
-            {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
-            }
+          allRoutes.resize (1);
         }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (allRoutes.size () == 0 && m_onDemand)
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      // the routes computed on demand complete the routing table
+      const OnDemandRoutes &onDemand = GetOnDemandRoutes (dest);
+      SelectRoutes (onDemand.hostRoutes, oif, allRoutes);
+      if (allRoutes.size () == 0)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          SelectRoutes (onDemand.networkRoutes, oif, allRoutes);
+        }
+      if (allRoutes.size () == 0)
+        {
+          SelectRoutes (onDemand.ASexternalRoutes, oif, allRoutes);
+          if (allRoutes.size () > 1)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
+              allRoutes.resize (1);
             }
         }
     }
@@ -245,6 +251,158 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::LookupPrefix (const RoutesTrie &trie, Ipv4Address dest, Ptr<NetDevice> oif,
+                                 std::vector<Ipv4RoutingTableEntry *> &routes) const
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  uint8_t address[4];
+  dest.Serialize (address);
+  const RoutesTrie::Values *matches[RoutesTrie::MAX_MATCHES];
+  uint32_t nMatches = trie.Lookup (address, matches);
+  // The routes of the longest prefix with a route on the requested
+  // interface are the equal-cost candidates.
+  for (uint32_t i = 0; i < nMatches && routes.empty (); i++)
+    {
+      for (RoutesTrie::Values::const_iterator j = matches[i]->begin ();
+           j != matches[i]->end ();
+           j++)
+        {
+          if (oif != 0)
+            {
+              if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                {
+                  NS_LOG_LOGIC ("Not on requested interface, skipping");
+                  continue;
+                }
+            }
+          routes.push_back (*j);
+          NS_LOG_LOGIC (routes.size () << "Found global route" << *j);
+        }
+    }
+}
+
+void
+Ipv4GlobalRouting::SelectRoutes (const std::list<Ipv4RoutingTableEntry *> &candidates, Ptr<NetDevice> oif,
+                                 std::vector<Ipv4RoutingTableEntry *> &routes) const
+{
+  NS_LOG_FUNCTION (this << oif);
+  uint32_t longest = 0;
+  for (std::list<Ipv4RoutingTableEntry *>::const_iterator i = candidates.begin ();
+       i != candidates.end ();
+       i++)
+    {
+      if (oif != 0 && oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+        {
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+          continue;
+        }
+      uint32_t length = (*i)->GetDestNetworkMask ().GetPrefixLength ();
+      if (routes.empty () || length > longest)
+        {
+          routes.clear ();
+          longest = length;
+        }
+      if (length == longest)
+        {
+          routes.push_back (*i);
+          NS_LOG_LOGIC (routes.size () << "Found global route computed on demand" << *i);
+        }
+    }
+}
+
+const Ipv4GlobalRouting::OnDemandRoutes &
+Ipv4GlobalRouting::GetOnDemandRoutes (Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << dest);
+  OnDemandCacheIndex::iterator i = m_onDemandCacheIndex.find (dest);
+  if (i != m_onDemandCacheIndex.end ())
+    {
+      // move to the front, as the most recently used
+      m_onDemandCache.splice (m_onDemandCache.begin (), m_onDemandCache, i->second);
+      return m_onDemandCache.front ();
+    }
+
+  NS_LOG_LOGIC ("Computing the routes to " << dest);
+  m_onDemandCache.push_front (OnDemandRoutes ());
+  m_onDemandCache.front ().destination = dest;
+  m_onDemandComputing = &m_onDemandCache.front ();
+  GlobalRouteManager::ComputeRoutesTo (m_ipv4->GetObject<Node> (), dest);
+  m_onDemandComputing = 0;
+  m_onDemandCacheIndex[dest] = m_onDemandCache.begin ();
+
+  if (m_onDemandCache.size () > m_onDemandCacheSize)
+    {
+      NS_LOG_LOGIC ("Evicting the routes to " << m_onDemandCache.back ().destination);
+      m_onDemandCacheIndex.erase (m_onDemandCache.back ().destination);
+      DeleteOnDemandRoutes (m_onDemandCache.back ());
+      m_onDemandCache.pop_back ();
+    }
+  return m_onDemandCache.front ();
+}
+
+void
+Ipv4GlobalRouting::DeleteOnDemandRoutes (OnDemandRoutes &routes)
+{
+  for (HostRoutesI i = routes.hostRoutes.begin (); i != routes.hostRoutes.end (); i++)
+    {
+      delete (*i);
+    }
+  for (NetworkRoutesI j = routes.networkRoutes.begin (); j != routes.networkRoutes.end (); j++)
+    {
+      delete (*j);
+    }
+  for (ASExternalRoutesI k = routes.ASexternalRoutes.begin (); k != routes.ASexternalRoutes.end (); k++)
+    {
+      delete (*k);
+    }
+  routes.hostRoutes.clear ();
+  routes.networkRoutes.clear ();
+  routes.ASexternalRoutes.clear ();
+}
+
+void
+Ipv4GlobalRouting::SetOnDemand (bool onDemand)
+{
+  NS_LOG_FUNCTION (this << onDemand);
+  m_onDemand = onDemand;
+  ClearOnDemandRoutes ();
+}
+
+void
+Ipv4GlobalRouting::ClearOnDemandRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (OnDemandCache::iterator i = m_onDemandCache.begin (); i != m_onDemandCache.end (); i++)
+    {
+      DeleteOnDemandRoutes (*i);
+    }
+  m_onDemandCache.clear ();
+  m_onDemandCacheIndex.clear ();
+}
+
+void
+Ipv4GlobalRouting::IndexRoute (RoutesTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint16_t length = mask.GetPrefixLength ();
+  NS_ABORT_MSG_UNLESS (mask == Ipv4Mask (("/" + std::to_string (length)).c_str ()),
+                       "The network mask " << mask << " is not contiguous");
+  uint8_t prefix[4];
+  route->GetDestNetwork ().Serialize (prefix);
+  trie.Insert (prefix, length, route);
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute (RoutesTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  uint8_t prefix[4];
+  route->GetDestNetwork ().Serialize (prefix);
+  bool found = trie.Remove (prefix, route->GetDestNetworkMask ().GetPrefixLength (), route);
+  NS_ASSERT (found);
+  NS_UNUSED (found);
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -319,6 +477,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostRoutesTrie, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +495,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkRoutesTrie, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +512,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalRoutesTrie, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +553,10 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRoutesTrie.Clear ();
+  m_networkRoutesTrie.Clear ();
+  m_ASexternalRoutesTrie.Clear ();
+  ClearOnDemandRoutes ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -537,9 +702,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -549,9 +712,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -561,9 +722,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -573,9 +732,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -228,6 +231,28 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Compute the routes on demand.
+   *
+   * When the routes are computed on demand, the routes to a destination
+   * which is not in the routing table are computed by the
+   * GlobalRouteManager when the destination is looked up for the first
+   * time, and cached.  The cached routes are not part of the routing
+   * table: they are not listed by GetRoute.  The routes cannot be
+   * computed on demand with a MultithreadedSimulatorImpl running several
+   * partitions.
+   *
+   * \param onDemand true to compute the routes on demand
+   *
+   * \see GlobalRouteManager::InitializeRoutesOnDemand
+   */
+  void SetOnDemand (bool onDemand);
+
+  /**
+   * \brief Delete the routes computed on demand.
+   */
+  void ClearOnDemandRoutes (void);
+
 protected:
   void DoDispose (void);
 
@@ -238,6 +263,10 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// Set to true if the routes are computed on demand
+  bool m_onDemand;
+  /// The maximum number of destinations whose routes computed on demand are cached
+  uint32_t m_onDemandCacheSize;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -259,6 +288,21 @@ private:
   typedef std::list<Ipv4RoutingTableEntry *>::const_iterator ASExternalRoutesCI;
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
+  /// index of Ipv4RoutingTableEntry by destination prefix
+  typedef PrefixTrie<Ipv4RoutingTableEntry *, 4> RoutesTrie;
+
+  /// The routes to a destination computed on demand
+  struct OnDemandRoutes
+  {
+    Ipv4Address destination;             //!< The destination
+    HostRoutes hostRoutes;               //!< Routes to the destination host
+    NetworkRoutes networkRoutes;         //!< Routes to the networks of the destination
+    ASExternalRoutes ASexternalRoutes;   //!< External routes to the destination
+  };
+  /// container of OnDemandRoutes, from the most recently used
+  typedef std::list<OnDemandRoutes> OnDemandCache;
+  /// index of the OnDemandCache by destination
+  typedef std::unordered_map<Ipv4Address, OnDemandCache::iterator, Ipv4AddressHash> OnDemandCacheIndex;
 
   /**
    * \brief Lookup in the forwarding table for destination.
@@ -268,9 +312,66 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Lookup the routes of the longest prefix matching a destination
+   * in a route index.
+   * \param trie the route index
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \param routes the matching routes on the output interface, in the
+   *        order they were added
+   */
+  void LookupPrefix (const RoutesTrie &trie, Ipv4Address dest, Ptr<NetDevice> oif,
+                     std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
+  /**
+   * \brief Select the routes of the longest prefix among routes which all
+   * match a destination.
+   * \param candidates the routes matching the destination
+   * \param oif output interface if any (put 0 otherwise)
+   * \param routes the routes of the longest prefix on the output interface,
+   *        in the order of the candidates
+   */
+  void SelectRoutes (const std::list<Ipv4RoutingTableEntry *> &candidates, Ptr<NetDevice> oif,
+                     std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
+  /**
+   * \brief Get the routes to a destination computed on demand, computing
+   * them if they are not cached.
+   * \param dest destination address
+   * \return the routes to the destination
+   */
+  const OnDemandRoutes &GetOnDemandRoutes (Ipv4Address dest);
+
+  /**
+   * \brief Delete the routes to a destination computed on demand.
+   * \param routes the routes
+   */
+  static void DeleteOnDemandRoutes (OnDemandRoutes &routes);
+
+  /**
+   * \brief Add a route to a route index.
+   * \param trie the route index
+   * \param route the route
+   */
+  static void IndexRoute (RoutesTrie &trie, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove a route from a route index.
+   * \param trie the route index
+   * \param route the route
+   */
+  static void UnindexRoute (RoutesTrie &trie, Ipv4RoutingTableEntry *route);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  RoutesTrie m_hostRoutesTrie;         //!< Routes to hosts, by destination
+  RoutesTrie m_networkRoutesTrie;      //!< Routes to networks, by destination prefix
+  RoutesTrie m_ASexternalRoutesTrie;   //!< External routes, by destination prefix
+  OnDemandCache m_onDemandCache;       //!< Routes computed on demand, from the most recently used
+  OnDemandCacheIndex m_onDemandCacheIndex; //!< Routes computed on demand, by destination
+  OnDemandRoutes *m_onDemandComputing; //!< Routes being computed on demand, if any
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
@@ -384,12 +384,9 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.WriteSpan (20);
 
-  uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  uint16_t size = m_payloadSize + 5*4;
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,23 +397,37 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
-  uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
-
-  if (m_calcChecksum) 
+  uint32_t source = m_source.Get ();
+  uint32_t destination = m_destination.Get ();
+  buffer[0] = (4 << 4) | (5);
+  buffer[1] = m_tos;
+  buffer[2] = size >> 8;
+  buffer[3] = size & 0xff;
+  buffer[4] = m_identification >> 8;
+  buffer[5] = m_identification & 0xff;
+  buffer[6] = flagsFrag;
+  buffer[7] = fragmentOffset & 0xff;
+  buffer[8] = m_ttl;
+  buffer[9] = m_protocol;
+  buffer[10] = 0;
+  buffer[11] = 0;
+  buffer[12] = source >> 24;
+  buffer[13] = (source >> 16) & 0xff;
+  buffer[14] = (source >> 8) & 0xff;
+  buffer[15] = source & 0xff;
+  buffer[16] = destination >> 24;
+  buffer[17] = (destination >> 16) & 0xff;
+  buffer[18] = (destination >> 8) & 0xff;
+  buffer[19] = destination & 0xff;
+
+  if (m_calcChecksum)
     {
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (20);
       NS_LOG_LOGIC ("checksum=" <<checksum);
-      i = start;
-      i.Next (10);
-      i.WriteU16 (checksum);
+      // in the byte order of Buffer::Iterator::WriteU16
+      buffer[10] = checksum & 0xff;
+      buffer[11] = checksum >> 8;
     }
 }
 uint32_t
@@ -425,7 +436,7 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
 
-  uint8_t verIhl = i.ReadU8 ();
+  uint8_t verIhl = i.PeekU8 ();
   uint8_t ihl = verIhl & 0x0f; 
   uint16_t headerSize = ihl * 4;
 
@@ -435,11 +446,13 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
       return 0;
     }
 
-  m_tos = i.ReadU8 ();
-  uint16_t size = i.ReadNtohU16 ();
+  uint8_t scratch[20];
+  const uint8_t *buffer = i.ReadSpan (20, scratch);
+  m_tos = buffer[1];
+  uint16_t size = (buffer[2] << 8) | buffer[3];
   m_payloadSize = size - headerSize;
-  m_identification = i.ReadNtohU16 ();
-  uint8_t flags = i.ReadU8 ();
+  m_identification = (buffer[4] << 8) | buffer[5];
+  uint8_t flags = buffer[6];
   m_flags = 0;
   if (flags & (1<<6)) 
     {
@@ -449,17 +462,18 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
     {
       m_flags |= MORE_FRAGMENTS;
     }
-  i.Prev ();
-  m_fragmentOffset = i.ReadU8 () & 0x1f;
+  m_fragmentOffset = flags & 0x1f;
   m_fragmentOffset <<= 8;
-  m_fragmentOffset |= i.ReadU8 ();
+  m_fragmentOffset |= buffer[7];
   m_fragmentOffset <<= 3;
-  m_ttl = i.ReadU8 ();
-  m_protocol = i.ReadU8 ();
-  m_checksum = i.ReadU16 ();
-  /* i.Next (2); // checksum */
-  m_source.Set (i.ReadNtohU32 ());
-  m_destination.Set (i.ReadNtohU32 ());
+  m_ttl = buffer[8];
+  m_protocol = buffer[9];
+  // in the byte order of Buffer::Iterator::ReadU16
+  m_checksum = buffer[10] | (buffer[11] << 8);
+  m_source.Set ((static_cast<uint32_t> (buffer[12]) << 24) | (buffer[13] << 16)
+                | (buffer[14] << 8) | buffer[15]);
+  m_destination.Set ((static_cast<uint32_t> (buffer[16]) << 24) | (buffer[17] << 16)
+                     | (buffer[18] << 8) | buffer[19]);
   m_headerSize = headerSize;
 
   if (m_calcChecksum) 
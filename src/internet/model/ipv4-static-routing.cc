@@ -25,6 +25,7 @@
 
 #include <iomanip>
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/names.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
@@ -72,7 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  AddNetworkRoute (route, metric);
 }
 
 void 
@@ -86,7 +87,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  AddNetworkRoute (route, metric);
 }
 
 void 
@@ -143,7 +144,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  AddNetworkRoute (route, 0);
 }
 
 uint32_t 
@@ -224,8 +225,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -239,57 +238,54 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
-
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // The longest prefix with a route on the requested interface wins.
+  // Among its routes, the first host route or the last network route
+  // with the lowest metric is selected.
+  uint8_t address[4];
+  dest.Serialize (address);
+  const NetworkRoutesTrie::Values *matches[NetworkRoutesTrie::MAX_MATCHES];
+  uint32_t nMatches = m_networkRoutesTrie.Lookup (address, matches);
+  Ipv4RoutingTableEntry *route = 0;
+  for (uint32_t i = 0; i < nMatches && route == 0; i++)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      uint32_t shortest_metric = 0xffffffff;
+      for (NetworkRoutesTrie::Values::const_iterator j = matches[i]->begin ();
+           j != matches[i]->end ();
+           j++)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+          uint32_t metric = j->second;
+          NS_LOG_LOGIC ("Found global network route " << j->first << ", mask length "
+                        << j->first->GetDestNetworkMask ().GetPrefixLength () << ", metric " << metric);
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (j->first->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
+          route = j->first;
+          if (route->GetDestNetworkMask () == Ipv4Mask::GetOnes ())
             {
               break;
             }
         }
     }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+    }
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetGateway () << " at the end");
@@ -447,8 +443,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          RemoveNetworkRoute (j);
           return;
         }
       tmp++;
@@ -565,6 +560,35 @@ Ipv4StaticRouting::~Ipv4StaticRouting ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+Ipv4StaticRouting::AddNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  // the trie indexes the routes by prefix length
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint16_t length = mask.GetPrefixLength ();
+  NS_ABORT_MSG_UNLESS (mask == Ipv4Mask (("/" + std::to_string (length)).c_str ()),
+                       "The network mask " << mask << " is not contiguous");
+  uint8_t prefix[4];
+  route->GetDestNetwork ().Serialize (prefix);
+  m_networkRoutes.push_back (make_pair (route, metric));
+  m_networkRoutesTrie.Insert (prefix, length, make_pair (route, metric));
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::RemoveNetworkRoute (NetworkRoutesI route)
+{
+  NS_LOG_FUNCTION (this << route->first);
+  uint8_t prefix[4];
+  route->first->GetDestNetwork ().Serialize (prefix);
+  bool found = m_networkRoutesTrie.Remove (prefix, route->first->GetDestNetworkMask ().GetPrefixLength (),
+                                           *route);
+  NS_ASSERT (found);
+  NS_UNUSED (found);
+  delete route->first;
+  return m_networkRoutes.erase (route);
+}
+
 void
 Ipv4StaticRouting::DoDispose (void)
 {
@@ -575,6 +599,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRoutesTrie.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,8 +638,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = RemoveNetworkRoute (it);
         }
       else
         {
@@ -660,8 +684,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = RemoveNetworkRoute (it);
         }
       else
         {
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -91,7 +92,8 @@ public:
  * \brief Add a network route to the static routing table.
  *
  * \param network The Ipv4Address network for this route.
- * \param networkMask The Ipv4Mask to extract the network.
+ * \param networkMask The Ipv4Mask to extract the network, which must be
+ * contiguous.
  * \param nextHop The next hop in the route to the destination network.
  * \param interface The network interface index used to send packets to the
  * destination.
@@ -109,7 +111,8 @@ public:
  * \brief Add a network route to the static routing table.
  *
  * \param network The Ipv4Address network for this route.
- * \param networkMask The Ipv4Mask to extract the network.
+ * \param networkMask The Ipv4Mask to extract the network, which must be
+ * contiguous.
  * \param interface The network interface index used to send packets to the
  * destination.
  * \param metric Metric of route in case of multiple routes to same destination
@@ -386,6 +389,9 @@ private:
   /// Iterator for container for the network routes
   typedef std::list<std::pair <Ipv4RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
 
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<std::pair <Ipv4RoutingTableEntry *, uint32_t>, 4> NetworkRoutesTrie;
+
   /// Container for the multicast routes
   typedef std::list<Ipv4MulticastRoutingTableEntry *> MulticastRoutes;
 
@@ -413,11 +419,35 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Add a network route to the forwarding table and to its index.
+   *
+   * The index is keyed by prefix length: a route whose network mask is
+   * not contiguous is a fatal error.
+   * \param route the route, which is then owned by the forwarding table
+   * \param metric metric of the route
+   */
+  void AddNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a network route from the forwarding table and from its
+   * index, and delete it.
+   * \param route the route to remove
+   * \return an iterator to the route following the removed one
+   */
+  NetworkRoutesI RemoveNetworkRoute (NetworkRoutesI route);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, indexed by destination prefix for the
+   * longest prefix match.
+   */
+  NetworkRoutesTrie m_networkRoutesTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -40,22 +40,20 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
       Ipv6EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_positions.clear ();
+  m_connections.clear ();
+  m_listeners.clear ();
+  m_ports.clear ();
 }
 
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
-    {
-      if ((*i)->GetLocalPort  () == port)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
@@ -82,10 +80,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv6EndPoint (Ipv6Address::GetAny (), port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -97,10 +92,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       NS_LOG_WARN ("Ephemeral port allocation failed.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, uint16_t port)
@@ -118,10 +110,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       NS_LOG_WARN ("Duplicated endpoint.");
       return 0;
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Add (new Ipv6EndPoint (address, port));
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
@@ -129,7 +118,24 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
+  endPoint->SetPeer (peerAddress, peerPort);
+
+  /* the end points with the same four-tuple are in the same index */
+  std::vector<Ipv6EndPoint *> endPoints;
+  if (IsConnected (endPoint))
+    {
+      FindConnections (Connection (localAddress, localPort, peerAddress, peerPort), endPoints);
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::const_iterator it = m_listeners.find (localPort);
+      if (it != m_listeners.end ())
+        {
+          endPoints.assign (it->second.begin (), it->second.end ());
+        }
+    }
+  for (std::vector<Ipv6EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -138,29 +144,25 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
+          delete endPoint;
           return 0;
         }
     }
-  Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
-  endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
-  return endPoint;
+  return Add (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<Ipv6EndPoint *, EndPointsI>::iterator it = m_positions.find (endPoint);
+  if (it != m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      Unindex (endPoint);
+      m_endPoints.erase (it->second);
+      m_positions.erase (it);
+      endPoint->m_demux = 0;
+      delete endPoint;
     }
 }
 
@@ -181,7 +183,23 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* A connected end point can only match if its local address is the
+     destination address or the any address; the other end points are
+     found by local port. */
+  std::vector<Ipv6EndPoint *> endPoints;
+  FindConnections (Connection (daddr, dport, saddr, sport), endPoints);
+  if (daddr != Ipv6Address::GetAny ())
+    {
+      FindConnections (Connection (Ipv6Address::GetAny (), dport, saddr, sport), endPoints);
+    }
+  std::unordered_map<uint16_t, EndPoints>::const_iterator listeners = m_listeners.find (dport);
+  if (listeners != m_listeners.end ())
+    {
+      endPoints.insert (endPoints.end (), listeners->second.begin (), listeners->second.end ());
+    }
+
+  for (std::vector<Ipv6EndPoint *>::const_iterator i = endPoints.begin (); i != endPoints.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -328,6 +346,107 @@ Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport,
   return generic;
 }
 
+Ipv6EndPointDemux::Connection::Connection (Ipv6Address localAddress, uint16_t localPort,
+                                           Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    peerAddress (peerAddress),
+    localPort (localPort),
+    peerPort (peerPort)
+{
+}
+
+bool Ipv6EndPointDemux::Connection::operator== (const Connection &o) const
+{
+  return localAddress == o.localAddress && peerAddress == o.peerAddress
+         && localPort == o.localPort && peerPort == o.peerPort;
+}
+
+size_t Ipv6EndPointDemux::ConnectionHash::operator() (const Connection &connection) const
+{
+  Ipv6AddressHash addressHash;
+  uint64_t hash = addressHash (connection.localAddress);
+  hash = hash * 0x9e3779b97f4a7c15ULL + addressHash (connection.peerAddress);
+  hash = hash * 0x9e3779b97f4a7c15ULL + ((static_cast<uint32_t> (connection.localPort) << 16) | connection.peerPort);
+  return static_cast<size_t> (hash ^ (hash >> 32));
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Add (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_positions[endPoint] = m_endPoints.insert (m_endPoints.end (), endPoint);
+  endPoint->m_demux = this;
+  Index (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void Ipv6EndPointDemux::Index (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  m_ports[port]++;
+  if (IsConnected (endPoint))
+    {
+      Connection connection (endPoint->GetLocalAddress (), port,
+                             endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      m_connections.insert (std::make_pair (connection, endPoint));
+    }
+  else
+    {
+      m_listeners[port].push_back (endPoint);
+    }
+}
+
+void Ipv6EndPointDemux::Unindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint16_t port = endPoint->GetLocalPort ();
+  std::unordered_map<uint16_t, uint32_t>::iterator count = m_ports.find (port);
+  NS_ASSERT (count != m_ports.end ());
+  if (--count->second == 0)
+    {
+      m_ports.erase (count);
+    }
+  if (IsConnected (endPoint))
+    {
+      Connection connection (endPoint->GetLocalAddress (), port,
+                             endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+      std::pair<Connections::iterator, Connections::iterator> range = m_connections.equal_range (connection);
+      for (Connections::iterator i = range.first; i != range.second; i++)
+        {
+          if (i->second == endPoint)
+            {
+              m_connections.erase (i);
+              break;
+            }
+        }
+    }
+  else
+    {
+      std::unordered_map<uint16_t, EndPoints>::iterator listeners = m_listeners.find (port);
+      NS_ASSERT (listeners != m_listeners.end ());
+      listeners->second.remove (endPoint);
+      if (listeners->second.empty ())
+        {
+          m_listeners.erase (listeners);
+        }
+    }
+}
+
+bool Ipv6EndPointDemux::IsConnected (Ipv6EndPoint *endPoint)
+{
+  return endPoint->GetPeerPort () != 0 && endPoint->GetPeerAddress () != Ipv6Address::GetAny ();
+}
+
+void Ipv6EndPointDemux::FindConnections (const Connection &connection, std::vector<Ipv6EndPoint *> &endPoints) const
+{
+  std::pair<Connections::const_iterator, Connections::const_iterator> range = m_connections.equal_range (connection);
+  for (Connections::const_iterator i = range.first; i != range.second; i++)
+    {
+      endPoints.push_back (i->second);
+    }
+}
+
 uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 {
   NS_LOG_FUNCTION (this);
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +36,9 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The end points whose peer address and port are both set are indexed by
+ * their four-tuple, and the other ones by their local port.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +158,87 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of a connected end point.
+   */
+  struct Connection
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    Connection (Ipv6Address localAddress, uint16_t localPort,
+                Ipv6Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Compare two four-tuples.
+     * \param o the other four-tuple
+     * \returns true if the four-tuples are equal
+     */
+    bool operator== (const Connection &o) const;
+
+    Ipv6Address localAddress; //!< The local address
+    Ipv6Address peerAddress;  //!< The peer address
+    uint16_t localPort;       //!< The local port
+    uint16_t peerPort;        //!< The peer port
+  };
+
+  /**
+   * \brief Hash function class for the four-tuples.
+   */
+  struct ConnectionHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param connection the four-tuple
+     * \returns the hash of the four-tuple
+     */
+    size_t operator() (const Connection &connection) const;
+  };
+
+  /**
+   * \brief Container of the connected end points, by four-tuple.
+   */
+  typedef std::unordered_multimap<Connection, Ipv6EndPoint *, ConnectionHash> Connections;
+
+  /**
+   * \brief Add an end point to the demux.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv6EndPoint * Add (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by four-tuple or by local port.
+   * \param endPoint the end point
+   */
+  void Index (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the indexes.
+   * \param endPoint the end point
+   */
+  void Unindex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Tell whether an end point is indexed by four-tuple.
+   * \param endPoint the end point
+   * \return true if the peer address and port of the end point are set
+   */
+  static bool IsConnected (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add the connected end points with a four-tuple to a list.
+   * \param [in] connection the four-tuple
+   * \param [in,out] endPoints the list of end points
+   */
+  void FindConnections (const Connection &connection, std::vector<Ipv6EndPoint *> &endPoints) const;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +264,26 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The position of each end point in m_endPoints.
+   */
+  std::unordered_map<Ipv6EndPoint *, EndPointsI> m_positions;
+
+  /**
+   * \brief The connected end points, by four-tuple.
+   */
+  Connections m_connections;
+
+  /**
+   * \brief The other end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_listeners;
+
+  /**
+   * \brief The number of end points of each local port.
+   */
+  std::unordered_map<uint16_t, uint32_t> m_ports;
 };
 
 } /* namespace ns3 */
@@ -57,6 +57,29 @@ Ipv6StaticRouting::~Ipv6StaticRouting ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+void Ipv6StaticRouting::AddNetworkRoute (Ipv6RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint8_t prefix[16];
+  route->GetDestNetwork ().GetBytes (prefix);
+  m_networkRoutes.push_back (std::make_pair (route, metric));
+  m_networkRoutesTrie.Insert (prefix, route->GetDestNetworkPrefix ().GetPrefixLength (),
+                              std::make_pair (route, metric));
+}
+
+Ipv6StaticRouting::NetworkRoutesI Ipv6StaticRouting::RemoveNetworkRoute (NetworkRoutesI route)
+{
+  NS_LOG_FUNCTION (this << route->first);
+  uint8_t prefix[16];
+  route->first->GetDestNetwork ().GetBytes (prefix);
+  bool found = m_networkRoutesTrie.Remove (prefix, route->first->GetDestNetworkPrefix ().GetPrefixLength (),
+                                           *route);
+  NS_ASSERT (found);
+  NS_UNUSED (found);
+  delete route->first;
+  return m_networkRoutes.erase (route);
+}
+
 void Ipv6StaticRouting::SetIpv6 (Ptr<Ipv6> ipv6)
 {
   NS_LOG_FUNCTION (this << ipv6);
@@ -151,7 +174,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface << metric);
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddNetworkRoute (route, metric);
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -164,7 +187,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
 
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddNetworkRoute (route, metric);
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -172,7 +195,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   NS_LOG_FUNCTION (this << network << networkPrefix << interface);
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AddNetworkRoute (route, metric);
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -196,7 +219,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Address network = Ipv6Address ("ff00::"); /* RFC 3513 */
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
-  m_networkRoutes.push_back (std::make_pair (route, 0));
+  AddNetworkRoute (route, 0);
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -285,8 +308,6 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
 {
   NS_LOG_FUNCTION (this << dst << interface);
   Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
-  uint32_t shortestMetric = 0xffffffff;
 
   /* when sending on link-local multicast, there have to be interface specified */
   if (dst.IsLinkLocalMulticast ())
@@ -300,68 +321,67 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  /* the longest prefix with a route on the requested interface wins, and
+   * among its routes the first host route or the last network route with
+   * the lowest metric */
+  uint8_t address[16];
+  dst.GetBytes (address);
+  const NetworkRoutesTrie::Values *matches[NetworkRoutesTrie::MAX_MATCHES];
+  uint32_t nMatches = m_networkRoutesTrie.Lookup (address, matches);
+  Ipv6RoutingTableEntry* route = 0;
+  for (uint32_t i = 0; i < nMatches && route == 0; i++)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
-
-      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
-
-      if (mask.IsMatch (dst, entry))
+      uint32_t shortestMetric = 0xffffffff;
+      for (NetworkRoutesTrie::Values::const_iterator it = matches[i]->begin (); it != matches[i]->end (); it++)
         {
-          NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
+          Ipv6RoutingTableEntry* j = it->first;
+          uint32_t metric = it->second;
+
+          NS_LOG_LOGIC ("Found global network route " << *j << ", mask length "
+                        << uint16_t (j->GetDestNetworkPrefix ().GetPrefixLength ()) << ", metric " << metric);
 
           /* if interface is given, check the route will output on this interface */
-          if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
+          if (interface && interface != m_ipv6->GetNetDevice (j->GetInterface ()))
             {
-              if (maskLen < longestMask)
-                {
-                  NS_LOG_LOGIC ("Previous match longer, skipping");
-                  continue;
-                }
-
-              if (maskLen > longestMask)
-                {
-                  shortestMetric = 0xffffffff;
-                }
+              continue;
+            }
 
-              longestMask = maskLen;
-              if (metric > shortestMetric)
-                {
-                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-                  continue;
-                }
+          if (metric > shortestMetric)
+            {
+              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+              continue;
+            }
 
-              shortestMetric = metric;
-              Ipv6RoutingTableEntry* route = j;
-              uint32_t interfaceIdx = route->GetInterface ();
-              rtentry = Create<Ipv6Route> ();
+          shortestMetric = metric;
+          route = j;
+          if (j->GetDestNetworkPrefix ().GetPrefixLength () == 128)
+            {
+              break;
+            }
+        }
+    }
 
-              if (route->GetGateway ().IsAny ())
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                }
-              else if (route->GetDest ().IsAny ()) /* default route */
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
-                }
-              else
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
-                }
+  if (route)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv6Route> ();
 
-              rtentry->SetDestination (route->GetDest ());
-              rtentry->SetGateway (route->GetGateway ());
-              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
-              if (maskLen == 128)
-                {
-                  break;
-                }
-            }
+      if (route->GetGateway ().IsAny ())
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
         }
+      else if (route->GetDest ().IsAny ()) /* default route */
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
+        }
+      else
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+        }
+
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
     }
 
   if (rtentry)
@@ -380,6 +400,7 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_networkRoutesTrie.Clear ();
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -528,8 +549,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          RemoveNetworkRoute (it);
           return;
         }
       tmp++;
@@ -547,8 +567,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex
           && rtentry->GetPrefixToUse () == prefixToUse)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          RemoveNetworkRoute (it);
           return;
         }
     }
@@ -672,8 +691,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = RemoveNetworkRoute (it);
         }
       else
         {
@@ -717,8 +735,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkPrefix () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = RemoveNetworkRoute (it);
         }
       else
         {
@@ -761,8 +778,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
 
           if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
             {
-              delete j->first;
-              j = m_networkRoutes.erase (j);
+              j = RemoveNetworkRoute (j);
             }
           else
             {
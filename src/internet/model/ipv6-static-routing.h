@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -255,6 +256,9 @@ private:
   /// Iterator for container for the network routes
   typedef std::list<std::pair <Ipv6RoutingTableEntry *, uint32_t> >::iterator NetworkRoutesI;
 
+  /// Index of the network routes by destination prefix
+  typedef PrefixTrie<std::pair <Ipv6RoutingTableEntry *, uint32_t>, 16> NetworkRoutesTrie;
+
   /// Container for the multicast routes
   typedef std::list<Ipv6MulticastRoutingTableEntry *> MulticastRoutes;
 
@@ -281,11 +285,32 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Add a network route to the forwarding table and to its index.
+   * \param route the route, which is then owned by the forwarding table
+   * \param metric metric of the route
+   */
+  void AddNetworkRoute (Ipv6RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a network route from the forwarding table and from its
+   * index, and delete it.
+   * \param route the route to remove
+   * \return an iterator to the route following the removed one
+   */
+  NetworkRoutesI RemoveNetworkRoute (NetworkRoutesI route);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, indexed by destination prefix for the
+   * longest prefix match.
+   */
+  NetworkRoutesTrie m_networkRoutesTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -315,14 +315,30 @@ void
 TcpHeader::Serialize (Buffer::Iterator start)  const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  i.WriteHtonU32 (m_sequenceNumber.GetValue ());
-  i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
-  i.WriteHtonU16 (m_windowSize);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU16 (m_urgentPointer);
+  uint8_t *buffer = i.WriteSpan (20);
+  uint32_t sequenceNumber = m_sequenceNumber.GetValue ();
+  uint32_t ackNumber = m_ackNumber.GetValue ();
+  uint16_t field = GetLength () << 12 | m_flags; //reserved bits are all zero
+  buffer[0] = m_sourcePort >> 8;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = m_destinationPort >> 8;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = sequenceNumber >> 24;
+  buffer[5] = (sequenceNumber >> 16) & 0xff;
+  buffer[6] = (sequenceNumber >> 8) & 0xff;
+  buffer[7] = sequenceNumber & 0xff;
+  buffer[8] = ackNumber >> 24;
+  buffer[9] = (ackNumber >> 16) & 0xff;
+  buffer[10] = (ackNumber >> 8) & 0xff;
+  buffer[11] = ackNumber & 0xff;
+  buffer[12] = field >> 8;
+  buffer[13] = field & 0xff;
+  buffer[14] = m_windowSize >> 8;
+  buffer[15] = m_windowSize & 0xff;
+  buffer[16] = 0;
+  buffer[17] = 0;
+  buffer[18] = m_urgentPointer >> 8;
+  buffer[19] = m_urgentPointer & 0xff;
 
   // Serialize options if they exist
   // This implementation does not presently try to align options on word
@@ -350,9 +366,9 @@ TcpHeader::Serialize (Buffer::Iterator start)  const
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
 
-      i = start;
-      i.Next (16);
-      i.WriteU16 (checksum);
+      // in the byte order of Buffer::Iterator::WriteU16
+      buffer[16] = checksum & 0xff;
+      buffer[17] = checksum >> 8;
     }
 }
 
@@ -361,16 +377,19 @@ TcpHeader::Deserialize (Buffer::Iterator start)
 {
   m_optionsLen = 0;
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_sequenceNumber = i.ReadNtohU32 ();
-  m_ackNumber = i.ReadNtohU32 ();
-  uint16_t field = i.ReadNtohU16 ();
+  uint8_t scratch[20];
+  const uint8_t *buffer = i.ReadSpan (20, scratch);
+  m_sourcePort = (buffer[0] << 8) | buffer[1];
+  m_destinationPort = (buffer[2] << 8) | buffer[3];
+  m_sequenceNumber = (static_cast<uint32_t> (buffer[4]) << 24) | (buffer[5] << 16)
+    | (buffer[6] << 8) | buffer[7];
+  m_ackNumber = (static_cast<uint32_t> (buffer[8]) << 24) | (buffer[9] << 16)
+    | (buffer[10] << 8) | buffer[11];
+  uint16_t field = (buffer[12] << 8) | buffer[13];
   m_flags = field & 0xFF;
   m_length = field >> 12;
-  m_windowSize = i.ReadNtohU16 ();
-  i.Next (2);
-  m_urgentPointer = i.ReadNtohU16 ();
+  m_windowSize = (buffer[14] << 8) | buffer[15];
+  m_urgentPointer = (buffer[18] << 8) | buffer[19];
 
   // Deserialize options if they exist
   m_options.clear ();
@@ -184,46 +184,44 @@ void
 UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
+  uint8_t *buffer = i.WriteSpan (8);
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
+  uint16_t length = m_payloadSize;
   if (m_payloadSize == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
+      length = start.GetSize ();
     }
-  else
+  buffer[0] = m_sourcePort >> 8;
+  buffer[1] = m_sourcePort & 0xff;
+  buffer[2] = m_destinationPort >> 8;
+  buffer[3] = m_destinationPort & 0xff;
+  buffer[4] = length >> 8;
+  buffer[5] = length & 0xff;
+
+  // the checksum is in the byte order of Buffer::Iterator::WriteU16
+  uint16_t checksum = m_checksum;
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteHtonU16 (m_payloadSize);
-    }
-
-  if ( m_checksum == 0)
-    {
-      i.WriteU16 (0);
-
-      if (m_calcChecksum)
-        {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-          i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
-        }
-    }
-  else
-    {
-      i.WriteU16 (m_checksum);
+      buffer[6] = 0;
+      buffer[7] = 0;
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      i = start;
+      checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
     }
+  buffer[6] = checksum & 0xff;
+  buffer[7] = checksum >> 8;
 }
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_payloadSize = i.ReadNtohU16 () - GetSerializedSize ();
-  m_checksum = i.ReadU16 ();
+  uint8_t scratch[8];
+  const uint8_t *buffer = i.ReadSpan (8, scratch);
+  m_sourcePort = (buffer[0] << 8) | buffer[1];
+  m_destinationPort = (buffer[2] << 8) | buffer[3];
+  m_payloadSize = ((buffer[4] << 8) | buffer[5]) - GetSerializedSize ();
+  // in the byte order of Buffer::Iterator::ReadU16
+  m_checksum = buffer[6] | (buffer[7] << 8);
 
   if (m_calcChecksum)
     {
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux lookup test.
+ *
+ * Checks that a connected endpoint is preferred to a listening one, that
+ * the endpoints are found again after their peer or local address change,
+ * and that the deallocated endpoints and ports are no longer found.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Look up the single endpoint matching a packet.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \returns the endpoint, or 0 if none matches
+   */
+  Ipv4EndPoint *Lookup (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                        Ipv4Address saddr, uint16_t sport);
+
+  Ptr<Ipv4Interface> m_interface; //!< The incoming interface
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookup")
+{
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestCase::Lookup (Ipv4EndPointDemux &demux, Ipv4Address daddr, uint16_t dport,
+                                   Ipv4Address saddr, uint16_t sport)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4EndPointDemux demux;
+
+  Ipv4EndPoint *listener = demux.Allocate (0, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Listening endpoint not allocated");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1000), listener, "Listening endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 81, peer, 1000), 0, "Endpoint found on the wrong port");
+
+  // the connections accepted by the listening endpoint
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint16_t i = 0; i < 1000; i++)
+    {
+      connections.push_back (demux.Allocate (0, local, 80, peer, 1000 + i));
+      NS_TEST_ASSERT_MSG_NE (connections.back (), 0, "Connected endpoint not allocated");
+    }
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80, peer, 1000), 0, "Duplicated endpoint allocated");
+  for (uint16_t i = 0; i < 1000; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1000 + i), connections[i], "Connected endpoint not found");
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 5000), listener, "Listening endpoint not found");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, Ipv4Address ("10.0.0.3"), 1000), listener, "Listening endpoint not found");
+
+  demux.DeAllocate (connections[0]);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1000), listener, "Deallocated endpoint found");
+
+  listener->SetRxEnabled (false);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 5000), 0, "Endpoint with disabled Rx found");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1001), connections[1], "Connected endpoint not found");
+
+  // a client endpoint, connected after its allocation
+  Ipv4EndPoint *client = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Client endpoint not allocated");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), true, "Ephemeral port not in use");
+  client->SetPeer (peer, 8080);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, peer, 8080), client, "Client endpoint not found after SetPeer");
+  client->SetLocalAddress (local);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, peer, 8080), client, "Client endpoint not found after SetLocalAddress");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, Ipv4Address ("10.0.0.4"), port, peer, 8080), 0, "Client endpoint found for another address");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, peer, 8081), 0, "Client endpoint found for another peer");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, port, peer, 8080), client, "Client endpoint not found by SimpleLookup");
+
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Ephemeral port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetAllEndPoints ().size (), 1000, "Wrong number of endpoints");
+
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux lookup test.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Look up the single endpoint matching a packet.
+   * \param demux the demux
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \returns the endpoint, or 0 if none matches
+   */
+  Ipv6EndPoint *Lookup (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                        Ipv6Address saddr, uint16_t sport);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookup")
+{
+}
+
+Ipv6EndPoint *
+Ipv6EndPointDemuxTestCase::Lookup (Ipv6EndPointDemux &demux, Ipv6Address daddr, uint16_t dport,
+                                   Ipv6Address saddr, uint16_t sport)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (daddr, dport, saddr, sport, 0);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+  Ipv6EndPointDemux demux;
+
+  Ipv6EndPoint *listener = demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Listening endpoint not allocated");
+  NS_TEST_EXPECT_MSG_EQ (demux.Allocate (0, local, 80), 0, "Duplicated endpoint allocated");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1000), listener, "Listening endpoint not found");
+
+  std::vector<Ipv6EndPoint *> connections;
+  for (uint16_t i = 0; i < 1000; i++)
+    {
+      connections.push_back (demux.Allocate (0, local, 80, peer, 1000 + i));
+      NS_TEST_ASSERT_MSG_NE (connections.back (), 0, "Connected endpoint not allocated");
+    }
+  for (uint16_t i = 0; i < 1000; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1000 + i), connections[i], "Connected endpoint not found");
+    }
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 5000), listener, "Listening endpoint not found");
+
+  demux.DeAllocate (connections[0]);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, 80, peer, 1000), listener, "Deallocated endpoint found");
+
+  Ipv6EndPoint *client = demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Client endpoint not allocated");
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (peer, 8080);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, peer, 8080), client, "Client endpoint not found after SetPeer");
+  client->SetLocalAddress (local);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, peer, 8080), client, "Client endpoint not found after SetLocalAddress");
+  client->SetLocalPort (port + 1);
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port, peer, 8080), 0, "Client endpoint found on its old port");
+  NS_TEST_EXPECT_MSG_EQ (Lookup (demux, local, port + 1, peer, 8080), client, "Client endpoint not found after SetLocalPort");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port), false, "Old port still in use");
+
+  demux.DeAllocate (client);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (port + 1), false, "Port still in use");
+  NS_TEST_EXPECT_MSG_EQ (demux.GetEndPoints ().size (), 1000, "Wrong number of endpoints");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
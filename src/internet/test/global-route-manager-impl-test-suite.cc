@@ -27,6 +27,10 @@
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -36,6 +40,80 @@ using namespace ns3;
  */
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief CandidateQueue Test
+ *
+ * Check that the vertices are popped by increasing distance, in the order
+ * they were pushed or last updated when the distances are equal, and that
+ * Find and Update keep working as the queue changes.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("CandidateQueue ordering, Find and Update")
+{
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  // (distance, push or update order) of each vertex, indexed by vertex
+  std::vector<std::pair<uint32_t, uint32_t> > expected;
+  std::vector<SPFVertex *> vertices;
+  CandidateQueue candidate;
+  uint32_t order = 0;
+
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      SPFVertex *v = new SPFVertex;
+      std::ostringstream oss;
+      oss << "10.0." << i / 256 << "." << i % 256;
+      v->SetVertexId (Ipv4Address (oss.str ().c_str ()));
+      v->SetDistanceFromRoot (std::rand () % 50);
+      candidate.Push (v);
+      vertices.push_back (v);
+      expected.push_back (std::make_pair (v->GetDistanceFromRoot (), order++));
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Size (), 200, "Wrong queue size");
+
+  // Lower the distance of every third vertex, as SPFNext does when it
+  // finds a shorter path to a candidate.
+  for (uint32_t i = 0; i < 200; i += 3)
+    {
+      SPFVertex *v = candidate.Find (vertices[i]->GetVertexId ());
+      NS_TEST_ASSERT_MSG_EQ (v, vertices[i], "Vertex " << i << " not found");
+      v->SetDistanceFromRoot (v->GetDistanceFromRoot () / 2);
+      candidate.Update (v);
+      expected[i] = std::make_pair (v->GetDistanceFromRoot (), order++);
+    }
+
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, SPFVertex *> > sorted;
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      sorted.push_back (std::make_pair (expected[i], vertices[i]));
+    }
+  std::sort (sorted.begin (), sorted.end ());
+
+  for (uint32_t i = 0; i < 200; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (candidate.Top (), sorted[i].second, "Wrong top vertex at " << i);
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ (v, sorted[i].second, "Wrong vertex popped at " << i);
+      NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), 0, "Popped vertex still found");
+      delete v;
+    }
+  NS_TEST_ASSERT_MSG_EQ (candidate.Empty (), true, "Queue not empty");
+  NS_TEST_ASSERT_MSG_EQ (candidate.Pop (), 0, "Pop from an empty queue");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -203,6 +281,17 @@ GlobalRouteManagerImplTestCase::DoRun (void)
   srmlsdb->Insert (lsa3->GetLinkStateId (), lsa3);
   NS_ASSERT (lsa2 == srmlsdb->GetLSA (lsa2->GetLinkStateId ()));
 
+  // the routers with routes to an address: its point-to-point link and
+  // the stub networks which contain it
+  std::set<Ipv4Address> vertices = srmlsdb->GetVerticesTo ("10.1.1.2");
+  NS_TEST_EXPECT_MSG_EQ (vertices.size (), 2, "Wrong number of vertices to 10.1.1.2");
+  NS_TEST_EXPECT_MSG_EQ (vertices.count ("0.0.0.0"), 1, "Router 0 has a stub network to 10.1.1.2");
+  NS_TEST_EXPECT_MSG_EQ (vertices.count ("0.0.0.2"), 1, "Router 2 has a link to 10.1.1.2");
+  vertices = srmlsdb->GetVerticesTo ("10.1.3.1");
+  NS_TEST_EXPECT_MSG_EQ (vertices.size (), 1, "Wrong number of vertices to 10.1.3.1");
+  NS_TEST_EXPECT_MSG_EQ (vertices.count ("0.0.0.2"), 1, "Router 2 has a stub network to 10.1.3.1");
+  NS_TEST_EXPECT_MSG_EQ (srmlsdb->GetVerticesTo ("10.2.0.1").size (), 0, "Vertices to an unknown address");
+
   // next, calculate routes based on the manually created LSDB
   GlobalRouteManagerImpl* srm = new GlobalRouteManagerImpl ();
   srm->DebugUseLsdb (srmlsdb);  // manually add in an LSDB
@@ -242,6 +331,7 @@ private:
 GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
 }
 
@@ -42,6 +42,9 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-route-manager.h"
+
+#include <sstream>
 
 using namespace ns3;
 
@@ -1244,6 +1247,412 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental recomputation test
+ *
+ * Two disconnected chains, n0-n1-n2 and n3-n4-n5, of point-to-point
+ * links.  Taking down an interface of the first chain must only
+ * rebuild the routes of n0, n1 and n2, with the same result as a full
+ * recomputation, and leave the route entries of n3, n4 and n5 untouched.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+
+protected:
+  /**
+   * Constructor.
+   * \param name The name of the test case.
+   */
+  Ipv4GlobalRoutingRecomputeTestCase (std::string name);
+
+  /**
+   * Get the global routing protocol of a node.
+   * \param i The node index.
+   * \returns The global routing protocol of node i.
+   */
+  Ptr<Ipv4GlobalRouting> GetRouting (uint32_t i) const;
+  /**
+   * Describe the routes of a node.
+   * \param i The node index.
+   * \returns One string per route of node i.
+   */
+  std::vector<std::string> GetRoutes (uint32_t i) const;
+  /**
+   * Get the route entries of a node.
+   * \param i The node index.
+   * \returns The route entries of node i.
+   */
+  std::vector<Ipv4RoutingTableEntry *> GetEntries (uint32_t i) const;
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Global routing recomputes only the affected routers")
+{
+}
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoSetup (void)
+{
+  m_nodes.Create (6);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      if (i % 3 == 2)
+        {
+          continue;
+        }
+      Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (m_nodes.Get (i), channel);
+      net.Add (simpleHelper.Install (m_nodes.Get (i + 1), channel));
+      ipv4.Assign (net);
+      ipv4.NewNetwork ();
+    }
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingRecomputeTestCase::GetRouting (uint32_t i) const
+{
+  Ptr<Ipv4L3Protocol> ip = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+  return ip->GetRoutingProtocol ()->GetObject <Ipv4GlobalRouting> ();
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes (uint32_t i) const
+{
+  std::vector<std::string> routes;
+  Ptr<Ipv4GlobalRouting> routing = GetRouting (i);
+  for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+    {
+      std::ostringstream oss;
+      oss << *routing->GetRoute (j);
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+std::vector<Ipv4RoutingTableEntry *>
+Ipv4GlobalRoutingRecomputeTestCase::GetEntries (uint32_t i) const
+{
+  std::vector<Ipv4RoutingTableEntry *> entries;
+  Ptr<Ipv4GlobalRouting> routing = GetRouting (i);
+  for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+    {
+      entries.push_back (routing->GetRoute (j));
+    }
+  return entries;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::vector<std::vector<Ipv4RoutingTableEntry *> > entries;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      entries.push_back (GetEntries (i));
+    }
+  NS_TEST_ASSERT_MSG_EQ (entries[1].size (), 4, "Wrong number of routes on n1");
+  NS_TEST_ASSERT_MSG_EQ (entries[4].size (), 4, "Wrong number of routes on n4");
+
+  // Nothing changed: no router is recomputed.
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((GetEntries (i) == entries[i]), true, "Routes of n" << i << " rebuilt");
+    }
+
+  // Take down the link between n1 and n2.
+  m_nodes.Get (1)->GetObject<Ipv4> ()->SetDown (2);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::vector<std::string> > routes;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      routes.push_back (GetRoutes (i));
+    }
+  NS_TEST_EXPECT_MSG_EQ ((GetEntries (1) == entries[1]), false, "Routes of n1 not rebuilt");
+  NS_TEST_EXPECT_MSG_LT (routes[1].size (), entries[1].size (), "Routes of n1 not removed");
+  for (uint32_t i = 3; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((GetEntries (i) == entries[i]), true, "Routes of n" << i << " rebuilt");
+    }
+
+  // A full recomputation gives the same routes.
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((GetRoutes (i) == routes[i]), true, "Wrong routes on n" << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting metric recomputation test
+ *
+ * A ring of six nodes, n0-n1-n2-n3-n4-n5-n0, of point-to-point links.
+ * Raising the metric of the interface of n0 to n1 only changes the
+ * shortest paths of n0, n5 and n4, which has two equal cost paths to n1
+ * before: the routes of n1, n2 and n3 must be left untouched, and the
+ * routes of all the nodes must be the routes of a full recomputation.
+ * Lowering the metric back must restore the routes.
+ */
+class Ipv4GlobalRoutingMetricTestCase : public Ipv4GlobalRoutingRecomputeTestCase
+{
+public:
+  Ipv4GlobalRoutingMetricTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  /**
+   * Set the metric of the interface of n0 to n1 and recompute the routes.
+   * \param metric The metric.
+   * \returns The routes of each node.
+   */
+  std::vector<std::vector<std::string> > SetMetric (uint16_t metric);
+};
+
+Ipv4GlobalRoutingMetricTestCase::Ipv4GlobalRoutingMetricTestCase ()
+  : Ipv4GlobalRoutingRecomputeTestCase ("Global routing recomputes only the routers affected by a metric")
+{
+}
+
+void
+Ipv4GlobalRoutingMetricTestCase::DoSetup (void)
+{
+  m_nodes.Create (6);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (m_nodes.Get (i), channel);
+      net.Add (simpleHelper.Install (m_nodes.Get ((i + 1) % 6), channel));
+      ipv4.Assign (net);
+      ipv4.NewNetwork ();
+    }
+}
+
+std::vector<std::vector<std::string> >
+Ipv4GlobalRoutingMetricTestCase::SetMetric (uint16_t metric)
+{
+  std::vector<std::vector<Ipv4RoutingTableEntry *> > entries;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      entries.push_back (GetEntries (i));
+    }
+
+  // interface 1 of n0 is on the link to n1
+  m_nodes.Get (0)->GetObject<Ipv4> ()->SetMetric (1, metric);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::vector<std::string> > routes;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      routes.push_back (GetRoutes (i));
+    }
+  for (uint32_t i = 1; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((GetEntries (i) == entries[i]), true, "Routes of n" << i << " rebuilt");
+    }
+
+  // A full recomputation gives the same routes.
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((GetRoutes (i) == routes[i]), true, "Wrong routes on n" << i);
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingMetricTestCase::DoRun (void)
+{
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> routes = GetRoutes (4);
+
+  std::vector<std::vector<std::string> > raised = SetMetric (2);
+  NS_TEST_EXPECT_MSG_LT (raised[4].size (), routes.size (), "Equal cost route of n4 not removed");
+
+  std::vector<std::vector<std::string> > lowered = SetMetric (1);
+  NS_TEST_EXPECT_MSG_EQ ((lowered[4] == routes), true, "Routes of n4 not restored");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting on demand test
+ *
+ * A ring of six nodes, n0-n1-n2-n3-n4-n5-n0, of point-to-point links.
+ * The routes computed on demand, with a cache smaller than the number
+ * of destinations, must be the routes computed for the whole network.
+ */
+class Ipv4GlobalRoutingOnDemandTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingOnDemandTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  /**
+   * Get the global routing protocol of a node.
+   * \param i The node index.
+   * \returns The global routing protocol of node i.
+   */
+  Ptr<Ipv4GlobalRouting> GetRouting (uint32_t i) const;
+  /**
+   * Describe the routes of every node to every address.
+   * \returns One string per node and address.
+   */
+  std::vector<std::string> GetRoutes (void) const;
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+  std::vector<Ipv4Address> m_addresses; //!< Addresses of the nodes.
+};
+
+Ipv4GlobalRoutingOnDemandTestCase::Ipv4GlobalRoutingOnDemandTestCase ()
+  : TestCase ("Global routing computes the routes on demand")
+{
+}
+
+void
+Ipv4GlobalRoutingOnDemandTestCase::DoSetup (void)
+{
+  m_nodes.Create (6);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject <SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (m_nodes.Get (i), channel);
+      net.Add (simpleHelper.Install (m_nodes.Get ((i + 1) % 6), channel));
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (net);
+      m_addresses.push_back (interfaces.GetAddress (0));
+      m_addresses.push_back (interfaces.GetAddress (1));
+      ipv4.NewNetwork ();
+    }
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingOnDemandTestCase::GetRouting (uint32_t i) const
+{
+  Ptr<Ipv4L3Protocol> ip = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+  return ip->GetRoutingProtocol ()->GetObject <Ipv4GlobalRouting> ();
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingOnDemandTestCase::GetRoutes (void) const
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = GetRouting (i);
+      for (std::vector<Ipv4Address>::const_iterator j = m_addresses.begin (); j != m_addresses.end (); j++)
+        {
+          Ipv4Header header;
+          header.SetDestination (*j);
+          Socket::SocketErrno err;
+          Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, err);
+          std::ostringstream oss;
+          oss << "n" << i << " to " << *j << ": ";
+          if (route != 0)
+            {
+              oss << route->GetGateway () << " on " << route->GetOutputDevice ()->GetIfIndex ();
+            }
+          routes.push_back (oss.str ());
+        }
+    }
+  return routes;
+}
+
+void
+Ipv4GlobalRoutingOnDemandTestCase::DoRun (void)
+{
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> routes = GetRoutes ();
+
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      GetRouting (i)->SetAttribute ("OnDemandCacheSize", UintegerValue (4));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTablesOnDemand ();
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (GetRouting (i)->GetNRoutes (), 0, "Routes computed in advance on n" << i);
+    }
+
+  // Twice, so that the routes are first computed, then evicted and computed again.
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      std::vector<std::string> onDemand = GetRoutes ();
+      NS_TEST_ASSERT_MSG_EQ (onDemand.size (), routes.size (), "Wrong number of routes");
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (onDemand[j], routes[j], "Wrong route computed on demand");
+        }
+    }
+
+  // The routes computed on demand are dropped with the other routes.
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ ((GetRoutes () == routes), true, "Wrong routes after the on demand mode");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1676,9 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingMetricTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingOnDemandTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
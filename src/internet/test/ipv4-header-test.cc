@@ -43,6 +43,7 @@
 #include <string>
 #include <sstream>
 #include <limits>
+#include <vector>
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -265,6 +266,95 @@ Ipv4HeaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 Header checksum update Test
+ */
+class Ipv4HeaderChecksumTest : public TestCase
+{
+public:
+  virtual void DoRun (void);
+  Ipv4HeaderChecksumTest ();
+
+private:
+  /**
+   * \brief Serialize a header.
+   * \param header The header.
+   * \returns The serialized header.
+   */
+  static std::vector<uint8_t> Serialize (const Ipv4Header &header);
+};
+
+Ipv4HeaderChecksumTest::Ipv4HeaderChecksumTest ()
+  : TestCase ("IPv4 Header checksum update on TTL change")
+{
+}
+
+std::vector<uint8_t>
+Ipv4HeaderChecksumTest::Serialize (const Ipv4Header &header)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  std::vector<uint8_t> data (p->GetSize ());
+  p->CopyData (&data[0], data.size ());
+  return data;
+}
+
+void
+Ipv4HeaderChecksumTest::DoRun (void)
+{
+  static const uint8_t protocols[] = {0, 1, 6, 17, 255};
+  for (uint32_t k = 0; k < sizeof (protocols) / sizeof (protocols[0]); k++)
+    {
+      Ipv4Header header;
+      header.EnableChecksum ();
+      header.SetSource (Ipv4Address ("10.1.2.3"));
+      header.SetDestination (Ipv4Address ("192.168.255.254"));
+      header.SetProtocol (protocols[k]);
+      header.SetPayloadSize (1000 + k);
+      header.SetIdentification (0xfffe - k);
+      header.SetTtl (255);
+      Ptr<Packet> p = Create<Packet> ();
+      p->AddHeader (header);
+
+      // a router forwarding the packet until its TTL expires
+      for (uint32_t ttl = 255; ttl > 0; ttl--)
+        {
+          Ipv4Header received;
+          received.EnableChecksum ();
+          p->RemoveHeader (received);
+          NS_TEST_EXPECT_MSG_EQ (received.IsChecksumOk (), true,
+                                 "Bad checksum for protocol " << (uint32_t) protocols[k] << ", TTL " << ttl);
+          NS_TEST_EXPECT_MSG_EQ (received.GetTtl (), ttl, "Wrong TTL");
+          received.SetTtl (ttl - 1);
+          header.SetTtl (ttl - 1);
+          NS_TEST_EXPECT_MSG_EQ ((Serialize (received) == Serialize (header)), true,
+                                 "Incremental checksum differs for protocol " << (uint32_t) protocols[k]
+                                 << ", TTL " << ttl - 1);
+          p->AddHeader (received);
+        }
+    }
+
+  // any other change recomputes the checksum
+  Ipv4Header header;
+  header.EnableChecksum ();
+  header.SetTtl (64);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (header);
+  Ipv4Header received;
+  received.EnableChecksum ();
+  p->RemoveHeader (received);
+  received.SetTtl (63);
+  received.SetDestination (Ipv4Address ("10.0.0.1"));
+  p->AddHeader (received);
+  Ipv4Header check;
+  check.EnableChecksum ();
+  p->RemoveHeader (check);
+  NS_TEST_EXPECT_MSG_EQ (check.IsChecksumOk (), true, "Bad checksum after a destination change");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -277,6 +367,7 @@ public:
   Ipv4HeaderTestSuite () : TestSuite ("ipv4-header", UNIT)
   {
     AddTestCase (new Ipv4HeaderTest, TestCase::QUICK);
+    AddTestCase (new Ipv4HeaderChecksumTest, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie test.
+ *
+ * Insert and remove random IPv4 prefixes, which often share their first
+ * bits, and check the lookups against a linear search of the prefixes.
+ */
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  PrefixTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** A prefix and its value. */
+  struct Route
+  {
+    Ipv4Address network; //!< The prefix address.
+    uint32_t length;     //!< The prefix length.
+    uint32_t value;      //!< The value.
+  };
+
+  /**
+   * Check the lookup of an address.
+   * \param trie The trie.
+   * \param routes The prefixes in the trie, in insertion order.
+   * \param address The address.
+   */
+  void CheckLookup (const PrefixTrie<uint32_t, 4> &trie, const std::vector<Route> &routes,
+                    Ipv4Address address);
+};
+
+PrefixTrieTestCase::PrefixTrieTestCase ()
+  : TestCase ("PrefixTrie lookups, insertions and removals")
+{
+}
+
+void
+PrefixTrieTestCase::CheckLookup (const PrefixTrie<uint32_t, 4> &trie, const std::vector<Route> &routes,
+                                 Ipv4Address address)
+{
+  uint8_t buf[4];
+  address.Serialize (buf);
+  const PrefixTrie<uint32_t, 4>::Values *matches[PrefixTrie<uint32_t, 4>::MAX_MATCHES];
+  uint32_t n = trie.Lookup (buf, matches);
+
+  // The expected values of each matching prefix length, longest first.
+  uint32_t k = 0;
+  for (int32_t length = 32; length >= 0; length--)
+    {
+      std::vector<uint32_t> expected;
+      Ipv4Mask mask (length == 0 ? 0 : ~0U << (32 - length));
+      for (std::vector<Route>::const_iterator i = routes.begin (); i != routes.end (); i++)
+        {
+          if (i->length == static_cast<uint32_t> (length) && mask.IsMatch (address, i->network))
+            {
+              expected.push_back (i->value);
+            }
+        }
+      if (expected.empty ())
+        {
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_LT (k, n, "Missing /" << length << " match for " << address);
+      NS_TEST_EXPECT_MSG_EQ ((*matches[k] == expected), true,
+                             "Wrong values of the /" << length << " match for " << address);
+      k++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (k, n, "Unexpected matches for " << address);
+}
+
+void
+PrefixTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  PrefixTrie<uint32_t, 4> trie;
+  std::vector<Route> routes;
+
+  // Only the first and the last byte vary, so that the prefixes share
+  // long common parts and the trie has to split its nodes.
+  for (uint32_t value = 0; value < 400; value++)
+    {
+      Route route;
+      route.network = Ipv4Address ((rng->GetInteger (0, 3) << 24) | (10 << 16) | rng->GetInteger (0, 255));
+      route.length = rng->GetInteger (0, 4) == 0 ? rng->GetInteger (0, 32) : rng->GetInteger (24, 32);
+      route.value = value;
+      uint8_t buf[4];
+      route.network.Serialize (buf);
+      trie.Insert (buf, route.length, route.value);
+      routes.push_back (route);
+    }
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      CheckLookup (trie, routes, Ipv4Address ((rng->GetInteger (0, 3) << 24) | (10 << 16) | rng->GetInteger (0, 255)));
+    }
+
+  // Remove half of the prefixes, including some values which are not in
+  // the trie.
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      uint32_t index = rng->GetInteger (0, routes.size () - 1);
+      Route route = routes[index];
+      uint8_t buf[4];
+      route.network.Serialize (buf);
+      NS_TEST_EXPECT_MSG_EQ (trie.Remove (buf, route.length, 1000), false, "Removed an unknown value");
+      NS_TEST_EXPECT_MSG_EQ (trie.Remove (buf, route.length, route.value), true, "Value not removed");
+      routes.erase (routes.begin () + index);
+    }
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      CheckLookup (trie, routes, Ipv4Address ((rng->GetInteger (0, 3) << 24) | (10 << 16) | rng->GetInteger (0, 255)));
+    }
+
+  trie.Clear ();
+  routes.clear ();
+  CheckLookup (trie, routes, Ipv4Address ("0.10.0.1"));
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite ()
+  : TestSuite ("prefix-trie", UNIT)
+{
+  AddTestCase (new PrefixTrieTestCase, TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,892 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-impl-pool.h"
+#include "ns3/channel.h"
+#include "ns3/simple-channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <pthread.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup mpi
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/**
+ * \ingroup mpi
+ * \brief A reusable barrier for the threads of the partitions.
+ *
+ * SystemCondition cannot be used here since it resets its condition
+ * when a thread starts waiting, which would lose the wake up of the
+ * threads arriving late.
+ */
+class PartitionBarrier
+{
+public:
+  /** Constructor. */
+  PartitionBarrier ();
+  /** Destructor. */
+  ~PartitionBarrier ();
+  /**
+   * Wait for \p n threads to reach the barrier.
+   *
+   * \param [in] n The number of threads.
+   * \param [in] last A callback invoked by the last thread to arrive,
+   *            before any thread leaves the barrier, if not null.
+   */
+  void Wait (uint32_t n, Callback<void> last);
+
+private:
+  pthread_mutex_t m_mutex;  //!< The mutex protecting the barrier state.
+  pthread_cond_t m_cond;    //!< The condition signalled by the last thread.
+  uint32_t m_count;         //!< Number of threads waiting.
+  uint64_t m_generation;    //!< Incremented each time the barrier opens.
+};
+
+PartitionBarrier::PartitionBarrier ()
+  : m_count (0),
+    m_generation (0)
+{
+  pthread_mutex_init (&m_mutex, 0);
+  pthread_cond_init (&m_cond, 0);
+}
+
+PartitionBarrier::~PartitionBarrier ()
+{
+  pthread_mutex_destroy (&m_mutex);
+  pthread_cond_destroy (&m_cond);
+}
+
+void
+PartitionBarrier::Wait (uint32_t n, Callback<void> last)
+{
+  pthread_mutex_lock (&m_mutex);
+  uint64_t generation = m_generation;
+  m_count++;
+  if (m_count == n)
+    {
+      if (!last.IsNull ())
+        {
+          last ();
+        }
+      m_count = 0;
+      m_generation++;
+      pthread_cond_broadcast (&m_cond);
+    }
+  else
+    {
+      while (generation == m_generation)
+        {
+          pthread_cond_wait (&m_cond, &m_mutex);
+        }
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+/** The largest timestamp. */
+static const uint64_t MAX_TS = 0x7fffffffffffffffLL;
+
+const uint32_t MultithreadedSimulatorImpl::NO_PARTITION;
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of partitions, each run by its own thread. "
+                   "Zero means one partition per processor.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = false;
+  m_stopTs = MAX_TS;
+  m_threadCount = 0;
+  m_partitioned = false;
+  m_currentTs = 0;
+  m_lookAhead = MAX_TS;
+  m_maxLookAhead = GetMaximumSimulationTime ();
+  m_windowEnd = 0;
+  m_finished = false;
+  m_windowCount = 0;
+  m_barrier = new PartitionBarrier ();
+  // events are created and released by all the threads.
+  EventImplPool::Detach ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (uint32_t j = 0; j < p->outbox.size (); j++)
+        {
+          for (std::vector<Handover>::iterator k = p->outbox[j].begin ();
+               k != p->outbox[j].end (); ++k)
+            {
+              k->impl->Unref ();
+            }
+        }
+      delete p;
+    }
+  m_partitions.clear ();
+  delete m_barrier;
+  m_barrier = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        CriticalSection cs (m_destroyMutex);
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  if (!m_partitions.empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_threadCount;
+  if (n == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      n = processors > 0 ? processors : 1;
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Partition *p = new Partition ();
+      p->index = i;
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      // uids are allocated from 4.
+      // uid 0 is "invalid" events
+      // uid 1 is "now" events
+      // uid 2 is "destroy" events
+      p->uid = 4;
+      // before ::Run is entered, the currentUid will be zero
+      p->currentUid = 0;
+      p->currentTs = m_currentTs;
+      p->currentContext = Simulator::NO_CONTEXT;
+      p->eventCount = 0;
+      p->unscheduledEvents = 0;
+      p->nextTs = MAX_TS;
+      p->stop = false;
+      p->stopTs = MAX_TS;
+      p->outbox.resize (n);
+      m_partitions.push_back (p);
+    }
+  NS_LOG_LOGIC ("created " << n << " partitions");
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionIndex (uint32_t context) const
+{
+  if (context < m_partitionOf.size () && m_partitionOf[context] != NO_PARTITION)
+    {
+      return m_partitionOf[context];
+    }
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return 0;
+    }
+  return context % m_partitions.size ();
+}
+
+MultithreadedSimulatorImpl::Partition &
+MultithreadedSimulatorImpl::GetOwner (const EventId &id) const
+{
+  uint32_t index = 0;
+  if (m_partitioned)
+    {
+      index = GetPartitionIndex (id.GetContext ());
+    }
+  NS_ASSERT_MSG (m_current == 0 || m_current->index == index,
+                 "An event can only be accessed from its own partition");
+  return *m_partitions[index];
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << context << partition);
+  NS_ASSERT_MSG (!m_partitioned, "The partitions cannot change once the simulation has run");
+  CreatePartitions ();
+  if (context >= m_partitionOf.size ())
+    {
+      m_partitionOf.resize (context + 1, NO_PARTITION);
+    }
+  m_partitionOf[context] = partition % m_partitions.size ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_partitions.size ();
+}
+
+void
+MultithreadedSimulatorImpl::AssignPartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n = m_partitions.size ();
+  uint32_t nNodes = NodeList::GetNNodes ();
+  if (m_partitionOf.size () < nNodes)
+    {
+      m_partitionOf.resize (nNodes, NO_PARTITION);
+    }
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      if (m_partitionOf[i] == NO_PARTITION)
+        {
+          // contiguous blocks, since neighbours are often created together.
+          m_partitionOf[i] = static_cast<uint64_t> (i) * n / nNodes;
+        }
+    }
+  m_partitioned = true;
+
+  // all the events scheduled so far are held by the first partition.
+  Partition &first = *m_partitions[0];
+  std::vector<Scheduler::Event> events;
+  while (!first.events->IsEmpty ())
+    {
+      events.push_back (first.events->RemoveNext ());
+    }
+  first.unscheduledEvents = 0;
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin ();
+       i != events.end (); ++i)
+    {
+      Partition &p = *m_partitions[GetPartitionIndex (i->key.m_context)];
+      p.events->Insert (*i);
+      p.unscheduledEvents++;
+    }
+  for (uint32_t i = 1; i < n; i++)
+    {
+      m_partitions[i]->uid = first.uid;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_lookAhead = m_maxLookAhead.GetTimeStep ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      uint32_t partition = GetPartitionIndex (node->GetId ());
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<Channel> channel = node->GetDevice (j)->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (std::size_t k = 0; k < channel->GetNDevices (); k++)
+            {
+              Ptr<Node> remoteNode = channel->GetDevice (k)->GetNode ();
+              if (remoteNode == 0 || GetPartitionIndex (remoteNode->GetId ()) == partition)
+                {
+                  continue;
+                }
+              TypeId tid = channel->GetInstanceTypeId ();
+              TypeId pointToPoint;
+              if (tid != SimpleChannel::GetTypeId ()
+                  && !(TypeId::LookupByNameFailSafe ("ns3::PointToPointChannel", &pointToPoint)
+                       && tid == pointToPoint))
+                {
+                  NS_FATAL_ERROR ("Channel " << tid.GetName () <<
+                                  " connects nodes " << node->GetId () << " and " <<
+                                  remoteNode->GetId () << " of different partitions:" <<
+                                  " only the point-to-point and simple channels can");
+                }
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              if (delay.Get ().GetTimeStep () < static_cast<int64_t> (m_lookAhead))
+                {
+                  m_lookAhead = delay.Get ().GetTimeStep ();
+                }
+            }
+        }
+    }
+  if (m_partitions.size () > 1 && m_lookAhead == 0)
+    {
+      NS_FATAL_ERROR ("A zero-delay channel connects two partitions: "
+                      "assign its nodes to the same partition");
+    }
+  NS_LOG_LOGIC ("lookahead is " << TimeStep (m_lookAhead));
+}
+
+void
+MultithreadedSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
+{
+  if (lookAhead > Time (0))
+    {
+      NS_LOG_FUNCTION (this << lookAhead);
+      m_maxLookAhead = lookAhead;
+    }
+  else
+    {
+      NS_LOG_WARN ("attempted to set look ahead negative: " << lookAhead);
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindowCount (void) const
+{
+  return m_windowCount;
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->events->IsEmpty ())
+        {
+          scheduler->Insert ((*i)->events->RemoveNext ());
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+Scheduler::EventKey
+MultithreadedSimulatorImpl::Insert (Partition &p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = p.uid;
+  p.uid++;
+  p.unscheduledEvents++;
+  p.events->Insert (ev);
+  return ev.key;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition &p)
+{
+  Scheduler::Event next = p.events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= p.currentTs);
+  p.unscheduledEvents--;
+  p.eventCount++;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts << " in partition " << p.index);
+  p.currentTs = next.key.m_ts;
+  p.currentContext = next.key.m_context;
+  p.currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Deliver (Partition &p)
+{
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      std::vector<Handover> &inbox = m_partitions[i]->outbox[p.index];
+      for (std::vector<Handover>::const_iterator j = inbox.begin ();
+           j != inbox.end (); ++j)
+        {
+          Insert (p, j->ts, j->context, j->impl);
+        }
+      inbox.clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (bool nextWindow)
+{
+  Callback<void> last;
+  if (nextWindow)
+    {
+      last = MakeCallback (&MultithreadedSimulatorImpl::NextWindow, this);
+    }
+  m_barrier->Wait (m_partitions.size (), last);
+}
+
+void
+MultithreadedSimulatorImpl::NextWindow (void)
+{
+  uint64_t next = MAX_TS;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      next = std::min (next, p->nextTs);
+      m_stop = m_stop || p->stop;
+      m_stopTs = std::min (m_stopTs, p->stopTs);
+      p->stop = false;
+      p->stopTs = MAX_TS;
+    }
+  if (m_stop || next == MAX_TS || next >= m_stopTs)
+    {
+      m_finished = true;
+      return;
+    }
+  if (m_lookAhead >= MAX_TS - next)
+    {
+      m_windowEnd = MAX_TS;
+    }
+  else
+    {
+      m_windowEnd = next + m_lookAhead;
+    }
+  if (m_stopTs < m_windowEnd)
+    {
+      // as with a stop event, the events scheduled later are not run.
+      m_windowEnd = m_stopTs;
+    }
+  m_windowCount++;
+  NS_LOG_LOGIC ("window [" << next << ", " << m_windowEnd << ")");
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *p)
+{
+  NS_LOG_FUNCTION (this << p->index);
+  m_current = p;
+  while (!m_finished)
+    {
+      uint64_t end = m_windowEnd;
+      while (!p->events->IsEmpty () && p->events->PeekNext ().key.m_ts < end)
+        {
+          ProcessOneEvent (*p);
+        }
+      // wait for all the events of the window to be handed over.
+      Barrier (false);
+      Deliver (*p);
+      p->nextTs = p->events->IsEmpty () ? MAX_TS : p->events->PeekNext ().key.m_ts;
+      Barrier (true);
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::RunThread (MultithreadedSimulatorImpl *impl, Partition *p)
+{
+  impl->RunPartition (p);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_current == 0, "Run cannot be called from an event");
+  CreatePartitions ();
+  if (!m_partitioned)
+    {
+      AssignPartitions ();
+    }
+  CalculateLookAhead ();
+
+  m_stop = false;
+  m_finished = false;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      p->nextTs = p->events->IsEmpty () ? MAX_TS : p->events->PeekNext ().key.m_ts;
+    }
+  NextWindow ();
+
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      Partition *p = m_partitions[i];
+      p->thread = Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::RunThread,
+                                                           this, p));
+      p->thread->Start ();
+    }
+  RunPartition (m_partitions[0]);
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      m_partitions[i]->thread->Join ();
+      m_partitions[i]->thread = 0;
+    }
+
+  int unscheduledEvents = 0;
+  uint64_t next = MAX_TS;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      m_currentTs = std::max (m_currentTs, (*i)->currentTs);
+      unscheduledEvents += (*i)->unscheduledEvents;
+      next = std::min (next, (*i)->nextTs);
+    }
+  if (!m_stop && m_stopTs != MAX_TS && next >= m_stopTs)
+    {
+      // the stop time has been reached, as if it were an event.
+      m_currentTs = std::max (m_currentTs, m_stopTs);
+      m_stopTs = MAX_TS;
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!IsFinished () || m_stop || unscheduledEvents == 0);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_current != 0)
+    {
+      m_current->stop = true;
+    }
+  else
+    {
+      m_stop = true;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  NS_ASSERT (delay.IsPositive ());
+  if (m_current != 0)
+    {
+      m_current->stopTs = std::min<uint64_t> (m_current->stopTs,
+                                              m_current->currentTs + delay.GetTimeStep ());
+    }
+  else
+    {
+      m_stopTs = std::min<uint64_t> (m_stopTs, m_currentTs + delay.GetTimeStep ());
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT (delay.IsPositive ());
+
+  Scheduler::EventKey key;
+  if (m_current != 0)
+    {
+      key = Insert (*m_current, m_current->currentTs + delay.GetTimeStep (),
+                    m_current->currentContext, event);
+    }
+  else
+    {
+      CreatePartitions ();
+      key = Insert (*m_partitions[0], m_currentTs + delay.GetTimeStep (),
+                    Simulator::NO_CONTEXT, event);
+    }
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT (delay.IsPositive ());
+
+  if (m_current == 0)
+    {
+      CreatePartitions ();
+      uint32_t index = m_partitioned ? GetPartitionIndex (context) : 0;
+      Insert (*m_partitions[index], m_currentTs + delay.GetTimeStep (), context, event);
+      return;
+    }
+
+  Partition &p = *m_current;
+  uint64_t ts = p.currentTs + delay.GetTimeStep ();
+  uint32_t index = GetPartitionIndex (context);
+  if (index == p.index)
+    {
+      Insert (p, ts, context, event);
+      return;
+    }
+  if (ts < m_windowEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " scheduled by context " <<
+                      p.currentContext << " with a delay of " << delay <<
+                      ", smaller than the lookahead " << TimeStep (m_lookAhead) <<
+                      " between their partitions");
+    }
+  // the target partition picks it up at the end of the window.
+  Handover handover;
+  handover.ts = ts;
+  handover.context = context;
+  handover.impl = event;
+  p.outbox[index].push_back (handover);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  EventId id (Ptr<EventImpl> (event, false), Now ().GetTimeStep (), 0xffffffff, 2);
+  CriticalSection cs (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  if (m_current != 0)
+    {
+      return TimeStep (m_current->currentTs);
+    }
+  return TimeStep (m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition &p = GetOwner (id);
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p.events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p.unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (id.PeekEventImpl () == 0
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  const Partition &p = GetOwner (id);
+  if (id.GetTs () < p.currentTs
+      || (id.GetTs () == p.currentTs
+          && id.GetUid () <= p.currentUid))
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  if (m_current != 0)
+    {
+      return m_current->currentContext;
+    }
+  return Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      count += (*i)->eventCount;
+    }
+  return count;
+}
+
+bool
+MultithreadedSimulatorImpl::IsLocalContext (uint32_t context) const
+{
+  if (m_current == 0)
+    {
+      // only one thread runs while the simulation is not running.
+      return true;
+    }
+  return GetPartitionIndex (context) == m_current->index;
+}
+
+} // namespace ns3
@@ -0,0 +1,490 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/abort.h"
+
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup mpi-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+
+/**
+ * \ingroup mpi
+ * \defgroup mpi-tests MPI module tests
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-tests
+ * Create a simulator implementation.
+ *
+ * \param [in] threads The number of threads of a MultithreadedSimulatorImpl,
+ *            or zero for a DefaultSimulatorImpl.
+ * \param [in] lookAhead The maximum lookahead.
+ * \returns The simulator implementation.
+ */
+static Ptr<SimulatorImpl>
+CreateImpl (uint32_t threads, Time lookAhead)
+{
+  ObjectFactory factory;
+  if (threads == 0)
+    {
+      factory.SetTypeId (DefaultSimulatorImpl::GetTypeId ());
+      return factory.Create<SimulatorImpl> ();
+    }
+  factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+  factory.Set ("ThreadCount", UintegerValue (threads));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  impl->SetMaximumLookAhead (lookAhead);
+  return impl;
+}
+
+/**
+ * \ingroup mpi-tests
+ * Pass tokens across contexts and check that every context sees the
+ * same events as with the DefaultSimulatorImpl.
+ */
+class MultithreadedSimulatorTokenTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] threads The number of threads.
+   */
+  MultithreadedSimulatorTokenTestCase (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+  /** Result of a run, per context. */
+  struct Result
+  {
+    std::vector<uint64_t> tokens;    //!< Number of tokens received.
+    std::vector<uint64_t> timeSum;   //!< Sum of the reception times.
+    std::vector<uint64_t> locals;    //!< Number of local events.
+    std::vector<uint64_t> errors;    //!< Number of failed checks.
+    uint64_t events;                 //!< Number of events.
+  };
+  /**
+   * Run the token workload.
+   *
+   * \param [in] threads The number of threads, or zero for the
+   *            DefaultSimulatorImpl.
+   * \returns The result.
+   */
+  Result Simulate (uint32_t threads);
+  /**
+   * Receive a token.
+   *
+   * \param [in] context The expected context.
+   * \param [in] hop The number of hops of the token.
+   */
+  void Receive (uint32_t context, uint32_t hop);
+  /**
+   * A local event of a context.
+   *
+   * \param [in] context The expected context.
+   * \param [in] expected The expected time.
+   */
+  void Local (uint32_t context, Time expected);
+  /**
+   * An event which must never run.
+   *
+   * \param [in] context The context.
+   */
+  void Never (uint32_t context);
+
+  /** Number of contexts. */
+  static const uint32_t N_CONTEXTS = 16;
+  /** Number of hops of each token. */
+  static const uint32_t N_HOPS = 200;
+
+  uint32_t m_threads;           //!< The number of threads.
+  Result m_result;              //!< The result of the current run.
+  std::vector<uint64_t> m_last; //!< Time of the last event of each context.
+};
+
+MultithreadedSimulatorTokenTestCase::MultithreadedSimulatorTokenTestCase (uint32_t threads)
+  : TestCase ("Check the token workload with " + std::to_string (threads) + " threads"),
+    m_threads (threads)
+{
+}
+
+void
+MultithreadedSimulatorTokenTestCase::Receive (uint32_t context, uint32_t hop)
+{
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  if (Simulator::GetContext () != context || now < m_last[context])
+    {
+      m_result.errors[context]++;
+    }
+  m_last[context] = now;
+  m_result.tokens[context]++;
+  m_result.timeSum[context] += now;
+
+  Time localDelay = MilliSeconds (hop % 3);
+  Simulator::Schedule (localDelay, &MultithreadedSimulatorTokenTestCase::Local,
+                       this, context, Simulator::Now () + localDelay);
+  EventId never = Simulator::Schedule (Seconds (1), &MultithreadedSimulatorTokenTestCase::Never,
+                                       this, context);
+  if (never.IsExpired ())
+    {
+      m_result.errors[context]++;
+    }
+  Simulator::Remove (never);
+  if (!never.IsExpired ())
+    {
+      m_result.errors[context]++;
+    }
+
+  if (hop < N_HOPS)
+    {
+      uint32_t next = (context * 7 + 3) % N_CONTEXTS;
+      Simulator::ScheduleWithContext (next, MilliSeconds (10 + hop % 5),
+                                      &MultithreadedSimulatorTokenTestCase::Receive,
+                                      this, next, hop + 1);
+    }
+}
+
+void
+MultithreadedSimulatorTokenTestCase::Local (uint32_t context, Time expected)
+{
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  if (Simulator::GetContext () != context || Simulator::Now () != expected
+      || now < m_last[context])
+    {
+      m_result.errors[context]++;
+    }
+  m_last[context] = now;
+  m_result.locals[context]++;
+}
+
+void
+MultithreadedSimulatorTokenTestCase::Never (uint32_t context)
+{
+  m_result.errors[context]++;
+}
+
+MultithreadedSimulatorTokenTestCase::Result
+MultithreadedSimulatorTokenTestCase::Simulate (uint32_t threads)
+{
+  Simulator::SetImplementation (CreateImpl (threads, MilliSeconds (10)));
+  m_result.tokens.assign (N_CONTEXTS, 0);
+  m_result.timeSum.assign (N_CONTEXTS, 0);
+  m_result.locals.assign (N_CONTEXTS, 0);
+  m_result.errors.assign (N_CONTEXTS, 0);
+  m_last.assign (N_CONTEXTS, 0);
+  for (uint32_t i = 0; i < N_CONTEXTS; i++)
+    {
+      Simulator::ScheduleWithContext (i, MilliSeconds (i),
+                                      &MultithreadedSimulatorTokenTestCase::Receive,
+                                      this, i, 0);
+    }
+  Simulator::Run ();
+  m_result.events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return m_result;
+}
+
+void
+MultithreadedSimulatorTokenTestCase::DoRun (void)
+{
+  Result expected = Simulate (0);
+  Result result = Simulate (m_threads);
+  NS_TEST_ASSERT_MSG_EQ (result.events, expected.events, "Wrong number of events");
+  for (uint32_t i = 0; i < N_CONTEXTS; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (result.tokens[i], expected.tokens[i], "Wrong number of tokens");
+      NS_TEST_ASSERT_MSG_EQ (result.timeSum[i], expected.timeSum[i], "Wrong token times");
+      NS_TEST_ASSERT_MSG_EQ (result.locals[i], expected.locals[i], "Wrong number of local events");
+      NS_TEST_ASSERT_MSG_EQ (expected.errors[i], 0, "Unexpected context, time or event");
+      NS_TEST_ASSERT_MSG_EQ (result.errors[i], 0, "Unexpected context, time or event");
+    }
+}
+
+/**
+ * \ingroup mpi-tests
+ * Check Simulator::Stop and the resumption of the simulation.
+ */
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorStopTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * A periodic event.
+   *
+   * \param [in] context The context.
+   */
+  void Tick (uint32_t context);
+
+  std::vector<uint32_t> m_ticks; //!< Number of ticks per context.
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase ()
+  : TestCase ("Check Simulator::Stop with the MultithreadedSimulatorImpl")
+{
+}
+
+void
+MultithreadedSimulatorStopTestCase::Tick (uint32_t context)
+{
+  m_ticks[context]++;
+  Simulator::Schedule (MilliSeconds (1), &MultithreadedSimulatorStopTestCase::Tick, this, context);
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun (void)
+{
+  Simulator::SetImplementation (CreateImpl (4, MilliSeconds (3)));
+  m_ticks.assign (8, 0);
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      Simulator::ScheduleWithContext (i, Seconds (0), &MultithreadedSimulatorStopTestCase::Tick, this, i);
+    }
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MilliSeconds (100), "Wrong stop time");
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      // ticks at 0, 1, ..., 99 ms
+      NS_TEST_ASSERT_MSG_EQ (m_ticks[i], 100, "Wrong number of ticks");
+    }
+  NS_TEST_ASSERT_MSG_EQ (Simulator::IsFinished (), false, "The ticks never end");
+
+  Simulator::Stop (MilliSeconds (50));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MilliSeconds (150), "Wrong second stop time");
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_ticks[i], 150, "Wrong number of ticks after resuming");
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi-tests
+ * Check the partition of the nodes and the lookahead computed from
+ * the channel delays.
+ */
+class MultithreadedSimulatorLookAheadTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorLookAheadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MultithreadedSimulatorLookAheadTestCase::MultithreadedSimulatorLookAheadTestCase ()
+  : TestCase ("Check the lookahead of the MultithreadedSimulatorImpl")
+{
+}
+
+void
+MultithreadedSimulatorLookAheadTestCase::DoRun (void)
+{
+  Ptr<SimulatorImpl> impl = CreateImpl (2, Seconds (1));
+  Ptr<MultithreadedSimulatorImpl> mt = DynamicCast<MultithreadedSimulatorImpl> (impl);
+  Simulator::SetImplementation (impl);
+
+  // a chain of 4 nodes, the first two nodes in the first partition.
+  NodeContainer nodes;
+  nodes.Create (4);
+  double delays[] = { 2, 5, 3 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (delays[i])));
+      for (uint32_t j = i; j <= i + 1; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes.Get (j)->AddDevice (device);
+        }
+    }
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (mt->GetPartitionCount (), 2, "Wrong number of partitions");
+  NS_TEST_ASSERT_MSG_EQ (mt->GetLookAhead (), MilliSeconds (5), "Wrong lookahead");
+  Simulator::Destroy ();
+
+  // the same chain, with the middle node in its own partition.
+  impl = CreateImpl (2, Seconds (1));
+  mt = DynamicCast<MultithreadedSimulatorImpl> (impl);
+  Simulator::SetImplementation (impl);
+  nodes = NodeContainer ();
+  nodes.Create (4);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (delays[i])));
+      for (uint32_t j = i; j <= i + 1; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes.Get (j)->AddDevice (device);
+        }
+    }
+  mt->SetPartition (nodes.Get (1)->GetId (), 1);
+  mt->SetPartition (nodes.Get (2)->GetId (), 0);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (mt->GetLookAhead (), MilliSeconds (2), "Wrong lookahead");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi-tests
+ * A channel which is not a SimpleChannel for the MultithreadedSimulatorImpl,
+ * like a CsmaChannel whose carrier sense state is shared by its devices.
+ */
+class MultithreadedSimulatorSharedChannel : public SimpleChannel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::MultithreadedSimulatorSharedChannel")
+      .SetParent<SimpleChannel> ()
+      .SetGroupName ("Mpi")
+      .AddConstructor<MultithreadedSimulatorSharedChannel> ()
+    ;
+    return tid;
+  }
+};
+
+/**
+ * \ingroup mpi-tests
+ * Check that the simulation aborts when the devices of a channel
+ * other than a point-to-point or simple channel are in different
+ * partitions.
+ *
+ * The simulation runs in a child process, whose abort is expected.
+ */
+class MultithreadedSimulatorChannelTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorChannelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run a simulation with a channel between two nodes in a child process.
+   *
+   * \param [in] shared Whether the channel is a
+   *            MultithreadedSimulatorSharedChannel or a SimpleChannel.
+   * \param [in] partitions The number of partitions of the nodes.
+   * \returns Whether the child process aborted.
+   */
+  bool RunAborts (bool shared, uint32_t partitions);
+};
+
+MultithreadedSimulatorChannelTestCase::MultithreadedSimulatorChannelTestCase ()
+  : TestCase ("Check the channels which can connect two partitions")
+{
+}
+
+bool
+MultithreadedSimulatorChannelTestCase::RunAborts (bool shared, uint32_t partitions)
+{
+  pid_t pid = fork ();
+  NS_ABORT_MSG_IF (pid < 0, "fork failed");
+  if (pid == 0)
+    {
+      // the expected error message only clutters the test output
+      int null = open ("/dev/null", O_WRONLY);
+      dup2 (null, STDERR_FILENO);
+      Ptr<SimulatorImpl> impl = CreateImpl (partitions, Seconds (1));
+      Simulator::SetImplementation (impl);
+      NodeContainer nodes;
+      nodes.Create (2);
+      Ptr<SimpleChannel> channel;
+      if (shared)
+        {
+          channel = CreateObject<MultithreadedSimulatorSharedChannel> ();
+        }
+      else
+        {
+          channel = CreateObject<SimpleChannel> ();
+        }
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes.Get (i)->AddDevice (device);
+        }
+      Simulator::Run ();
+      Simulator::Destroy ();
+      _exit (0);
+    }
+  int status;
+  waitpid (pid, &status, 0);
+  return !WIFEXITED (status) || WEXITSTATUS (status) != 0;
+}
+
+void
+MultithreadedSimulatorChannelTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (RunAborts (false, 2), false,
+                         "A simple channel can connect two partitions");
+  NS_TEST_ASSERT_MSG_EQ (RunAborts (true, 1), false,
+                         "Any channel can be used within a partition");
+  NS_TEST_ASSERT_MSG_EQ (RunAborts (true, 2), true,
+                         "Another channel cannot connect two partitions");
+}
+
+/**
+ * \ingroup mpi-tests
+ * MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    AddTestCase (new MultithreadedSimulatorTokenTestCase (1), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorTokenTestCase (3), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorTokenTestCase (8), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorStopTestCase (), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorLookAheadTestCase (), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorChannelTestCase (), TestCase::QUICK);
+  }
+};
+
+/** Static variable for test initialization. */
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite;
@@ -20,6 +20,13 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-mutex.h"
+
+#include <cstddef>
+#include <atomic>
+#include <cstring>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -43,6 +50,69 @@ static struct Zeroes
   const uint32_t size;  //!< buffer size
 } g_zeroes; //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * \brief Compute the ones-complement sum of the 16-bit words of an array.
+ *
+ * The words are read in little-endian order, as by
+ * Buffer::Iterator::ReadU16, and an odd last byte is padded with zero.
+ * The array is read eight bytes at a time into a 64-bit accumulator
+ * whose carries are folded back once at the end (RFC 1071), which
+ * compilers turn into vector code where available.
+ *
+ * \param [in] data The array.
+ * \param [in] size The size of the array.
+ * \returns The sum, folded to 16 bits.
+ */
+uint16_t
+ChecksumSum (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  while (size >= 32)
+    {
+      uint64_t w[4];
+      std::memcpy (w, data, 32);
+      sum += (w[0] & 0xffffffff) + (w[0] >> 32);
+      sum += (w[1] & 0xffffffff) + (w[1] >> 32);
+      sum += (w[2] & 0xffffffff) + (w[2] >> 32);
+      sum += (w[3] & 0xffffffff) + (w[3] >> 32);
+      data += 32;
+      size -= 32;
+    }
+  while (size >= 8)
+    {
+      uint64_t w;
+      std::memcpy (&w, data, 8);
+      sum += (w & 0xffffffff) + (w >> 32);
+      data += 8;
+      size -= 8;
+    }
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  const uint16_t one = 1;
+  if (*reinterpret_cast<const uint8_t *> (&one) == 0)
+    {
+      // big-endian host: the words above were summed in network order
+      sum = ((sum >> 8) | (sum << 8)) & 0xffff;
+    }
+  while (size >= 2)
+    {
+      sum += data[0] | (data[1] << 8);
+      data += 2;
+      size -= 2;
+    }
+  if (size == 1)
+    {
+      sum += data[0];
+    }
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return sum;
+}
+
 }
 
 namespace ns3 {
@@ -50,98 +120,531 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+/**
+ * \ingroup packet
+ * The maximum number of bytes held by each thread cache and by the
+ * shared depot of the buffer storage pool.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
+static GlobalValue g_bufferPoolCapacity = GlobalValue
+  ("BufferPoolCapacity",
+   "The maximum number of bytes of released packet buffers kept for reuse by each thread",
+   UintegerValue (2 * 1024 * 1024),
+   MakeUintegerChecker<uint64_t> ());
+
+/**
+ * \ingroup packet
+ * Whether g_bufferPoolCapacity has been constructed: the buffers created
+ * by the static constructors which run before are not pooled.
+ */
+static bool g_bufferPoolReady = false;
+
+/**
+ * \ingroup packet
+ * Set g_bufferPoolReady once g_bufferPoolCapacity has been constructed.
+ */
+static struct BufferPoolReady
+{
+  BufferPoolReady ()
+  {
+    g_bufferPoolReady = true;
+  }
+} g_bufferPoolReadySetter; //!< Set g_bufferPoolReady
+
+/**
+ * \ingroup packet
+ * \brief Size-classed pool of Buffer::Data storage.
+ *
+ * Each thread allocates and releases buffer storage through its own
+ * cache, without any locking. The cache keeps one free list per size
+ * class; storage is always allocated with the full size of its class,
+ * so that any block of a class can serve any request of that class,
+ * whatever the mix of packet sizes. Storage larger than the largest
+ * class is not pooled.
+ *
+ * When a thread cache holds more than the capacity, half of the free
+ * list which overflows is moved to a depot shared by all the threads;
+ * when a free list is empty, it is refilled from the depot. The depot
+ * is protected by a mutex, which is only taken on these transfers, so
+ * that the storage released by a thread, such as the packets received
+ * by the nodes of another partition of a multithreaded simulation, is
+ * reused by the other threads.
+ *
+ * The state of the pool is plain old data, so that it is valid before
+ * any static constructor and after all the static destructors have run.
+ */
+class Buffer::Pool
+{
+public:
+  /**
+   * Get storage from the pool.
+   *
+   * \param size The minimum storage size.
+   * \returns The storage, with a reference count of one.
+   */
+  static struct Buffer::Data * Get (uint32_t size);
+  /**
+   * Release storage to the pool.
+   *
+   * \param data The storage.
+   */
+  static void Put (struct Buffer::Data *data);
+  /** \copydoc Buffer::GetPoolStats */
+  static Buffer::PoolStats GetStats (void);
+  /** \copydoc Buffer::PurgePool */
+  static void Purge (void);
+  /**
+   * Release all the storage held by the depot and stop pooling the
+   * storage released afterwards, by the static destructors.
+   */
+  static void Destroy (void);
+
+private:
+  /** log2 of the size of the smallest size class. */
+  static const uint32_t MIN_SHIFT = 6;
+  /** Number of size classes, up to 64 KiB. */
+  static const uint32_t N_CLASSES = 11;
+  /** Maximum number of blocks moved from the depot on a refill. */
+  static const uint32_t BATCH = 32;
+
+  /** The free blocks of a size class. */
+  struct FreeList
+  {
+    struct Buffer::Data *head; //!< The first block.
+    uint32_t n;                //!< The number of blocks.
+  };
+  /** The storage cache of a thread. */
+  struct Cache
+  {
+    FreeList lists[N_CLASSES];   //!< One free list per size class.
+    uint64_t capacity;           //!< The maximum number of bytes held.
+    std::atomic<uint64_t> bytes; //!< The number of bytes held.
+    std::atomic<uint64_t> blocks; //!< The number of blocks held.
+    std::atomic<uint64_t> hits;  //!< Requests served by the pool.
+    std::atomic<uint64_t> misses; //!< Requests served by the system.
+    Cache *next;                 //!< The next cache of the registry.
+  };
+  /** The depot shared by all the threads, protected by GetMutex(). */
+  struct Depot
+  {
+    FreeList lists[N_CLASSES]; //!< One free list per size class.
+    uint64_t capacity;         //!< The maximum number of bytes held.
+    uint64_t bytes;            //!< The number of bytes held.
+    uint64_t blocks;           //!< The number of blocks held.
+    uint64_t hits;             //!< Hits of the exited threads.
+    uint64_t misses;           //!< Misses of the exited threads.
+    Cache *caches;             //!< The caches of the live threads.
+  };
+  /** Release the cache of the calling thread when it exits. */
+  struct ThreadExit
+  {
+    ~ThreadExit ();
+  };
+
+  /**
+   * \param size The storage size.
+   * \returns The size class of \p size, which is N_CLASSES if
+   *          \p size is not pooled.
+   */
+  static inline uint32_t GetClass (uint32_t size);
+  /**
+   * \param c A size class.
+   * \returns The size of the storage of class \p c.
+   */
+  static inline uint32_t GetClassSize (uint32_t c);
+  /**
+   * \returns The cache of the calling thread, or 0 if the storage of
+   *          the calling thread is not pooled.
+   */
+  static inline Cache * GetCache (void);
+  /**
+   * Create the cache of the calling thread.
+   * \returns The cache, or 0 if the thread has exited, the pool has
+   *          been destroyed or the pool is not ready yet.
+   */
+  static Cache * CreateCache (void);
+  /**
+   * Release all the storage of a thread cache to the depot.
+   * \param cache The cache.
+   */
+  static void ReleaseCache (Cache *cache);
+  /**
+   * Update the statistics of a thread cache.
+   * \param cache The cache.
+   * \param bytes The number of bytes added to the cache.
+   * \param blocks The number of blocks added to the cache.
+   */
+  static inline void Account (Cache *cache, int64_t bytes, int64_t blocks);
+  /**
+   * Increment a counter of the calling thread.
+   * \param counter The counter.
+   */
+  static inline void Increment (std::atomic<uint64_t> *counter);
+  /**
+   * Get the mutex which protects the depot. The mutex is never deleted,
+   * since buffers may be released by static destructors.
+   * \returns The mutex.
+   */
+  static SystemMutex & GetMutex (void);
+  /**
+   * Push a block on a free list.
+   * \param list The free list.
+   * \param data The block.
+   */
+  static inline void Push (FreeList *list, struct Buffer::Data *data);
+  /**
+   * Pop a block from a non-empty free list.
+   * \param list The free list.
+   * \returns The block.
+   */
+  static inline struct Buffer::Data * Pop (FreeList *list);
+  /**
+   * Release the blocks of a free list to the system.
+   * \param list The free list.
+   */
+  static void Clear (FreeList *list);
+
+  /** The depot. */
+  static Depot g_depot;
+  /** Whether the static destructors of this file have run. */
+  static bool g_destroyed;
+  /** The cache of the calling thread. */
+  static thread_local Cache *t_cache;
+  /** Whether the calling thread has released its cache. */
+  static thread_local bool t_exited;
+};
+
+Buffer::Pool::Depot Buffer::Pool::g_depot;
+bool Buffer::Pool::g_destroyed = false;
+thread_local Buffer::Pool::Cache *Buffer::Pool::t_cache = 0;
+thread_local bool Buffer::Pool::t_exited = false;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
+Buffer::LocalStaticDestructor::~LocalStaticDestructor (void)
 {
   NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  Buffer::Pool::Destroy ();
+}
+
+Buffer::Pool::ThreadExit::~ThreadExit ()
+{
+  if (t_cache != 0)
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
+      ReleaseCache (t_cache);
+      t_cache = 0;
     }
+  t_exited = true;
+}
+
+uint32_t
+Buffer::Pool::GetClass (uint32_t size)
+{
+  uint32_t c = 0;
+  while (c < N_CLASSES && GetClassSize (c) < size)
+    {
+      c++;
+    }
+  return c;
+}
+
+uint32_t
+Buffer::Pool::GetClassSize (uint32_t c)
+{
+  return 1U << (c + MIN_SHIFT);
+}
+
+Buffer::Pool::Cache *
+Buffer::Pool::GetCache (void)
+{
+  Cache *cache = t_cache;
+  if (cache == 0)
+    {
+      cache = CreateCache ();
+    }
+  return cache;
 }
 
 void
-Buffer::Recycle (struct Buffer::Data *data)
+Buffer::Pool::Push (FreeList *list, struct Buffer::Data *data)
 {
-  NS_LOG_FUNCTION (data);
-  NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  // the free blocks are linked through their first data bytes.
+  static_assert (offsetof (struct Buffer::Data, m_data) % alignof (struct Buffer::Data *) == 0,
+                 "Buffer::Data::m_data must be pointer-aligned");
+  *reinterpret_cast<struct Buffer::Data **> (data->m_data) = list->head;
+  list->head = data;
+  list->n++;
+}
+
+struct Buffer::Data *
+Buffer::Pool::Pop (FreeList *list)
+{
+  struct Buffer::Data *data = list->head;
+  list->head = *reinterpret_cast<struct Buffer::Data **> (data->m_data);
+  list->n--;
+  return data;
+}
+
+void
+Buffer::Pool::Clear (FreeList *list)
+{
+  while (list->head != 0)
     {
+      struct Buffer::Data *data = Pop (list);
       Buffer::Deallocate (data);
     }
-  else
+}
+
+SystemMutex &
+Buffer::Pool::GetMutex (void)
+{
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
+void
+Buffer::Pool::Account (Cache *cache, int64_t bytes, int64_t blocks)
+{
+  // only the owner thread writes the counters: no atomic read-modify-write.
+  cache->bytes.store (cache->bytes.load (std::memory_order_relaxed) + bytes,
+                      std::memory_order_relaxed);
+  cache->blocks.store (cache->blocks.load (std::memory_order_relaxed) + blocks,
+                       std::memory_order_relaxed);
+}
+
+void
+Buffer::Pool::Increment (std::atomic<uint64_t> *counter)
+{
+  counter->store (counter->load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+Buffer::Pool::Cache *
+Buffer::Pool::CreateCache (void)
+{
+  if (t_exited || g_destroyed || !g_bufferPoolReady)
+    {
+      return 0;
+    }
+  // register the release of the cache when the thread exits.
+  static thread_local ThreadExit threadExit;
+  (void) threadExit;
+
+  Cache *cache = new Cache ();
+  for (uint32_t c = 0; c < N_CLASSES; c++)
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      cache->lists[c].head = 0;
+      cache->lists[c].n = 0;
     }
+  UintegerValue capacity;
+  g_bufferPoolCapacity.GetValue (capacity);
+  cache->capacity = capacity.Get ();
+  cache->bytes = 0;
+  cache->blocks = 0;
+  cache->hits = 0;
+  cache->misses = 0;
+  {
+    CriticalSection cs (GetMutex ());
+    cache->next = g_depot.caches;
+    g_depot.caches = cache;
+    if (g_depot.capacity == 0)
+      {
+        g_depot.capacity = cache->capacity;
+      }
+  }
+  t_cache = cache;
+  return cache;
 }
 
-Buffer::Data *
-Buffer::Create (uint32_t dataSize)
+void
+Buffer::Pool::ReleaseCache (Cache *cache)
 {
-  NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  CriticalSection cs (GetMutex ());
+  for (Cache **i = &g_depot.caches; *i != 0; i = &(*i)->next)
     {
-      g_freeList = new Buffer::FreeList ();
+      if (*i == cache)
+        {
+          *i = cache->next;
+          break;
+        }
     }
-  else if (IS_INITIALIZED (g_freeList))
+  g_depot.hits += cache->hits;
+  g_depot.misses += cache->misses;
+  for (uint32_t c = 0; c < N_CLASSES; c++)
     {
-      while (!g_freeList->empty ()) 
+      FreeList *list = &cache->lists[c];
+      while (list->head != 0)
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
+          struct Buffer::Data *data = Pop (list);
+          if (!g_destroyed && g_depot.bytes + data->m_size <= g_depot.capacity)
+            {
+              Push (&g_depot.lists[c], data);
+              g_depot.bytes += data->m_size;
+              g_depot.blocks++;
+            }
+          else
             {
-              data->m_count = 1;
-              return data;
+              Buffer::Deallocate (data);
             }
-          Buffer::Deallocate (data);
         }
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  delete cache;
+}
+
+struct Buffer::Data *
+Buffer::Pool::Get (uint32_t size)
+{
+  uint32_t c = GetClass (size);
+  Cache *cache = GetCache ();
+  if (cache == 0)
+    {
+      return Buffer::Allocate (c == N_CLASSES ? size : GetClassSize (c));
+    }
+  if (c == N_CLASSES)
+    {
+      Increment (&cache->misses);
+      return Buffer::Allocate (size);
+    }
+  FreeList *list = &cache->lists[c];
+  if (list->head == 0)
+    {
+      // refill from the depot.
+      CriticalSection cs (GetMutex ());
+      FreeList *depot = &g_depot.lists[c];
+      uint32_t n = 0;
+      while (n < BATCH && depot->head != 0)
+        {
+          Push (list, Pop (depot));
+          n++;
+        }
+      g_depot.bytes -= n * GetClassSize (c);
+      g_depot.blocks -= n;
+      Account (cache, n * GetClassSize (c), n);
+    }
+  if (list->head == 0)
+    {
+      Increment (&cache->misses);
+      return Buffer::Allocate (GetClassSize (c));
+    }
+  struct Buffer::Data *data = Pop (list);
+  Account (cache, -static_cast<int64_t> (data->m_size), -1);
+  Increment (&cache->hits);
+  data->m_count = 1;
+  return data;
+}
+
+void
+Buffer::Pool::Put (struct Buffer::Data *data)
+{
+  uint32_t c = GetClass (data->m_size);
+  Cache *cache = GetCache ();
+  if (cache == 0 || c == N_CLASSES || data->m_size != GetClassSize (c))
+    {
+      Buffer::Deallocate (data);
+      return;
+    }
+  FreeList *list = &cache->lists[c];
+  Push (list, data);
+  Account (cache, data->m_size, 1);
+  if (cache->bytes.load (std::memory_order_relaxed) > cache->capacity)
+    {
+      // move half of the overflowing free list to the depot.
+      CriticalSection cs (GetMutex ());
+      uint32_t n = (list->n + 1) / 2;
+      for (uint32_t i = 0; i < n; i++)
+        {
+          struct Buffer::Data *block = Pop (list);
+          if (g_depot.bytes + block->m_size <= g_depot.capacity)
+            {
+              Push (&g_depot.lists[c], block);
+              g_depot.bytes += block->m_size;
+              g_depot.blocks++;
+            }
+          else
+            {
+              Buffer::Deallocate (block);
+            }
+        }
+      Account (cache, -static_cast<int64_t> (n * GetClassSize (c)), -static_cast<int64_t> (n));
+    }
+}
+
+Buffer::PoolStats
+Buffer::Pool::GetStats (void)
+{
+  CriticalSection cs (GetMutex ());
+  Buffer::PoolStats stats;
+  stats.hits = g_depot.hits;
+  stats.misses = g_depot.misses;
+  stats.bytes = g_depot.bytes;
+  stats.blocks = g_depot.blocks;
+  for (Cache *cache = g_depot.caches; cache != 0; cache = cache->next)
+    {
+      stats.hits += cache->hits.load (std::memory_order_relaxed);
+      stats.misses += cache->misses.load (std::memory_order_relaxed);
+      stats.bytes += cache->bytes.load (std::memory_order_relaxed);
+      stats.blocks += cache->blocks.load (std::memory_order_relaxed);
+    }
+  return stats;
+}
+
+void
+Buffer::Pool::Purge (void)
+{
+  Cache *cache = t_cache;
+  CriticalSection cs (GetMutex ());
+  for (uint32_t c = 0; c < N_CLASSES; c++)
+    {
+      if (cache != 0)
+        {
+          Account (cache, -static_cast<int64_t> (cache->lists[c].n * GetClassSize (c)),
+                   -static_cast<int64_t> (cache->lists[c].n));
+          Clear (&cache->lists[c]);
+        }
+      Clear (&g_depot.lists[c]);
+    }
+  g_depot.bytes = 0;
+  g_depot.blocks = 0;
+}
+
+void
+Buffer::Pool::Destroy (void)
+{
+  Purge ();
+  CriticalSection cs (GetMutex ());
+  g_destroyed = true;
+}
+
+void
+Buffer::Recycle (struct Buffer::Data *data)
+{
+  NS_LOG_FUNCTION (data);
+  NS_ASSERT (data->m_count == 0);
+  Buffer::Pool::Put (data);
+}
+
+Buffer::Data *
+Buffer::Create (uint32_t dataSize)
+{
+  NS_LOG_FUNCTION (dataSize);
+  struct Buffer::Data *data = Buffer::Pool::Get (dataSize);
   NS_ASSERT (data->m_count == 1);
+  data->m_materialized = 0;
   return data;
 }
+
+Buffer::PoolStats
+Buffer::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return Buffer::Pool::GetStats ();
+}
+
+void
+Buffer::PurgePool (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Buffer::Pool::Purge ();
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -155,7 +658,27 @@ Buffer::Data *
 Buffer::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
-  return Allocate (size);
+  struct Buffer::Data *data = Allocate (size);
+  data->m_materialized = 0;
+  return data;
+}
+
+Buffer::PoolStats
+Buffer::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Buffer::PoolStats stats;
+  stats.hits = 0;
+  stats.misses = 0;
+  stats.blocks = 0;
+  stats.bytes = 0;
+  return stats;
+}
+
+void
+Buffer::PurgePool (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
 }
 #endif /* BUFFER_FREE_LIST */
 
@@ -328,6 +851,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
+      newData->m_materialized = m_data->m_materialized;
       m_data->m_count--;
       if (m_data->m_count == 0)
         {
@@ -373,6 +897,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
+      newData->m_materialized = m_data->m_materialized;
       m_data->m_count--;
       if (m_data->m_count == 0) 
         {
@@ -400,37 +925,69 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
-      o.m_start == o.m_zeroAreaStart &&
-      o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
-    {
-      /**
-       * This is an optimization which kicks in when
-       * we attempt to aggregate two buffers which contain
-       * adjacent zero areas.
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  bool adjacent = m_end == m_zeroAreaEnd && o.m_start == o.m_zeroAreaStart;
+  if (oZeroSize == 0 || (oZeroSize <= zeroSize && !adjacent))
+    {
+      /* keep the zero area of this buffer and append the content of
+       * the other one, which has the smallest zero area, after it.
        */
-      uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
-      m_zeroAreaEnd += zeroSize;
-      m_end = m_zeroAreaEnd;
-      m_data->m_dirtyEnd = m_zeroAreaEnd;
-      uint32_t endData = o.m_end - o.m_zeroAreaEnd;
-      AddAtEnd (endData);
-      Buffer::Iterator dst = End ();
-      dst.Prev (endData);
-      Buffer::Iterator src = o.End ();
-      src.Prev (endData);
-      dst.Write (src, o.End ());
+      AddAtEnd (o.GetSize ());
+      Buffer::Iterator destStart = End ();
+      destStart.Prev (o.GetSize ());
+      destStart.Write (o.Begin (), o.End ());
+      m_data->m_materialized += o.m_data->m_materialized + oZeroSize;
       NS_ASSERT (CheckInternalState ());
       return;
     }
 
-  *this = CreateFullCopy ();
-  AddAtEnd (o.GetSize ());
-  Buffer::Iterator destStart = End ();
-  destStart.Prev (o.GetSize ());
-  destStart.Write (o.Begin (), o.End ());
+  /* keep the zero area of the other buffer: unless both zero areas
+   * are adjacent, write the zero area of this buffer, which is the
+   * smallest one, and the bytes which precede the other zero area.
+   * Then extend the zero area of this buffer, which is now at its end
+   * or empty, with the other zero area.
+   */
+  if (zeroSize != 0 && !adjacent)
+    {
+      *this = CreateFullCopy ();
+    }
+  uint32_t startData = o.m_zeroAreaStart - o.m_start;
+  AddAtEnd (startData);
+  if (m_data->m_count != 1 || m_end != m_data->m_dirtyEnd)
+    {
+      // the zero area can only be extended in an unshared data buffer.
+      struct Buffer::Data *newData = Buffer::Create (GetInternalSize ());
+      memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
+      newData->m_materialized = m_data->m_materialized;
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          Buffer::Recycle (m_data);
+        }
+      m_data = newData;
+      m_zeroAreaStart -= m_start;
+      m_zeroAreaEnd -= m_start;
+      m_end -= m_start;
+      m_start = 0;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+    }
+  memcpy (m_data->m_data + GetInternalEnd () - startData, o.m_data->m_data + o.m_start, startData);
+  if (m_zeroAreaStart == m_zeroAreaEnd)
+    {
+      m_zeroAreaStart = m_end;
+      m_zeroAreaEnd = m_end;
+    }
+  NS_ASSERT (m_zeroAreaEnd == m_end);
+  m_zeroAreaEnd += oZeroSize;
+  m_end = m_zeroAreaEnd;
+  m_data->m_dirtyEnd = m_end;
+  m_data->m_materialized += o.m_data->m_materialized;
+  uint32_t endData = o.m_end - o.m_zeroAreaEnd;
+  AddAtEnd (endData);
+  memcpy (m_data->m_data + GetInternalEnd () - endData, o.m_data->m_data + o.m_zeroAreaStart, endData);
+  m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -534,17 +1091,22 @@ Buffer::CreateFullCopy (void) const
   NS_ASSERT (CheckInternalState ());
   if (m_zeroAreaEnd - m_zeroAreaStart != 0) 
     {
-      Buffer tmp;
-      tmp.AddAtStart (m_zeroAreaEnd - m_zeroAreaStart);
-      tmp.Begin ().WriteU8 (0, m_zeroAreaEnd - m_zeroAreaStart);
+      uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
       uint32_t dataStart = m_zeroAreaStart - m_start;
-      tmp.AddAtStart (dataStart);
-      tmp.Begin ().Write (m_data->m_data+m_start, dataStart);
       uint32_t dataEnd = m_end - m_zeroAreaEnd;
-      tmp.AddAtEnd (dataEnd);
-      Buffer::Iterator i = tmp.End ();
-      i.Prev (dataEnd);
-      i.Write (m_data->m_data+m_zeroAreaStart,dataEnd);
+      Buffer tmp (0, false);
+      tmp.m_data = Buffer::Create (GetSize ());
+      memcpy (tmp.m_data->m_data, m_data->m_data + m_start, dataStart);
+      memset (tmp.m_data->m_data + dataStart, 0, zeroSize);
+      memcpy (tmp.m_data->m_data + dataStart + zeroSize, m_data->m_data + m_zeroAreaStart, dataEnd);
+      tmp.m_data->m_materialized = m_data->m_materialized + zeroSize;
+      tmp.m_maxZeroAreaStart = 0;
+      tmp.m_start = 0;
+      tmp.m_zeroAreaStart = GetSize ();
+      tmp.m_zeroAreaEnd = GetSize ();
+      tmp.m_end = GetSize ();
+      tmp.m_data->m_dirtyStart = tmp.m_start;
+      tmp.m_data->m_dirtyEnd = tmp.m_end;
       NS_ASSERT (tmp.CheckInternalState ());
       return tmp;
     }
@@ -552,6 +1114,36 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  uint32_t dataStart = m_zeroAreaStart - m_start;
+  uint32_t dataEnd = m_end - m_zeroAreaEnd;
+  Buffer tmp (0, false);
+  tmp.m_data = Buffer::Create (dataStart + dataEnd);
+  memcpy (tmp.m_data->m_data, m_data->m_data + m_start, dataStart);
+  memcpy (tmp.m_data->m_data + dataStart, m_data->m_data + m_zeroAreaStart, dataEnd);
+  tmp.m_data->m_materialized = m_data->m_materialized;
+  tmp.m_maxZeroAreaStart = dataStart;
+  tmp.m_start = 0;
+  tmp.m_zeroAreaStart = dataStart;
+  tmp.m_zeroAreaEnd = m_zeroAreaEnd - m_start;
+  tmp.m_end = m_end - m_start;
+  tmp.m_data->m_dirtyStart = tmp.m_start;
+  tmp.m_data->m_dirtyEnd = tmp.m_end;
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
+uint32_t
+Buffer::GetMaterializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_data->m_materialized;
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
@@ -812,14 +1404,11 @@ bool
 Buffer::Iterator::CheckNoZero (uint32_t start, uint32_t end) const
 {
   NS_LOG_FUNCTION (this << &start << &end);
-  for (uint32_t i = start; i < end; i++)
-    {
-      if (!Check (i))
-        {
-          return false;
-        }
-    }
-  return true;
+  // same as Check (i) for each i in [start, end)
+  return start >= end ||
+         (start >= m_dataStart &&
+          end - 1 <= m_dataEnd &&
+          (m_zeroStart == m_zeroEnd || end <= m_zeroStart || start >= m_zeroEnd));
 }
 bool 
 Buffer::Iterator::Check (uint32_t i) const
@@ -843,25 +1432,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the destination may follow the zero area of this buffer.
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
+      to += toCopy;
       m_current += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
+      to += toCopy;
       m_current += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
@@ -953,7 +1553,7 @@ void
 Buffer::Iterator::Write (uint8_t const*buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
-  NS_ASSERT_MSG (CheckNoZero (m_current, size),
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
   uint8_t *to;
   if (m_current <= m_zeroStart)
@@ -1140,14 +1740,40 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  uint64_t sum = initialChecksum;
+  uint32_t end = m_current + size;
+  uint32_t offset = 0;
+  // Sum the bytes before and after the zero area in place.  The sum of
+  // a span starting at an odd offset is the byte-swapped sum of its
+  // words (RFC 1071, section 2).
+  if (m_current < m_zeroStart)
+    {
+      uint32_t n = std::min (end, m_zeroStart) - m_current;
+      sum += ChecksumSum (m_data + m_current, n);
+      offset += n;
+      m_current += n;
+    }
+  if (m_current < end && m_current < m_zeroEnd)
+    {
+      uint32_t n = std::min (end, m_zeroEnd) - m_current;
+      offset += n;
+      m_current += n;
+    }
+  if (m_current < end)
+    {
+      uint32_t n = end - m_current;
+      uint16_t partial = ChecksumSum (m_data + m_current - (m_zeroEnd - m_zeroStart), n);
+      if (offset & 1)
+        {
+          partial = (partial >> 8) | (partial << 8);
+        }
+      sum += partial;
+      m_current += n;
+    }
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -356,6 +356,31 @@ public:
      */
     inline void Read (Iterator start, uint32_t size);
 
+    /**
+     * \param size number of bytes to write
+     * \returns a pointer to the memory of the next size bytes of the buffer
+     *
+     * Check once that the next size bytes are within the buffer and
+     * outside of the zero-filled area, advance the Iterator by size
+     * bytes and return the memory of these bytes.  Headers and trailers
+     * can then serialize their fields with plain memory writes instead
+     * of one checked WriteU8, WriteHtonU16, ... per field.
+     */
+    inline uint8_t *WriteSpan (uint32_t size);
+    /**
+     * \param size number of bytes to read
+     * \param scratch a user-provided array of at least size bytes
+     * \returns a pointer to the next size bytes of the buffer
+     *
+     * Check once that the next size bytes are within the buffer and
+     * advance the Iterator by size bytes.  If they are contiguous in
+     * memory, the returned pointer points into the buffer; if they
+     * overlap the zero-filled area, they are copied to scratch, which
+     * is returned.  Headers and trailers can then deserialize their
+     * fields with plain memory reads.
+     */
+    inline const uint8_t *ReadSpan (uint32_t size, uint8_t *scratch);
+
     /**
      * \brief Calculate the checksum.
      * \param size size of the buffer.
@@ -489,6 +514,21 @@ private:
    */
   inline uint32_t GetSize (void) const;
 
+  /**
+   * \brief Get the number of bytes of virtual zero data written to memory.
+   *
+   * The zero-filled payload of a buffer, such as the one created by
+   * Buffer (uint32_t), is kept virtual: it is not stored in memory
+   * until the buffer is concatenated with another buffer which also
+   * has a zero-filled area (only one of both can be kept virtual) or
+   * PeekData is called.
+   *
+   * \return the number of bytes of virtual zero data which have been
+   * written to the memory of this buffer, including the ones written
+   * to the buffers it was copied or concatenated from.
+   */
+  uint32_t GetMaterializedSize (void) const;
+
   /**
    * \return a pointer to the start of the internal 
    * byte buffer.
@@ -527,6 +567,10 @@ private:
    * Add bytes at the end of the Buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
+   *
+   * The zero-filled areas of both buffers are kept virtual if they
+   * are adjacent or if only one of them is not empty; otherwise, only
+   * the smallest of them is written to memory.
    */
   void AddAtEnd (const Buffer &o);
   /**
@@ -555,6 +599,14 @@ private:
    */
   Buffer CreateFragment (uint32_t start, uint32_t length) const;
 
+  /**
+   * \return a copy of this buffer which does not share its data
+   * storage with this buffer.
+   *
+   * The zero-filled area of the buffer is kept virtual.
+   */
+  Buffer DeepCopy (void) const;
+
   /**
    * \return an Iterator which points to the
    * start of this Buffer.
@@ -642,6 +694,34 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Statistics of the pool which recycles the buffer storage.
+   */
+  struct PoolStats
+  {
+    uint64_t hits;   //!< Number of storage requests served by the pool.
+    uint64_t misses; //!< Number of storage requests served by the system.
+    uint64_t blocks; //!< Number of storage blocks held by the pool.
+    uint64_t bytes;  //!< Number of bytes held by the pool.
+  };
+  /**
+   * \brief Get the statistics of the buffer storage pool.
+   *
+   * The storage released by the buffers is kept in a per-thread cache
+   * of size classes (powers of two from 64 bytes to 64 KiB), which
+   * overflows into a depot shared by all the threads. The
+   * "BufferPoolCapacity" global value sets the maximum number of
+   * bytes held by each thread cache and by the depot.
+   *
+   * \returns the statistics summed over all the threads.
+   */
+  static PoolStats GetPoolStats (void);
+  /**
+   * \brief Release to the system the storage held by the cache of the
+   * calling thread and by the shared depot.
+   */
+  static void PurgePool (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -678,6 +758,16 @@ private:
      * end of the area in which user bytes were written.
      */
     uint32_t m_dirtyEnd;
+    /**
+     * The number of bytes of virtual zero data which have been
+     * written to this data buffer or to the ones it was copied from.
+     */
+    uint32_t m_materialized;
+    /**
+     * Unused: keeps the m_data field below pointer-aligned, as the
+     * free blocks of the buffer pool are linked through it.
+     */
+    uint32_t m_padding;
     /**
      * The real data buffer holds _at least_ one byte.
      * Its real size is stored in the m_size field.
@@ -767,7 +857,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -791,15 +881,13 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
+  /// Size-classed pool of buffer data storage
+  class Pool;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
@@ -865,6 +953,48 @@ Buffer::Iterator::Prev (uint32_t delta)
   NS_ASSERT (m_current >= delta);
   m_current -= delta;
 }
+uint8_t *
+Buffer::Iterator::WriteSpan (uint32_t size)
+{
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
+                 GetWriteErrorMessage ());
+  uint8_t *buffer;
+  if (m_current + size <= m_zeroStart)
+    {
+      buffer = &m_data[m_current];
+    }
+  else
+    {
+      buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
+  return buffer;
+}
+
+const uint8_t *
+Buffer::Iterator::ReadSpan (uint32_t size, uint8_t *scratch)
+{
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  const uint8_t *buffer;
+  if (m_current + size <= m_zeroStart)
+    {
+      buffer = &m_data[m_current];
+    }
+  else if (m_current >= m_zeroEnd)
+    {
+      buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  else
+    {
+      Read (scratch, size);
+      return scratch;
+    }
+  m_current += size;
+  return buffer;
+}
+
 void
 Buffer::Iterator::WriteU8 (uint8_t data)
 {
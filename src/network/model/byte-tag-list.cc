@@ -53,12 +53,19 @@ struct ByteTagListData {
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+};
+/**
+ * Container for struct ByteTagListData. Each thread has its own, as the
+ * packets of the partitions of a MultithreadedSimulatorImpl are
+ * created concurrently.
+ */
+static thread_local ByteTagListDataFreeList g_freeList;
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static thread_local bool g_freeListDestroyed = false; //!< true once g_freeList is destroyed
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -69,6 +76,7 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       uint8_t *buffer = (uint8_t *)(*i);
       delete [] buffer;
     }
+  g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -239,6 +247,24 @@ ByteTagList::Add (const ByteTagList &o)
     }
 }
 
+ByteTagList
+ByteTagList::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList copy;
+  copy.m_minStart = m_minStart;
+  copy.m_maxEnd = m_maxEnd;
+  copy.m_adjustment = m_adjustment;
+  if (m_data != 0)
+    {
+      copy.m_data = copy.Allocate (m_used);
+      std::memcpy (&copy.m_data->data, &m_data->data, m_used);
+      copy.m_used = m_used;
+      copy.m_data->dirty = m_used;
+    }
+  return copy;
+}
+
 void 
 ByteTagList::RemoveAll (void)
 {
@@ -345,7 +371,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!g_freeListDestroyed && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -379,7 +405,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeListDestroyed ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -188,6 +188,12 @@ private:
    */
   void Add (const ByteTagList &o);
 
+  /**
+   * \returns a copy of this list which does not share its storage
+   * with this list.
+   */
+  ByteTagList DeepCopy (void) const;
+
   /**
    * 
    * Removes all of the tags from the ByteTagList
@@ -19,6 +19,7 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/packet-burst.h"
 #include "net-device.h"
 
 namespace ns3 {
@@ -41,4 +42,22 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  bool sent = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      sent = Send (*i, dest, protocolNumber) && sent;
+    }
+  return sent;
+}
+
+void
+NetDevice::SetReceiveBatchCallback (ReceiveBatchCallback cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+}
+
 } // namespace ns3
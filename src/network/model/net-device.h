@@ -33,6 +33,7 @@
 namespace ns3 {
 
 class Node;
+class PacketBurst;
 class Channel;
 
 /**
@@ -260,6 +261,23 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        these packets. Used to call the right L3Protocol when the
+   *        packets are received.
+   *
+   *  Called from higher layer to send a burst of packets into Network
+   *  Device to the specified destination Address.  The packets are
+   *  sent in order, as if Send was called for each of them, but the
+   *  devices which override this method check their state and start
+   *  their transmission once per burst rather than once per packet.
+   *  The default implementation calls Send for each packet.
+   *
+   * \return whether the Send operation succeeded for all the packets
+   */
+  virtual bool SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -326,6 +344,32 @@ public:
    */
   virtual void SetReceiveCallback (ReceiveCallback cb) = 0;
 
+  /**
+   * \param device a pointer to the net device which is calling this callback
+   * \param burst the packets received, in order
+   * \param protocol the 16 bit protocol number associated with these packets.
+   *        This protocol number is expected to be the same protocol number
+   *        given to the SendBatch method by the user on the sender side.
+   * \param sender the address of the sender
+   * \returns true if the callback could handle the packets successfully, false
+   *          otherwise.
+   */
+  typedef Callback< bool, Ptr<NetDevice>, Ptr<const PacketBurst>, uint16_t, const Address & > ReceiveBatchCallback;
+
+  /**
+   * \param cb callback to invoke whenever a burst of packets from the same
+   *        sender has been received at once and must be forwarded to the
+   *        higher layers.
+   *
+   * The devices which receive whole bursts, such as SimpleNetDevice when
+   * its data rate is infinite, invoke this callback once per burst when
+   * it is set.  The other devices, and all the devices when it is not
+   * set, invoke the receive callback for each packet.  Setting the
+   * receive callback clears this callback, so it must be set after the
+   * receive callback.  The default implementation ignores the callback.
+   */
+  virtual void SetReceiveBatchCallback (ReceiveBatchCallback cb);
+
 
   /**
    * \param device a pointer to the net device which is calling this callback
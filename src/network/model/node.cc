@@ -24,6 +24,7 @@
 #include "net-device.h"
 #include "application.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/uinteger.h"
@@ -133,6 +134,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
+  device->SetReceiveBatchCallback (MakeCallback (&Node::NonPromiscReceiveBatchFromDevice, this));
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
@@ -297,6 +299,39 @@ Node::NonPromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> pack
   return ReceiveFromDevice (device, packet, protocol, from, device->GetAddress (), NetDevice::PacketType (0), false);
 }
 
+bool
+Node::NonPromiscReceiveBatchFromDevice (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                        const Address &from)
+{
+  NS_LOG_FUNCTION (this << device << burst << protocol << &from);
+  NS_ASSERT_MSG (Simulator::GetContext () == GetId (), "Received packets with erroneous context ; " <<
+                 "make sure the channels in use are correctly updating events context " <<
+                 "when transferring events from one node to another.");
+  std::vector<ProtocolHandler> handlers;
+  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
+       i != m_handlers.end (); i++)
+    {
+      if ((i->device == 0 || i->device == device) &&
+          (i->protocol == 0 || i->protocol == protocol) &&
+          !i->promiscuous)
+        {
+          handlers.push_back (i->handler);
+        }
+    }
+  Address to = device->GetAddress ();
+  for (std::list<Ptr<Packet> >::const_iterator p = burst->Begin (); p != burst->End (); p++)
+    {
+      NS_LOG_DEBUG ("Node " << GetId () << " ReceiveBatchFromDevice:  dev "
+                            << device->GetIfIndex () << " (type=" << device->GetInstanceTypeId ().GetName ()
+                            << ") Packet UID " << (*p)->GetUid ());
+      for (std::vector<ProtocolHandler>::iterator h = handlers.begin (); h != handlers.end (); h++)
+        {
+          (*h)(device, *p, protocol, from, to, NetDevice::PacketType (0));
+        }
+    }
+  return !handlers.empty ();
+}
+
 bool
 Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
                          const Address &from, const Address &to, NetDevice::PacketType packetType, bool promiscuous)
@@ -235,6 +235,20 @@ private:
    * \returns true if the packet has been delivered to a protocol handler.
    */
   bool NonPromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  /**
+   * \brief Receive a burst of packets from a device in non-promiscuous mode.
+   *
+   * The protocol handlers are looked up once for the whole burst, and
+   * each packet is then delivered in order to each of them, as
+   * NonPromiscReceiveFromDevice would do.
+   *
+   * \param device the device
+   * \param burst the packets
+   * \param protocol the protocol
+   * \param from the sender
+   * \returns true if the packets have been delivered to a protocol handler.
+   */
+  bool NonPromiscReceiveBatchFromDevice (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol, const Address &from);
   /**
    * \brief Receive a packet from a device in promiscuous mode.
    * \param device the device
@@ -33,10 +33,12 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+bool PacketMetadata::m_enableCompact = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,7 +47,7 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListDestroyed = true;
 }
 
 void 
@@ -70,6 +72,14 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableCompact (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Enable ();
+  m_enableCompact = true;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -380,8 +390,7 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
   if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
+      (m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
     {
       ReserveCopy (n);
@@ -418,8 +427,7 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
   if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
+      (m_data->m_count != 1 &&
        m_used != m_data->m_dirtyEnd))
     {
       ReserveCopy (n);
@@ -505,6 +513,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
 
   // create a copy of the packet without its tail.
   PacketMetadata h (m_packetUid, 0);
+  h.m_mode = FULL;
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -575,7 +584,7 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (!m_freeListDestroyed && !m_freeList.empty ())
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
       m_freeList.pop_back ();
@@ -596,7 +605,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -650,6 +659,20 @@ PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
   return fragment;
 }
 
+PacketMetadata
+PacketMetadata::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketMetadata copy = *this;
+  uint32_t used = m_mode == COMPACT ? sizeof (struct Compact) : m_used;
+  struct PacketMetadata::Data *data = PacketMetadata::Create (used);
+  memcpy (data->m_data, m_data->m_data, used);
+  data->m_dirtyEnd = used;
+  copy.m_data->m_count--;
+  copy.m_data = data;
+  return copy;
+}
+
 void 
 PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
@@ -663,11 +686,28 @@ void
 PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
 {
   NS_LOG_FUNCTION (this << uid << size);
-  if (!m_enable)
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      if (uid == 0)
+        {
+          // the payload, added by the constructor.
+          struct PacketMetadata::Compact *compact = GetCompactForWrite ();
+          compact->size = size;
+          compact->chunkUid = m_chunkUid;
+          m_chunkUid++;
+          return;
+        }
+      if (AddCompact (uid >> 1, size, true))
+        {
+          return;
+        }
+      Expand ();
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -685,11 +725,20 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      if (RemoveCompact (uid >> 1, size, true))
+        {
+          return;
+        }
+      // let the FULL mode report the mismatch.
+      Expand ();
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -733,11 +782,19 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable)
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      if (AddCompact (uid >> 1, size, false))
+        {
+          return;
+        }
+      Expand ();
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -755,11 +812,20 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   uint32_t uid = trailer.GetInstanceTypeId ().GetUid () << 1;
   NS_LOG_FUNCTION (this << &trailer << size);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      if (RemoveCompact (uid >> 1, size, false))
+        {
+          return;
+        }
+      // let the FULL mode report the mismatch.
+      Expand ();
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -802,11 +868,22 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
 {
   NS_LOG_FUNCTION (this << &o);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_mode == DISABLED)
+    {
+      m_metadataSkipped |= !m_enable;
+      return;
+    }
+  if (o.m_mode == COMPACT)
     {
-      m_metadataSkipped = true;
+      PacketMetadata full = o;
+      full.Expand ();
+      AddAtEnd (full);
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      Expand ();
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -879,9 +956,9 @@ void
 PacketMetadata::AddPaddingAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
-  if (!m_enable)
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
 }
@@ -890,11 +967,19 @@ PacketMetadata::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      if (start == 0)
+        {
+          return;
+        }
+      Expand ();
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -922,6 +1007,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_mode = FULL;
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -953,11 +1039,19 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (IsStateOk ());
-  if (!m_enable) 
+  if (m_mode == DISABLED)
     {
-      m_metadataSkipped = true;
+      m_metadataSkipped |= !m_enable;
       return;
     }
+  if (m_mode == COMPACT)
+    {
+      if (end == 0)
+        {
+          return;
+        }
+      Expand ();
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -986,6 +1080,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_mode = FULL;
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1042,6 +1137,330 @@ PacketMetadata::GetUid (void) const
   NS_LOG_FUNCTION (this);
   return m_packetUid;
 }
+
+void
+PacketMetadata::SetMode (enum Mode mode, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << mode << size);
+  if (mode == m_mode)
+    {
+      return;
+    }
+  if (m_mode == COMPACT && mode == FULL)
+    {
+      Expand ();
+      return;
+    }
+  if (m_mode == FULL && mode == COMPACT)
+    {
+      TryCompact ();
+      return;
+    }
+  // start or stop the recording.
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+  m_mode = mode;
+  if (mode == COMPACT)
+    {
+      InitCompact ();
+    }
+  if (mode != DISABLED && size > 0)
+    {
+      DoAddHeader (0, size);
+    }
+  NS_ASSERT (IsStateOk ());
+}
+
+enum PacketMetadata::Mode
+PacketMetadata::GetMode (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return static_cast<enum Mode> (m_mode);
+}
+
+void
+PacketMetadata::InitCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data->m_count > 1 || m_data->m_size < sizeof (struct Compact))
+    {
+      struct PacketMetadata::Data *data = PacketMetadata::Create (sizeof (struct Compact));
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+      m_data = data;
+    }
+  m_data->m_dirtyEnd = sizeof (struct Compact);
+  struct PacketMetadata::Compact *compact = GetCompactForWrite ();
+  compact->size = 0;
+  compact->chunkUid = 0;
+  compact->headers = 0;
+  compact->trailers = 0;
+}
+
+const struct PacketMetadata::Compact *
+PacketMetadata::GetCompact (void) const
+{
+  NS_ASSERT (m_mode == COMPACT && m_data->m_size >= sizeof (struct Compact));
+  return reinterpret_cast<const struct PacketMetadata::Compact *> (m_data->m_data);
+}
+
+struct PacketMetadata::Compact *
+PacketMetadata::GetCompactForWrite (void)
+{
+  NS_ASSERT (m_mode == COMPACT && m_data->m_size >= sizeof (struct Compact));
+  if (m_data->m_count > 1)
+    {
+      struct PacketMetadata::Data *data = PacketMetadata::Create (sizeof (struct Compact));
+      memcpy (data->m_data, m_data->m_data, sizeof (struct Compact));
+      data->m_dirtyEnd = sizeof (struct Compact);
+      m_data->m_count--;
+      m_data = data;
+    }
+  return reinterpret_cast<struct PacketMetadata::Compact *> (m_data->m_data);
+}
+
+void
+PacketMetadata::ReadCompactItem (uint16_t index, struct PacketMetadata::SmallItem *item,
+                                 struct PacketMetadata::ExtraItem *extraItem) const
+{
+  NS_LOG_FUNCTION (this << index);
+  const struct PacketMetadata::Compact *compact = GetCompact ();
+  item->next = 0xffff;
+  item->prev = 0xffff;
+  if (index < compact->headers)
+    {
+      const struct PacketMetadata::CompactItem *header = &compact->items[compact->headers - 1 - index];
+      item->typeUid = header->typeUid << 1;
+      item->size = header->size;
+      item->chunkUid = header->chunkUid;
+    }
+  else if (index == compact->headers && compact->size > 0)
+    {
+      item->typeUid = 0;
+      item->size = compact->size;
+      item->chunkUid = compact->chunkUid;
+    }
+  else
+    {
+      index -= compact->headers + (compact->size > 0 ? 1 : 0);
+      NS_ASSERT (index < compact->trailers);
+      const struct PacketMetadata::CompactItem *trailer = &compact->items[PACKET_METADATA_COMPACT_SIZE - 1 - index];
+      item->typeUid = trailer->typeUid << 1;
+      item->size = trailer->size;
+      item->chunkUid = trailer->chunkUid;
+    }
+  extraItem->fragmentStart = 0;
+  extraItem->fragmentEnd = item->size;
+  extraItem->packetUid = m_packetUid;
+}
+
+bool
+PacketMetadata::AddCompact (uint32_t uid, uint32_t size, bool isHeader)
+{
+  NS_LOG_FUNCTION (this << uid << size << isHeader);
+  NS_ASSERT (m_mode == COMPACT);
+  if (GetCompact ()->headers + GetCompact ()->trailers == PACKET_METADATA_COMPACT_SIZE ||
+      size > 0xffff)
+    {
+      return false;
+    }
+  struct PacketMetadata::Compact *compact = GetCompactForWrite ();
+  struct PacketMetadata::CompactItem *item;
+  if (isHeader)
+    {
+      item = &compact->items[compact->headers];
+      compact->headers++;
+    }
+  else
+    {
+      compact->trailers++;
+      item = &compact->items[PACKET_METADATA_COMPACT_SIZE - compact->trailers];
+    }
+  item->typeUid = static_cast<uint16_t> (uid);
+  item->chunkUid = m_chunkUid;
+  item->size = static_cast<uint16_t> (size);
+  m_chunkUid++;
+  return true;
+}
+
+bool
+PacketMetadata::RemoveCompact (uint32_t uid, uint32_t size, bool isHeader)
+{
+  NS_LOG_FUNCTION (this << uid << size << isHeader);
+  NS_ASSERT (m_mode == COMPACT);
+  const struct PacketMetadata::Compact *compact = GetCompact ();
+  const struct PacketMetadata::CompactItem *item;
+  if (isHeader)
+    {
+      if (compact->headers == 0)
+        {
+          return false;
+        }
+      item = &compact->items[compact->headers - 1];
+    }
+  else
+    {
+      if (compact->trailers == 0)
+        {
+          return false;
+        }
+      item = &compact->items[PACKET_METADATA_COMPACT_SIZE - compact->trailers];
+    }
+  if (item->typeUid != uid || item->size != size)
+    {
+      return false;
+    }
+  if (isHeader)
+    {
+      GetCompactForWrite ()->headers--;
+    }
+  else
+    {
+      GetCompactForWrite ()->trailers--;
+    }
+  return true;
+}
+
+void
+PacketMetadata::Expand (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_mode == COMPACT && m_head == 0xffff);
+  // the items are written over the array, or in a new data buffer
+  // if the array is shared with the copies of the packet.
+  struct PacketMetadata::Compact compact = *GetCompact ();
+  m_mode = FULL;
+  m_used = 0;
+  struct PacketMetadata::SmallItem item;
+  uint16_t written;
+  if (compact.size > 0)
+    {
+      item.next = 0xffff;
+      item.prev = 0xffff;
+      item.typeUid = 0;
+      item.size = compact.size;
+      item.chunkUid = compact.chunkUid;
+      written = AddSmall (&item);
+      UpdateHead (written);
+    }
+  for (uint8_t i = 0; i < compact.headers; i++)
+    {
+      item.next = m_head;
+      item.prev = 0xffff;
+      item.typeUid = compact.items[i].typeUid << 1;
+      item.size = compact.items[i].size;
+      item.chunkUid = compact.items[i].chunkUid;
+      written = AddSmall (&item);
+      UpdateHead (written);
+    }
+  for (uint8_t i = 1; i <= compact.trailers; i++)
+    {
+      const struct PacketMetadata::CompactItem *trailer = &compact.items[PACKET_METADATA_COMPACT_SIZE - i];
+      item.next = 0xffff;
+      item.prev = m_tail;
+      item.typeUid = trailer->typeUid << 1;
+      item.size = trailer->size;
+      item.chunkUid = trailer->chunkUid;
+      written = AddSmall (&item);
+      UpdateTail (written);
+    }
+  NS_ASSERT (IsStateOk ());
+}
+
+bool
+PacketMetadata::TryCompact (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_mode == FULL);
+  struct PacketMetadata::CompactItem headers[PACKET_METADATA_COMPACT_SIZE];
+  struct PacketMetadata::CompactItem trailers[PACKET_METADATA_COMPACT_SIZE];
+  uint8_t nHeaders = 0;
+  uint8_t nTrailers = 0;
+  uint32_t payloadSize = 0;
+  uint16_t payloadChunkUid = 0;
+  uint16_t current = m_head;
+  while (current != 0xffff)
+    {
+      struct PacketMetadata::SmallItem item;
+      PacketMetadata::ExtraItem extraItem;
+      ReadItems (current, &item, &extraItem);
+      if (extraItem.fragmentStart != 0 ||
+          extraItem.fragmentEnd != item.size ||
+          extraItem.packetUid != m_packetUid)
+        {
+          return false;
+        }
+      uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
+      if (uid == 0)
+        {
+          if (payloadSize != 0 || nTrailers != 0)
+            {
+              return false;
+            }
+          payloadSize = item.size;
+          payloadChunkUid = item.chunkUid;
+        }
+      else
+        {
+          if (nHeaders + nTrailers == PACKET_METADATA_COMPACT_SIZE ||
+              item.size > 0xffff)
+            {
+              return false;
+            }
+          struct PacketMetadata::CompactItem compact;
+          compact.typeUid = static_cast<uint16_t> (uid);
+          compact.chunkUid = item.chunkUid;
+          compact.size = static_cast<uint16_t> (item.size);
+          TypeId tid;
+          tid.SetUid (uid);
+          if (!tid.IsChildOf (Header::GetTypeId ()))
+            {
+              trailers[nTrailers] = compact;
+              nTrailers++;
+            }
+          else if (payloadSize == 0 && nTrailers == 0)
+            {
+              headers[nHeaders] = compact;
+              nHeaders++;
+            }
+          else
+            {
+              return false;
+            }
+        }
+      if (current == m_tail)
+        {
+          break;
+        }
+      current = item.next;
+    }
+
+  // the items are read from the outermost header to the outermost
+  // trailer; the array stores the innermost ones first.
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+  m_mode = COMPACT;
+  InitCompact ();
+  struct PacketMetadata::Compact *compact = GetCompactForWrite ();
+  for (uint8_t i = 0; i < nHeaders; i++)
+    {
+      compact->items[i] = headers[nHeaders - 1 - i];
+    }
+  for (uint8_t i = 0; i < nTrailers; i++)
+    {
+      compact->items[PACKET_METADATA_COMPACT_SIZE - 1 - i] = trailers[i];
+    }
+  compact->headers = nHeaders;
+  compact->trailers = nTrailers;
+  compact->size = payloadSize;
+  compact->chunkUid = payloadChunkUid;
+  return true;
+}
 PacketMetadata::ItemIterator 
 PacketMetadata::BeginItem (Buffer buffer) const
 {
@@ -1051,7 +1470,7 @@ PacketMetadata::BeginItem (Buffer buffer) const
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
   : m_metadata (metadata),
     m_buffer (buffer),
-    m_current (metadata->m_head),
+    m_current (metadata->m_mode == COMPACT ? 0 : metadata->m_head),
     m_offset (0),
     m_hasReadTail (false)
 {
@@ -1061,6 +1480,12 @@ bool
 PacketMetadata::ItemIterator::HasNext (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_metadata->m_mode == COMPACT)
+    {
+      // m_current is the index of the next item of the array.
+      const struct PacketMetadata::Compact *compact = m_metadata->GetCompact ();
+      return m_current < compact->headers + (compact->size > 0 ? 1 : 0) + compact->trailers;
+    }
   if (m_current == 0xffff)
     {
       return false;
@@ -1078,12 +1503,20 @@ PacketMetadata::ItemIterator::Next (void)
   struct PacketMetadata::Item item;
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
-  m_metadata->ReadItems (m_current, &smallItem, &extraItem);
-  if (m_current == m_metadata->m_tail)
+  if (m_metadata->m_mode == COMPACT)
     {
-      m_hasReadTail = true;
+      m_metadata->ReadCompactItem (m_current, &smallItem, &extraItem);
+      m_current++;
+    }
+  else
+    {
+      m_metadata->ReadItems (m_current, &smallItem, &extraItem);
+      if (m_current == m_metadata->m_tail)
+        {
+          m_hasReadTail = true;
+        }
+      m_current = smallItem.next;
     }
-  m_current = smallItem.next;
   uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
   item.tid.SetUid (uid);
   item.currentTrimedFromStart = extraItem.fragmentStart;
@@ -1141,10 +1574,16 @@ PacketMetadata::GetSerializedSize (void) const
   // if packet-metadata not enabled, total size
   // is simply 4-bytes for itself plus 8-bytes 
   // for packet uid
-  if (!m_enable)
+  if (m_mode == DISABLED)
     {
       return totalSize;
     }
+  if (m_mode == COMPACT)
+    {
+      PacketMetadata full = *this;
+      full.Expand ();
+      return full.GetSerializedSize ();
+    }
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
@@ -1179,6 +1618,12 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
   uint8_t* start = buffer;
+  if (m_mode == COMPACT)
+    {
+      PacketMetadata full = *this;
+      full.Expand ();
+      return full.Serialize (buffer, maxSize);
+    }
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
   if (buffer == 0) 
@@ -1284,6 +1729,14 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
+  if (m_mode == COMPACT)
+    {
+      Expand ();
+    }
+  if (desSize > 0)
+    {
+      m_mode = FULL;
+    }
 
   struct PacketMetadata::SmallItem item = {0};
   struct PacketMetadata::ExtraItem extraItem = {0};
@@ -74,10 +74,37 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * Maintaining this linked list is costly.  In the COMPACT mode, the
+ * metadata of a packet records instead the type, the size and the
+ * chunk uid of its headers and trailers in a small fixed-size array,
+ * stored in the shared data buffer in place of the linked list, with
+ * no encoding: adding or removing a header is a push or a pop on this
+ * array.  The items are iterated and serialized from the array itself.
+ * The linked list is reconstructed from the array when an operation
+ * which cannot be represented in the array is performed, such as
+ * fragmenting or concatenating packets, or adding more headers and
+ * trailers than the array can hold.  From then on, the metadata of
+ * this packet (and of its future copies) is recorded in the FULL mode.
+ *
+ * The mode is chosen for each packet when it is created: it is
+ * DISABLED unless Enable or EnableCompact were called, and it can be
+ * changed for a single packet with SetMode, which makes it possible to
+ * record the metadata of some flows only.  The mode is inherited by
+ * the copies and by the fragments of the packet.
  */
 class PacketMetadata 
 {
 public:
+  /**
+   * How the metadata of a packet is recorded.
+   */
+  enum Mode
+  {
+    DISABLED, //!< No metadata is recorded.
+    FULL,     //!< The items are recorded in the linked list.
+    COMPACT   //!< The headers and trailers are recorded in a fixed-size array.
+  };
 
   /**
    * \brief structure describing a packet metadata item
@@ -160,6 +187,14 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the packet metadata, recorded in the COMPACT mode
+   *
+   * The packets created after this call record their metadata in the
+   * COMPACT mode.  Calling Enable after this method does not change
+   * the mode of the packets.
+   */
+  static void EnableCompact (void);
 
   /**
    * \brief Constructor
@@ -218,6 +253,12 @@ private:
    */
   PacketMetadata CreateFragment (uint32_t start, uint32_t end) const;
 
+  /**
+   * \returns a copy of the metadata which does not share its
+   * storage with this metadata.
+   */
+  PacketMetadata DeepCopy (void) const;
+
   /**
    * \brief Add a metadata at the metadata start
    * \param o the metadata to add
@@ -245,6 +286,27 @@ private:
    */
   uint64_t GetUid (void) const;
 
+  /**
+   * \brief Set how the metadata is recorded
+   *
+   * Switching from DISABLED to another mode starts the recording of
+   * the metadata, with a payload item of \p size bytes which stands for
+   * the current content of the packet; switching to DISABLED discards
+   * the recorded items.  Switching from COMPACT to FULL reconstructs
+   * the items.  Switching from FULL to COMPACT succeeds only if the
+   * items are whole headers, trailers and payload of this packet which
+   * fit in the array of the COMPACT mode; otherwise the mode stays FULL.
+   *
+   * \param mode the new mode
+   * \param size the size of the packet
+   */
+  void SetMode (enum Mode mode, uint32_t size);
+  /**
+   * \brief Get how the metadata is recorded
+   * \return the current mode
+   */
+  enum Mode GetMode (void) const;
+
   /**
    * \brief Get the metadata serialized size
    * \return the seralized size
@@ -402,6 +464,47 @@ private:
                                   const uint8_t* current,
                                   uint32_t maxSize);
 
+  /**
+   * the number of headers and trailers which can be recorded
+   * in the COMPACT mode
+   */
+#define PACKET_METADATA_COMPACT_SIZE 6
+
+  /**
+   * \brief A header or trailer recorded in the COMPACT mode
+   */
+  struct CompactItem {
+    /** the uid of the TypeId of the header or trailer. */
+    uint16_t typeUid;
+    /** the chunk uid of the header or trailer. */
+    uint16_t chunkUid;
+    /** the size (in bytes) of the header or trailer. */
+    uint16_t size;
+  };
+
+  /**
+   * \brief The headers and trailers recorded in the COMPACT mode
+   *
+   * It is stored at the start of the m_data buffer of the Data
+   * structure, which it shares copy-on-write with the copies of the
+   * packet, like the linked list of the FULL mode.
+   */
+  struct Compact {
+    /** the size (in bytes) of the payload. */
+    uint32_t size;
+    /** the chunk uid of the payload. */
+    uint16_t chunkUid;
+    /** the number of headers in items. */
+    uint8_t headers;
+    /** the number of trailers in items. */
+    uint8_t trailers;
+    /**
+     * the headers, from the first element, innermost first, and the
+     * trailers, from the last element, innermost first.
+     */
+    struct CompactItem items[PACKET_METADATA_COMPACT_SIZE];
+  };
+
   /**
    * the size of PacketMetadata::Data::m_data such that the total size
    * of PacketMetadata::Data is 16 bytes
@@ -620,6 +723,65 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Record a header or a trailer in the COMPACT mode
+   * \param uid the uid of the TypeId of the header or trailer
+   * \param size the serialized size of the header or trailer
+   * \param isHeader true for a header, false for a trailer
+   * \returns true if the item was recorded, false if the array is full
+   */
+  bool AddCompact (uint32_t uid, uint32_t size, bool isHeader);
+  /**
+   * \brief Remove the outermost header or trailer in the COMPACT mode
+   * \param uid the uid of the TypeId of the header or trailer
+   * \param size the serialized size of the header or trailer
+   * \param isHeader true for a header, false for a trailer
+   * \returns true if the item was removed, false if it does not match
+   *          the outermost header or trailer
+   */
+  bool RemoveCompact (uint32_t uid, uint32_t size, bool isHeader);
+  /**
+   * \brief Initialize an empty COMPACT mode array
+   *
+   * The array is written in a data buffer which is not shared with
+   * the copies of the packet.
+   */
+  void InitCompact (void);
+  /**
+   * \brief Get the array of the COMPACT mode
+   * \returns the array
+   */
+  const struct Compact *GetCompact (void) const;
+  /**
+   * \brief Get the array of the COMPACT mode, to modify it
+   *
+   * The data buffer is copied first if it is shared with the copies
+   * of the packet.
+   *
+   * \returns the array
+   */
+  struct Compact *GetCompactForWrite (void);
+  /**
+   * \brief Read an item of the COMPACT mode
+   * \param index the index of the item, from the outermost header to
+   *        the outermost trailer
+   * \param item the item to fill
+   * \param extraItem the extra item to fill
+   */
+  void ReadCompactItem (uint16_t index, struct PacketMetadata::SmallItem *item,
+                        struct PacketMetadata::ExtraItem *extraItem) const;
+  /**
+   * \brief Switch from the COMPACT to the FULL mode
+   *
+   * Reconstruct the linked list of items from the array of the
+   * COMPACT mode.
+   */
+  void Expand (void);
+  /**
+   * \brief Switch from the FULL to the COMPACT mode, if possible
+   * \returns true if the items could be recorded in the COMPACT mode
+   */
+  bool TryCompact (void);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -661,9 +823,16 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * the recycled metadata data storage. Each thread has its own, as the
+   * packets of the partitions of a MultithreadedSimulatorImpl are
+   * created concurrently.
+   */
+  static thread_local DataFreeList m_freeList;
+  static thread_local bool m_freeListDestroyed; //!< true once m_freeList is destroyed
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_enableCompact; //!< Record the packet metadata in the COMPACT mode
 
   /**
    * Set to true when adding metadata to a packet is skipped because
@@ -672,8 +841,15 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  /**
+   * Chunk Uid.  Each thread has its own counter, so the threads of
+   * a MultithreadedSimulatorImpl give the same chunk uids to different
+   * headers and trailers, just like the wrap around of the 16-bit
+   * counter does: a packet handed over to another thread may carry
+   * items whose chunk uid is also given to a new item by that thread.
+   */
+  static thread_local uint16_t m_chunkUid;
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -684,6 +860,7 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  uint8_t m_mode; //!< how the metadata is recorded (enum Mode)
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -692,13 +869,18 @@ public:
 namespace ns3 {
 
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (PacketMetadata::Create (m_enable && m_enableCompact ? sizeof (struct Compact) : 10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_mode (m_enable ? (m_enableCompact ? COMPACT : FULL) : DISABLED),
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
+  if (m_mode == COMPACT)
+    {
+      InitCompact ();
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -709,6 +891,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_mode (o.m_mode),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
@@ -734,6 +917,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_mode = o.m_mode;
   m_packetUid = o.m_packetUid;
   return *this;
 }
@@ -34,6 +34,100 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+/**
+ * The size of the header of an inline tag: uid (2 bytes) and size (1 byte).
+ */
+static const uint32_t INLINE_HEADER_SIZE = 3;
+
+PacketTagList::Iterator::Item::Item (TagBuffer buf_)
+  : buf (buf_)
+{
+}
+
+PacketTagList::Iterator::Iterator (const uint8_t *start, const uint8_t *end,
+                                   const struct TagData *head)
+  : m_current (start),
+    m_end (end),
+    m_next (head)
+{
+}
+
+bool
+PacketTagList::Iterator::HasNext (void) const
+{
+  return m_current < m_end || m_next != 0;
+}
+
+struct PacketTagList::Iterator::Item
+PacketTagList::Iterator::Next (void)
+{
+  NS_ASSERT (HasNext ());
+  if (m_current < m_end)
+    {
+      uint8_t *data = const_cast<uint8_t *> (m_current) + INLINE_HEADER_SIZE;
+      uint32_t size = m_current[2];
+      struct Item item = Item (TagBuffer (data, data + size));
+      item.tid.SetUid (m_current[0] | (m_current[1] << 8));
+      m_current = data + size;
+      return item;
+    }
+  uint8_t *data = const_cast<uint8_t *> (m_next->data);
+  struct Item item = Item (TagBuffer (data, data + m_next->size));
+  item.tid = m_next->tid;
+  m_next = m_next->next;
+  return item;
+}
+
+uint32_t
+PacketTagList::GetMask (TypeId tid)
+{
+  return 1U << (tid.GetUid () & 31);
+}
+
+uint8_t *
+PacketTagList::FindInline (TypeId tid) const
+{
+  uint8_t *cur = const_cast<uint8_t *> (m_inline);
+  uint8_t *end = cur + m_used;
+  while (cur < end)
+    {
+      if ((cur[0] | (cur[1] << 8)) == tid.GetUid ())
+        {
+          return cur;
+        }
+      cur += INLINE_HEADER_SIZE + cur[2];
+    }
+  return 0;
+}
+
+void
+PacketTagList::RemoveInline (uint8_t *entry)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = INLINE_HEADER_SIZE + entry[2];
+  uint8_t *end = m_inline + m_used;
+  std::memmove (entry, entry + size, end - (entry + size));
+  m_used -= size;
+  UpdateMask ();
+}
+
+void
+PacketTagList::UpdateMask (void)
+{
+  m_mask = 0;
+  uint8_t *cur = m_inline;
+  uint8_t *end = cur + m_used;
+  while (cur < end)
+    {
+      m_mask |= 1U << (cur[0] & 31);
+      cur += INLINE_HEADER_SIZE + cur[2];
+    }
+  for (struct TagData *data = m_next; data != 0; data = data->next)
+    {
+      m_mask |= GetMask (data->tid);
+    }
+}
+
 PacketTagList::TagData *
 PacketTagList::CreateTagData (size_t dataSize)
 {
@@ -51,6 +145,28 @@ PacketTagList::CreateTagData (size_t dataSize)
   return tag;
 }
 
+PacketTagList
+PacketTagList::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  copy.m_mask = m_mask;
+  copy.m_used = m_used;
+  std::memcpy (copy.m_inline, m_inline, m_used);
+  struct TagData **prevNext = &copy.m_next;
+  for (const struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *data = CreateTagData (cur->size);
+      data->tid = cur->tid;
+      data->count = 1;
+      std::memcpy (data->data, cur->data, cur->size);
+      data->next = 0;
+      *prevNext = data;
+      prevNext = &data->next;
+    }
+  return copy;
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -175,7 +291,25 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  TypeId tid = tag.GetInstanceTypeId ();
+  if ((m_mask & GetMask (tid)) == 0)
+    {
+      return false;
+    }
+  uint8_t *entry = FindInline (tid);
+  if (entry != 0)
+    {
+      uint8_t *data = entry + INLINE_HEADER_SIZE;
+      tag.Deserialize (TagBuffer (data, data + entry[2]));
+      RemoveInline (entry);
+      return true;
+    }
+  bool found = COWTraverse (tag, &PacketTagList::RemoveWriter);
+  if (found)
+    {
+      UpdateMask ();
+    }
+  return found;
 }
 
 // COWWriter implementing Remove
@@ -214,6 +348,28 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
 bool
 PacketTagList::Replace (Tag & tag)
 {
+  TypeId tid = tag.GetInstanceTypeId ();
+  if ((m_mask & GetMask (tid)) == 0)
+    {
+      Add (tag);
+      return false;
+    }
+  uint8_t *entry = FindInline (tid);
+  if (entry != 0)
+    {
+      uint32_t size = tag.GetSerializedSize ();
+      if (size == entry[2])
+        {
+          uint8_t *data = entry + INLINE_HEADER_SIZE;
+          tag.Serialize (TagBuffer (data, data + size));
+        }
+      else
+        {
+          RemoveInline (entry);
+          Add (tag);
+        }
+      return true;
+    }
   bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
   if (!found)
     {
@@ -260,12 +416,30 @@ void
 PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  PacketTagList *self = const_cast<PacketTagList *> (this);
   // ensure this id was not yet added
+  NS_ASSERT_MSG ((m_mask & GetMask (tid)) == 0 || FindInline (tid) == 0,
+                 "Error: cannot add the same kind of tag twice.");
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
+      NS_ASSERT_MSG (cur->tid != tid,
                      "Error: cannot add the same kind of tag twice.");
     }
+  self->m_mask |= GetMask (tid);
+  uint32_t size = tag.GetSerializedSize ();
+  if (size <= 0xff && m_used + INLINE_HEADER_SIZE + size <= PACKET_TAG_LIST_INLINE_SIZE)
+    {
+      // store the tag in the inline array
+      uint8_t *entry = self->m_inline + m_used;
+      entry[0] = tid.GetUid () & 0xff;
+      entry[1] = (tid.GetUid () >> 8) & 0xff;
+      entry[2] = size;
+      uint8_t *data = entry + INLINE_HEADER_SIZE;
+      tag.Serialize (TagBuffer (data, data + size));
+      self->m_used += INLINE_HEADER_SIZE + size;
+      return;
+    }
   struct TagData * head = CreateTagData (tag.GetSerializedSize ());
   head->count = 1;
   head->next = 0;
@@ -273,7 +447,7 @@ PacketTagList::Add (const Tag &tag) const
   head->next = m_next;
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
 
-  const_cast<PacketTagList *> (this)->m_next = head;
+  self->m_next = head;
 }
 
 bool
@@ -281,6 +455,17 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
+  if ((m_mask & GetMask (tid)) == 0)
+    {
+      return false;
+    }
+  uint8_t *entry = FindInline (tid);
+  if (entry != 0)
+    {
+      uint8_t *data = entry + INLINE_HEADER_SIZE;
+      tag.Deserialize (TagBuffer (data, data + entry[2]));
+      return true;
+    }
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
@@ -300,5 +485,11 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+PacketTagList::Iterator
+PacketTagList::Begin (void) const
+{
+  return Iterator (m_inline, m_inline + m_used, m_next);
+}
+
 } /* namespace ns3 */
 
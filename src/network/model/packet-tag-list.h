@@ -26,8 +26,10 @@
 */
 
 #include <stdint.h>
+#include <cstring>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "tag-buffer.h"
 
 namespace ns3 {
 
@@ -43,7 +45,16 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
+ * The first tags added to a packet are stored in serialized form in a
+ * small array, #m_inline, which is part of the PacketTagList object
+ * itself: adding them does not allocate memory, and copying a
+ * PacketTagList copies them.  Each tag is stored as the 16-bit uid of
+ * its TypeId, its 8-bit size and its data.  The tags which do not fit
+ * in this array spill to the tree of TagData structures described
+ * below.  A 32-bit mask of the uids of the tags present, #m_mask,
+ * makes looking for a missing tag a constant time operation.
+ *
+ * The implementation of the spilled tags is a bit tricky.  Refer to this
  * diagram in the discussion that follows.
  *
  * \dot
@@ -147,6 +158,51 @@ public:
     uint8_t data[1];            /**< Serialization buffer */
   };  /* struct TagData */
 
+  /**
+   * \brief An iterator over the tags of a PacketTagList
+   */
+  class Iterator
+  {
+public:
+    /**
+     * \brief A tag of the list
+     */
+    struct Item
+    {
+      TypeId tid;             //!< type of the tag
+      TagBuffer buf;          //!< the data for the tag as generated by Tag::Serialize
+      /**
+       * Constructs an item with the given TagBuffer
+       * \param [in] buf The Tag Buffer
+       */
+      Item (TagBuffer buf);
+    };
+
+    /**
+     * \returns true if there are more Items in the list
+     */
+    bool HasNext (void) const;
+    /**
+     * \returns the next Item in the list
+     */
+    struct PacketTagList::Iterator::Item Next (void);
+
+private:
+    /// Friend class
+    friend class PacketTagList;
+    /**
+     * \brief Constructor
+     * \param [in] start The first inline tag
+     * \param [in] end The end of the inline tags
+     * \param [in] head The first spilled tag
+     */
+    Iterator (const uint8_t *start, const uint8_t *end, const struct TagData *head);
+
+    const uint8_t *m_current;     //!< Current inline tag
+    const uint8_t *m_end;         //!< End of the inline tags
+    const struct TagData *m_next; //!< Current spilled tag
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -177,6 +233,12 @@ public:
    */
   inline ~PacketTagList ();
 
+  /**
+   * \returns a copy of this list which does not share its \ref TagData
+   * with this list.
+   */
+  PacketTagList DeepCopy (void) const;
+
   /**
    * Add a tag to the head of this branch.
    *
@@ -214,11 +276,45 @@ public:
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to head of the list of the tags which did not fit
+   *          in the inline array
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns an iterator over all the tags of the list
+   */
+  Iterator Begin (void) const;
 
 private:
+  /**
+   * the size (in bytes) of the array of inline tags, such that the
+   * total size of a PacketTagList is 64 bytes
+   */
+#define PACKET_TAG_LIST_INLINE_SIZE 48
+
+  /**
+   * \param [in] tid The TypeId of a tag.
+   * \returns The bit of #m_mask which stands for \pname{tid}.
+   */
+  static uint32_t GetMask (TypeId tid);
+  /**
+   * Find a tag in the inline array.
+   *
+   * \param [in] tid The TypeId of the tag.
+   * \returns The inline tag, or zero if not found.
+   */
+  uint8_t *FindInline (TypeId tid) const;
+  /**
+   * Remove a tag from the inline array.
+   *
+   * \param [in] entry The inline tag, as returned by FindInline.
+   */
+  void RemoveInline (uint8_t *entry);
+  /**
+   * Recompute #m_mask from the tags present.
+   */
+  void UpdateMask (void);
+
   /**
    * Allocate and construct a TagData struct, sizing the data area
    * large enough to serialize dataSize bytes from a Tag.
@@ -282,6 +378,18 @@ private:
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /**
+   * One bit per uid (modulo 32) of the tags present
+   */
+  uint32_t m_mask;
+  /**
+   * Number of bytes used in #m_inline
+   */
+  uint8_t m_used;
+  /**
+   * The inline tags: uid (2 bytes, little endian), size (1 byte), data
+   */
+  uint8_t m_inline[PACKET_TAG_LIST_INLINE_SIZE];
 };
 
 } // namespace ns3
@@ -293,33 +401,44 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_mask (0),
+    m_used (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (o.m_next),
+    m_mask (o.m_mask),
+    m_used (o.m_used)
 {
   if (m_next != 0)
     {
       m_next->count++;
     }
+  std::memcpy (m_inline, o.m_inline, m_used);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o) 
     {
       return *this;
     }
-  RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  if (m_next != o.m_next)
     {
-      m_next->count++;
+      RemoveAll ();
+      m_next = o.m_next;
+      if (m_next != 0) 
+        {
+          m_next->count++;
+        }
     }
+  m_mask = o.m_mask;
+  m_used = o.m_used;
+  std::memcpy (m_inline, o.m_inline, m_used);
   return *this;
 }
 
@@ -331,6 +450,8 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
+  m_mask = 0;
+  m_used = 0;
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
@@ -28,7 +28,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid (0);
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,39 +81,38 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (PacketTagList::Iterator i)
+  : m_current (i)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current.HasNext ();
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
-  const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  PacketTagList::Iterator::Item i = m_current.Next ();
+  return PacketTagIterator::Item (i.tid, i.buf);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, TagBuffer buffer)
+  : m_tid (tid),
+    m_buffer (buffer)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data + m_data->size));
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (m_buffer);
 }
 
 
@@ -126,6 +125,20 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (m_buffer.DeepCopy (), m_byteTagList.DeepCopy (),
+                                              m_packetTagList.DeepCopy (), m_metadata.DeepCopy ()),
+                                  false);
+  if (m_nixVector != 0)
+    {
+      copy->m_nixVector = m_nixVector->Copy ();
+    }
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,10 +149,9 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid.fetch_add (1, std::memory_order_relaxed), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -178,10 +190,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid.fetch_add (1, std::memory_order_relaxed), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +215,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid.fetch_add (1, std::memory_order_relaxed), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -341,7 +351,19 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   copy.Adjust (GetSize ());
   m_byteTagList.Add (copy);
   m_buffer.AddAtEnd (packet->m_buffer);
-  m_metadata.AddAtEnd (packet->m_metadata);
+  if (m_metadata.GetMode () != PacketMetadata::DISABLED &&
+      packet->m_metadata.GetMode () == PacketMetadata::DISABLED)
+    {
+      // the appended packet does not record its metadata: its
+      // content is recorded as payload.
+      PacketMetadata metadata = packet->m_metadata;
+      metadata.SetMode (PacketMetadata::FULL, packet->GetSize ());
+      m_metadata.AddAtEnd (metadata);
+    }
+  else
+    {
+      m_metadata.AddAtEnd (packet->m_metadata);
+    }
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -386,6 +408,13 @@ Packet::CopyData (std::ostream *os, uint32_t size) const
   return m_buffer.CopyData (os, size);
 }
 
+uint32_t
+Packet::GetMaterializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_buffer.GetMaterializedSize ();
+}
+
 uint64_t 
 Packet::GetUid (void) const
 {
@@ -582,6 +611,26 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableCompactPrinting (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketMetadata::EnableCompact ();
+}
+
+void
+Packet::SetMetadataMode (enum PacketMetadata::Mode mode)
+{
+  NS_LOG_FUNCTION (this << mode);
+  m_metadata.SetMode (mode, m_buffer.GetSize ());
+}
+
+enum PacketMetadata::Mode
+Packet::GetMetadataMode (void) const
+{
+  return m_metadata.GetMode ();
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -920,7 +969,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Begin ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
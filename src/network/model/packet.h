@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -155,10 +156,12 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the ns3::TypeId associated to this tag.
+     * \param buffer the buffer associated to this tag.
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, TagBuffer buffer);
+    TypeId m_tid;         //!< the ns3::TypeId associated to this tag.
+    TagBuffer m_buffer;   //!< the buffer associated to this tag.
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -173,10 +176,10 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param i the list of packet tags
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
-  const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  PacketTagIterator (PacketTagList::Iterator i);
+  PacketTagList::Iterator m_current;  //!< actual position over the set of tags in a packet
 };
 
 /**
@@ -302,6 +305,19 @@ public:
    * \returns the size in bytes of the packet
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \brief Returns the number of bytes of the zero-filled payload which
+   * have been written to memory.
+   *
+   * The zero-filled payload is only written to memory when packets
+   * with zero-filled payloads are concatenated, as in TCP or IP
+   * reassembly, and cannot all be kept virtual.
+   *
+   * \returns the number of bytes of zero-filled payload written to
+   * the memory of this packet.
+   * \sa Buffer::GetMaterializedSize
+   */
+  uint32_t GetMaterializedSize (void) const;
   /**
    * \brief Add header to this packet.
    *
@@ -453,6 +469,18 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a full copy of the packet.
+   *
+   * \returns a copy of the packet which shares none of its internal
+   * datasets with the original packet.
+   *
+   * Unlike Copy, the returned packet can be handed over to another
+   * thread: the reference counts of the datasets shared by COW copies
+   * are not thread-safe. The copy keeps the uid of the original packet.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -530,6 +558,42 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing packets metadata, recorded compactly.
+   *
+   * Same as EnablePrinting, except that the packets record their
+   * headers and trailers in a small array rather than in the full
+   * metadata, which is reconstructed only when it is needed, for
+   * example by Print.  This lowers the cost of the metadata for the
+   * packets which are never printed, such as when the metadata is
+   * enabled by the helpers but only pcap traces are written.
+   *
+   * \sa PacketMetadata::EnableCompact
+   */
+  static void EnableCompactPrinting (void);
+
+  /**
+   * \brief Set how the metadata of this packet is recorded.
+   *
+   * This makes it possible to record the metadata of some flows
+   * only, without enabling it for all the packets with
+   * EnablePrinting: the mode is inherited by the copies and the
+   * fragments of the packet, so setting it on the packets of a flow
+   * when they are created is enough to print them anywhere in the
+   * simulation.  When the recording is started on a packet, its
+   * current content is recorded as payload.
+   *
+   * \param mode the new mode
+   *
+   * \sa PacketMetadata::SetMode
+   */
+  void SetMetadataMode (enum PacketMetadata::Mode mode);
+  /**
+   * \brief Get how the metadata of this packet is recorded.
+   *
+   * \returns the current mode
+   */
+  enum PacketMetadata::Mode GetMetadataMode (void) const;
 
   /**
    * \brief Returns number of bytes required for packet
@@ -787,7 +851,7 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
@@ -22,6 +22,11 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+#include "ns3/crc32.h"
+#include <cstring>
+#include <vector>
 
 using namespace ns3;
 
@@ -389,6 +394,415 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer storage pool tests.
+ */
+class BufferPoolTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferPoolTest ();
+private:
+  /**
+   * Create and release buffers of various sizes.
+   */
+  static void CreateBuffers (void);
+};
+
+BufferPoolTest::BufferPoolTest ()
+  : TestCase ("Buffer storage pool") {
+}
+
+void
+BufferPoolTest::CreateBuffers (void)
+{
+  // a mix of acknowledgments, regular and jumbo frames.
+  static const uint32_t sizes[] = {40, 1500, 9000, 60, 576, 40000, 1500, 40};
+  std::vector<Buffer> buffers;
+  for (uint32_t round = 0; round < 4; round++)
+    {
+      for (uint32_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+        {
+          Buffer buffer;
+          buffer.AddAtStart (sizes[i]);
+          buffers.push_back (buffer);
+        }
+    }
+}
+
+void
+BufferPoolTest::DoRun (void)
+{
+  Buffer::PurgePool ();
+  Buffer::PoolStats stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.blocks, 0, "Pool not purged");
+  NS_TEST_ASSERT_MSG_EQ (stats.bytes, 0, "Pool not purged");
+
+  // the first buffers are allocated by the system, their storage is
+  // then recycled whatever the mix of sizes.
+  CreateBuffers ();
+  stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_GT (stats.blocks, 0, "Storage not recycled");
+  NS_TEST_ASSERT_MSG_GT (stats.bytes, 0, "Storage not recycled");
+  uint64_t misses = stats.misses;
+  uint64_t hits = stats.hits;
+  CreateBuffers ();
+  stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, misses, "Storage allocated by the system");
+  NS_TEST_ASSERT_MSG_GT (stats.hits, hits, "Storage not reused");
+
+  // the storage released by a thread is reused by the other threads.
+  Buffer::PurgePool ();
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&BufferPoolTest::CreateBuffers));
+  thread->Start ();
+  thread->Join ();
+  stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_GT (stats.blocks, 0, "Storage of the thread not recycled");
+  misses = stats.misses;
+  CreateBuffers ();
+  stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, misses, "Storage of the thread not reused");
+
+  // large buffers are not pooled.
+  uint64_t blocks = stats.blocks;
+  {
+    Buffer buffer;
+    buffer.AddAtStart (100000);
+  }
+  stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.misses, misses + 1, "Large storage not allocated by the system");
+  NS_TEST_ASSERT_MSG_EQ (stats.blocks, blocks, "Large storage pooled");
+
+  Buffer::PurgePool ();
+  stats = Buffer::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.blocks, 0, "Pool not purged");
+  NS_TEST_ASSERT_MSG_EQ (stats.bytes, 0, "Pool not purged");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer zero-filled area tests.
+ */
+class BufferZeroAreaTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferZeroAreaTest ();
+private:
+  /**
+   * Create a buffer with a zero-filled area.
+   * \param start The size of the data before the zero area.
+   * \param zero The size of the zero area.
+   * \param end The size of the data after the zero area.
+   * \param value The value of the data bytes.
+   * \param expected The expected content, to which the content of
+   *        the buffer is appended.
+   * \returns The buffer.
+   */
+  static Buffer CreateBuffer (uint32_t start, uint32_t zero, uint32_t end,
+                              uint8_t value, std::vector<uint8_t> *expected);
+  /**
+   * Check the content of a buffer.
+   * \param buffer The buffer.
+   * \param expected The expected content.
+   * \returns \c true if the buffer holds the expected content.
+   */
+  static bool CheckContent (const Buffer &buffer, const std::vector<uint8_t> &expected);
+};
+
+BufferZeroAreaTest::BufferZeroAreaTest ()
+  : TestCase ("Buffer zero-filled areas") {
+}
+
+Buffer
+BufferZeroAreaTest::CreateBuffer (uint32_t start, uint32_t zero, uint32_t end,
+                                  uint8_t value, std::vector<uint8_t> *expected)
+{
+  Buffer buffer (zero);
+  buffer.AddAtStart (start);
+  buffer.Begin ().WriteU8 (value, start);
+  buffer.AddAtEnd (end);
+  Buffer::Iterator i = buffer.End ();
+  i.Prev (end);
+  i.WriteU8 (value + 1, end);
+  expected->insert (expected->end (), start, value);
+  expected->insert (expected->end (), zero, 0);
+  expected->insert (expected->end (), end, value + 1);
+  return buffer;
+}
+
+bool
+BufferZeroAreaTest::CheckContent (const Buffer &buffer, const std::vector<uint8_t> &expected)
+{
+  if (buffer.GetSize () != expected.size ())
+    {
+      return false;
+    }
+  std::vector<uint8_t> content (buffer.GetSize () + 1);
+  buffer.CopyData (&content[0], buffer.GetSize ());
+  content.resize (buffer.GetSize ());
+  return content == expected;
+}
+
+void
+BufferZeroAreaTest::DoRun (void)
+{
+  // {start, zero, end} of the first and second buffers, and the number
+  // of zero bytes written to memory by their concatenation.
+  static const uint32_t cases[][7] = {
+    {0, 1000, 0, 0, 500, 0, 0},       // adjacent zero areas
+    {20, 1000, 0, 0, 500, 8, 0},      // adjacent zero areas, trailing data
+    {20, 1000, 0, 8, 500, 0, 500},    // data between, keep the first zero area
+    {20, 1000, 4, 8, 500, 4, 500},
+    {20, 100, 4, 8, 1000, 4, 100},    // data between, keep the second zero area
+    {20, 0, 0, 8, 1000, 4, 0},        // the first buffer has no zero area
+    {20, 0, 4, 0, 1000, 0, 0},
+    {20, 1000, 4, 8, 0, 4, 0},        // the second buffer has no zero area
+    {20, 0, 4, 8, 0, 4, 0},           // no zero areas at all
+  };
+  for (uint32_t k = 0; k < sizeof (cases) / sizeof (cases[0]); k++)
+    {
+      const uint32_t *c = cases[k];
+      for (uint32_t shared = 0; shared < 2; shared++)
+        {
+          std::vector<uint8_t> expected;
+          Buffer a = CreateBuffer (c[0], c[1], c[2], 0x11, &expected);
+          std::vector<uint8_t> expectedA = expected;
+          Buffer b = CreateBuffer (c[3], c[4], c[5], 0x22, &expected);
+          // a copy shares the data of the first buffer.
+          Buffer copy = shared ? a : Buffer ();
+          a.AddAtEnd (b);
+          NS_TEST_EXPECT_MSG_EQ (CheckContent (a, expected), true, "Wrong content in case " << k);
+          NS_TEST_EXPECT_MSG_EQ (a.GetMaterializedSize (), c[6], "Wrong materialized size in case " << k);
+          if (shared)
+            {
+              NS_TEST_EXPECT_MSG_EQ (CheckContent (copy, expectedA), true, "Shared buffer modified in case " << k);
+            }
+          // the concatenated buffer still works as usual.
+          a.AddAtStart (2);
+          a.Begin ().WriteU8 (0x33, 2);
+          a.AddAtEnd (2);
+          Buffer::Iterator i = a.End ();
+          i.Prev (2);
+          i.WriteU8 (0x44, 2);
+          expected.insert (expected.begin (), 2, 0x33);
+          expected.insert (expected.end (), 2, 0x44);
+          NS_TEST_EXPECT_MSG_EQ (CheckContent (a, expected), true, "Wrong content after update in case " << k);
+        }
+    }
+
+  // the materialized size is kept through fragments, copies and
+  // further concatenations.
+  std::vector<uint8_t> expected;
+  Buffer a = CreateBuffer (20, 1000, 4, 0x11, &expected);
+  Buffer b = CreateBuffer (8, 500, 4, 0x22, &expected);
+  a.AddAtEnd (b);
+  Buffer fragment = a.CreateFragment (10, 1500);
+  NS_TEST_EXPECT_MSG_EQ (fragment.GetMaterializedSize (), 500, "Materialized size not kept by fragments");
+  Buffer c = CreateBuffer (8, 2000, 4, 0x33, &expected);
+  a.AddAtEnd (c);
+  NS_TEST_EXPECT_MSG_EQ (CheckContent (a, expected), true, "Wrong content");
+  NS_TEST_EXPECT_MSG_EQ (a.GetMaterializedSize (), 1500, "Wrong materialized size");
+  a.PeekData ();
+  NS_TEST_EXPECT_MSG_EQ (a.GetMaterializedSize (), 3500, "Wrong materialized size");
+  NS_TEST_EXPECT_MSG_EQ (CheckContent (a, expected), true, "Wrong content");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Internet checksum and CRC-32 tests.
+ */
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+private:
+  /**
+   * Compute the Internet checksum one byte at a time.
+   * \param data The data.
+   * \param size The size of the data.
+   * \param initial The initial checksum.
+   * \returns The checksum, as Buffer::Iterator::CalculateIpChecksum.
+   */
+  static uint16_t IpChecksum (const uint8_t *data, uint32_t size, uint32_t initial);
+  /**
+   * Compute the CRC-32 one byte at a time.
+   * \param data The data.
+   * \param size The size of the data.
+   * \returns The CRC-32.
+   */
+  static uint32_t Crc32 (const uint8_t *data, uint32_t size);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Internet checksum and CRC-32") {
+}
+
+uint16_t
+BufferChecksumTest::IpChecksum (const uint8_t *data, uint32_t size, uint32_t initial)
+{
+  uint32_t sum = initial;
+  for (uint32_t i = 0; i + 1 < size; i += 2)
+    {
+      sum += data[i] | (data[i + 1] << 8);
+    }
+  if (size & 1)
+    {
+      sum += data[size - 1];
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+uint32_t
+BufferChecksumTest::Crc32 (const uint8_t *data, uint32_t size)
+{
+  uint32_t crc = 0xffffffff;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      crc ^= data[i];
+      for (uint32_t bit = 0; bit < 8; bit++)
+        {
+          crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+  return ~crc;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  uint32_t seed = 1;
+  // buffers with data before and after a zero-filled area, summed from
+  // even and odd offsets, so that the spans of data start at both
+  // parities.
+  static const uint32_t sizes[] = {0, 1, 2, 7, 33, 64};
+  for (uint32_t a = 0; a < sizeof (sizes) / sizeof (sizes[0]); a++)
+    {
+      for (uint32_t z = 0; z < sizeof (sizes) / sizeof (sizes[0]); z++)
+        {
+          for (uint32_t b = 0; b < sizeof (sizes) / sizeof (sizes[0]); b++)
+            {
+              Buffer buffer (sizes[z]);
+              buffer.AddAtStart (sizes[a]);
+              buffer.AddAtEnd (sizes[b]);
+              Buffer::Iterator i = buffer.Begin ();
+              for (uint32_t j = 0; j < sizes[a]; j++)
+                {
+                  seed = seed * 1103515245 + 12345;
+                  i.WriteU8 (seed >> 16);
+                }
+              i = buffer.End ();
+              i.Prev (sizes[b]);
+              for (uint32_t j = 0; j < sizes[b]; j++)
+                {
+                  seed = seed * 1103515245 + 12345;
+                  i.WriteU8 (seed >> 16);
+                }
+              std::vector<uint8_t> data (buffer.GetSize () + 1);
+              buffer.CopyData (&data[0], buffer.GetSize ());
+              for (uint32_t start = 0; start < 4 && start <= buffer.GetSize (); start++)
+                {
+                  uint32_t size = buffer.GetSize () - start;
+                  i = buffer.Begin ();
+                  i.Next (start);
+                  uint16_t checksum = i.CalculateIpChecksum (size, 0x1234);
+                  NS_TEST_EXPECT_MSG_EQ (checksum, IpChecksum (&data[start], size, 0x1234),
+                                         "Wrong checksum of " << sizes[a] << "+" << sizes[z]
+                                         << "+" << sizes[b] << " bytes from " << start);
+                  NS_TEST_EXPECT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), buffer.GetSize (),
+                                         "Iterator not advanced");
+                }
+            }
+        }
+    }
+
+  // the check value of the CRC-32 and a long array, with all the
+  // alignments of its end.
+  const uint8_t check[] = "123456789";
+  NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (check, 9), 0xcbf43926, "Wrong CRC-32 check value");
+  std::vector<uint8_t> data (1500);
+  for (uint32_t j = 0; j < data.size (); j++)
+    {
+      seed = seed * 1103515245 + 12345;
+      data[j] = seed >> 16;
+    }
+  for (uint32_t size = data.size () - 9; size <= data.size (); size++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (&data[0], size), Crc32 (&data[0], size),
+                             "Wrong CRC-32 of " << size << " bytes");
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer::Iterator::WriteSpan and Buffer::Iterator::ReadSpan tests.
+ */
+class BufferSpanTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferSpanTest ();
+};
+
+BufferSpanTest::BufferSpanTest ()
+  : TestCase ("Buffer::Iterator WriteSpan and ReadSpan") {
+}
+
+void
+BufferSpanTest::DoRun (void)
+{
+  // 4 bytes of data, 4 zero bytes and 4 bytes of data
+  Buffer buffer (4);
+  buffer.AddAtStart (4);
+  buffer.AddAtEnd (4);
+  Buffer::Iterator i = buffer.Begin ();
+  uint8_t *span = i.WriteSpan (4);
+  for (uint32_t j = 0; j < 4; j++)
+    {
+      span[j] = j + 1;
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 4, "Iterator not advanced");
+  i.Next (4);
+  span = i.WriteSpan (4);
+  for (uint32_t j = 0; j < 4; j++)
+    {
+      span[j] = j + 9;
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, "Iterator not advanced");
+  uint8_t expected[] = {1, 2, 3, 4, 0, 0, 0, 0, 9, 10, 11, 12};
+  uint8_t content[12];
+  buffer.CopyData (content, 12);
+  NS_TEST_EXPECT_MSG_EQ (memcmp (content, expected, 12), 0, "Wrong content");
+
+  // spans before, across and after the zero-filled area
+  uint8_t scratch[12];
+  for (uint32_t start = 0; start < 12; start++)
+    {
+      for (uint32_t size = 0; start + size <= 12; size++)
+        {
+          i = buffer.Begin ();
+          i.Next (start);
+          const uint8_t *read = i.ReadSpan (size, scratch);
+          NS_TEST_EXPECT_MSG_EQ (memcmp (read, &expected[start], size), 0,
+                                 "Wrong span of " << size << " bytes from " << start);
+          NS_TEST_EXPECT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), start + size,
+                                 "Iterator not advanced");
+          NS_TEST_EXPECT_MSG_EQ ((read == scratch), (start < 8 && start + size > 4),
+                                 "Wrong span memory of " << size << " bytes from " << start);
+        }
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +819,10 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferPoolTest, TestCase::QUICK);
+  AddTestCase (new BufferZeroAreaTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
+  AddTestCase (new BufferSpanTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
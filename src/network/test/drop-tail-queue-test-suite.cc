@@ -19,6 +19,7 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/string.h"
+#include "ns3/boolean.h"
 
 using namespace ns3;
 
@@ -31,18 +32,27 @@ using namespace ns3;
 class DropTailQueueTestCase : public TestCase
 {
 public:
-  DropTailQueueTestCase ();
+  /**
+   * Constructor
+   * \param ring true to store the packets in a ring buffer
+   */
+  DropTailQueueTestCase (bool ring);
   virtual void DoRun (void);
+private:
+  bool m_ring; //!< true to store the packets in a ring buffer
 };
 
-DropTailQueueTestCase::DropTailQueueTestCase ()
-  : TestCase ("Sanity check on the drop tail queue implementation")
+DropTailQueueTestCase::DropTailQueueTestCase (bool ring)
+  : TestCase (std::string ("Sanity check on the drop tail queue implementation with a ")
+              + (ring ? "ring buffer" : "list")),
+    m_ring (ring)
 {
 }
 void
 DropTailQueueTestCase::DoRun (void)
 {
   Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetAttribute ("RingBuffer", BooleanValue (m_ring));
   NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxSize", StringValue ("3p")), true,
                          "Verify that we can actually set the attribute");
 
@@ -83,6 +93,79 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a DropTailQueue behaves the same with a ring buffer and
+ * with a list, across the growth and the wrap-around of the ring buffer.
+ */
+class DropTailQueueRingBufferTestCase : public TestCase
+{
+public:
+  DropTailQueueRingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueRingBufferTestCase::DropTailQueueRingBufferTestCase ()
+  : TestCase ("Drop tail queue with a ring buffer and with a list")
+{
+}
+
+void
+DropTailQueueRingBufferTestCase::DoRun (void)
+{
+  const char *sizes[] = {"5p", "40p", "3000B"};
+  for (uint32_t k = 0; k < 3; k++)
+    {
+      Ptr<DropTailQueue<Packet> > list = CreateObject<DropTailQueue<Packet> > ();
+      list->SetAttribute ("RingBuffer", BooleanValue (false));
+      list->SetAttribute ("MaxSize", StringValue (sizes[k]));
+      Ptr<DropTailQueue<Packet> > ring = CreateObject<DropTailQueue<Packet> > ();
+      ring->SetAttribute ("MaxSize", StringValue (sizes[k]));
+
+      uint32_t seed = 1;
+      for (uint32_t i = 0; i < 2000; i++)
+        {
+          seed = seed * 1103515245 + 12345;
+          uint32_t op = (seed >> 16) % 8;
+          if (op < 4)
+            {
+              Ptr<Packet> p = Create<Packet> (10 + (seed >> 8) % 100);
+              NS_TEST_EXPECT_MSG_EQ (ring->Enqueue (p), list->Enqueue (p),
+                                     "Different enqueue result at step " << i);
+            }
+          else if (op < 6)
+            {
+              Ptr<Packet> a = ring->Dequeue ();
+              Ptr<Packet> b = list->Dequeue ();
+              NS_TEST_EXPECT_MSG_EQ (a, b, "Different packet dequeued at step " << i);
+            }
+          else if (op < 7)
+            {
+              Ptr<const Packet> a = ring->Peek ();
+              Ptr<const Packet> b = list->Peek ();
+              NS_TEST_EXPECT_MSG_EQ (a, b, "Different packet peeked at step " << i);
+            }
+          else
+            {
+              Ptr<Packet> a = ring->Remove ();
+              Ptr<Packet> b = list->Remove ();
+              NS_TEST_EXPECT_MSG_EQ (a, b, "Different packet removed at step " << i);
+            }
+          NS_TEST_EXPECT_MSG_EQ (ring->GetNPackets (), list->GetNPackets (),
+                                 "Different number of packets at step " << i);
+          NS_TEST_EXPECT_MSG_EQ (ring->GetNBytes (), list->GetNBytes (),
+                                 "Different number of bytes at step " << i);
+        }
+      NS_TEST_EXPECT_MSG_EQ (ring->GetTotalDroppedPackets (), list->GetTotalDroppedPackets (),
+                             "Different number of dropped packets");
+      ring->Flush ();
+      NS_TEST_EXPECT_MSG_EQ (ring->IsEmpty (), true, "Queue not flushed");
+      NS_TEST_EXPECT_MSG_EQ ((ring->Dequeue () == 0), true, "Packet dequeued from an empty queue");
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -95,7 +178,9 @@ public:
   DropTailQueueTestSuite ()
     : TestSuite ("drop-tail-queue", UNIT)
   {
-    AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueTestCase (false), TestCase::QUICK);
+    AddTestCase (new DropTailQueueTestCase (true), TestCase::QUICK);
+    AddTestCase (new DropTailQueueRingBufferTestCase (), TestCase::QUICK);
   }
 };
 
@@ -330,6 +330,12 @@ public:
    */
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  /**
+   * Constructor
+   * \param name The test case name
+   */
+  PacketMetadataTest (std::string name);
 private:
   /**
    * Adds an header to the packet
@@ -344,6 +350,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -902,6 +913,123 @@ PacketMetadataTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Metadata modes unit tests.
+ */
+class PacketMetadataModeTest : public PacketMetadataTest {
+public:
+  PacketMetadataModeTest ();
+  virtual void DoRun (void);
+};
+
+PacketMetadataModeTest::PacketMetadataModeTest ()
+  : PacketMetadataTest ("Packet metadata modes")
+{
+}
+
+void
+PacketMetadataModeTest::DoRun (void)
+{
+  PacketMetadata::Enable ();
+
+  // the compact mode records the headers and trailers without
+  // reconstructing the items.
+  Ptr<Packet> p = Create<Packet> (10);
+  p->SetMetadataMode (PacketMetadata::COMPACT);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::COMPACT, "Could not compact the metadata");
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_TRAILER (p, 4);
+  ADD_TRAILER (p, 5);
+  REM_HEADER (p, 3);
+  REM_TRAILER (p, 5);
+  Ptr<Packet> p1 = p->Copy ();
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::COMPACT, "Unexpected reconstruction");
+  NS_TEST_EXPECT_MSG_EQ (p1->GetMetadataMode (), PacketMetadata::COMPACT, "Mode not inherited by the copy");
+  CHECK_HISTORY (p, 4,
+                 2, 1, 10, 4);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::COMPACT, "Items reconstructed to be printed");
+  NS_TEST_EXPECT_MSG_EQ (p1->GetMetadataMode (), PacketMetadata::COMPACT, "Unexpected reconstruction");
+  ADD_HEADER (p1, 6);
+  CHECK_HISTORY (p1, 5,
+                 6, 2, 1, 10, 4);
+  CHECK_HISTORY (p, 4,
+                 2, 1, 10, 4);
+  p->SetMetadataMode (PacketMetadata::FULL);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::FULL, "Items not reconstructed");
+  CHECK_HISTORY (p, 4,
+                 2, 1, 10, 4);
+  p->SetMetadataMode (PacketMetadata::COMPACT);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::COMPACT, "Could not compact the metadata");
+  CHECK_HISTORY (p, 4,
+                 2, 1, 10, 4);
+
+  // more headers than the array can hold.
+  p = Create<Packet> (10);
+  p->SetMetadataMode (PacketMetadata::COMPACT);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  ADD_HEADER (p, 4);
+  ADD_TRAILER (p, 5);
+  ADD_TRAILER (p, 6);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::COMPACT, "Unexpected reconstruction");
+  ADD_HEADER (p, 7);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::FULL, "Items not reconstructed");
+  REM_HEADER (p, 7);
+  CHECK_HISTORY (p, 7,
+                 4, 3, 2, 1, 10, 5, 6);
+
+  // the fragments of two copies of a header are merged.
+  p = Create<Packet> (10);
+  p->SetMetadataMode (PacketMetadata::COMPACT);
+  ADD_HEADER (p, 10);
+  p1 = p->Copy ();
+  Ptr<Packet> p2 = p->CreateFragment (0, 5);
+  Ptr<Packet> p3 = p1->CreateFragment (5, 15);
+  NS_TEST_EXPECT_MSG_EQ (p->GetMetadataMode (), PacketMetadata::COMPACT, "Unexpected reconstruction");
+  CHECK_HISTORY (p2, 1, 5);
+  p2->AddAtEnd (p3);
+  CHECK_HISTORY (p2, 2, 10, 10);
+  p3->SetMetadataMode (PacketMetadata::COMPACT);
+  NS_TEST_EXPECT_MSG_EQ (p3->GetMetadataMode (), PacketMetadata::FULL, "Fragments cannot be compacted");
+  p2->SetMetadataMode (PacketMetadata::COMPACT);
+  NS_TEST_EXPECT_MSG_EQ (p2->GetMetadataMode (), PacketMetadata::COMPACT, "Could not compact the reassembled packet");
+  CHECK_HISTORY (p2, 2, 10, 10);
+
+  // the copies of an empty packet do not share their items.
+  p = Create<Packet> ();
+  p1 = p->Copy ();
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p1, 2);
+  CHECK_HISTORY (p, 1, 1);
+  CHECK_HISTORY (p1, 1, 2);
+  p = Create<Packet> ();
+  p->SetMetadataMode (PacketMetadata::COMPACT);
+  p1 = p->Copy ();
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p1, 2);
+  CHECK_HISTORY (p, 1, 1);
+  CHECK_HISTORY (p1, 1, 2);
+
+  // the metadata of a single packet.
+  p = Create<Packet> (10);
+  p->SetMetadataMode (PacketMetadata::DISABLED);
+  ADD_HEADER (p, 1);
+  CHECK_HISTORY (p, 0);
+  p->SetMetadataMode (PacketMetadata::COMPACT);
+  ADD_HEADER (p, 2);
+  CHECK_HISTORY (p, 2, 2, 11);
+  p1 = Create<Packet> (5);
+  p1->SetMetadataMode (PacketMetadata::DISABLED);
+  p->AddAtEnd (p1);
+  CHECK_HISTORY (p, 3, 2, 11, 5);
+}
+
 
 /**
  * \ingroup network-test
@@ -919,6 +1047,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataModeTest, TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <set>
 
 using namespace ns3;
 
@@ -994,6 +995,76 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Inline and spilled tags
+    std::cout << GetName () << "check inline and spilled tags" << std::endl;
+    t1.m_data = 1;        // reset by the Replace checks
+    t2.m_data = 1;
+    t3.m_data = 1;
+    ATestTag<30> s1 (1);  // too large to fit with t1, t2, t3
+    ATestTag<31> s2 (1);
+    PacketTagList mix;
+    mix.Add (t1);
+    mix.Add (t2);
+    mix.Add (t3);
+    mix.Add (s1);
+    mix.Add (s2);
+    PacketTagList cpy = mix;
+
+    std::set<uint16_t> uids;
+    uint32_t n = 0;
+    for (PacketTagList::Iterator i = cpy.Begin (); i.HasNext (); ++n)
+      {
+        uids.insert (i.Next ().tid.GetUid ());
+      }
+    NS_TEST_EXPECT_MSG_EQ (n, 5, "iteration over inline and spilled tags");
+    NS_TEST_EXPECT_MSG_EQ (uids.count (t1.GetTypeId ().GetUid ()), 1, "iterate t1");
+    NS_TEST_EXPECT_MSG_EQ (uids.count (s2.GetTypeId ().GetUid ()), 1, "iterate s2");
+
+    cpy.Remove (t2);
+    cpy.Remove (s1);
+    const char * msg = "mixed remove";
+    CheckRef (cpy, t1, msg, false);
+    CheckRef (cpy, t2, msg, true);
+    CheckRef (cpy, t3, msg, false);
+    CheckRef (cpy, s1, msg, true);
+    CheckRef (cpy, s2, msg, false);
+    msg = "mixed remove orig";
+    CheckRef (mix, t2, msg, false);
+    CheckRef (mix, s1, msg, false);
+
+    cpy = mix;
+    t3.m_data = 3;
+    s2.m_data = 3;
+    cpy.Replace (t3);
+    cpy.Replace (s2);
+    msg = "mixed replace";
+    CheckRef (cpy, t3, msg, false);
+    CheckRef (cpy, s2, msg, false);
+    t3.m_data = 1;
+    s2.m_data = 1;
+    msg = "mixed replace orig";
+    CheckRef (mix, t3, msg, false);
+    CheckRef (mix, s2, msg, false);
+
+    // an inline tag removed from a full inline array leaves room for
+    // a spilled tag to be added back inline
+    cpy = mix;
+    cpy.Remove (s1);
+    cpy.Remove (t1);
+    cpy.Remove (t2);
+    cpy.Remove (t3);
+    cpy.Add (s1);
+    msg = "re-add";
+    CheckRef (cpy, s1, msg, false);
+    CheckRef (cpy, s2, msg, false);
+    CheckRef (cpy, t1, msg, true);
+
+    cpy.RemoveAll ();
+    NS_TEST_EXPECT_MSG_EQ (cpy.Begin ().HasNext (), false, "RemoveAll");
+    CheckRef (cpy, s2, "RemoveAll", true);
+    CheckRef (mix, s2, "RemoveAll orig", false);
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
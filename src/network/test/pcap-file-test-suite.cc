@@ -21,6 +21,8 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <vector>
+#include <algorithm>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
@@ -1144,6 +1146,165 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the Pcap File Object can write and
+ * read back pcapng and compressed files.
+ */
+class PcapNgTestCase : public TestCase
+{
+public:
+  PcapNgTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Copy the packets of known.pcap to a new file.
+   * \param filename The name of the new file.
+   * \param snapLen The snap length of the new file.
+   * \param swapMode Whether the new file is byte-swapped.
+   * \param nanosecMode Whether the timestamps of the new file are in nanoseconds.
+   * \param ngMode Whether the new file is in the pcapng format.
+   */
+  void Copy (std::string filename, uint32_t snapLen, bool swapMode, bool nanosecMode, bool ngMode);
+};
+
+PcapNgTestCase::PcapNgTestCase ()
+  : TestCase ("Check to see that PcapFile can write and read pcapng and compressed files")
+{
+}
+
+void
+PcapNgTestCase::Copy (std::string filename, uint32_t snapLen, bool swapMode, bool nanosecMode, bool ngMode)
+{
+  PcapFile in, out;
+  in.Open (CreateDataDirFilename ("known.pcap"), std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Open (known.pcap, \"std::ios::in\") returns error");
+  out.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  out.Init (in.GetDataLinkType (), snapLen, PcapFile::ZONE_DEFAULT, swapMode, nanosecMode, ngMode);
+  NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Init () returns error");
+
+  uint8_t data[2000];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      in.Read (data, sizeof(data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Read() of known good pcap file returns error");
+      out.Write (tsSec, nanosecMode ? tsUsec * 1000 : tsUsec, data, origLen);
+      NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Write must not fail");
+    }
+  out.Close ();
+  NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Close must not fail");
+}
+
+void
+PcapNgTestCase::DoRun (void)
+{
+  std::string known = CreateDataDirFilename ("known.pcap");
+  uint32_t sec, usec, packets;
+
+  //
+  // A pcapng copy of known.pcap, in either byte order and compressed or
+  // not, must read the same as known.pcap.
+  //
+  std::vector<std::string> suffixes;
+  suffixes.push_back (".pcapng");
+  if (PcapFile::IsCompressionSupported ())
+    {
+      suffixes.push_back (".pcapng.gz");
+      suffixes.push_back (".pcap.gz");
+    }
+  for (std::size_t i = 0; i < suffixes.size (); ++i)
+    {
+      for (uint32_t swap = 0; swap < 2; ++swap)
+        {
+          std::string filename = CreateTempDirFilename ("copy" + suffixes[i]);
+          bool ngMode = suffixes[i] != ".pcap.gz";
+          Copy (filename, PcapFile::SNAPLEN_DEFAULT, swap, false, ngMode);
+
+          PcapFile f;
+          f.Open (filename, std::ios::in);
+          NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+          NS_TEST_EXPECT_MSG_EQ (f.IsNgMode (), ngMode, "Wrong format read from " << filename);
+          NS_TEST_EXPECT_MSG_EQ (f.GetSwapMode (), swap, "Wrong byte order read from " << filename);
+          NS_TEST_EXPECT_MSG_EQ (f.GetDataLinkType (), 1, "Wrong data link type read from " << filename);
+          f.Close ();
+
+          packets = 0;
+          bool diff = PcapFile::Diff (known, filename, sec, usec, packets);
+          NS_TEST_EXPECT_MSG_EQ (diff, false, "PcapDiff(known.pcap, " << filename << ") must be false");
+          NS_TEST_EXPECT_MSG_EQ (packets, N_KNOWN_PACKETS, "Wrong number of packets compared");
+          remove (filename.c_str ());
+        }
+    }
+
+  //
+  // Nanosecond timestamps are written with an interface option, and the
+  // records of a pcapng file are truncated to the snap length.
+  //
+  std::string filename = CreateTempDirFilename ("truncated.pcapng");
+  Copy (filename, 40, false, true, true);
+  PcapFile f;
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  NS_TEST_EXPECT_MSG_EQ (f.IsNanoSecMode (), true, "Nanosecond resolution not read");
+  NS_TEST_EXPECT_MSG_EQ (f.GetSnapLen (), 40, "Wrong snap length read");
+
+  uint8_t data[N_PACKET_BYTES];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+
+      f.Read (data, sizeof(data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read() of pcapng file returns error");
+      NS_TEST_ASSERT_MSG_EQ (tsSec, p.tsSec, "Incorrectly read seconds timestamp");
+      NS_TEST_ASSERT_MSG_EQ (tsUsec, p.tsUsec * 1000, "Incorrectly read nanoseconds timestamp");
+      NS_TEST_ASSERT_MSG_EQ (inclLen, std::min<uint32_t> (p.inclLen, 40), "Packet not truncated to the snap length");
+      NS_TEST_ASSERT_MSG_EQ (origLen, p.origLen, "Incorrectly read original length");
+      NS_TEST_ASSERT_MSG_EQ (readLen, N_PACKET_BYTES, "Incorrect actual read length given buffer size");
+    }
+  f.Read (data, 1, tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_ASSERT_MSG_EQ (f.Eof (), true, "Read() of pcapng file at EOF does not return error");
+  f.Close ();
+  remove (filename.c_str ());
+
+  //
+  // A block with an invalid length is not read as a packet.
+  //
+  filename = CreateTempDirFilename ("malformed.pcapng");
+  f.Clear ();
+  f.Open (filename, std::ios::out);
+  f.Init (1, 65535, 0, false, false, true);
+  f.Close ();
+  FILE *p = std::fopen (filename.c_str (), "ab");
+  NS_TEST_ASSERT_MSG_NE (p, 0, "fopen(" << filename << ") should have been able to open a correctly named file");
+  uint32_t block[] = { 3, 10, 0, 0, 0, 0, 0, 0, 0, 0 };
+  std::fwrite (block, sizeof (block), 1, p);
+  std::fclose (p);
+  f.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::in\") returns error");
+  f.Read (data, sizeof(data), tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), true, "Read() of a block with an invalid length does not return error");
+  NS_TEST_EXPECT_MSG_EQ (f.Eof (), false, "Read() of a block with an invalid length returns end of file");
+  f.Close ();
+  f.Clear ();
+  remove (filename.c_str ());
+
+  if (!PcapFile::IsCompressionSupported ())
+    {
+      filename = CreateTempDirFilename ("copy.pcap.gz");
+      f.Open (filename, std::ios::out);
+      NS_TEST_EXPECT_MSG_EQ (f.Fail (), true, "Compressed file created without compression support");
+      f.Close ();
+      remove (filename.c_str ());
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1328,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/packet-burst.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief SimpleNetDevice::SendBatch test.
+ *
+ * Send a burst of packets with SendBatch and with one Send per packet,
+ * and check that the receiver gets the same packets at the same time,
+ * with fewer events when the burst is delivered at once.  Also check
+ * that a burst goes through a receive callback set on the device after
+ * it was added to its node.
+ */
+class SimpleNetDeviceBatchTest : public TestCase
+{
+public:
+  SimpleNetDeviceBatchTest ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a burst of packets.
+   * \param device The sending device.
+   * \param batch Whether to send the burst with SendBatch.
+   */
+  void Send (Ptr<NetDevice> device, bool batch);
+  /**
+   * Receive a packet.
+   * \param device The receiving device.
+   * \param packet The packet.
+   * \param protocol The protocol number.
+   * \param from The sender address.
+   * \param to The destination address.
+   * \param packetType The packet type.
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * Receive a packet through the receive callback of the device.
+   * \param device The receiving device.
+   * \param packet The packet.
+   * \param protocol The protocol number.
+   * \param from The sender address.
+   * \returns true.
+   */
+  bool ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                          const Address &from);
+  /**
+   * Run a simulation.
+   * \param batch Whether to send the burst with SendBatch.
+   * \param callback Whether to receive the packets through the receive
+   *        callback of the device rather than through the node.
+   * \returns The number of events executed.
+   */
+  uint64_t Run (bool batch, bool callback);
+
+  std::vector<uint32_t> m_sizes; //!< Sizes of the received packets.
+  std::vector<Time> m_times;     //!< Reception times of the packets.
+};
+
+SimpleNetDeviceBatchTest::SimpleNetDeviceBatchTest ()
+  : TestCase ("SimpleNetDevice SendBatch")
+{
+}
+
+void
+SimpleNetDeviceBatchTest::Send (Ptr<NetDevice> device, bool batch)
+{
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      burst->AddPacket (Create<Packet> (100 * i));
+    }
+  if (batch)
+    {
+      NS_TEST_EXPECT_MSG_EQ (device->SendBatch (burst, device->GetBroadcast (), 0x800), true,
+                             "Burst not sent");
+    }
+  else
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (device->Send (*i, device->GetBroadcast (), 0x800), true,
+                                 "Packet not sent");
+        }
+    }
+}
+
+void
+SimpleNetDeviceBatchTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                   const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  NS_TEST_EXPECT_MSG_EQ (protocol, 0x800, "Wrong protocol");
+  m_sizes.push_back (packet->GetSize ());
+  m_times.push_back (Simulator::Now ());
+}
+
+bool
+SimpleNetDeviceBatchTest::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                             uint16_t protocol, const Address &from)
+{
+  Receive (device, packet, protocol, from, device->GetBroadcast (), NetDevice::PACKET_BROADCAST);
+  return true;
+}
+
+uint64_t
+SimpleNetDeviceBatchTest::Run (bool batch, bool callback)
+{
+  m_sizes.clear ();
+  m_times.clear ();
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper helper;
+  helper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2)));
+  NetDeviceContainer devices = helper.Install (nodes);
+  if (callback)
+    {
+      devices.Get (1)->SetReceiveCallback (MakeCallback (&SimpleNetDeviceBatchTest::ReceiveFromDevice, this));
+    }
+  else
+    {
+      nodes.Get (1)->RegisterProtocolHandler (MakeCallback (&SimpleNetDeviceBatchTest::Receive, this),
+                                              0x800, devices.Get (1));
+    }
+  Simulator::Schedule (Seconds (1), &SimpleNetDeviceBatchTest::Send, this, devices.Get (0), batch);
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+SimpleNetDeviceBatchTest::DoRun (void)
+{
+  uint64_t eventsOne = Run (false, false);
+  std::vector<uint32_t> sizes = m_sizes;
+  std::vector<Time> times = m_times;
+  uint64_t eventsBatch = Run (true, false);
+
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 4, "Wrong number of packets received");
+  NS_TEST_ASSERT_MSG_EQ (sizes.size (), 4, "Wrong number of packets received");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], sizes[i], "Packet " << i << " received out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], times[i], "Packet " << i << " received at the wrong time");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_times[0], MilliSeconds (1002), "Wrong delay");
+  NS_TEST_EXPECT_MSG_LT (eventsBatch, eventsOne, "The burst was not delivered at once");
+
+  Run (true, true);
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 4, "The burst bypassed the receive callback");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], sizes[i], "Packet " << i << " received out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], times[i], "Packet " << i << " received at the wrong time");
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief SimpleNetDevice TestSuite
+ */
+class SimpleNetDeviceTestSuite : public TestSuite
+{
+public:
+  SimpleNetDeviceTestSuite ();
+};
+
+SimpleNetDeviceTestSuite::SimpleNetDeviceTestSuite ()
+  : TestSuite ("simple-net-device", UNIT)
+{
+  AddTestCase (new SimpleNetDeviceBatchTest, TestCase::QUICK);
+}
+
+static SimpleNetDeviceTestSuite g_simpleNetDeviceTestSuite; //!< Static variable for test initialization
@@ -67,12 +67,54 @@ static uint32_t crc32table[256] = {
 0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D 
 };
 
+/**
+ * Tables of CRC-32 values for the slicing-by-8 algorithm: table[k][i]
+ * is the CRC of byte i followed by k zero bytes, so that eight bytes
+ * of input are processed with eight independent lookups.
+ */
+struct Crc32Tables
+{
+  /** Build the tables from crc32table. */
+  Crc32Tables ()
+  {
+    for (uint32_t i = 0; i < 256; i++)
+      {
+        table[0][i] = crc32table[i];
+      }
+    for (uint32_t k = 1; k < 8; k++)
+      {
+        for (uint32_t i = 0; i < 256; i++)
+          {
+            uint32_t prev = table[k - 1][i];
+            table[k][i] = (prev >> 8) ^ crc32table[prev & 0xff];
+          }
+      }
+  }
+  uint32_t table[8][256]; //!< The tables.
+};
+
 uint32_t
 CRC32Calculate (const uint8_t *data, int length)
 {
+  // built on first use, in case of a call during static initialization
+  static const struct Crc32Tables tables;
+  const uint32_t (*t)[256] = tables.table;
   uint32_t crc = 0xffffffff;
 
-  while (length--)
+  while (length >= 8)
+    {
+      uint32_t one = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16)
+                            | (static_cast<uint32_t> (data[3]) << 24));
+      uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16)
+        | (static_cast<uint32_t> (data[7]) << 24);
+      crc = t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff]
+        ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24]
+        ^ t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff]
+        ^ t[1][(two >> 16) & 0xff] ^ t[0][two >> 24];
+      data += 8;
+      length -= 8;
+    }
+  while (length-- > 0)
     {
       crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
     }
@@ -20,6 +20,7 @@
 #define DROPTAIL_H
 
 #include "ns3/queue.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -27,6 +28,11 @@ namespace ns3 {
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * By default, the packets are stored in a ring buffer, so that a queue
+ * which has reached its working size no longer allocates memory per
+ * packet.  Setting the RingBuffer attribute to false stores them in a
+ * list, as the other queues do.
  */
 template <typename Item>
 class DropTailQueue : public Queue<Item>
@@ -52,12 +58,23 @@ public:
   virtual Ptr<const Item> Peek (void) const;
 
 private:
-  using Queue<Item>::begin;
-  using Queue<Item>::end;
+  /**
+   * \brief Select the storage of the packets
+   * \param enable true to store the packets in a ring buffer
+   */
+  void SetRingBuffer (bool enable);
+  /**
+   * \brief Get the storage of the packets
+   * \return true if the packets are stored in a ring buffer
+   */
+  bool GetRingBuffer (void) const;
+
   using Queue<Item>::DoEnqueue;
   using Queue<Item>::DoDequeue;
   using Queue<Item>::DoRemove;
   using Queue<Item>::DoPeek;
+  using Queue<Item>::UseRingBuffer;
+  using Queue<Item>::IsRingBuffer;
 
   NS_LOG_TEMPLATE_DECLARE;     //!< redefinition of the log component
 };
@@ -75,6 +92,13 @@ DropTailQueue<Item>::GetTypeId (void)
     .SetParent<Queue<Item> > ()
     .SetGroupName ("Network")
     .template AddConstructor<DropTailQueue<Item> > ()
+    .AddAttribute ("RingBuffer",
+                   "Whether the packets are stored in a ring buffer rather than in a list. "
+                   "It can only be changed while the queue is empty.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DropTailQueue<Item>::SetRingBuffer,
+                                        &DropTailQueue<Item>::GetRingBuffer),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -99,7 +123,7 @@ DropTailQueue<Item>::Enqueue (Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  return DoEnqueue (end (), item);
+  return DoEnqueue (item);
 }
 
 template <typename Item>
@@ -108,7 +132,7 @@ DropTailQueue<Item>::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoDequeue (begin ());
+  Ptr<Item> item = DoDequeue ();
 
   NS_LOG_LOGIC ("Popped " << item);
 
@@ -121,20 +145,35 @@ DropTailQueue<Item>::Remove (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoRemove (begin ());
+  Ptr<Item> item = DoRemove ();
 
   NS_LOG_LOGIC ("Removed " << item);
 
   return item;
 }
 
+template <typename Item>
+void
+DropTailQueue<Item>::SetRingBuffer (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  UseRingBuffer (enable);
+}
+
+template <typename Item>
+bool
+DropTailQueue<Item>::GetRingBuffer (void) const
+{
+  return IsRingBuffer ();
+}
+
 template <typename Item>
 Ptr<const Item>
 DropTailQueue<Item>::Peek (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  return DoPeek (begin ());
+  return DoPeek ();
 }
 
 // The following explicit template instantiation declarations prevent all the
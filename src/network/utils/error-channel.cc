@@ -21,6 +21,7 @@
 #include "ns3/simple-net-device.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "error-channel.h"
@@ -129,6 +130,19 @@ ErrorChannel::Send (Ptr<Packet> p, uint16_t protocol,
     }
 }
 
+void
+ErrorChannel::SendBatch (Ptr<PacketBurst> burst, uint16_t protocol,
+                         Mac48Address to, Mac48Address from,
+                         Ptr<SimpleNetDevice> sender)
+{
+  NS_LOG_FUNCTION (burst << protocol << to << from << sender);
+  // the packets are delayed and duplicated one at a time
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      Send (*i, protocol, to, from, sender);
+    }
+}
+
 void
 ErrorChannel::Add (Ptr<SimpleNetDevice> device)
 {
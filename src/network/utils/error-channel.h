@@ -49,6 +49,8 @@ public:
   // inherited from ns3::SimpleChannel
   virtual void Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
                      Ptr<SimpleNetDevice> sender);
+  virtual void SendBatch (Ptr<PacketBurst> burst, uint16_t protocol, Mac48Address to, Mac48Address from,
+                          Ptr<SimpleNetDevice> sender);
 
   virtual void Add (Ptr<SimpleNetDevice> device);
 
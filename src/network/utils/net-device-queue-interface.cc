@@ -43,6 +43,7 @@ NetDeviceQueue::~NetDeviceQueue ()
 
   m_queueLimits = 0;
   m_wakeCallback.Nullify ();
+  m_availablePackets.Nullify ();
   m_device = 0;
 }
 
@@ -53,6 +54,17 @@ NetDeviceQueue::IsStopped (void) const
   return m_stoppedByDevice || m_stoppedByQueueLimits;
 }
 
+uint32_t
+NetDeviceQueue::GetAvailablePackets (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_availablePackets.IsNull ())
+    {
+      return 0;
+    }
+  return m_availablePackets ();
+}
+
 void
 NetDeviceQueue::Start (void)
 {
@@ -27,6 +27,7 @@
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/net-device.h"
+#include "ns3/queue-size.h"
 
 namespace ns3 {
 
@@ -86,6 +87,21 @@ public:
    */
   bool IsStopped (void) const;
 
+  /**
+   * \brief Get the number of packets which can be sent to the device
+   *        before this transmission queue may be stopped.
+   * \return the number of packets, zero if it is unknown.
+   *
+   * Called by queue discs to hand several packets to the device at once:
+   * this transmission queue is not stopped by the given number of packets
+   * whatever their size, so that the next packet is sent to the device as
+   * if they were sent one at a time.  The number is only known if the
+   * traces of the device queue are connected with ConnectQueueTraces, if
+   * the size of the device queue is measured in packets, and if no queue
+   * limits are set.
+   */
+  uint32_t GetAvailablePackets (void) const;
+
   /**
    * \brief Notify this NetDeviceQueue that the NetDeviceQueueInterface was
    *        aggregated to an object.
@@ -197,11 +213,22 @@ public:
   void ConnectQueueTraces (Ptr<QueueType> queue);
 
 private:
+  /**
+   * \brief Get the number of packets which can be enqueued in the queue
+   *        of a netdevice before PacketEnqueued stops this queue
+   *
+   * \param queue the device queue
+   * \return the number of packets, zero if it is unknown
+   */
+  template <typename QueueType>
+  uint32_t GetQueueAvailablePackets (QueueType* queue) const;
+
   bool m_stoppedByDevice;         //!< True if the queue has been stopped by the device
   bool m_stoppedByQueueLimits;    //!< True if the queue has been stopped by a queue limits object
   Ptr<QueueLimits> m_queueLimits; //!< Queue limits object
   WakeCallback m_wakeCallback;    //!< Wake callback
   Ptr<NetDevice> m_device;        //!< the netdevice aggregated to the NetDeviceQueueInterface
+  Callback<uint32_t> m_availablePackets; //!< GetQueueAvailablePackets bound to the device queue
 
   NS_LOG_TEMPLATE_DECLARE;        //!< redefinition of the log component
 };
@@ -317,6 +344,29 @@ NetDeviceQueue::ConnectQueueTraces (Ptr<QueueType> queue)
   queue->TraceConnectWithoutContext ("DropBeforeEnqueue",
                                      MakeCallback (&NetDeviceQueue::PacketDiscarded<QueueType>, this)
                                      .Bind (PeekPointer (queue)));
+  m_availablePackets = MakeCallback (&NetDeviceQueue::GetQueueAvailablePackets<QueueType>, this)
+                       .Bind (PeekPointer (queue));
+}
+
+template <typename QueueType>
+uint32_t
+NetDeviceQueue::GetQueueAvailablePackets (QueueType* queue) const
+{
+  NS_LOG_FUNCTION (this << queue);
+
+  QueueSize current = queue->GetCurrentSize ();
+  QueueSize max = queue->GetMaxSize ();
+  if (m_queueLimits || max.GetUnit () != QueueSizeUnit::PACKETS)
+    {
+      return 0;
+    }
+  // PacketEnqueued stops this queue once the device queue cannot
+  // store another packet
+  if (current.GetValue () + 1 >= max.GetValue ())
+    {
+      return 0;
+    }
+  return max.GetValue () - current.GetValue () - 1;
 }
 
 template <typename QueueType>
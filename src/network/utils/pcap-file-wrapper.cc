@@ -46,6 +46,17 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("PcapNg",
+                   "Whether the file is written in the pcapng format rather than in the classic pcap format(default).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_ngMode),
+                   MakeBooleanChecker())
+    .AddAttribute ("Compress",
+                   "Whether the file is compressed with gzip, in which case the .gz suffix is "
+                   "appended to its name if missing. Requires ns-3 to be built with zlib.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_compress),
+                   MakeBooleanChecker())
   ;
   return tid;
 }
@@ -93,6 +104,14 @@ void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  std::string suffix = ".gz";
+  if (m_compress && (mode & std::ios::out) && !(mode & std::ios::in)
+      && (filename.size () < suffix.size ()
+          || filename.compare (filename.size () - suffix.size (), suffix.size (), suffix) != 0))
+    {
+      m_file.Open (filename + suffix, mode);
+      return;
+    }
   m_file.Open (filename, mode);
 }
 
@@ -107,11 +126,11 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
-      m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
+      m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode, m_ngMode);
     } 
   else
     {
-      m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
+      m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode, m_ngMode);
     } 
 }
 
@@ -70,6 +70,9 @@ public:
    * selected as a binary file (fstream::binary is automatically ored with the mode
    * field).
    *
+   * If the Compress attribute is set, a file created for writing gets the
+   * ".gz" suffix, if missing, and is compressed with gzip.
+   *
    * \param filename String containing the name of the file.
    *
    * \param mode String containing the access mode for the file.
@@ -224,6 +227,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_ngMode; //!< File in the pcapng format
+  bool     m_compress; //!< File compressed with gzip
 };
 
 } // namespace ns3
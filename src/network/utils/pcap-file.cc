@@ -28,7 +28,10 @@
 #include "ns3/buffer.h"
 #include "pcap-file.h"
 #include "ns3/log.h"
-#include "ns3/build-profile.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,10 +50,294 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+const uint32_t NG_SECTION_HEADER = 0x0a0d0d0a;    /**< Type of the pcapng section header block, used as magic number */
+const uint32_t NG_INTERFACE_DESCRIPTION = 1;      /**< Type of the pcapng interface description block */
+const uint32_t NG_ENHANCED_PACKET = 6;            /**< Type of the pcapng enhanced packet block */
+const uint32_t NG_BYTE_ORDER_MAGIC = 0x1a2b3c4d;  /**< Byte order magic of the pcapng section header block */
+const uint16_t NG_VERSION_MAJOR = 1;              /**< Major version of supported pcapng file format */
+const uint16_t NG_VERSION_MINOR = 0;              /**< Minor version of supported pcapng file format */
+const uint16_t NG_OPT_ENDOFOPT = 0;               /**< Option ending the options of a pcapng block */
+const uint16_t NG_OPT_IF_TSRESOL = 9;             /**< Interface option giving the timestamp resolution */
+
+const uint32_t BUFFER_SIZE = 65536;           /**< Size of the buffers of the file streams */
+
+#ifdef HAVE_ZLIB
+/**
+ * \ingroup network
+ * \brief A stream buffer compressing or uncompressing with gzip the data
+ * exchanged with another stream buffer.
+ *
+ * Seeking is limited to what PcapFile needs: telling the current position,
+ * skipping forward and rewinding the uncompressed data when reading, and
+ * telling the current position when writing.
+ */
+class GzipStreamBuf : public std::streambuf
+{
+public:
+  /**
+   * Constructor
+   * \param file the stream buffer of the compressed data
+   * \param write true to compress the data written, false to uncompress
+   * the data read
+   */
+  GzipStreamBuf (std::streambuf *file, bool write);
+  ~GzipStreamBuf ();
+
+  /**
+   * \brief Compress the pending data and write the end of the gzip stream,
+   * if compressing
+   * \returns true on success
+   */
+  bool Finish (void);
+
+protected:
+  virtual int_type overflow (int_type c);
+  virtual int sync (void);
+  virtual int_type underflow (void);
+  virtual pos_type seekoff (off_type off, std::ios::seekdir dir, std::ios::openmode which);
+  virtual pos_type seekpos (pos_type pos, std::ios::openmode which);
+
+private:
+  /**
+   * \brief Compress the data of the put area and write the result
+   * \param flush the zlib flush mode
+   * \returns true on success
+   */
+  bool Deflate (int flush);
+
+  std::streambuf *m_file;       //!< stream buffer of the compressed data
+  z_stream m_zstream;           //!< zlib state
+  bool m_write;                 //!< true if compressing
+  bool m_dirty;                 //!< data compressed since the last flush
+  std::vector<char> m_in;       //!< buffer of the uncompressed data written or compressed data read
+  std::vector<char> m_out;      //!< buffer of the compressed data written or uncompressed data read
+  uint64_t m_pos;               //!< uncompressed position of the start of the put or get area
+};
+
+GzipStreamBuf::GzipStreamBuf (std::streambuf *file, bool write)
+  : m_file (file),
+    m_write (write),
+    m_dirty (false),
+    m_in (BUFFER_SIZE),
+    m_out (BUFFER_SIZE),
+    m_pos (0)
+{
+  std::memset (&m_zstream, 0, sizeof (m_zstream));
+  if (m_write)
+    {
+      // 15 + 16: largest window, with a gzip header and trailer
+      deflateInit2 (&m_zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+      setp (&m_in[0], &m_in[0] + m_in.size ());
+    }
+  else
+    {
+      // 15 + 32: largest window, with a zlib or gzip header
+      inflateInit2 (&m_zstream, 15 + 32);
+      setg (&m_out[0], &m_out[0], &m_out[0]);
+    }
+}
+
+GzipStreamBuf::~GzipStreamBuf ()
+{
+  if (m_write)
+    {
+      deflateEnd (&m_zstream);
+    }
+  else
+    {
+      inflateEnd (&m_zstream);
+    }
+}
+
+bool
+GzipStreamBuf::Deflate (int flush)
+{
+  m_zstream.next_in = reinterpret_cast<Bytef *> (pbase ());
+  m_zstream.avail_in = static_cast<uInt> (pptr () - pbase ());
+  m_pos += m_zstream.avail_in;
+  m_dirty = m_dirty || m_zstream.avail_in > 0;
+  int ret;
+  do
+    {
+      m_zstream.next_out = reinterpret_cast<Bytef *> (&m_out[0]);
+      m_zstream.avail_out = static_cast<uInt> (m_out.size ());
+      ret = deflate (&m_zstream, flush);
+      if (ret == Z_STREAM_ERROR)
+        {
+          return false;
+        }
+      std::streamsize produced = m_out.size () - m_zstream.avail_out;
+      if (m_file->sputn (&m_out[0], produced) != produced)
+        {
+          return false;
+        }
+    }
+  while (m_zstream.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+  setp (&m_in[0], &m_in[0] + m_in.size ());
+  return true;
+}
+
+bool
+GzipStreamBuf::Finish (void)
+{
+  if (!m_write)
+    {
+      return true;
+    }
+  return Deflate (Z_FINISH) && m_file->pubsync () == 0;
+}
+
+GzipStreamBuf::int_type
+GzipStreamBuf::overflow (int_type c)
+{
+  if (!m_write || !Deflate (Z_NO_FLUSH))
+    {
+      return traits_type::eof ();
+    }
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+int
+GzipStreamBuf::sync (void)
+{
+  if (!m_write)
+    {
+      return 0;
+    }
+  if (pptr () == pbase () && !m_dirty)
+    {
+      return 0;
+    }
+  //
+  // A sync flush makes everything written so far readable, so that a
+  // file flushed on a fatal error can be uncompressed up to that point.
+  //
+  if (!Deflate (Z_SYNC_FLUSH))
+    {
+      return -1;
+    }
+  m_dirty = false;
+  return m_file->pubsync ();
+}
+
+GzipStreamBuf::int_type
+GzipStreamBuf::underflow (void)
+{
+  if (m_write)
+    {
+      return traits_type::eof ();
+    }
+  if (gptr () < egptr ())
+    {
+      return traits_type::to_int_type (*gptr ());
+    }
+  m_pos += egptr () - eback ();
+  setg (&m_out[0], &m_out[0], &m_out[0]);
+  while (true)
+    {
+      if (m_zstream.avail_in == 0)
+        {
+          std::streamsize n = m_file->sgetn (&m_in[0], m_in.size ());
+          if (n <= 0)
+            {
+              return traits_type::eof ();
+            }
+          m_zstream.next_in = reinterpret_cast<Bytef *> (&m_in[0]);
+          m_zstream.avail_in = static_cast<uInt> (n);
+        }
+      m_zstream.next_out = reinterpret_cast<Bytef *> (&m_out[0]);
+      m_zstream.avail_out = static_cast<uInt> (m_out.size ());
+      int ret = inflate (&m_zstream, Z_NO_FLUSH);
+      if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+        {
+          return traits_type::eof ();
+        }
+      if (ret == Z_STREAM_END)
+        {
+          // Concatenated gzip members form a single stream
+          inflateReset (&m_zstream);
+        }
+      std::size_t produced = m_out.size () - m_zstream.avail_out;
+      if (produced > 0)
+        {
+          setg (&m_out[0], &m_out[0], &m_out[0] + produced);
+          return traits_type::to_int_type (*gptr ());
+        }
+    }
+}
+
+GzipStreamBuf::pos_type
+GzipStreamBuf::seekoff (off_type off, std::ios::seekdir dir, std::ios::openmode which)
+{
+  uint64_t current = m_write ? m_pos + (pptr () - pbase ()) : m_pos + (gptr () - eback ());
+  uint64_t target;
+  if (dir == std::ios::beg)
+    {
+      target = off;
+    }
+  else if (dir == std::ios::cur)
+    {
+      target = current + off;
+    }
+  else
+    {
+      return pos_type (off_type (-1));
+    }
+  if (target == current)
+    {
+      return pos_type (off_type (current));
+    }
+  if (m_write)
+    {
+      return pos_type (off_type (-1));
+    }
+  if (target < current)
+    {
+      //
+      // Rewind to the start of the compressed data and skip forward.
+      //
+      if (m_file->pubseekpos (0, std::ios::in) != pos_type (off_type (0)))
+        {
+          return pos_type (off_type (-1));
+        }
+      inflateReset (&m_zstream);
+      m_zstream.avail_in = 0;
+      m_pos = 0;
+      setg (&m_out[0], &m_out[0], &m_out[0]);
+      current = 0;
+    }
+  while (current < target)
+    {
+      if (gptr () == egptr () && traits_type::eq_int_type (underflow (), traits_type::eof ()))
+        {
+          return pos_type (off_type (-1));
+        }
+      uint64_t step = std::min<uint64_t> (egptr () - gptr (), target - current);
+      gbump (static_cast<int> (step));
+      current += step;
+    }
+  return pos_type (off_type (current));
+}
+
+GzipStreamBuf::pos_type
+GzipStreamBuf::seekpos (pos_type pos, std::ios::openmode which)
+{
+  return seekoff (off_type (pos), std::ios::beg, which);
+}
+#endif /* HAVE_ZLIB */
+
 PcapFile::PcapFile ()
   : m_file (),
+    m_buffer (BUFFER_SIZE),
+    m_gzip (0),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_ngMode (false)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -88,9 +375,36 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  CloseCompression ();
   m_file.close ();
 }
 
+void
+PcapFile::CloseCompression (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_gzip == 0)
+    {
+      return;
+    }
+#ifdef HAVE_ZLIB
+  GzipStreamBuf *gzip = static_cast<GzipStreamBuf *> (m_gzip);
+  std::ios::iostate state = m_file.rdstate ();
+  if (m_file.is_open () && !gzip->Finish ())
+    {
+      state |= std::ios::badbit;
+    }
+  //
+  // Attaching a stream buffer clears the state of the stream, which is
+  // restored so that a failure is not hidden by closing the file.
+  //
+  m_file.std::basic_ios<char>::rdbuf (m_file.rdbuf ());
+  m_file.clear (state);
+  delete gzip;
+#endif
+  m_gzip = 0;
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -154,6 +468,24 @@ PcapFile::IsNanoSecMode (void)
   return m_nanosecMode;
 }
 
+bool
+PcapFile::IsNgMode (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_ngMode;
+}
+
+bool
+PcapFile::IsCompressionSupported (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
 uint8_t
 PcapFile::Swap (uint8_t val)
 {
@@ -198,6 +530,42 @@ PcapFile::Swap (PcapRecordHeader *from, PcapRecordHeader *to)
   to->m_origLen = Swap (from->m_origLen);
 }
 
+void
+PcapFile::WriteU16 (uint16_t value)
+{
+  if (m_swapMode)
+    {
+      value = Swap (value);
+    }
+  m_file.write ((const char *)&value, sizeof(value));
+}
+
+void
+PcapFile::WriteU32 (uint32_t value)
+{
+  if (m_swapMode)
+    {
+      value = Swap (value);
+    }
+  m_file.write ((const char *)&value, sizeof(value));
+}
+
+uint16_t
+PcapFile::ReadU16 (void)
+{
+  uint16_t value = 0;
+  m_file.read ((char *)&value, sizeof(value));
+  return m_swapMode ? Swap (value) : value;
+}
+
+uint32_t
+PcapFile::ReadU32 (void)
+{
+  uint32_t value = 0;
+  m_file.read ((char *)&value, sizeof(value));
+  return m_swapMode ? Swap (value) : value;
+}
+
 void
 PcapFile::WriteFileHeader (void)
 {
@@ -207,6 +575,45 @@ PcapFile::WriteFileHeader (void)
   // at the start of the file.
   //
   m_file.seekp (0, std::ios::beg);
+
+  if (m_ngMode)
+    {
+      //
+      // A section header block without options, of unspecified section
+      // length...
+      //
+      WriteU32 (NG_SECTION_HEADER);
+      WriteU32 (28);
+      WriteU32 (NG_BYTE_ORDER_MAGIC);
+      WriteU16 (NG_VERSION_MAJOR);
+      WriteU16 (NG_VERSION_MINOR);
+      WriteU32 (0xffffffff);
+      WriteU32 (0xffffffff);
+      WriteU32 (28);
+
+      //
+      // ... followed by the interface description block of the single
+      // interface of the file.  The timestamps are in microseconds unless
+      // an if_tsresol option says otherwise.
+      //
+      uint32_t length = m_nanosecMode ? 32 : 20;
+      WriteU32 (NG_INTERFACE_DESCRIPTION);
+      WriteU32 (length);
+      WriteU16 (static_cast<uint16_t> (m_fileHeader.m_type));
+      WriteU16 (0);
+      WriteU32 (m_fileHeader.m_snapLen);
+      if (m_nanosecMode)
+        {
+          WriteU16 (NG_OPT_IF_TSRESOL);
+          WriteU16 (1);
+          const char resolution[4] = { 9, 0, 0, 0 };
+          m_file.write (resolution, sizeof(resolution));
+          WriteU16 (NG_OPT_ENDOFOPT);
+          WriteU16 (0);
+        }
+      WriteU32 (length);
+      return;
+    }
  
   //
   // We have the ability to write out the pcap file header in a foreign endian
@@ -257,6 +664,22 @@ PcapFile::ReadAndVerifyFileHeader (void)
   // them all individually.
   //
   m_file.read ((char *)&m_fileHeader.m_magicNumber, sizeof(m_fileHeader.m_magicNumber));
+
+  //
+  // The type of the section header block of a pcapng file reads the same
+  // in both byte orders.
+  //
+  m_ngMode = m_file.good () && m_fileHeader.m_magicNumber == NG_SECTION_HEADER;
+  if (m_ngMode)
+    {
+      ReadAndVerifyNgFileHeader ();
+      if (m_file.fail ())
+        {
+          m_file.close ();
+        }
+      return;
+    }
+
   m_file.read ((char *)&m_fileHeader.m_versionMajor, sizeof(m_fileHeader.m_versionMajor));
   m_file.read ((char *)&m_fileHeader.m_versionMinor, sizeof(m_fileHeader.m_versionMinor));
   m_file.read ((char *)&m_fileHeader.m_zone, sizeof(m_fileHeader.m_zone));
@@ -321,6 +744,123 @@ PcapFile::ReadAndVerifyFileHeader (void)
     }
 }
 
+void
+PcapFile::ReadAndVerifyNgFileHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t length = 0;
+  uint32_t byteOrderMagic = 0;
+  m_file.read ((char *)&length, sizeof(length));
+  m_file.read ((char *)&byteOrderMagic, sizeof(byteOrderMagic));
+  if (m_file.fail ())
+    {
+      return;
+    }
+
+  //
+  // The byte order magic tells whether the section is swapped.
+  //
+  if (byteOrderMagic == NG_BYTE_ORDER_MAGIC)
+    {
+      m_swapMode = false;
+    }
+  else if (byteOrderMagic == Swap (NG_BYTE_ORDER_MAGIC))
+    {
+      m_swapMode = true;
+      length = Swap (length);
+    }
+  else
+    {
+      m_file.setstate (std::ios::failbit);
+      return;
+    }
+
+  m_fileHeader.m_versionMajor = ReadU16 ();
+  m_fileHeader.m_versionMinor = ReadU16 ();
+  if (m_fileHeader.m_versionMajor != NG_VERSION_MAJOR || length < 28 || length % 4 != 0)
+    {
+      m_file.setstate (std::ios::failbit);
+      return;
+    }
+  // Skip the section length, the options and the trailing length
+  m_file.seekg (length - 16, std::ios::cur);
+
+  //
+  // The first interface description block describes the interface of the
+  // packets; other blocks may come before it.
+  //
+  uint32_t type;
+  do
+    {
+      type = ReadU32 ();
+      length = ReadU32 ();
+      if (m_file.fail () || length < 12 || length % 4 != 0)
+        {
+          m_file.setstate (std::ios::failbit);
+          return;
+        }
+      if (type != NG_INTERFACE_DESCRIPTION)
+        {
+          m_file.seekg (length - 8, std::ios::cur);
+        }
+    }
+  while (type != NG_INTERFACE_DESCRIPTION);
+
+  if (length < 20)
+    {
+      m_file.setstate (std::ios::failbit);
+      return;
+    }
+  m_fileHeader.m_magicNumber = NG_SECTION_HEADER;
+  m_fileHeader.m_zone = 0;
+  m_fileHeader.m_sigFigs = 0;
+  m_fileHeader.m_type = ReadU16 ();
+  ReadU16 ();
+  m_fileHeader.m_snapLen = ReadU32 ();
+
+  //
+  // Look for the timestamp resolution in the options.  Only microseconds
+  // and nanoseconds are supported.
+  //
+  m_nanosecMode = false;
+  uint32_t left = length - 20;
+  while (left >= 4 && !m_file.fail ())
+    {
+      uint16_t code = ReadU16 ();
+      uint16_t optionLength = ReadU16 ();
+      left -= 4;
+      if (code == NG_OPT_ENDOFOPT)
+        {
+          break;
+        }
+      uint32_t padded = (optionLength + 3) & ~3;
+      if (padded > left)
+        {
+          m_file.setstate (std::ios::failbit);
+          return;
+        }
+      if (code == NG_OPT_IF_TSRESOL && optionLength == 1)
+        {
+          uint8_t resolution = 0;
+          m_file.read ((char *)&resolution, sizeof(resolution));
+          if (resolution != 6 && resolution != 9)
+            {
+              m_file.setstate (std::ios::failbit);
+              return;
+            }
+          m_nanosecMode = resolution == 9;
+          m_file.seekg (padded - 1, std::ios::cur);
+        }
+      else
+        {
+          m_file.seekg (padded, std::ios::cur);
+        }
+      left -= padded;
+    }
+  // Skip what is left of the options and the trailing length
+  m_file.seekg (left + 4, std::ios::cur);
+}
+
 void
 PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 {
@@ -333,7 +873,49 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
   mode |= std::ios::binary;
 
   m_filename=filename;
+
+  //
+  // The records are small, so give the file a large buffer to write and
+  // read them with few system calls.
+  //
+  m_file.rdbuf ()->pubsetbuf (&m_buffer[0], m_buffer.size ());
   m_file.open (filename.c_str (), mode);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+
+  bool compress = false;
+  if (mode & std::ios::in)
+    {
+      //
+      // A gzip file starts with 0x1f 0x8b.
+      //
+      char magic[2] = { 0, 0 };
+      m_file.read (magic, sizeof(magic));
+      compress = m_file.gcount () == 2 && magic[0] == '\x1f' && magic[1] == '\x8b';
+      m_file.clear ();
+      m_file.seekg (0, std::ios::beg);
+    }
+  else
+    {
+      std::string suffix = ".gz";
+      compress = filename.size () >= suffix.size ()
+        && filename.compare (filename.size () - suffix.size (), suffix.size (), suffix) == 0;
+    }
+
+  if (compress)
+    {
+#ifdef HAVE_ZLIB
+      m_gzip = new GzipStreamBuf (m_file.rdbuf (), (mode & std::ios::in) == 0);
+      m_file.std::basic_ios<char>::rdbuf (m_gzip);
+#else
+      NS_LOG_WARN ("Cannot open " << filename << ": gzip compression is not supported");
+      m_file.setstate (std::ios::failbit);
+      return;
+#endif
+    }
+
   if (mode & std::ios::in)
     {
       // will set the fail bit if file header is invalid.
@@ -342,15 +924,20 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 }
 
 void
-PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode)
+PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrection, bool swapMode, bool nanosecMode, bool ngMode)
 {
-  NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << swapMode);
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << timeZoneCorrection << swapMode << nanosecMode << ngMode);
 
   //
   // Initialize the magic number and nanosecond mode flag
   //
   m_nanosecMode = nanosecMode;
-  if (nanosecMode)
+  m_ngMode = ngMode;
+  if (ngMode)
+    {
+      m_fileHeader.m_magicNumber = NG_SECTION_HEADER;
+    }
+  else if (nanosecMode)
     {
       m_fileHeader.m_magicNumber = NS_MAGIC;
     }
@@ -362,8 +949,8 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   //
   // Initialize remainder of the in-memory file header.
   //
-  m_fileHeader.m_versionMajor = VERSION_MAJOR;
-  m_fileHeader.m_versionMinor = VERSION_MINOR;
+  m_fileHeader.m_versionMajor = ngMode ? NG_VERSION_MAJOR : VERSION_MAJOR;
+  m_fileHeader.m_versionMinor = ngMode ? NG_VERSION_MINOR : VERSION_MINOR;
   m_fileHeader.m_zone = timeZoneCorrection;
   m_fileHeader.m_sigFigs = 0;
   m_fileHeader.m_snapLen = snapLen;
@@ -407,6 +994,24 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
+  if (m_ngMode)
+    {
+      //
+      // An enhanced packet block, whose 64 bits timestamp counts units of
+      // the resolution of the interface.
+      //
+      uint64_t timestamp = static_cast<uint64_t> (tsSec) * (m_nanosecMode ? 1000000000 : 1000000) + tsUsec;
+      uint32_t padded = (inclLen + 3) & ~3;
+      WriteU32 (NG_ENHANCED_PACKET);
+      WriteU32 (32 + padded);
+      WriteU32 (0);
+      WriteU32 (static_cast<uint32_t> (timestamp >> 32));
+      WriteU32 (static_cast<uint32_t> (timestamp));
+      WriteU32 (inclLen);
+      WriteU32 (totalLen);
+      return inclLen;
+    }
+
   PcapRecordHeader header;
   header.m_tsSec = tsSec;
   header.m_tsUsec = tsUsec;
@@ -426,17 +1031,30 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
   m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
   m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
   return inclLen;
 }
 
+void
+PcapFile::WritePacketTrailer (uint32_t inclLen)
+{
+  NS_LOG_FUNCTION (this << inclLen);
+  if (!m_ngMode)
+    {
+      return;
+    }
+  uint32_t padded = (inclLen + 3) & ~3;
+  const char padding[4] = { 0, 0, 0, 0 };
+  m_file.write (padding, padded - inclLen);
+  WriteU32 (32 + padded);
+}
+
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
   m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  WritePacketTrailer (inclLen);
 }
 
 void 
@@ -445,7 +1063,7 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
   p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  WritePacketTrailer (inclLen);
 }
 
 void 
@@ -461,8 +1079,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
   headerBuffer.CopyData (&m_file, toCopy);
-  inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (&m_file, inclLen - toCopy);
+  WritePacketTrailer (inclLen);
 }
 
 void
@@ -480,6 +1098,52 @@ PcapFile::Read (
 
   PcapRecordHeader header;
 
+  if (m_ngMode)
+    {
+      //
+      // Skip the blocks other than the enhanced packet blocks.
+      //
+      uint32_t type = ReadU32 ();
+      uint32_t length = ReadU32 ();
+      while (!m_file.fail () && type != NG_ENHANCED_PACKET)
+        {
+          if (length < 12 || length % 4 != 0)
+            {
+              m_file.setstate (std::ios::failbit);
+              return;
+            }
+          m_file.seekg (length - 8, std::ios::cur);
+          type = ReadU32 ();
+          length = ReadU32 ();
+        }
+      if (m_file.fail ())
+        {
+          return;
+        }
+      ReadU32 ();
+      uint64_t timestamp = static_cast<uint64_t> (ReadU32 ()) << 32;
+      timestamp |= ReadU32 ();
+      inclLen = ReadU32 ();
+      origLen = ReadU32 ();
+      if (m_file.fail ())
+        {
+          return;
+        }
+      if (length < 32 + inclLen || length % 4 != 0)
+        {
+          m_file.setstate (std::ios::failbit);
+          return;
+        }
+      uint32_t units = m_nanosecMode ? 1000000000 : 1000000;
+      tsSec = static_cast<uint32_t> (timestamp / units);
+      tsUsec = static_cast<uint32_t> (timestamp % units);
+      readLen = maxBytes < inclLen ? maxBytes : inclLen;
+      m_file.read ((char *)data, readLen);
+      // Skip the rest of the data, the padding, the options and the trailing length
+      m_file.seekg (length - 28 - readLen, std::ios::cur);
+      return;
+    }
+
   //
   // Watch out for memory alignment differences between machines, so read
   // them all individually.
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ptr.h"
 
@@ -38,6 +39,16 @@ class Header;
  * A class representing a pcap file.  This allows easy creation, writing and 
  * reading of files composed of stored packets; which may be viewed using
  * standard tools.
+ *
+ * Files are written either in the classic pcap format or in the pcapng
+ * format, and both formats are read.  A pcapng file is written with a
+ * single section header block and a single interface description block,
+ * which all its enhanced packet blocks refer to.  When a pcapng file is
+ * read, the first interface description block gives the data link type
+ * and the snap length of all the packets, whatever their interface, and
+ * the blocks other than the enhanced packet blocks are skipped.  Files
+ * whose name ends with ".gz" are compressed with gzip when ns-3 is built
+ * with zlib, and compressed files are detected and read transparently.
  */
 class PcapFile
 {
@@ -74,6 +85,11 @@ public:
    * selected as a binary file (fstream::binary is automatically ored with the mode
    * field).
    *
+   * A file opened for writing whose name ends with ".gz" is compressed with
+   * gzip; the open fails if compression is not supported (see
+   * IsCompressionSupported).  A file opened for reading is uncompressed on
+   * the fly if it is compressed with gzip.
+   *
    * \param filename String containing the name of the file.
    *
    * \param mode the access mode for the file.
@@ -111,6 +127,11 @@ public:
    * \param nanosecMode Flag indicating the time resolution of the writing
    * system. Default to false.
    *
+   * \param ngMode Flag indicating that the file is written in the pcapng
+   * format, with a section header block, an interface description block
+   * and an enhanced packet block per packet, rather than in the classic
+   * pcap format. Defaults to false.
+   *
    * \return false if the open succeeds, true otherwise.
    *
    * \warning Calling this method on an existing file will result in the loss
@@ -120,7 +141,8 @@ public:
              uint32_t snapLen = SNAPLEN_DEFAULT, 
              int32_t timeZoneCorrection = ZONE_DEFAULT,
              bool swapMode = false,
-             bool nanosecMode = false);
+             bool nanosecMode = false,
+             bool ngMode = false);
 
   /**
    * \brief Write next packet to file
@@ -202,11 +224,28 @@ public:
    * file have nanosecond resolution.
    */
    bool IsNanoSecMode (void);
+
+  /**
+   * \brief Get the format of the file.
+   *
+   * \returns true if the file is in the pcapng format, false if it is in
+   * the classic pcap format.
+   */
+  bool IsNgMode (void);
+
+  /**
+   * \returns true if ns-3 was built with zlib, so that files can be
+   * written and read compressed with gzip.
+   */
+  static bool IsCompressionSupported (void);
  
   /**
    * \brief Returns the magic number of the pcap file as defined by the magic_number
    * field in the pcap global header.
    *
+   * The magic number of a pcapng file is the type of its section header
+   * block, 0x0a0d0d0a.
+   *
    * See http://wiki.wireshark.org/Development/LibpcapFileFormat
    *
    * \returns magic number
@@ -361,16 +400,63 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Write the padding and the trailer of a packet record
+   *
+   * The classic pcap records have neither; the pcapng blocks are padded
+   * to 32 bits and end with their length.
+   *
+   * \param inclLen the length of the packet written in the file
+   */
+  void WritePacketTrailer (uint32_t inclLen);
+
+  /**
+   * \brief Write a 16 bits value in the byte order of the file
+   * \param value the value
+   */
+  void WriteU16 (uint16_t value);
+  /**
+   * \brief Write a 32 bits value in the byte order of the file
+   * \param value the value
+   */
+  void WriteU32 (uint32_t value);
+  /**
+   * \brief Read a 16 bits value in the byte order of the file
+   * \returns the value
+   */
+  uint16_t ReadU16 (void);
+  /**
+   * \brief Read a 32 bits value in the byte order of the file
+   * \returns the value
+   */
+  uint32_t ReadU32 (void);
+
   /**
    * \brief Read and verify a Pcap file header
    */
   void ReadAndVerifyFileHeader (void);
 
+  /**
+   * \brief Read and verify the section header block and the interface
+   * description block of a pcapng file, after the type of the section
+   * header block.
+   */
+  void ReadAndVerifyNgFileHeader (void);
+
+  /**
+   * \brief Finish the compression of the file, if any, and detach the
+   * compression layer from the file stream.
+   */
+  void CloseCompression (void);
+
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  std::vector<char> m_buffer;   //!< buffer of the file stream
+  std::streambuf *m_gzip;       //!< gzip compression layer, if any
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  bool m_ngMode;                //!< pcapng format
 };
 
 } // namespace ns3
@@ -29,11 +29,14 @@
 #include "ns3/traced-value.h"
 #include "ns3/unused.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -248,6 +251,16 @@ private:
  * \endcode
  *
  * Then, include queue.h in the corresponding .cc file.
+ *
+ * The items are stored in a list, so that subclasses can insert and
+ * remove items at any position.  FIFO subclasses can instead store them
+ * in a ring buffer (see UseRingBuffer), which grows by doubling its
+ * capacity, up to the maximum size of the queue when it is expressed
+ * in packets, and is reused afterwards, so that enqueuing an item does
+ * not allocate memory.  With a ring buffer, items can only be enqueued
+ * at the tail and dequeued, removed or peeked at the head, by the
+ * DoEnqueue, DoDequeue, DoRemove and DoPeek methods which take no
+ * iterator.
  */
 template <typename Item>
 class Queue : public QueueBase
@@ -398,6 +411,47 @@ protected:
    */
   Ptr<const Item> DoPeek (ConstIterator pos) const;
 
+  /**
+   * Push an item at the tail of the queue
+   * \param item the item to enqueue
+   * \return true if success, false if the packet has been dropped.
+   */
+  bool DoEnqueue (Ptr<Item> item);
+
+  /**
+   * Pull the item at the head of the queue to dequeue it
+   * \return the item.
+   */
+  Ptr<Item> DoDequeue (void);
+
+  /**
+   * Pull the item at the head of the queue to drop it
+   * \return the item.
+   */
+  Ptr<Item> DoRemove (void);
+
+  /**
+   * Peek the item at the head of the queue
+   * \return the item.
+   */
+  Ptr<const Item> DoPeek (void) const;
+
+  /**
+   * \brief Select the storage of the items
+   * \param enable true to store the items in a ring buffer, false to
+   *        store them in a list
+   *
+   * The storage can only be changed while the queue is empty.  With a
+   * ring buffer, the methods which take an iterator, begin and end
+   * cannot be used.
+   */
+  void UseRingBuffer (bool enable);
+
+  /**
+   * \return true if the items are stored in a ring buffer
+   */
+  bool IsRingBuffer (void) const;
+
   /**
    * \brief Drop a packet before enqueue
    * \param item item that was dropped
@@ -419,7 +473,22 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
+  /**
+   * Update the statistics and fire the trace sources of an enqueued item
+   * \param item the item
+   */
+  void NotifyEnqueue (Ptr<Item> item);
+
+  /**
+   * Update the statistics and fire the trace sources of a dequeued item
+   * \param item the item
+   */
+  void NotifyDequeue (Ptr<Item> item);
+
   std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  bool m_useRing;                           //!< true if the items are in m_ring
+  std::vector<Ptr<Item> > m_ring;           //!< the ring buffer of the items
+  std::size_t m_ringHead;                   //!< the index of the head item in m_ring
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -468,7 +537,9 @@ Queue<Item>::GetTypeId (void)
 
 template <typename Item>
 Queue<Item>::Queue ()
-  : NS_LOG_TEMPLATE_DEFINE ("Queue")
+  : m_useRing (false),
+    m_ringHead (0),
+    NS_LOG_TEMPLATE_DEFINE ("Queue")
 {
 }
 
@@ -490,8 +561,63 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
       return false;
     }
 
+  NS_ASSERT_MSG (!m_useRing, "Items can only be enqueued at the tail of a ring buffer");
   m_packets.insert (pos, item);
+  NotifyEnqueue (item);
+
+  return true;
+}
+
+template <typename Item>
+bool
+Queue<Item>::DoEnqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (!m_useRing)
+    {
+      return DoEnqueue (end (), item);
+    }
+
+  if (GetCurrentSize () + item > GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
+    }
 
+  std::size_t n = m_nPackets.Get ();
+  if (n == m_ring.size ())
+    {
+      // grow the ring buffer, moving the items to the start of the new one
+      std::size_t capacity = std::max<std::size_t> (2 * n, 16);
+      if (GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS)
+        {
+          capacity = std::max<std::size_t> (std::min<std::size_t> (capacity, GetMaxSize ().GetValue ()), n + 1);
+        }
+      std::vector<Ptr<Item> > ring (capacity);
+      for (std::size_t i = 0; i < n; i++)
+        {
+          ring[i] = m_ring[(m_ringHead + i) % n];
+        }
+      m_ring.swap (ring);
+      m_ringHead = 0;
+    }
+  std::size_t tail = m_ringHead + n;
+  if (tail >= m_ring.size ())
+    {
+      tail -= m_ring.size ();
+    }
+  m_ring[tail] = item;
+  NotifyEnqueue (item);
+
+  return true;
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyEnqueue (Ptr<Item> item)
+{
   uint32_t size = item->GetSize ();
   m_nBytes += size;
   m_nTotalReceivedBytes += size;
@@ -501,8 +627,20 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
+}
 
-  return true;
+template <typename Item>
+void
+Queue<Item>::NotifyDequeue (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
 }
 
 template <typename Item>
@@ -517,19 +655,44 @@ Queue<Item>::DoDequeue (ConstIterator pos)
       return 0;
     }
 
+  NS_ASSERT_MSG (!m_useRing, "Items can only be dequeued at the head of a ring buffer");
   Ptr<Item> item = *pos;
   m_packets.erase (pos);
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
+      NotifyDequeue (item);
+    }
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_useRing)
+    {
+      return DoDequeue (begin ());
+    }
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
 
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
+  Ptr<Item> item = m_ring[m_ringHead];
+  m_ring[m_ringHead] = 0;
+  if (++m_ringHead == m_ring.size ())
+    {
+      m_ringHead = 0;
+    }
 
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+  if (item != 0)
+    {
+      NotifyDequeue (item);
     }
   return item;
 }
@@ -546,21 +709,47 @@ Queue<Item>::DoRemove (ConstIterator pos)
       return 0;
     }
 
+  NS_ASSERT_MSG (!m_useRing, "Items can only be removed at the head of a ring buffer");
   Ptr<Item> item = *pos;
   m_packets.erase (pos);
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
+      // packets are first dequeued and then dropped
+      NotifyDequeue (item);
+      DropAfterDequeue (item);
+    }
+  return item;
+}
 
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoRemove (void)
+{
+  NS_LOG_FUNCTION (this);
 
-      // packets are first dequeued and then dropped
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+  if (!m_useRing)
+    {
+      return DoRemove (begin ());
+    }
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
 
+  Ptr<Item> item = m_ring[m_ringHead];
+  m_ring[m_ringHead] = 0;
+  if (++m_ringHead == m_ring.size ())
+    {
+      m_ringHead = 0;
+    }
+
+  if (item != 0)
+    {
+      // packets are first dequeued and then dropped
+      NotifyDequeue (item);
       DropAfterDequeue (item);
     }
   return item;
@@ -589,30 +778,76 @@ Queue<Item>::DoPeek (ConstIterator pos) const
       return 0;
     }
 
+  NS_ASSERT_MSG (!m_useRing, "Only the head of a ring buffer can be peeked");
   return *pos;
 }
 
+template <typename Item>
+Ptr<const Item>
+Queue<Item>::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_useRing)
+    {
+      return DoPeek (begin ());
+    }
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_ring[m_ringHead];
+}
+
+template <typename Item>
+void
+Queue<Item>::UseRingBuffer (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  NS_ABORT_MSG_UNLESS (IsEmpty (), "The storage of a non-empty queue cannot be changed");
+  m_useRing = enable;
+  if (!enable)
+    {
+      std::vector<Ptr<Item> > ().swap (m_ring);
+      m_ringHead = 0;
+    }
+}
+
+template <typename Item>
+bool
+Queue<Item>::IsRingBuffer (void) const
+{
+  return m_useRing;
+}
+
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::begin (void) const
 {
+  NS_ASSERT_MSG (!m_useRing, "A ring buffer has no iterators");
   return m_packets.cbegin ();
 }
 
 template <typename Item>
 typename Queue<Item>::Iterator Queue<Item>::begin (void)
 {
+  NS_ASSERT_MSG (!m_useRing, "A ring buffer has no iterators");
   return m_packets.begin ();
 }
 
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::end (void) const
 {
+  NS_ASSERT_MSG (!m_useRing, "A ring buffer has no iterators");
   return m_packets.cend ();
 }
 
 template <typename Item>
 typename Queue<Item>::Iterator Queue<Item>::end (void)
 {
+  NS_ASSERT_MSG (!m_useRing, "A ring buffer has no iterators");
   return m_packets.end ();
 }
 
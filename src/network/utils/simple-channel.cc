@@ -22,6 +22,7 @@
 #include "simple-net-device.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
 
@@ -72,8 +73,61 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
               continue;
             }
         }
-      Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
-                                      &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+      uint32_t context = tmp->GetNode ()->GetId ();
+      if (Simulator::IsLocalContext (context))
+        {
+          Simulator::ScheduleWithContext (context, m_delay,
+                                          &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+        }
+      else
+        {
+          // the receiver is run by another thread: the event must share
+          // neither the packet storage nor the reference count of the device.
+          Simulator::ScheduleWithContext (context, m_delay,
+                                          &SimpleNetDevice::Receive, PeekPointer (tmp), p->DeepCopy (),
+                                          protocol, to, from);
+        }
+    }
+}
+
+void
+SimpleChannel::SendBatch (Ptr<PacketBurst> burst, uint16_t protocol,
+                          Mac48Address to, Mac48Address from,
+                          Ptr<SimpleNetDevice> sender)
+{
+  NS_LOG_FUNCTION (this << burst << protocol << to << from << sender);
+  for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
+    {
+      Ptr<SimpleNetDevice> tmp = *i;
+      if (tmp == sender)
+        {
+          continue;
+        }
+      if (m_blackListedDevices.find (tmp) != m_blackListedDevices.end ())
+        {
+          if (find (m_blackListedDevices[tmp].begin (), m_blackListedDevices[tmp].end (), sender) !=
+              m_blackListedDevices[tmp].end () )
+            {
+              continue;
+            }
+        }
+      uint32_t context = tmp->GetNode ()->GetId ();
+      if (Simulator::IsLocalContext (context))
+        {
+          Simulator::ScheduleWithContext (context, m_delay,
+                                          &SimpleNetDevice::ReceiveBatch, tmp, burst->Copy (), protocol, to, from);
+        }
+      else
+        {
+          Ptr<PacketBurst> copy = Create<PacketBurst> ();
+          for (std::list<Ptr<Packet> >::const_iterator j = burst->Begin (); j != burst->End (); ++j)
+            {
+              copy->AddPacket ((*j)->DeepCopy ());
+            }
+          Simulator::ScheduleWithContext (context, m_delay,
+                                          &SimpleNetDevice::ReceiveBatch, PeekPointer (tmp), copy,
+                                          protocol, to, from);
+        }
     }
 }
 
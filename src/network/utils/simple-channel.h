@@ -30,6 +30,7 @@ namespace ns3 {
 
 class SimpleNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup channel
@@ -68,6 +69,21 @@ public:
   virtual void Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
                      Ptr<SimpleNetDevice> sender);
 
+  /**
+   * A burst of packets is sent at once by a net device.  A single
+   * receive event, for the whole burst, will be scheduled for all net
+   * device connected to the channel other than the net device who sent
+   * the packets
+   *
+   * \param burst packets to be sent
+   * \param protocol protocol number
+   * \param to address to send packets to
+   * \param from address the packets are coming from
+   * \param sender netdevice who sent the packets
+   */
+  virtual void SendBatch (Ptr<PacketBurst> burst, uint16_t protocol, Mac48Address to, Mac48Address from,
+                          Ptr<SimpleNetDevice> sender);
+
   /**
    * Attached a net device to the channel.
    *
@@ -21,6 +21,7 @@
 #include "simple-channel.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/error-model.h"
@@ -270,6 +271,27 @@ SimpleNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol,
     }
 }
 
+void
+SimpleNetDevice::ReceiveBatch (Ptr<PacketBurst> burst, uint16_t protocol,
+                               Mac48Address to, Mac48Address from)
+{
+  NS_LOG_FUNCTION (this << burst << protocol << to << from);
+
+  if (m_rxBatchCallback.IsNull () || m_receiveErrorModel || !m_promiscCallback.IsNull ())
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          Receive (*i, protocol, to, from);
+        }
+      return;
+    }
+
+  if (to == m_address || to.IsBroadcast () || to.IsGroup ())
+    {
+      m_rxBatchCallback (this, burst, protocol, from);
+    }
+}
+
 void 
 SimpleNetDevice::SetChannel (Ptr<SimpleChannel> channel)
 {
@@ -467,6 +489,46 @@ SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address&
 }
 
 
+bool
+SimpleNetDevice::SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  if (m_bps > DataRate (0) || m_queue->GetNPackets () > 0 || TransmitCompleteEvent.IsRunning ())
+    {
+      // the packets are transmitted one after the other
+      return NetDevice::SendBatch (burst, dest, protocolNumber);
+    }
+
+  //
+  // With an infinite data rate and an idle device, all the packets
+  // leave the device now: they go through the queue, for its traces,
+  // and are handed over to the channel as a single burst.
+  //
+  bool sent = true;
+  Ptr<PacketBurst> packets = CreateObject<PacketBurst> ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      Ptr<Packet> p = *i;
+      if (p->GetSize () > GetMtu ())
+        {
+          sent = false;
+          continue;
+        }
+      if (m_queue->Enqueue (p))
+        {
+          p = m_queue->Dequeue ();
+        }
+      packets->AddPacket (p);
+    }
+  if (packets->GetNPackets () > 0)
+    {
+      m_channel->SendBatch (packets, protocolNumber, Mac48Address::ConvertFrom (dest), m_address, this);
+      TransmitCompleteEvent = Simulator::Schedule (Time (0), &SimpleNetDevice::TransmitComplete, this);
+    }
+  return sent;
+}
+
 void
 SimpleNetDevice::TransmitComplete ()
 {
@@ -528,6 +590,15 @@ SimpleNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
 {
   NS_LOG_FUNCTION (this << &cb);
   m_rxCallback = cb;
+  // the bursts must not bypass a new receive callback.
+  m_rxBatchCallback.Nullify ();
+}
+
+void
+SimpleNetDevice::SetReceiveBatchCallback (NetDevice::ReceiveBatchCallback cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  m_rxBatchCallback = cb;
 }
 
 void
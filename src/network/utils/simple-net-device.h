@@ -49,6 +49,18 @@ class ErrorModel;
  *
  * By default the device is in Broadcast mode, with infinite bandwidth.
  *
+ * With an infinite bandwidth, a burst given to SendBatch while the device
+ * is idle is handed over to the channel in a single event, and received
+ * by the other devices in a single event, at the same time as the
+ * packets sent one by one with Send would be.  Only the events differ:
+ * Send transmits the packets queued behind the first one in a separate
+ * event each, so that the events scheduled at the same time by the
+ * receivers of the first packets may run before the next packets are
+ * received, which never happens with a burst.  The receive batch
+ * callback is cleared by SetReceiveCallback, so that a custom receive
+ * callback gets all the packets, one by one, unless the receive batch
+ * callback is set again afterwards.
+ *
  * \brief simple net device for simple things and testing
  */
 class SimpleNetDevice : public NetDevice
@@ -72,6 +84,20 @@ public:
    * \param from address packet was sent from
    */
   void Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
+
+  /**
+   * Receive a burst of packets from a connected SimpleChannel.  The
+   * burst is forwarded by calling the rx batch callback once, unless
+   * the callback is not set or a receive error model or a promiscuous
+   * callback is set, in which case each packet is received as by
+   * Receive.
+   *
+   * \param burst Packets received on the channel
+   * \param protocol protocol number
+   * \param to address packets should be sent to
+   * \param from address packets were sent from
+   */
+  void ReceiveBatch (Ptr<PacketBurst> burst, uint16_t protocol, Mac48Address to, Mac48Address from);
   
   /**
    * Attach a channel to this net device.  This will be the 
@@ -125,10 +151,12 @@ public:
   virtual bool IsBridge (void) const;
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual bool SendBatch (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
   virtual bool NeedsArp (void) const;
   virtual void SetReceiveCallback (NetDevice::ReceiveCallback cb);
+  virtual void SetReceiveBatchCallback (NetDevice::ReceiveBatchCallback cb);
 
   virtual Address GetMulticast (Ipv6Address addr) const;
 
@@ -141,6 +169,7 @@ protected:
 private:
   Ptr<SimpleChannel> m_channel; //!< the channel the device is connected to
   NetDevice::ReceiveCallback m_rxCallback; //!< Receive callback
+  NetDevice::ReceiveBatchCallback m_rxBatchCallback; //!< Batch receive callback
   NetDevice::PromiscReceiveCallback m_promiscCallback; //!< Promiscuous receive callback
   Ptr<Node> m_node; //!< Node this netDevice is associated to
   uint16_t m_mtu;   //!< MTU
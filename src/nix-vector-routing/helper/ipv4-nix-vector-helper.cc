@@ -20,6 +20,7 @@
 
 #include "ipv4-nix-vector-helper.h"
 #include "ns3/ipv4-nix-vector-routing.h"
+#include "ns3/node.h"
 
 namespace ns3 {
 
@@ -21,17 +21,13 @@
 #ifndef IPV4_NIX_VECTOR_ROUTING_H
 #define IPV4_NIX_VECTOR_ROUTING_H
 
-#include <map>
+#include <unordered_map>
 
-#include "ns3/channel.h"
-#include "ns3/node-container.h"
-#include "ns3/node-list.h"
-#include "ns3/net-device-container.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/nix-vector.h"
-#include "ns3/bridge-net-device.h"
 #include "ns3/nstime.h"
+#include "ns3/nix-vector-graph.h"
 
 namespace ns3 {
 
@@ -44,18 +40,46 @@ namespace ns3 {
 
 /**
  * \ingroup nix-vector-routing
- * Map of Ipv4Address to NixVector
- */
-typedef std::map<Ipv4Address, Ptr<NixVector> > NixMap_t;
-/**
- * \ingroup nix-vector-routing
- * Map of Ipv4Address to Ipv4Route
+ *
+ * \brief The nix-vector graph of the IPv4 nodes, and the index of their
+ * addresses.
+ *
+ * It is shared by the Ipv4NixVectorRouting of all the nodes.
  */
-typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
+class Ipv4NixVectorGraph : public NixVectorGraph
+{
+public:
+  Ipv4NixVectorGraph ();
+
+  /**
+   * \brief Rebuild the graph and the index of the addresses before their
+   * next use.
+   */
+  virtual void Invalidate (void);
+
+  /**
+   * \brief Find the node which owns an address.
+   * \param dest the address
+   * \returns the node index, or NONE
+   */
+  uint32_t GetNodeByIp (Ipv4Address dest);
+
+protected:
+  virtual bool IsInterfaceUp (Ptr<NetDevice> device) const;
+
+private:
+  /** The node which owns each address */
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_addresses;
+  bool m_addressesValid; //!< Set to false to rebuild the index of the addresses
+};
 
 /**
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
+ *
+ * The topology and the shortest path trees are shared by the nodes (see
+ * Ipv4NixVectorGraph); each node caches the nix-vectors and routes to the
+ * destinations it uses.
  */
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
@@ -89,124 +113,56 @@ public:
   void FlushGlobalNixRoutingCache (void) const;
 
 private:
+  /** The nix-vector and the route to a destination, cached by a node */
+  struct CacheEntry
+  {
+    uint32_t node;             //!< The destination node index, or NONE
+    uint32_t version;          //!< The version of the routes to the destination node
+    Ptr<NixVector> nixVector;  //!< The nix-vector from this node, if built
+    Ptr<Ipv4Route> route;      //!< The route, if built
+    uint32_t neighbor;         //!< The neighbor index of the route
+  };
+
+  /// container of CacheEntry, by destination address
+  typedef std::unordered_map<Ipv4Address, CacheEntry, Ipv4AddressHash> Cache;
 
   /**
-   * Flushes the cache which stores nix-vector based on
-   * destination IP
+   * Flushes the cache which stores nix-vectors and routes
+   * based on destination IP
    */
   void FlushNixCache (void) const;
 
   /**
-   * Flushes the cache which stores the Ipv4 route
-   * based on the destination IP
+   * \returns The graph shared by all the nodes.
    */
-  void FlushIpv4RouteCache (void) const;
+  static Ipv4NixVectorGraph *GetGraph (void);
 
   /**
-   * Upon a run-time topology change caches are
-   * flushed and the total number of neighbors is
-   * reset to zero
+   * Checks the cache based on dest IP, and resets the entry
+   * if it is missing or if the routes to the destination changed
+   * \param address Address to check
+   * \returns The cache entry.
    */
-  void ResetTotalNeighbors (void);
+  CacheEntry &GetCacheEntry (Ipv4Address address);
 
   /**
-   * Takes in the source node and dest IP and calls GetNodeByIp,
-   * BFS, accounting for any output interface specified, and finally
-   * BuildNixVector to return the built nix-vector
+   * Takes in the source node and the dest node and
+   * builds the nix-vector, accounting for any output interface specified
    *
    * \param source Source node
-   * \param dest Destination node address
+   * \param dest Destination node index
    * \param oif Preferred output interface
    * \returns The NixVector to be used in routing.
    */
-  Ptr<NixVector> GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif);
-
-  /**
-   * Checks the cache based on dest IP for the nix-vector
-   * \param address Address to check
-   * \returns The NixVector to be used in routing.
-   */
-  Ptr<NixVector> GetNixVectorInCache (Ipv4Address address);
-
-  /**
-   * Checks the cache based on dest IP for the Ipv4Route
-   * \param address Address to check
-   * \returns The cached route.
-   */
-  Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address address);
+  Ptr<NixVector> GetNixVector (Ptr<Node> source, uint32_t dest, Ptr<NetDevice> oif);
 
   /**
-   * Given a net-device returns all the adjacent net-devices,
-   * essentially getting the neighbors on that channel
-   * \param [in] netDevice the NetDevice attached to the channel.
-   * \param [in] channel the channel to check
-   * \param [out] netDeviceContainer the NetDeviceContainer of the NetDevices in the channel.
+   * Builds the route to a neighbor
+   * \param dest Destination address
+   * \param nodeIndex Nix index of the neighbor
+   * \returns The route.
    */
-  void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
-
-  /**
-   * Iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address
-   * \param dest destination node IP
-   * \return The node with the specified IP.
-   */
-  Ptr<Node> GetNodeByIp (Ipv4Address dest);
-
-  /**
-   * Recurses the parent vector, created by BFS and actually builds the nixvector
-   * \param [in] parentVector Parent vector for retracing routes
-   * \param [in] source Source Node index
-   * \param [in] dest Destination Node index
-   * \param [out] nixVector the NixVector to be used for routing
-   * \returns true on success, false otherwise.
-   */
-  bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
-
-  /**
-   * Special variation of BuildNixVector for when a node is sending to itself
-   * \param [out] nixVector the NixVector to be used for routing
-   * \returns true on success, false otherwise.
-   */
-  bool BuildNixVectorLocal (Ptr<NixVector> nixVector);
-
-  /**
-   * Simple iterates through the nodes net-devices and determines
-   * how many neighbors it has
-   * \returns the number of neighbors.
-   */
-  uint32_t FindTotalNeighbors (void);
-
-  /**
-   * Determine if the NetDevice is bridged
-   * \param nd the NetDevice to check
-   * \returns the bridging NetDevice (or null if the NetDevice is not bridged)
-   */
-  Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd) const;
-
-
-  /**
-   * Nix index is with respect to the neighbors.  The net-device index must be
-   * derived from this
-   * \param [in] nodeIndex Nix Node index
-   * \param [out] gatewayIp IP address of the gateway
-   * \returns the index of the NetDevice in the node.
-   */
-  uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp);
-
-  /**
-   * \brief Breadth first search algorithm.
-   * \param [in] numberOfNodes total number of nodes
-   * \param [in] source Source Node
-   * \param [in] dest Destination Node
-   * \param [out] parentVector Parent vector for retracing routes
-   * \param [in] oif specific output interface to use from source node, if not null
-   * \returns false if dest not found, true o.w.
-   */
-  bool BFS (uint32_t numberOfNodes,
-            Ptr<Node> source,
-            Ptr<Node> dest,
-            std::vector< Ptr<Node> > & parentVector,
-            Ptr<NetDevice> oif);
+  Ptr<Ipv4Route> BuildRoute (Ipv4Address dest, uint32_t nodeIndex);
 
   void DoDispose (void);
 
@@ -221,29 +177,12 @@ private:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
- 
-  /**
-   * Flushes routing caches if required.
-   */
-  void CheckCacheStateAndFlush (void) const;
 
-  /**
-   * Flag to mark when caches are dirty and need to be flushed.  
-   * Used for lazy cleanup of caches when there are many topology changes.
-   */
-  static bool g_isCacheDirty;
-
-  /** Cache stores nix-vectors based on destination ip */
-  mutable NixMap_t m_nixCache;
-
-  /** Cache stores Ipv4Routes based on destination ip */
-  mutable Ipv4RouteMap_t m_ipv4RouteCache;
+  /** Cache stores nix-vectors and Ipv4Routes based on destination ip */
+  mutable Cache m_cache;
 
   Ptr<Ipv4> m_ipv4; //!< IPv4 object
   Ptr<Node> m_node; //!< Node object
-
-  /** Total neighbors used for nix-vector to determine number of bits */
-  uint32_t m_totalNeighbors;
 };
 } // namespace ns3
 
@@ -0,0 +1,499 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <map>
+
+#include "ns3/log.h"
+#include "ns3/names.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/simulation-singleton.h"
+
+#include "ipv6-nix-vector-routing.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6NixVectorRouting");
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6NixVectorRouting);
+
+Ipv6NixVectorGraph::Ipv6NixVectorGraph ()
+  : m_addressesValid (false)
+{
+}
+
+void
+Ipv6NixVectorGraph::Invalidate (void)
+{
+  NixVectorGraph::Invalidate ();
+  CriticalSection cs (m_mutex);
+  m_addressesValid = false;
+}
+
+uint32_t
+Ipv6NixVectorGraph::GetNodeByIp (Ipv6Address dest)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CriticalSection cs (m_mutex);
+
+  if (!m_addressesValid)
+    {
+      // The first node which owns an address gets it.
+      m_addresses.clear ();
+      for (uint32_t n = 0; n < NodeList::GetNNodes (); n++)
+        {
+          Ptr<Ipv6> ipv6 = NodeList::GetNode (n)->GetObject<Ipv6> ();
+          if (!ipv6)
+            {
+              continue;
+            }
+          for (uint32_t i = 0; i < ipv6->GetNInterfaces (); i++)
+            {
+              for (uint32_t j = 0; j < ipv6->GetNAddresses (i); j++)
+                {
+                  m_addresses.insert (std::make_pair (ipv6->GetAddress (i, j).GetAddress (), n));
+                }
+            }
+        }
+      m_addressesValid = true;
+    }
+
+  std::unordered_map<Ipv6Address, uint32_t, Ipv6AddressHash>::const_iterator i = m_addresses.find (dest);
+  if (i == m_addresses.end ())
+    {
+      NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
+      return NONE;
+    }
+  return i->second;
+}
+
+bool
+Ipv6NixVectorGraph::IsInterfaceUp (Ptr<NetDevice> device) const
+{
+  Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+  if (!ipv6)
+    {
+      return true;
+    }
+  int32_t interfaceIndex = ipv6->GetInterfaceForDevice (device);
+  return interfaceIndex != -1 && ipv6->IsUp (interfaceIndex);
+}
+
+TypeId 
+Ipv6NixVectorRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv6NixVectorRouting")
+    .SetParent<Ipv6RoutingProtocol> ()
+    .SetGroupName ("NixVectorRouting")
+    .AddConstructor<Ipv6NixVectorRouting> ()
+  ;
+  return tid;
+}
+
+Ipv6NixVectorRouting::Ipv6NixVectorRouting ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+Ipv6NixVectorRouting::~Ipv6NixVectorRouting ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+Ipv6NixVectorRouting::SetIpv6 (Ptr<Ipv6> ipv6)
+{
+  NS_ASSERT (ipv6 != 0);
+  NS_ASSERT (m_ipv6 == 0);
+  NS_LOG_DEBUG ("Created Ipv6NixVectorProtocol");
+
+  m_ipv6 = ipv6;
+}
+
+void 
+Ipv6NixVectorRouting::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_node = 0;
+  m_ipv6 = 0;
+  m_cache.clear ();
+
+  Ipv6RoutingProtocol::DoDispose ();
+}
+
+void
+Ipv6NixVectorRouting::SetNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  m_node = node;
+}
+
+void
+Ipv6NixVectorRouting::FlushGlobalNixRoutingCache (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  GetGraph ()->Invalidate ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<Ipv6NixVectorRouting> rp = node->GetObject<Ipv6NixVectorRouting> ();
+      if (!rp)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Flushing Nix caches.");
+      rp->FlushNixCache ();
+    }
+}
+
+void
+Ipv6NixVectorRouting::FlushNixCache (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_cache.clear ();
+}
+
+Ipv6NixVectorGraph *
+Ipv6NixVectorRouting::GetGraph (void)
+{
+  return SimulationSingleton<Ipv6NixVectorGraph>::Get ();
+}
+
+Ipv6NixVectorRouting::CacheEntry &
+Ipv6NixVectorRouting::GetCacheEntry (Ipv6Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  Ipv6NixVectorGraph *graph = GetGraph ();
+  Cache::iterator iter = m_cache.find (address);
+  if (iter != m_cache.end () && iter->second.version == graph->GetVersion (iter->second.node))
+    {
+      NS_LOG_LOGIC ("Found destination in cache.");
+      return iter->second;
+    }
+
+  // not in cache, or the routes to the destination changed
+  CacheEntry &entry = m_cache[address];
+  entry.node = graph->GetNodeByIp (address);
+  entry.version = graph->GetVersion (entry.node);
+  entry.nixVector = 0;
+  entry.route = 0;
+  entry.neighbor = 0;
+  return entry;
+}
+
+Ptr<NixVector>
+Ipv6NixVectorRouting::GetNixVector (Ptr<Node> source, uint32_t dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (dest == NixVectorGraph::NONE)
+    {
+      NS_LOG_ERROR ("No routing path exists");
+      return 0;
+    }
+
+  // Do not process packets to self
+  if (source->GetId () == dest)
+    {
+      NS_LOG_DEBUG ("Do not process packets to self");
+      return 0;
+    }
+
+  Ptr<NixVector> nixVector = Create<NixVector> ();
+  if (GetGraph ()->BuildNixVector (source->GetId (), dest, oif, nixVector))
+    {
+      return nixVector;
+    }
+  NS_LOG_ERROR ("No routing path exists");
+  return 0;
+}
+
+Ptr<Ipv6Route>
+Ipv6NixVectorRouting::BuildRoute (Ipv6Address dest, uint32_t nodeIndex)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // Nix index is with respect to the neighbors.  The net-device index
+  // and the gateway are derived from it.
+  uint32_t index;
+  Ptr<NetDevice> gatewayDevice = GetGraph ()->GetNeighbor (m_node->GetId (), nodeIndex, index);
+  Ptr<Ipv6> ipv6 = gatewayDevice->GetNode ()->GetObject<Ipv6> ();
+  uint32_t gatewayInterface = ipv6->GetInterfaceForDevice (gatewayDevice);
+  Ipv6Address gatewayIp = ipv6->GetAddress (gatewayInterface, 0).GetAddress ();
+  for (uint32_t i = 0; i < ipv6->GetNAddresses (gatewayInterface); i++)
+    {
+      if (ipv6->GetAddress (gatewayInterface, i).GetScope () == Ipv6InterfaceAddress::LINKLOCAL)
+        {
+          gatewayIp = ipv6->GetAddress (gatewayInterface, i).GetAddress ();
+          break;
+        }
+    }
+
+  int32_t interfaceIndex = m_ipv6->GetInterfaceForDevice (m_node->GetDevice (index));
+  NS_ASSERT_MSG (interfaceIndex != -1, "Interface index not found for device");
+
+  // start filling in the Ipv6Route info
+  Ptr<Ipv6Route> rtentry = Create<Ipv6Route> ();
+  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIndex, dest));
+  rtentry->SetGateway (gatewayIp);
+  rtentry->SetDestination (dest);
+  rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIndex));
+  return rtentry;
+}
+
+Ptr<Ipv6Route> 
+Ipv6NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ipv6Address dest = header.GetDestinationAddress ();
+  NS_LOG_DEBUG ("Dest IP from header: " << dest);
+
+  if (dest.IsMulticast () || dest.IsLinkLocal ())
+    {
+      NS_LOG_LOGIC ("Not a global unicast destination");
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+
+  // check if cache
+  CacheEntry &entry = GetCacheEntry (dest);
+
+  // not in cache
+  if (!entry.nixVector)
+    {
+      NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
+      // Build the nix-vector, given this node and the
+      // dest node, and cache it
+      entry.nixVector = GetNixVector (m_node, entry.node, 0);
+    }
+
+  // path doesn't exist
+  if (!entry.nixVector)
+    {
+      NS_LOG_ERROR ("No path to the dest: " << dest);
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+      return 0;
+    }
+
+  // create a new nix vector to be used, 
+  // we want to keep the cached version clean
+  Ptr<NixVector> nixVectorForPacket = entry.nixVector->Copy ();
+
+  // Get the interface number that we go out of, by extracting
+  // from the nix-vector
+  uint32_t numberOfBits = nixVectorForPacket->BitCount (GetGraph ()->GetNNeighbors (m_node->GetId ()));
+  uint32_t nodeIndex = nixVectorForPacket->ExtractNeighborIndex (numberOfBits);
+
+  // Search here in a cache for this node index 
+  // and look for a Ipv6Route
+  Ptr<Ipv6Route> rtentry = entry.route;
+  if (!rtentry || entry.neighbor != nodeIndex)
+    {
+      NS_LOG_LOGIC ("Ipv6Route not in cache, build: ");
+      rtentry = BuildRoute (dest, nodeIndex);
+
+      // add rtentry to cache
+      entry.route = rtentry;
+      entry.neighbor = nodeIndex;
+    }
+
+  if (oif && rtentry->GetOutputDevice () != oif)
+    {
+      // a different specified output device is to be used:
+      // build a path specific to it, which is not cached
+      NS_LOG_LOGIC ("Nix-vector through the specified device, build: ");
+      nixVectorForPacket = GetNixVector (m_node, entry.node, oif);
+      if (!nixVectorForPacket)
+        {
+          NS_LOG_ERROR ("No path to the dest: " << dest);
+          sockerr = Socket::ERROR_NOROUTETOHOST;
+          return 0;
+        }
+      numberOfBits = nixVectorForPacket->BitCount (GetGraph ()->GetNNeighbors (m_node->GetId ()));
+      rtentry = BuildRoute (dest, nixVectorForPacket->ExtractNeighborIndex (numberOfBits));
+    }
+
+  sockerr = Socket::ERROR_NOTERROR;
+
+  NS_LOG_LOGIC ("Nix-vector contents: " << *entry.nixVector << " : Remaining bits: " << nixVectorForPacket->GetRemainingBits ());
+
+  // Add  nix-vector in the packet class 
+  // make sure the packet exists first
+  if (p)
+    {
+      NS_LOG_LOGIC ("Adding Nix-vector to packet: " << *nixVectorForPacket);
+      p->SetNixVector (nixVectorForPacket);
+    }
+
+  return rtentry;
+}
+
+bool 
+Ipv6NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                                  UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                                  LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NS_ASSERT (m_ipv6 != 0);
+  // Check if input device supports IP
+  NS_ASSERT (m_ipv6->GetInterfaceForDevice (idev) >= 0);
+
+  // The local delivery is done by Ipv6L3Protocol, and the multicast
+  // packets are left to the other routing protocols.  A packet whose
+  // nix-vector is used up reached its destination node, but through an
+  // interface without its destination address (see the
+  // StrongEndSystemModel attribute of Ipv6L3Protocol).
+  Ptr<NixVector> nixVector = p->GetNixVector ();
+  if (header.GetDestinationAddress ().IsMulticast () || !nixVector
+      || nixVector->GetRemainingBits () == 0)
+    {
+      NS_LOG_LOGIC ("No nix-vector to route with");
+      return false;
+    }
+
+  // Get the interface number that we go out of, by extracting
+  // from the nix-vector
+  uint32_t numberOfBits = nixVector->BitCount (GetGraph ()->GetNNeighbors (m_node->GetId ()));
+  uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
+
+  CacheEntry &entry = GetCacheEntry (header.GetDestinationAddress ());
+  Ptr<Ipv6Route> rtentry = entry.route;
+  // not in cache, or toward another neighbor
+  if (!rtentry || entry.neighbor != nodeIndex)
+    {
+      NS_LOG_LOGIC ("Ipv6Route not in cache, build: ");
+      rtentry = BuildRoute (header.GetDestinationAddress (), nodeIndex);
+
+      // add rtentry to cache
+      entry.route = rtentry;
+      entry.neighbor = nodeIndex;
+    }
+
+  NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
+                " bits from Nix-vector: " << nixVector << " : " << *nixVector);
+
+  // call the unicast callback
+  ucb (idev, rtentry, p, header);
+
+  return true;
+}
+
+void
+Ipv6NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+  std::ostream* os = stream->GetStream ();
+
+  *os << "Node: " << m_ipv6->GetObject<Node> ()->GetId ()
+      << ", Time: " << Now().As (unit)
+      << ", Local time: " << GetObject<Node> ()->GetLocalTime ().As (unit)
+      << ", Nix Routing" << std::endl;
+
+  // the entries whose routes are still valid, sorted by destination
+  std::map<Ipv6Address, const CacheEntry *> entries;
+  for (Cache::const_iterator it = m_cache.begin (); it != m_cache.end (); it++)
+    {
+      if (it->second.version == GetGraph ()->GetVersion (it->second.node))
+        {
+          entries[it->first] = &it->second;
+        }
+    }
+
+  *os << "NixCache:" << std::endl;
+  if (entries.size () > 0)
+    {
+      *os << "Destination                   NixVector" << std::endl;
+      for (std::map<Ipv6Address, const CacheEntry *>::const_iterator it = entries.begin (); it != entries.end (); it++)
+        {
+          if (!it->second->nixVector)
+            {
+              continue;
+            }
+          std::ostringstream dest;
+          dest << it->first;
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << dest.str ();
+          *os << *(it->second->nixVector) << std::endl;
+        }
+    }
+  *os << "Ipv6RouteCache:" << std::endl;
+  if (entries.size () > 0)
+    {
+      *os << "Destination                   Gateway                       Source                          OutputDevice" << std::endl;
+      for (std::map<Ipv6Address, const CacheEntry *>::const_iterator it = entries.begin (); it != entries.end (); it++)
+        {
+          Ptr<Ipv6Route> route = it->second->route;
+          if (!route)
+            {
+              continue;
+            }
+          std::ostringstream dest, gw, src;
+          dest << route->GetDestination ();
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << dest.str ();
+          gw << route->GetGateway ();
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << gw.str ();
+          src << route->GetSource ();
+          *os << std::setiosflags (std::ios::left) << std::setw (30) << src.str ();
+          *os << "  ";
+          if (Names::FindName (route->GetOutputDevice ()) != "")
+            {
+              *os << Names::FindName (route->GetOutputDevice ());
+            }
+          else
+            {
+              *os << route->GetOutputDevice ()->GetIfIndex ();
+            }
+          *os << std::endl;
+        }
+    }
+  *os << std::endl;
+}
+
+// virtual functions from Ipv6RoutingProtocol 
+void
+Ipv6NixVectorRouting::NotifyInterfaceUp (uint32_t i)
+{
+  GetGraph ()->NotifyDevice (m_ipv6->GetNetDevice (i));
+}
+void
+Ipv6NixVectorRouting::NotifyInterfaceDown (uint32_t i)
+{
+  GetGraph ()->NotifyDevice (m_ipv6->GetNetDevice (i));
+}
+void
+Ipv6NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  GetGraph ()->Invalidate ();
+}
+void
+Ipv6NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  GetGraph ()->Invalidate ();
+}
+void
+Ipv6NixVectorRouting::NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
+{
+}
+void
+Ipv6NixVectorRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
+{
+}
+
+} // namespace ns3
@@ -0,0 +1,504 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+
+#include "nix-vector-graph.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NixVectorGraph");
+
+/**
+ * \ingroup nix-vector-routing
+ * The maximum number of destinations whose shortest path trees are kept.
+ */
+static GlobalValue g_nixVectorMaxTrees = GlobalValue ("NixVectorMaxTrees",
+                                                      "The maximum number of destinations whose shortest path trees "
+                                                      "are kept by nix-vector routing, for each version of IP",
+                                                      UintegerValue (64),
+                                                      MakeUintegerChecker<uint32_t> (1));
+
+const uint32_t NixVectorGraph::NONE;
+
+NixVectorGraph::NixVectorGraph ()
+  : m_valid (false),
+    m_nNodes (0),
+    m_epoch (0),
+    m_lastVersion (0)
+{
+  NS_LOG_FUNCTION (this);
+  UintegerValue maxTrees;
+  g_nixVectorMaxTrees.GetValue (maxTrees);
+  m_maxTrees = maxTrees.Get ();
+}
+
+NixVectorGraph::~NixVectorGraph ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NixVectorGraph::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  CriticalSection cs (m_mutex);
+  m_valid = false;
+}
+
+void
+NixVectorGraph::NotifyDevice (Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  CriticalSection cs (m_mutex);
+  uint32_t node = device->GetNode ()->GetId ();
+  if (!m_valid || node >= m_nNodes)
+    {
+      // the graph is built from scratch before its next use
+      return;
+    }
+
+  bool usable = IsUsable (device);
+  std::vector<uint32_t> changed;
+  for (uint32_t e = m_offsets[node]; e < m_offsets[node + 1]; e++)
+    {
+      if (m_edges[e].device == device->GetIfIndex () && m_usable[e] != usable)
+        {
+          m_usable[e] = usable;
+          changed.push_back (e);
+        }
+    }
+  if (changed.empty ())
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Links of node " << node << " device " << device->GetIfIndex () << (usable ? " up" : " down"));
+
+  for (Trees::iterator i = m_trees.begin (); i != m_trees.end (); )
+    {
+      bool valid = true;
+      if (usable)
+        {
+          // The tree stays a shortest path tree unless a new link leads
+          // closer to the destination.
+          uint32_t distance = GetDistance (*i, node);
+          for (std::vector<uint32_t>::const_iterator j = changed.begin (); j != changed.end (); j++)
+            {
+              uint32_t remoteDistance = GetDistance (*i, m_edges[*j].remoteNode);
+              if (remoteDistance != NONE && (distance == NONE || remoteDistance + 1 < distance))
+                {
+                  valid = false;
+                }
+            }
+        }
+      else
+        {
+          // The paths which do not use the lost links keep their length.
+          valid = std::find (changed.begin (), changed.end (), i->next[node]) == changed.end ();
+        }
+      if (valid)
+        {
+          i++;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Dropping the tree toward node " << i->dest);
+          ChangeVersion (i->dest);
+          m_treeIndex.erase (i->dest);
+          i = m_trees.erase (i);
+        }
+    }
+
+  // The routes to the destinations without a tree were built from trees
+  // which are gone, and may be affected.
+  for (uint32_t dest = 0; dest < m_nNodes; dest++)
+    {
+      if (m_treeIndex.find (dest) == m_treeIndex.end ())
+        {
+          ChangeVersion (dest);
+        }
+    }
+}
+
+uint32_t
+NixVectorGraph::GetVersion (uint32_t dest)
+{
+  CriticalSection cs (m_mutex);
+  Update ();
+  if (dest >= m_nNodes)
+    {
+      return m_epoch;
+    }
+  return m_versions[dest];
+}
+
+bool
+NixVectorGraph::BuildNixVector (uint32_t source, uint32_t dest, Ptr<NetDevice> oif, Ptr<NixVector> nixVector)
+{
+  NS_LOG_FUNCTION (this << source << dest << oif);
+  CriticalSection cs (m_mutex);
+  Update ();
+  NS_ASSERT (source < m_nNodes && dest < m_nNodes);
+
+  std::vector<uint32_t> path;
+  if (oif)
+    {
+      // specific to this source: search from the source
+      if (!BFS (source, dest, oif->GetIfIndex (), path))
+        {
+          return false;
+        }
+    }
+  else
+    {
+      const Tree &tree = GetTree (dest);
+      for (uint32_t node = source; node != dest; node = m_edges[path.back ()].remoteNode)
+        {
+          if (tree.next[node] == NONE)
+            {
+              return false;
+            }
+          path.push_back (tree.next[node]);
+        }
+    }
+
+  // The nodes extract their neighbor index in path order, so the last
+  // hop is added first.
+  std::vector<uint32_t> nodes;
+  nodes.push_back (source);
+  for (uint32_t i = 0; i + 1 < path.size (); i++)
+    {
+      nodes.push_back (m_edges[path[i]].remoteNode);
+    }
+  for (uint32_t i = path.size (); i-- > 0; )
+    {
+      uint32_t node = nodes[i];
+      uint32_t totalNeighbors = m_offsets[node + 1] - m_offsets[node];
+      NS_LOG_LOGIC ("Adding Nix: " << path[i] - m_offsets[node] << " with "
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << node);
+      nixVector->AddNeighborIndex (path[i] - m_offsets[node], nixVector->BitCount (totalNeighbors));
+    }
+  return true;
+}
+
+uint32_t
+NixVectorGraph::GetNNeighbors (uint32_t node)
+{
+  CriticalSection cs (m_mutex);
+  Update ();
+  NS_ASSERT (node < m_nNodes);
+  return m_offsets[node + 1] - m_offsets[node];
+}
+
+Ptr<NetDevice>
+NixVectorGraph::GetNeighbor (uint32_t node, uint32_t neighbor, uint32_t &device)
+{
+  CriticalSection cs (m_mutex);
+  Update ();
+  NS_ASSERT_MSG (node < m_nNodes && neighbor < m_offsets[node + 1] - m_offsets[node],
+                 "Node " << node << " has no neighbor " << neighbor);
+  const Edge &edge = m_edges[m_offsets[node] + neighbor];
+  device = edge.device;
+  return NodeList::GetNode (edge.remoteNode)->GetDevice (edge.remoteDevice);
+}
+
+void
+NixVectorGraph::Update (void)
+{
+  if (!m_valid || m_nNodes != NodeList::GetNNodes ())
+    {
+      Build ();
+    }
+}
+
+void
+NixVectorGraph::Build (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nNodes = NodeList::GetNNodes ();
+  m_offsets.assign (1, 0);
+  m_edges.clear ();
+  m_usable.clear ();
+
+  // scan through the net devices of the nodes
+  // and then look at the nodes adjacent to them
+  for (uint32_t n = 0; n < m_nNodes; n++)
+    {
+      Ptr<Node> node = NodeList::GetNode (n);
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          if (localNetDevice->IsBridge ())
+            {
+              continue;
+            }
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+
+          // this function takes in the local net dev, and channel, and
+          // writes to the netDeviceContainer the adjacent net devs
+          NetDeviceContainer netDeviceContainer;
+          GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+          bool usable = IsUsable (localNetDevice);
+          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+            {
+              Edge edge;
+              edge.device = i;
+              edge.remoteNode = (*iter)->GetNode ()->GetId ();
+              edge.remoteDevice = (*iter)->GetIfIndex ();
+              m_edges.push_back (edge);
+              m_usable.push_back (usable);
+            }
+        }
+      m_offsets.push_back (m_edges.size ());
+    }
+
+  // Index the edges by neighbor, for the searches from the destinations.
+  m_inOffsets.assign (m_nNodes + 1, 0);
+  for (std::vector<Edge>::const_iterator i = m_edges.begin (); i != m_edges.end (); i++)
+    {
+      m_inOffsets[i->remoteNode + 1]++;
+    }
+  for (uint32_t n = 0; n < m_nNodes; n++)
+    {
+      m_inOffsets[n + 1] += m_inOffsets[n];
+    }
+  std::vector<uint32_t> position (m_inOffsets.begin (), m_inOffsets.end () - 1);
+  m_inEdges.resize (m_edges.size ());
+  m_inNodes.resize (m_edges.size ());
+  for (uint32_t n = 0; n < m_nNodes; n++)
+    {
+      for (uint32_t e = m_offsets[n]; e < m_offsets[n + 1]; e++)
+        {
+          uint32_t k = position[m_edges[e].remoteNode]++;
+          m_inEdges[k] = e;
+          m_inNodes[k] = n;
+        }
+    }
+
+  m_trees.clear ();
+  m_treeIndex.clear ();
+  m_epoch = ++m_lastVersion;
+  m_versions.assign (m_nNodes, m_epoch);
+  m_valid = true;
+  NS_LOG_LOGIC ("Built the graph of " << m_nNodes << " nodes and " << m_edges.size () << " links");
+}
+
+const NixVectorGraph::Tree &
+NixVectorGraph::GetTree (uint32_t dest)
+{
+  NS_LOG_FUNCTION (this << dest);
+  std::unordered_map<uint32_t, Trees::iterator>::iterator found = m_treeIndex.find (dest);
+  if (found != m_treeIndex.end ())
+    {
+      m_trees.splice (m_trees.begin (), m_trees, found->second);
+      return m_trees.front ();
+    }
+
+  // Breadth first search from the destination, through the links which
+  // can be used toward it.
+  m_trees.push_front (Tree ());
+  Tree &tree = m_trees.front ();
+  tree.dest = dest;
+  tree.next.assign (m_nNodes, NONE);
+  std::vector<bool> seen (m_nNodes, false);
+  std::vector<uint32_t> queue;
+  queue.push_back (dest);
+  seen[dest] = true;
+  for (uint32_t head = 0; head < queue.size (); head++)
+    {
+      uint32_t node = queue[head];
+      for (uint32_t k = m_inOffsets[node]; k < m_inOffsets[node + 1]; k++)
+        {
+          uint32_t from = m_inNodes[k];
+          if (!seen[from] && m_usable[m_inEdges[k]])
+            {
+              seen[from] = true;
+              tree.next[from] = m_inEdges[k];
+              queue.push_back (from);
+            }
+        }
+    }
+  m_treeIndex[dest] = m_trees.begin ();
+
+  if (m_trees.size () > m_maxTrees)
+    {
+      m_treeIndex.erase (m_trees.back ().dest);
+      m_trees.pop_back ();
+    }
+  return m_trees.front ();
+}
+
+uint32_t
+NixVectorGraph::GetDistance (const Tree &tree, uint32_t node) const
+{
+  uint32_t distance = 0;
+  while (node != tree.dest)
+    {
+      if (tree.next[node] == NONE)
+        {
+          return NONE;
+        }
+      node = m_edges[tree.next[node]].remoteNode;
+      distance++;
+    }
+  return distance;
+}
+
+bool
+NixVectorGraph::BFS (uint32_t source, uint32_t dest, uint32_t oif, std::vector<uint32_t> &path) const
+{
+  NS_LOG_FUNCTION (this << source << dest << oif);
+  std::vector<uint32_t> parentEdge (m_nNodes, NONE);
+  std::vector<uint32_t> parentNode (m_nNodes, NONE);
+  std::vector<uint32_t> queue;
+  queue.push_back (source);
+  parentNode[source] = source;
+  for (uint32_t head = 0; head < queue.size () && parentNode[dest] == NONE; head++)
+    {
+      uint32_t node = queue[head];
+      for (uint32_t e = m_offsets[node]; e < m_offsets[node + 1]; e++)
+        {
+          // from the source, only leave through the output interface
+          if (!m_usable[e] || (node == source && m_edges[e].device != oif))
+            {
+              continue;
+            }
+          uint32_t remote = m_edges[e].remoteNode;
+          if (parentNode[remote] == NONE)
+            {
+              parentNode[remote] = node;
+              parentEdge[remote] = e;
+              queue.push_back (remote);
+            }
+        }
+    }
+  if (parentNode[dest] == NONE)
+    {
+      return false;
+    }
+  for (uint32_t node = dest; node != source; node = parentNode[node])
+    {
+      path.push_back (parentEdge[node]);
+    }
+  std::reverse (path.begin (), path.end ());
+  return true;
+}
+
+bool
+NixVectorGraph::IsUsable (Ptr<NetDevice> device) const
+{
+  return IsInterfaceUp (device) && device->IsLinkUp ();
+}
+
+void
+NixVectorGraph::ChangeVersion (uint32_t dest)
+{
+  m_versions[dest] = ++m_lastVersion;
+}
+
+void
+NixVectorGraph::GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> remoteDevice = channel->GetDevice (i);
+      if (remoteDevice != netDevice)
+        {
+          Ptr<BridgeNetDevice> bd = NetDeviceIsBridged (remoteDevice);
+          // we have a bridged device, we need to add all
+          // bridged devices
+          if (bd)
+            {
+              NS_LOG_LOGIC ("Looking through bridge ports of bridge net device " << bd);
+              for (uint32_t j = 0; j < bd->GetNBridgePorts (); ++j)
+                {
+                  Ptr<NetDevice> ndBridged = bd->GetBridgePort (j);
+                  if (ndBridged == remoteDevice)
+                    {
+                      NS_LOG_LOGIC ("That bridge port is me, don't walk backward");
+                      continue;
+                    }
+                  Ptr<Channel> chBridged = ndBridged->GetChannel ();
+                  if (chBridged == 0)
+                    {
+                      continue;
+                    }
+                  GetAdjacentNetDevices (ndBridged, chBridged, netDeviceContainer);
+                }
+            }
+          else
+            {
+              netDeviceContainer.Add (channel->GetDevice (i));
+            }
+        }
+    }
+}
+
+Ptr<BridgeNetDevice>
+NixVectorGraph::NetDeviceIsBridged (Ptr<NetDevice> nd)
+{
+  NS_LOG_FUNCTION (nd);
+
+  Ptr<Node> node = nd->GetNode ();
+  uint32_t nDevices = node->GetNDevices ();
+
+  //
+  // There is no bit on a net device that says it is being bridged, so we have
+  // to look for bridges on the node to which the device is attached.  If we
+  // find a bridge, we need to look through its bridge ports (the devices it
+  // bridges) to see if we find the device in question.
+  //
+  for (uint32_t i = 0; i < nDevices; ++i)
+    {
+      Ptr<NetDevice> ndTest = node->GetDevice (i);
+      NS_LOG_LOGIC ("Examine device " << i << " " << ndTest);
+
+      if (ndTest->IsBridge ())
+        {
+          NS_LOG_LOGIC ("device " << i << " is a bridge net device");
+          Ptr<BridgeNetDevice> bnd = ndTest->GetObject<BridgeNetDevice> ();
+          NS_ABORT_MSG_UNLESS (bnd, "NixVectorGraph::NetDeviceIsBridged (): GetObject for <BridgeNetDevice> failed");
+
+          for (uint32_t j = 0; j < bnd->GetNBridgePorts (); ++j)
+            {
+              NS_LOG_LOGIC ("Examine bridge port " << j << " " << bnd->GetBridgePort (j));
+              if (bnd->GetBridgePort (j) == nd)
+                {
+                  NS_LOG_LOGIC ("Net device " << nd << " is bridged by " << bnd);
+                  return bnd;
+                }
+            }
+        }
+    }
+  NS_LOG_LOGIC ("Net device " << nd << " is not bridged");
+  return 0;
+}
+
+} // namespace ns3
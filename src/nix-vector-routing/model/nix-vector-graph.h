@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NIX_VECTOR_GRAPH_H
+#define NIX_VECTOR_GRAPH_H
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/system-mutex.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/nix-vector.h"
+#include "ns3/net-device-container.h"
+#include "ns3/bridge-net-device.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup nix-vector-routing
+ *
+ * \brief The topology shared by the nix-vector routing protocols of all
+ * the nodes, and the shortest path trees computed on it.
+ *
+ * The neighbors of each node are numbered once, in the order of its net
+ * devices, and stored as integer indexes in a single array, so that the
+ * memory used grows with the number of links only.  A breadth first
+ * search from a destination gives the next hop of every node toward that
+ * destination: the resulting tree is shared by all the sources, and the
+ * trees of the most recently used destinations are kept (see the
+ * NixVectorMaxTrees global value).
+ *
+ * The links out of a net device whose IP interface or link is down are
+ * not used.  When an interface goes up or down, only the trees which
+ * this can change are dropped; the routing protocols compare the version
+ * of a destination (see GetVersion) to the version of their cached
+ * routes to know whether these are still valid.
+ *
+ * The subclasses tell whether the IP interface of a net device is up, for
+ * their version of IP.
+ *
+ * All the public methods lock the graph, so that the nodes of the
+ * partitions of a MultithreadedSimulatorImpl can share it.  The graph is
+ * built from the net devices and the IP interfaces of all the nodes,
+ * though, so these must not change while such a simulation runs.
+ */
+class NixVectorGraph
+{
+public:
+  /** The index of a node which does not exist. */
+  static const uint32_t NONE = 0xffffffff;
+
+  NixVectorGraph ();
+  virtual ~NixVectorGraph ();
+
+  /**
+   * \brief Rebuild the whole graph before its next use.
+   *
+   * All the versions change.
+   */
+  virtual void Invalidate (void);
+
+  /**
+   * \brief Update the links out of a net device, after its IP interface
+   * went up or down.
+   *
+   * The trees which the change may shorten or break are dropped, and the
+   * versions of their destinations change.
+   *
+   * \param device the net device
+   */
+  void NotifyDevice (Ptr<NetDevice> device);
+
+  /**
+   * \brief Get the version of the routes to a destination.
+   *
+   * The version changes when the routes to the destination may have
+   * changed.
+   *
+   * \param dest the destination node index, or NONE
+   * \returns the version
+   */
+  uint32_t GetVersion (uint32_t dest);
+
+  /**
+   * \brief Build the nix-vector of a shortest path.
+   * \param [in] source the source node index
+   * \param [in] dest the destination node index
+   * \param [in] oif the net device of the source to leave through, if not null
+   * \param [out] nixVector the nix-vector
+   * \returns false if there is no path to the destination, true otherwise
+   */
+  bool BuildNixVector (uint32_t source, uint32_t dest, Ptr<NetDevice> oif, Ptr<NixVector> nixVector);
+
+  /**
+   * \brief Get the number of neighbors of a node, which gives the number
+   * of bits of its neighbor indexes in the nix-vectors.
+   * \param node the node index
+   * \returns the number of neighbors
+   */
+  uint32_t GetNNeighbors (uint32_t node);
+
+  /**
+   * \brief Get a neighbor of a node.
+   * \param [in] node the node index
+   * \param [in] neighbor the neighbor index, as found in the nix-vectors
+   * \param [out] device the index of the net device of the node which
+   *              leads to the neighbor
+   * \returns the net device of the neighbor
+   */
+  Ptr<NetDevice> GetNeighbor (uint32_t node, uint32_t neighbor, uint32_t &device);
+
+protected:
+  /**
+   * \brief Tell whether the IP interface of a net device is up.
+   * \param device the net device
+   * \returns true if the node has no IP interface on the net device, or
+   *          if the interface is up
+   */
+  virtual bool IsInterfaceUp (Ptr<NetDevice> device) const = 0;
+
+  /**
+   * The lock of the graph, which the subclasses also hold while
+   * accessing their own shared state.  It is not recursive.
+   */
+  SystemMutex m_mutex;
+
+private:
+  /** A link from a node to a neighbor. */
+  struct Edge
+  {
+    uint32_t device;       //!< The net device index, in the node
+    uint32_t remoteNode;   //!< The neighbor node index
+    uint32_t remoteDevice; //!< The net device index, in the neighbor
+  };
+
+  /** The shortest path tree toward a destination. */
+  struct Tree
+  {
+    uint32_t dest;              //!< The destination node index
+    std::vector<uint32_t> next; //!< The edge from each node toward the destination, or NONE
+  };
+
+  /// container of Tree, from the most recently used
+  typedef std::list<Tree> Trees;
+
+  /**
+   * \brief Disable the copy.
+   * \param o the graph to copy
+   */
+  NixVectorGraph (const NixVectorGraph &o);
+  /**
+   * \brief Disable the assignment.
+   * \param o the graph to copy
+   * \returns this graph
+   */
+  NixVectorGraph &operator= (const NixVectorGraph &o);
+
+  /**
+   * \brief Build the graph if it is invalid or if nodes were created.
+   */
+  void Update (void);
+
+  /**
+   * \brief Build the graph from the nodes of the NodeList.
+   */
+  void Build (void);
+
+  /**
+   * \brief Get the shortest path tree toward a destination, computing it
+   * if it is not cached.
+   * \param dest the destination node index
+   * \returns the tree
+   */
+  const Tree &GetTree (uint32_t dest);
+
+  /**
+   * \brief Get the number of hops from a node to the destination of a tree.
+   * \param tree the tree
+   * \param node the node index
+   * \returns the number of hops, or NONE if the destination cannot be reached
+   */
+  uint32_t GetDistance (const Tree &tree, uint32_t node) const;
+
+  /**
+   * \brief Breadth first search from a source, leaving through a net device.
+   * \param [in] source the source node index
+   * \param [in] dest the destination node index
+   * \param [in] oif the net device index of the source to leave through
+   * \param [out] path the edges from the source to the destination
+   * \returns false if dest not found, true o.w.
+   */
+  bool BFS (uint32_t source, uint32_t dest, uint32_t oif, std::vector<uint32_t> &path) const;
+
+  /**
+   * \brief Tell whether the links out of a net device can be used.
+   * \param device the net device
+   * \returns true if the IP interface and the link of the device are up
+   */
+  bool IsUsable (Ptr<NetDevice> device) const;
+
+  /**
+   * \brief Change the version of a destination.
+   * \param dest the destination node index
+   */
+  void ChangeVersion (uint32_t dest);
+
+  /**
+   * Given a net-device returns all the adjacent net-devices,
+   * essentially getting the neighbors on that channel
+   * \param [in] netDevice the NetDevice attached to the channel.
+   * \param [in] channel the channel to check
+   * \param [out] netDeviceContainer the NetDeviceContainer of the NetDevices in the channel.
+   */
+  static void GetAdjacentNetDevices (Ptr<NetDevice> netDevice, Ptr<Channel> channel, NetDeviceContainer & netDeviceContainer);
+
+  /**
+   * Determine if the NetDevice is bridged
+   * \param nd the NetDevice to check
+   * \returns the bridging NetDevice (or null if the NetDevice is not bridged)
+   */
+  static Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd);
+
+  bool m_valid;                      //!< Set to false to rebuild the graph
+  uint32_t m_nNodes;                 //!< The number of nodes in the graph
+  std::vector<uint32_t> m_offsets;   //!< The first edge of each node, and the number of edges
+  std::vector<Edge> m_edges;         //!< The edges of all the nodes, in neighbor order
+  std::vector<bool> m_usable;        //!< Whether each edge can be used
+  std::vector<uint32_t> m_inOffsets; //!< The first edge toward each node
+  std::vector<uint32_t> m_inEdges;   //!< The edges toward each node
+  std::vector<uint32_t> m_inNodes;   //!< The node of each edge of m_inEdges
+
+  Trees m_trees;                     //!< The cached trees, from the most recently used
+  std::unordered_map<uint32_t, Trees::iterator> m_treeIndex; //!< The cached trees, by destination
+  uint32_t m_maxTrees;               //!< The maximum number of cached trees
+
+  std::vector<uint32_t> m_versions;  //!< The version of each destination
+  uint32_t m_epoch;                  //!< The version when the graph was built
+  uint32_t m_lastVersion;            //!< The last version given
+};
+
+} // namespace ns3
+
+#endif /* NIX_VECTOR_GRAPH_H */
@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv6-list-routing-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv6-nix-vector-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simple-channel.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv6-route.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup nix-vector-routing
+ * \defgroup nix-vector-routing-test Nix-vector routing tests
+ */
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing test, for IPv4 or IPv6.
+ *
+ * Five nodes with point-to-point links: n0-n1-n2, and the longer path
+ * n0-n3-n4-n2.  The packets from n0 to n2 go through n1, then through n3
+ * and n4 while the interface of n1 toward n2 is down, and through n1
+ * again when it is back up.
+ */
+class NixVectorRoutingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param ipv6 true to test IPv6, false to test IPv4
+   */
+  NixVectorRoutingTestCase (bool ipv6);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send a packet from n0 to n2.
+   */
+  void SendData (void);
+  /**
+   * Receive the packets.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (Ptr<Socket> socket);
+  /**
+   * Get the device of n0 through which the packets to n2 leave.
+   * \returns The output device.
+   */
+  Ptr<NetDevice> GetOutputDevice (void) const;
+  /**
+   * Set the interface of n1 toward n2 up or down.
+   * \param up true to set the interface up
+   */
+  void SetUp (bool up);
+
+  bool m_ipv6;                 //!< Test IPv6 rather than IPv4
+  NodeContainer m_nodes;       //!< The nodes
+  NetDeviceContainer m_n0n1;   //!< The devices of the n0-n1 link
+  NetDeviceContainer m_n1n2;   //!< The devices of the n1-n2 link
+  NetDeviceContainer m_n0n3;   //!< The devices of the n0-n3 link
+  Address m_destination;       //!< The address of n2
+  Ptr<Socket> m_txSocket;      //!< The socket of n0
+  uint32_t m_received;         //!< The number of packets received by n2
+};
+
+NixVectorRoutingTestCase::NixVectorRoutingTestCase (bool ipv6)
+  : TestCase (ipv6 ? "IPv6 nix-vector routing" : "IPv4 nix-vector routing"),
+    m_ipv6 (ipv6),
+    m_received (0)
+{
+}
+
+void
+NixVectorRoutingTestCase::SendData (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_txSocket->SendTo (Create<Packet> (123), 0, m_destination), 123, "Packet not sent");
+}
+
+void
+NixVectorRoutingTestCase::ReceivePkt (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received++;
+    }
+}
+
+Ptr<NetDevice>
+NixVectorRoutingTestCase::GetOutputDevice (void) const
+{
+  Socket::SocketErrno err;
+  if (m_ipv6)
+    {
+      Ipv6Header header;
+      header.SetDestinationAddress (Inet6SocketAddress::ConvertFrom (m_destination).GetIpv6 ());
+      Ptr<Ipv6Route> route = m_nodes.Get (0)->GetObject<Ipv6> ()->GetRoutingProtocol ()->RouteOutput (0, header, 0, err);
+      return route ? route->GetOutputDevice () : 0;
+    }
+  Ipv4Header header;
+  header.SetDestination (InetSocketAddress::ConvertFrom (m_destination).GetIpv4 ());
+  Ptr<Ipv4Route> route = m_nodes.Get (0)->GetObject<Ipv4> ()->GetRoutingProtocol ()->RouteOutput (0, header, 0, err);
+  return route ? route->GetOutputDevice () : 0;
+}
+
+void
+NixVectorRoutingTestCase::SetUp (bool up)
+{
+  Ptr<Node> n1 = m_nodes.Get (1);
+  if (m_ipv6)
+    {
+      Ptr<Ipv6> ipv6 = n1->GetObject<Ipv6> ();
+      uint32_t interface = ipv6->GetInterfaceForDevice (m_n1n2.Get (0));
+      up ? ipv6->SetUp (interface) : ipv6->SetDown (interface);
+    }
+  else
+    {
+      Ptr<Ipv4> ipv4 = n1->GetObject<Ipv4> ();
+      uint32_t interface = ipv4->GetInterfaceForDevice (m_n1n2.Get (0));
+      up ? ipv4->SetUp (interface) : ipv4->SetDown (interface);
+    }
+}
+
+void
+NixVectorRoutingTestCase::DoRun (void)
+{
+  m_nodes.Create (5);
+
+  InternetStackHelper internet;
+  if (m_ipv6)
+    {
+      Ipv6ListRoutingHelper list;
+      list.Add (Ipv6StaticRoutingHelper (), 0);
+      list.Add (Ipv6NixVectorHelper (), 10);
+      internet.SetIpv4StackInstall (false);
+      internet.SetRoutingHelper (list);
+    }
+  else
+    {
+      internet.SetIpv6StackInstall (false);
+      internet.SetRoutingHelper (Ipv4NixVectorHelper ());
+    }
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  uint32_t links[5][2] = { { 0, 1 }, { 1, 2 }, { 0, 3 }, { 3, 4 }, { 4, 2 } };
+  std::vector<NetDeviceContainer> devices;
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (m_nodes.Get (links[i][0]), channel);
+      net.Add (simpleHelper.Install (m_nodes.Get (links[i][1]), channel));
+      devices.push_back (net);
+    }
+  m_n0n1 = devices[0];
+  m_n1n2 = devices[1];
+  m_n0n3 = devices[2];
+  if (m_ipv6)
+    {
+      // n2 receives the packets through n4 on another interface than the
+      // one of its address
+      m_nodes.Get (2)->GetObject<Ipv6> ()->SetAttribute ("StrongEndSystemModel", BooleanValue (false));
+    }
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      if (m_ipv6)
+        {
+          for (uint32_t j = 0; j < 2; j++)
+            {
+              devices[i].Get (j)->GetNode ()->GetObject<Icmpv6L4Protocol> ()->SetAttribute ("DAD", BooleanValue (false));
+            }
+          Ipv6InterfaceContainer interfaces = ipv6.Assign (devices[i]);
+          interfaces.SetForwarding (0, true);
+          interfaces.SetForwarding (1, true);
+          if (i == 1)
+            {
+              m_destination = Inet6SocketAddress (interfaces.GetAddress (1, 1), 1234);
+            }
+          ipv6.NewNetwork ();
+        }
+      else
+        {
+          Ipv4InterfaceContainer interfaces = ipv4.Assign (devices[i]);
+          if (i == 1)
+            {
+              m_destination = InetSocketAddress (interfaces.GetAddress (1), 1234);
+            }
+          ipv4.NewNetwork ();
+        }
+    }
+
+  Ptr<Socket> rxSocket = Socket::CreateSocket (m_nodes.Get (2), UdpSocketFactory::GetTypeId ());
+  if (m_ipv6)
+    {
+      rxSocket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+    }
+  else
+    {
+      rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+    }
+  rxSocket->SetRecvCallback (MakeCallback (&NixVectorRoutingTestCase::ReceivePkt, this));
+  m_txSocket = Socket::CreateSocket (m_nodes.Get (0), UdpSocketFactory::GetTypeId ());
+
+  // shortest path, through n1
+  NS_TEST_EXPECT_MSG_EQ (GetOutputDevice (), m_n0n1.Get (0), "Wrong output device");
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingTestCase::SendData, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 1, "Packet not received through n1");
+
+  // n1 cannot reach n2: through n3 and n4
+  SetUp (false);
+  NS_TEST_EXPECT_MSG_EQ (GetOutputDevice (), m_n0n3.Get (0), "Wrong output device with n1-n2 down");
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingTestCase::SendData, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 2, "Packet not received through n3 and n4");
+
+  // back through n1
+  SetUp (true);
+  NS_TEST_EXPECT_MSG_EQ (GetOutputDevice (), m_n0n1.Get (0), "Wrong output device with n1-n2 up");
+  Simulator::Schedule (Seconds (1), &NixVectorRoutingTestCase::SendData, this);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_received, 3, "Packet not received through n1 again");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * \brief Nix-vector routing TestSuite
+ */
+class NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  NixVectorRoutingTestSuite ();
+};
+
+NixVectorRoutingTestSuite::NixVectorRoutingTestSuite ()
+  : TestSuite ("nix-vector-routing", UNIT)
+{
+  AddTestCase (new NixVectorRoutingTestCase (false), TestCase::QUICK);
+  AddTestCase (new NixVectorRoutingTestCase (true), TestCase::QUICK);
+}
+
+static NixVectorRoutingTestSuite g_nixVectorRoutingTestSuite; //!< Static variable for test initialization
@@ -97,9 +97,21 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+  uint32_t context = m_link[wire].m_dst->GetNode ()->GetId ();
+  if (Simulator::IsLocalContext (context))
+    {
+      Simulator::ScheduleWithContext (context,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, p->Copy ());
+    }
+  else
+    {
+      // the receiver is run by another thread: the event must share
+      // neither the packet storage nor the reference count of the device.
+      Simulator::ScheduleWithContext (context,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), p->DeepCopy ());
+    }
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
@@ -25,6 +25,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -556,6 +557,51 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+bool
+PointToPointNetDevice::SendBatch (
+  Ptr<PacketBurst> burst,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  if (IsLinkUp () == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return false;
+    }
+
+  //
+  // Queue the packets as Send does, with the link checked once for the
+  // whole burst.  The first packet starts the transmission if the
+  // device is idle; the others wait in the queue.
+  //
+  bool sent = true;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      Ptr<Packet> packet = *i;
+      AddHeader (packet, protocolNumber);
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+          sent = false;
+          continue;
+        }
+      if (m_txMachineState == READY)
+        {
+          packet = m_queue->Dequeue ();
+          m_snifferTrace (packet);
+          m_promiscSnifferTrace (packet);
+          sent = TransmitStart (packet) && sent;
+        }
+    }
+  return sent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
@@ -24,6 +24,13 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/packet-burst.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/socket.h"
+#include "ns3/uinteger.h"
+
+#include <vector>
 
 using namespace ns3;
 
@@ -94,6 +101,350 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test class for PointToPointNetDevice::SendBatch
+ *
+ * It sends a burst of packets with SendBatch and with one Send per
+ * packet, and checks that they are received in the same order at the
+ * same times.
+ */
+class PointToPointBatchTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointBatchTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send a burst of packets to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param batch whether to send the burst with SendBatch
+   */
+  void SendBurst (Ptr<PointToPointNetDevice> device, bool batch);
+  /**
+   * \brief Receive a packet
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param packetType the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * \brief Run a simulation
+   *
+   * \param batch whether to send the burst with SendBatch
+   */
+  void Run (bool batch);
+
+  std::vector<uint32_t> m_sizes; //!< sizes of the received packets
+  std::vector<Time> m_times;     //!< reception times of the packets
+};
+
+PointToPointBatchTest::PointToPointBatchTest ()
+  : TestCase ("PointToPoint SendBatch")
+{
+}
+
+void
+PointToPointBatchTest::SendBurst (Ptr<PointToPointNetDevice> device, bool batch)
+{
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      burst->AddPacket (Create<Packet> (100 * i));
+    }
+  if (batch)
+    {
+      NS_TEST_EXPECT_MSG_EQ (device->SendBatch (burst, device->GetBroadcast (), 0x800), true,
+                             "Burst not sent");
+      return;
+    }
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (device->Send (*i, device->GetBroadcast (), 0x800), true,
+                             "Packet not sent");
+    }
+}
+
+void
+PointToPointBatchTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_sizes.push_back (packet->GetSize ());
+  m_times.push_back (Simulator::Now ());
+}
+
+void
+PointToPointBatchTest::Run (bool batch)
+{
+  m_sizes.clear ();
+  m_times.clear ();
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  b->RegisterProtocolHandler (MakeCallback (&PointToPointBatchTest::Receive, this), 0x800, devB);
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBatchTest::SendBurst, this, devA, batch);
+
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+}
+
+void
+PointToPointBatchTest::DoRun (void)
+{
+  Run (false);
+  std::vector<uint32_t> sizes = m_sizes;
+  std::vector<Time> times = m_times;
+  Run (true);
+
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 4, "Wrong number of packets received");
+  NS_TEST_ASSERT_MSG_EQ (sizes.size (), 4, "Wrong number of packets received");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_sizes[i], sizes[i], "Packet " << i << " received out of order");
+      NS_TEST_EXPECT_MSG_EQ (m_times[i], times[i], "Packet " << i << " received at the wrong time");
+    }
+}
+
+/**
+ * \brief Test class for a PointToPointChannel which connects two
+ * partitions of a MultithreadedSimulatorImpl
+ *
+ * Both nodes send packets with tags to each other and echo the packets
+ * they receive, each node in its own partition. The packets received
+ * must be the same, at the same times, as with the DefaultSimulatorImpl.
+ */
+class PointToPointPartitionTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPartitionTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /** A received packet */
+  struct Reception
+  {
+    Time time;        //!< reception time
+    uint64_t uid;     //!< packet uid
+    uint32_t size;    //!< packet size
+    uint16_t protocol; //!< protocol number
+    uint8_t priority; //!< priority of the packet tag
+    uint8_t byteTag;  //!< priority of the byte tag
+  };
+
+  /**
+   * \brief Send a packet and schedule the next one
+   *
+   * \param device NetDevice to send to
+   * \param i index of the packet
+   */
+  void Send (Ptr<PointToPointNetDevice> device, uint32_t i);
+  /**
+   * \brief Receive a packet, and echo it if it is not an echo
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender address
+   * \param to the destination address
+   * \param packetType the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * \brief Run a simulation
+   *
+   * \param threads the number of threads of a MultithreadedSimulatorImpl,
+   *        or zero for a DefaultSimulatorImpl
+   */
+  void Run (uint32_t threads);
+
+  /** number of packets sent by each node */
+  static const uint32_t N_PACKETS = 200;
+
+  std::vector<Reception> m_received[2]; //!< packets received by each node
+  std::vector<uint64_t> m_sent[2];      //!< uids of the packets sent by each node
+  std::vector<Ptr<Packet> > m_kept[2];  //!< copies of the packets sent, modified after the send
+};
+
+PointToPointPartitionTest::PointToPointPartitionTest ()
+  : TestCase ("PointToPoint across the partitions of a MultithreadedSimulatorImpl")
+{
+}
+
+void
+PointToPointPartitionTest::Send (Ptr<PointToPointNetDevice> device, uint32_t i)
+{
+  uint32_t node = device->GetNode ()->GetId () % 2;
+  Ptr<Packet> p = Create<Packet> (100 + i);
+  SocketPriorityTag tag;
+  tag.SetPriority (i % 7);
+  p->AddPacketTag (tag);
+  tag.SetPriority (i % 5);
+  p->AddByteTag (tag);
+  m_sent[node].push_back (p->GetUid ());
+  // keep a COW copy, and write to it while the packet is in flight
+  Ptr<Packet> kept = p->Copy ();
+  device->Send (p, device->GetBroadcast (), 0x800);
+  kept->AddPaddingAtEnd (10);
+  kept->RemovePacketTag (tag);
+  m_kept[node].push_back (kept);
+  if (i + 1 < N_PACKETS)
+    {
+      Simulator::Schedule (MicroSeconds (150), &PointToPointPartitionTest::Send, this, device, i + 1);
+    }
+}
+
+void
+PointToPointPartitionTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                    const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  uint32_t node = device->GetNode ()->GetId () % 2;
+  Reception reception;
+  reception.time = Simulator::Now ();
+  reception.uid = packet->GetUid ();
+  reception.size = packet->GetSize ();
+  reception.protocol = protocol;
+  SocketPriorityTag tag;
+  reception.priority = packet->PeekPacketTag (tag) ? tag.GetPriority () : 0xff;
+  reception.byteTag = packet->FindFirstMatchingByteTag (tag) ? tag.GetPriority () : 0xff;
+  m_received[node].push_back (reception);
+  if (protocol == 0x800)
+    {
+      Ptr<Packet> echo = packet->Copy ();
+      echo->AddPaddingAtEnd (1);
+      device->Send (echo, device->GetBroadcast (), 0x86DD);
+    }
+}
+
+void
+PointToPointPartitionTest::Run (uint32_t threads)
+{
+  for (uint32_t node = 0; node < 2; node++)
+    {
+      m_received[node].clear ();
+      m_sent[node].clear ();
+      m_kept[node].clear ();
+    }
+  ObjectFactory factory;
+  if (threads == 0)
+    {
+      factory.SetTypeId (DefaultSimulatorImpl::GetTypeId ());
+    }
+  else
+    {
+      factory.SetTypeId (MultithreadedSimulatorImpl::GetTypeId ());
+      factory.Set ("ThreadCount", UintegerValue (threads));
+    }
+  Ptr<SimulatorImpl> impl = factory.Create<SimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetDataRate (DataRate ("100Mbps"));
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetDataRate (DataRate ("100Mbps"));
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  // the packets are sent with the IPv4 protocol number, and echoed with the IPv6 one
+  a->RegisterProtocolHandler (MakeCallback (&PointToPointPartitionTest::Receive, this), 0, devA);
+  b->RegisterProtocolHandler (MakeCallback (&PointToPointPartitionTest::Receive, this), 0, devB);
+
+  Ptr<MultithreadedSimulatorImpl> mt = DynamicCast<MultithreadedSimulatorImpl> (impl);
+  if (mt != 0)
+    {
+      mt->SetPartition (a->GetId (), 0);
+      mt->SetPartition (b->GetId (), 1);
+    }
+
+  Simulator::ScheduleWithContext (a->GetId (), Seconds (1.0), &PointToPointPartitionTest::Send, this, devA, 0);
+  Simulator::ScheduleWithContext (b->GetId (), Seconds (1.0), &PointToPointPartitionTest::Send, this, devB, 0);
+
+  Simulator::Run ();
+
+  if (mt != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (mt->GetLookAhead (), MilliSeconds (2), "The channel does not connect the partitions");
+    }
+
+  Simulator::Destroy ();
+}
+
+void
+PointToPointPartitionTest::DoRun (void)
+{
+  Run (0);
+  std::vector<Reception> expected[2] = { m_received[0], m_received[1] };
+  Run (2);
+
+  for (uint32_t node = 0; node < 2; node++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (expected[node].size (), 2 * N_PACKETS, "Wrong number of packets received");
+      NS_TEST_ASSERT_MSG_EQ (m_received[node].size (), 2 * N_PACKETS, "Wrong number of packets received");
+      uint32_t data = 0;
+      for (uint32_t i = 0; i < m_received[node].size (); i++)
+        {
+          const Reception &r = m_received[node][i];
+          const Reception &e = expected[node][i];
+          NS_TEST_EXPECT_MSG_EQ (r.time, e.time, "Packet " << i << " received at the wrong time");
+          NS_TEST_EXPECT_MSG_EQ (r.size, e.size, "Packet " << i << " received out of order");
+          NS_TEST_EXPECT_MSG_EQ (r.protocol, e.protocol, "Packet " << i << " received out of order");
+          NS_TEST_EXPECT_MSG_EQ ((uint32_t) r.priority, (uint32_t) e.priority, "Wrong packet tag");
+          NS_TEST_EXPECT_MSG_EQ ((uint32_t) r.byteTag, (uint32_t) e.byteTag, "Wrong byte tag");
+          if (r.protocol == 0x800)
+            {
+              // the packets sent by the other node keep their uid
+              NS_TEST_EXPECT_MSG_EQ (r.uid, m_sent[1 - node][data], "Wrong uid");
+              data++;
+            }
+        }
+    }
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +461,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBatchTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPartitionTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
 #include "ns3/object-vector.h"
 #include "ns3/packet.h"
@@ -270,6 +271,12 @@ TypeId QueueDisc::GetTypeId (void)
                    MakeUintegerAccessor (&QueueDisc::SetQuota,
                                          &QueueDisc::GetQuota),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BulkDequeue",
+                   "Whether the packets dequeued in a qdisc run for the same destination "
+                   "are sent to the device at once, through NetDevice::SendBatch",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QueueDisc::m_bulkDequeue),
+                   MakeBooleanChecker ())
     .AddAttribute ("InternalQueueList", "The list of internal queues.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&QueueDisc::m_queues),
@@ -323,6 +330,7 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
   :  m_nPackets (0),
      m_nBytes (0),
      m_maxSize (QueueSize ("1p")),         // to avoid that setting the mode at construction time is ignored
+     m_bulkDequeue (true),
      m_running (false),
      m_peeked (false),
      m_sizePolicy (policy),
@@ -383,6 +391,7 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
+  m_sendBatch = nullptr;
   m_requeued = 0;
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
@@ -558,6 +567,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback (SendBatchCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBatch = func;
+}
+
+QueueDisc::SendBatchCallback
+QueueDisc::GetSendBatchCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBatch;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -950,6 +973,15 @@ QueueDisc::Run (void)
 
   if (RunBegin ())
     {
+      // the packets of a multi-queue device may go to different queues,
+      // which may be stopped independently
+      if (m_bulkDequeue && m_sendBatch &&
+          (!m_devQueueIface || m_devQueueIface->GetNTxQueues () == 1))
+        {
+          RestartBatches ();
+          RunEnd ();
+          return;
+        }
       uint32_t quota = m_quota;
       while (Restart ())
         {
@@ -998,6 +1030,54 @@ QueueDisc::Restart (void)
   return Transmit (item);
 }
 
+void
+QueueDisc::RestartBatches (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t quota = m_quota;
+  Ptr<QueueDiscItem> item = DequeuePacket ();
+  while (item != 0)
+    {
+      // Restart would dequeue the next packet if the device queue is not
+      // stopped by the packets dequeued before it.  The device queue of a
+      // device which does not support flow control is never stopped.
+      uint32_t available = m_devQueueIface ? m_devQueueIface->GetTxQueue (0)->GetAvailablePackets () : quota;
+      std::vector<Ptr<QueueDiscItem> > items (1, item);
+      item = 0;
+      while (items.size () < quota && items.size () <= available && GetNPackets () > 0)
+        {
+          Ptr<QueueDiscItem> next = DequeuePacket ();
+          if (next == 0)
+            {
+              break;
+            }
+          if (next->GetAddress () != items.front ()->GetAddress () ||
+              next->GetProtocol () != items.front ()->GetProtocol ())
+            {
+              // the first packet of the next burst
+              item = next;
+              break;
+            }
+          items.push_back (next);
+        }
+      quota -= items.size ();
+      TransmitBatch (items);
+
+      if (item != 0)
+        {
+          NS_ASSERT (!m_devQueueIface || !m_devQueueIface->GetTxQueue (0)->IsStopped ());
+          continue;
+        }
+      if (quota == 0 || GetNPackets () == 0 ||
+          (m_devQueueIface && m_devQueueIface->GetTxQueue (0)->IsStopped ()))
+        {
+          break;
+        }
+      item = DequeuePacket ();
+    }
+}
+
 Ptr<QueueDiscItem>
 QueueDisc::DequeuePacket ()
 {
@@ -1110,4 +1190,25 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+void
+QueueDisc::TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+  NS_ASSERT (!items.empty ());
+
+  // the device has a single queue, which makes no use of the priority tag
+  for (std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin (); i != items.end (); ++i)
+    {
+      SocketPriorityTag priorityTag;
+      (*i)->GetPacket ()->RemovePacketTag (priorityTag);
+    }
+  if (items.size () == 1)
+    {
+      NS_ASSERT_MSG (m_send, "Send callback not set");
+      m_send (items.front ());
+      return;
+    }
+  m_sendBatch (items);
+}
+
 } // namespace ns3
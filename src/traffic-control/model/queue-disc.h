@@ -372,6 +372,24 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /// Callback invoked to send a burst of packets for the same destination to the receiving object when Run is called
+  typedef std::function<void (const std::vector<Ptr<QueueDiscItem> > &)> SendBatchCallback;
+
+  /**
+   * \param func the callback to send a burst of packets to the receiving object.
+   *
+   * Set the callback used by the Run method to send the packets it dequeues
+   * for the same destination to the receiving object at once (see the
+   * BulkDequeue attribute).  The packets are sent one at a time through the
+   * callback set by SetSendCallback if this callback is not set.
+   */
+  void SetSendBatchCallback (SendBatchCallback func);
+
+  /**
+   * \return the callback to send a burst of packets to the receiving object.
+   */
+  SendBatchCallback GetSendBatchCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -644,6 +662,17 @@ private:
    */
   bool Restart (void);
 
+  /**
+   * Modelled after the Linux function try_bulk_dequeue_skb (net/sched/sch_generic.c)
+   * Dequeue packets (by calling DequeuePacket) and send the consecutive packets
+   * for the same destination to the device at once (by calling TransmitBatch),
+   * until the quota is exceeded, the queue disc is empty or the device queue is
+   * stopped.  A packet is only dequeued if the device queue cannot be stopped by
+   * the packets dequeued before it, so that the packets are dequeued and sent
+   * as if Restart was called for each of them.
+   */
+  void RestartBatches (void);
+
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
    * \return the requeued packet, if any, or the packet dequeued by the queue disc, otherwise.
@@ -666,6 +695,13 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Send packets for the same destination to the device, whose queue is
+   * known not to be stopped.
+   * \param items the packets to transmit
+   */
+  void TransmitBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -695,6 +731,8 @@ private:
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBatchCallback m_sendBatch;    //!< Callback used to send a burst of packets to the receiving object
+  bool m_bulkDequeue;               //!< Send the packets dequeued in a run as bursts
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
   Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/object-map.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
 #include <tuple>
@@ -179,13 +180,22 @@ TrafficControlLayer::ScanDevices (void)
               ndi->second.m_queueDiscsToWake.push_back (ndi->second.m_rootQueueDisc);
             }
 
-          // set the NetDeviceQueueInterface object and the SendCallback on the queue discs
+          // set the NetDeviceQueueInterface object and the send callbacks on the queue discs
           // into which packets are enqueued and dequeued by calling Run
           for (auto& q : ndi->second.m_queueDiscsToWake)
             {
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              q->SetSendBatchCallback ([dev] (const std::vector<Ptr<QueueDiscItem> > &items)
+                                       {
+                                         Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+                                         for (auto& item : items)
+                                           {
+                                             burst->AddPacket (item->GetPacket ());
+                                           }
+                                         dev->SendBatch (burst, items.front ()->GetAddress (), items.front ()->GetProtocol ());
+                                       });
             }
         }
     }
@@ -250,6 +260,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBatchCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -34,6 +34,11 @@
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/queue.h"
 #include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/queue-disc.h"
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -363,6 +368,244 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Traffic Control Bulk Dequeue Test Case
+ *
+ * The device stops its queue while packets are sent, so that they are stored
+ * in the queue disc, and wakes it up later, so that the queue disc run sends
+ * them to the device with SendBatch if bulk dequeue is enabled.  Checks that
+ * the packets are dequeued, enqueued in the device queue, transmitted and
+ * received in the same order and at the same time as when they are sent one
+ * at a time.
+ */
+class TcBulkDequeueTestCase : public TestCase
+{
+public:
+  TcBulkDequeueTestCase ();
+  virtual ~TcBulkDequeueTestCase ();
+private:
+  virtual void DoRun (void);
+
+  /// Time and size of the packets
+  typedef std::vector<std::pair<Time, uint32_t> > PacketLog;
+
+  /// The traces of a run
+  struct RunLog
+  {
+    PacketLog qdiscDequeue;     //!< the packets dequeued by the queue disc
+    PacketLog deviceEnqueue;    //!< the packets enqueued in the device queue
+    PacketLog deviceDequeue;    //!< the packets dequeued from the device queue
+    PacketLog received;         //!< the packets received by the peer device
+    std::string order;          //!< 'q' per queue disc dequeue, 'd' per device enqueue
+  };
+
+  /**
+   * Run the scenario
+   * \param bulkDequeue the value of the BulkDequeue attribute of the queue disc
+   * \param log the traces of the run
+   */
+  void RunScenario (bool bulkDequeue, RunLog *log);
+  /**
+   * Instruct a node to send packets of increasing size
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendPackets (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Stop or wake up the device queue, as the device would do
+   * \param dev the device
+   * \param stop true to stop the queue, false to wake it up
+   */
+  void StopDeviceQueue (Ptr<NetDevice> dev, bool stop);
+  /**
+   * Trace a packet dequeued by the queue disc
+   * \param item the packet
+   */
+  void QueueDiscDequeue (Ptr<const QueueDiscItem> item);
+  /**
+   * Trace a packet enqueued in the device queue
+   * \param p the packet
+   */
+  void DeviceEnqueue (Ptr<const Packet> p);
+  /**
+   * Trace a packet dequeued from the device queue
+   * \param p the packet
+   */
+  void DeviceDequeue (Ptr<const Packet> p);
+  /**
+   * Receive a packet on the peer device
+   * \param dev the device
+   * \param p the packet
+   * \param protocol the protocol
+   * \param from the sender address
+   * \param to the destination address
+   * \param type the packet type
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                const Address &to, NetDevice::PacketType type);
+  /**
+   * Check that two packet logs are identical
+   * \param bulk the log of the run with bulk dequeue
+   * \param single the log of the run without bulk dequeue
+   * \param what the name of the log
+   */
+  void CheckLog (const PacketLog &bulk, const PacketLog &single, const char *what);
+
+  RunLog *m_log;              //!< the traces of the current run
+};
+
+TcBulkDequeueTestCase::TcBulkDequeueTestCase ()
+  : TestCase ("Test that bulk dequeues do not change the transmission of the packets"),
+    m_log (0)
+{
+}
+
+TcBulkDequeueTestCase::~TcBulkDequeueTestCase ()
+{
+}
+
+void
+TcBulkDequeueTestCase::SendPackets (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      tc->Send (n->GetDevice (0), Create<QueueDiscTestItem> (Create<Packet> (500 + 10 * i)));
+    }
+}
+
+void
+TcBulkDequeueTestCase::StopDeviceQueue (Ptr<NetDevice> dev, bool stop)
+{
+  Ptr<NetDeviceQueue> txq = dev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0);
+  if (stop)
+    {
+      txq->Stop ();
+    }
+  else
+    {
+      txq->Wake ();
+    }
+}
+
+void
+TcBulkDequeueTestCase::QueueDiscDequeue (Ptr<const QueueDiscItem> item)
+{
+  m_log->qdiscDequeue.push_back (std::make_pair (Simulator::Now (), item->GetPacket ()->GetSize ()));
+  m_log->order += 'q';
+}
+
+void
+TcBulkDequeueTestCase::DeviceEnqueue (Ptr<const Packet> p)
+{
+  m_log->deviceEnqueue.push_back (std::make_pair (Simulator::Now (), p->GetSize ()));
+  m_log->order += 'd';
+}
+
+void
+TcBulkDequeueTestCase::DeviceDequeue (Ptr<const Packet> p)
+{
+  m_log->deviceDequeue.push_back (std::make_pair (Simulator::Now (), p->GetSize ()));
+}
+
+bool
+TcBulkDequeueTestCase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from,
+                                const Address &to, NetDevice::PacketType type)
+{
+  m_log->received.push_back (std::make_pair (Simulator::Now (), p->GetSize ()));
+  return true;
+}
+
+void
+TcBulkDequeueTestCase::RunScenario (bool bulkDequeue, RunLog *log)
+{
+  m_log = log;
+
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+
+  NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+  // the packets are not addressed to the device
+  rxDevC.Get (0)->SetPromiscReceiveCallback (MakeCallback (&TcBulkDequeueTestCase::Receive, this));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("30p"));
+
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())).Get (0);
+
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", StringValue ("100p"),
+                        "BulkDequeue", BooleanValue (bulkDequeue));
+  QueueDiscContainer qdiscs = tch.Install (txDev);
+  qdiscs.Get (0)->TraceConnectWithoutContext ("Dequeue", MakeCallback (&TcBulkDequeueTestCase::QueueDiscDequeue, this));
+
+  PointerValue ptr;
+  txDev->GetAttribute ("TxQueue", ptr);
+  Ptr<Queue<Packet> > queue = ptr.Get<Queue<Packet> > ();
+  queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&TcBulkDequeueTestCase::DeviceEnqueue, this));
+  queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&TcBulkDequeueTestCase::DeviceDequeue, this));
+
+  // the device stops its queue, which fills the queue disc, and wakes it up
+  // when it can store more packets than the queue disc
+  Simulator::Schedule (MilliSeconds (1), &TcBulkDequeueTestCase::StopDeviceQueue, this, txDev, true);
+  Simulator::Schedule (MilliSeconds (2), &TcBulkDequeueTestCase::SendPackets, this, n.Get (0), 20);
+  Simulator::Schedule (MilliSeconds (3), &TcBulkDequeueTestCase::StopDeviceQueue, this, txDev, false);
+  // once the device queue is empty, the device queue fills up before the queue disc is empty
+  Simulator::Schedule (MilliSeconds (200), &TcBulkDequeueTestCase::StopDeviceQueue, this, txDev, true);
+  Simulator::Schedule (MilliSeconds (201), &TcBulkDequeueTestCase::SendPackets, this, n.Get (0), 40);
+  Simulator::Schedule (MilliSeconds (202), &TcBulkDequeueTestCase::StopDeviceQueue, this, txDev, false);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_log = 0;
+}
+
+void
+TcBulkDequeueTestCase::CheckLog (const PacketLog &bulk, const PacketLog &single, const char *what)
+{
+  NS_TEST_ASSERT_MSG_EQ (bulk.size (), single.size (), "Different number of packets " << what);
+  for (std::size_t i = 0; i < bulk.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (bulk[i].first, single[i].first, "Packet " << i << " " << what << " at a different time");
+      NS_TEST_EXPECT_MSG_EQ (bulk[i].second, single[i].second, "Packet " << i << " " << what << " out of order");
+    }
+}
+
+void
+TcBulkDequeueTestCase::DoRun (void)
+{
+  RunLog bulk;
+  RunScenario (true, &bulk);
+  RunLog single;
+  RunScenario (false, &single);
+
+  NS_TEST_EXPECT_MSG_EQ (single.received.size (), 60, "All the packets must be received");
+  CheckLog (bulk.qdiscDequeue, single.qdiscDequeue, "dequeued by the queue disc");
+  CheckLog (bulk.deviceEnqueue, single.deviceEnqueue, "enqueued in the device queue");
+  CheckLog (bulk.deviceDequeue, single.deviceDequeue, "dequeued from the device queue");
+  CheckLog (bulk.received, single.received, "received");
+
+  // the packets are sent to the device one at a time without bulk dequeue,
+  // while the packets stored when the device queue is woken up are sent at
+  // once, up to the 30 packets which fill the device queue
+  NS_TEST_EXPECT_MSG_EQ (single.order.find ("qq"), std::string::npos, "Packets sent at once without bulk dequeue");
+  NS_TEST_EXPECT_MSG_EQ (bulk.order.find (std::string (20, 'q') + std::string (20, 'd')), 0,
+                         "Packets not sent at once with bulk dequeue");
+  NS_TEST_EXPECT_MSG_EQ (bulk.order.find (std::string (30, 'q') + std::string (30, 'd')), 40,
+                         "Packets not sent at once with bulk dequeue");
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -377,5 +620,6 @@ public:
   {
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::PACKETS), TestCase::QUICK);
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES), TestCase::QUICK);
+    AddTestCase (new TcBulkDequeueTestCase, TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
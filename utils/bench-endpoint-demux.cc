@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of the transport endpoint demultiplexing
+// of a server node with many concurrent connections: a listening endpoint
+// and n connected endpoints share the local port, as the TCP connections
+// accepted by a server do.  It reports the time per allocation of a
+// connected endpoint, per lookup of the segments of the open connections,
+// of new connections (which match the listening endpoint), per ephemeral
+// port allocation of a client and per deallocation, for the IPv4 and IPv6
+// demuxes.
+// Sample usage:  ./waf --run 'bench-endpoint-demux --n=50000'
+
+#include "ns3/command-line.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-interface.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/** The clock of the measures. */
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Print the time per operation of a case.
+ *
+ * \param [in] name The name of the case.
+ * \param [in] start The start time of the case.
+ * \param [in] count The number of operations.
+ * \param [in] found The number of operations which found an endpoint.
+ */
+static void
+Report (const std::string &name, Clock::time_point start, uint32_t count, uint32_t found)
+{
+  double ns = std::chrono::duration<double, std::nano> (Clock::now () - start).count ();
+  std::cout << std::left << std::setw (24) << name
+            << std::right << std::setw (12) << ns / count
+            << std::setw (12) << found << std::endl;
+}
+
+/**
+ * Get the peer address of a connection.
+ *
+ * \param [in] i The index of the connection.
+ * \returns The IPv4 address of the peer.
+ */
+static Ipv4Address
+GetPeer4 (uint32_t i)
+{
+  // 1000 ports per peer
+  return Ipv4Address (0x0b000000 + i / 1000);
+}
+
+/**
+ * Get the peer address of a connection.
+ *
+ * \param [in] i The index of the connection.
+ * \returns The IPv6 address of the peer.
+ */
+static Ipv6Address
+GetPeer6 (uint32_t i)
+{
+  uint8_t address[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  address[14] = (i / 1000) >> 8;
+  address[15] = (i / 1000) & 0xff;
+  return Ipv6Address (address);
+}
+
+/**
+ * Get the peer port of a connection.
+ *
+ * \param [in] i The index of the connection.
+ * \returns The peer port.
+ */
+static uint16_t
+GetPeerPort (uint32_t i)
+{
+  return 10000 + i % 1000;
+}
+
+/**
+ * Benchmark the IPv4 demux.
+ *
+ * \param [in] n The number of connections.
+ * \param [in] lookups The number of lookups per case.
+ */
+static void
+Bench4 (uint32_t n, uint32_t lookups)
+{
+  Ipv4Address local ("10.0.0.1");
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4EndPointDemux demux;
+  demux.Allocate (0, local, 80);
+
+  std::vector<Ipv4EndPoint *> connections (n);
+  Clock::time_point start = Clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      connections[i] = demux.Allocate (0, local, 80, GetPeer4 (i), GetPeerPort (i));
+    }
+  Report ("ipv4 allocate", start, n, n);
+
+  uint32_t found = 0;
+  start = Clock::now ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      uint32_t j = (i * 7919) % n;
+      found += demux.Lookup (local, 80, GetPeer4 (j), GetPeerPort (j), interface).size ();
+    }
+  Report ("ipv4 lookup connected", start, lookups, found);
+
+  found = 0;
+  start = Clock::now ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      found += demux.Lookup (local, 80, Ipv4Address ("12.0.0.1"), GetPeerPort (i), interface).size ();
+    }
+  Report ("ipv4 lookup listening", start, lookups, found);
+
+  uint32_t clients = std::min<uint32_t> (lookups, 10000);
+  std::vector<Ipv4EndPoint *> ephemeral (clients);
+  start = Clock::now ();
+  for (uint32_t i = 0; i < clients; i++)
+    {
+      ephemeral[i] = demux.Allocate ();
+      ephemeral[i]->SetPeer (GetPeer4 (i), 80);
+    }
+  Report ("ipv4 connect", start, clients, clients);
+
+  start = Clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  Report ("ipv4 deallocate", start, n, n);
+}
+
+/**
+ * Benchmark the IPv6 demux.
+ *
+ * \param [in] n The number of connections.
+ * \param [in] lookups The number of lookups per case.
+ */
+static void
+Bench6 (uint32_t n, uint32_t lookups)
+{
+  Ipv6Address local ("2001:db8::1");
+  Ipv6EndPointDemux demux;
+  demux.Allocate (0, local, 80);
+
+  std::vector<Ipv6EndPoint *> connections (n);
+  Clock::time_point start = Clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      connections[i] = demux.Allocate (0, local, 80, GetPeer6 (i), GetPeerPort (i));
+    }
+  Report ("ipv6 allocate", start, n, n);
+
+  uint32_t found = 0;
+  start = Clock::now ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      uint32_t j = (i * 7919) % n;
+      found += demux.Lookup (local, 80, GetPeer6 (j), GetPeerPort (j), 0).size ();
+    }
+  Report ("ipv6 lookup connected", start, lookups, found);
+
+  found = 0;
+  start = Clock::now ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      found += demux.Lookup (local, 80, Ipv6Address ("2001:db9::1"), GetPeerPort (i), 0).size ();
+    }
+  Report ("ipv6 lookup listening", start, lookups, found);
+
+  uint32_t clients = std::min<uint32_t> (lookups, 10000);
+  std::vector<Ipv6EndPoint *> ephemeral (clients);
+  start = Clock::now ();
+  for (uint32_t i = 0; i < clients; i++)
+    {
+      ephemeral[i] = demux.Allocate ();
+      ephemeral[i]->SetPeer (GetPeer6 (i), 80);
+    }
+  Report ("ipv6 connect", start, clients, clients);
+
+  start = Clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      demux.DeAllocate (connections[i]);
+    }
+  Report ("ipv6 deallocate", start, n, n);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 50000;
+  uint32_t lookups = 100000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the transport endpoint demultiplexing with many connections.\n\n"
+             "A listening endpoint and n connected endpoints share the local port.");
+  cmd.AddValue ("n", "number of connected endpoints", n);
+  cmd.AddValue ("lookups", "number of lookups per case", lookups);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || lookups == 0)
+    {
+      std::cerr << "n and lookups must be positive" << std::endl;
+      return 1;
+    }
+
+  std::cout << "# " << n << " connections, " << lookups << " lookups per case" << std::endl;
+  std::cout << std::left << std::setw (24) << "# case"
+            << std::right << std::setw (12) << "ns/op"
+            << std::setw (12) << "found" << std::endl;
+  std::cout << std::fixed << std::setprecision (1);
+  Bench4 (n, lookups);
+  Bench6 (n, lookups);
+
+  return 0;
+}
@@ -0,0 +1,468 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of the packet operations performed by
+// the layers of a TCP/IPv4 stack, with the real Ipv4Header, TcpHeader,
+// TCP options and tags instead of the synthetic ones of bench-packets:
+// header serialization and deserialization, fragmentation and
+// reassembly, packet and byte tags, chains of copies along a path, each
+// with the packet metadata disabled, fully recorded and compact.
+// For each case it reports the time and the number of heap allocations
+// (operator new) per operation, so that regressions in the src/network
+// and src/internet header code show up in either.
+// Sample usage:  ./waf --run 'bench-packet-stack --n=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/packet.h"
+#include "ns3/packet-metadata.h"
+#include "ns3/socket.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-packet-info-tag.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-ts.h"
+#include "ns3/tcp-option-sack.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <new>
+#include <string>
+
+using namespace ns3;
+
+/** Number of calls to operator new since the start of the program. */
+static uint64_t g_allocations = 0;
+/** Number of bytes allocated by operator new since the start of the program. */
+static uint64_t g_allocatedBytes = 0;
+
+/**
+ * Count the allocations of the simulator.
+ *
+ * \param [in] size The number of bytes to allocate.
+ * \returns The allocated memory.
+ */
+void *
+operator new (std::size_t size)
+{
+  g_allocations++;
+  g_allocatedBytes += size;
+  void *p = std::malloc (size > 0 ? size : 1);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+/**
+ * Count the allocations of the simulator.
+ *
+ * \param [in] size The number of bytes to allocate.
+ * \returns The allocated memory.
+ */
+void *
+operator new[] (std::size_t size)
+{
+  return operator new (size);
+}
+
+/**
+ * Free memory allocated by operator new.
+ *
+ * \param [in] p The memory to free.
+ */
+void
+operator delete (void *p) noexcept
+{
+  std::free (p);
+}
+
+/**
+ * Free memory allocated by operator new[].
+ *
+ * \param [in] p The memory to free.
+ */
+void
+operator delete[] (void *p) noexcept
+{
+  std::free (p);
+}
+
+/** The TCP segment size. */
+static const uint32_t SEGMENT_SIZE = 1448;
+/** The IPv4 MTU used to fragment the datagrams. */
+static const uint32_t MTU = 576;
+/** The number of hops of the copy chains. */
+static const uint32_t HOPS = 8;
+
+/** Bytes seen by the benchmarks, so that the operations are not optimized out. */
+static uint64_t g_bytes = 0;
+
+/**
+ * Build the TCP header of a data segment, with timestamps and SACK
+ * blocks.
+ *
+ * \returns The header.
+ */
+static TcpHeader
+MakeTcpHeader (void)
+{
+  TcpHeader tcp;
+  tcp.SetSourcePort (49153);
+  tcp.SetDestinationPort (80);
+  tcp.SetSequenceNumber (SequenceNumber32 (1000));
+  tcp.SetAckNumber (SequenceNumber32 (2000));
+  tcp.SetFlags (TcpHeader::ACK);
+  tcp.SetWindowSize (65535);
+  Ptr<TcpOptionTS> ts = CreateObject<TcpOptionTS> ();
+  ts->SetTimestamp (123456);
+  ts->SetEcho (123000);
+  tcp.AppendOption (ts);
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (3000), SequenceNumber32 (4000)));
+  sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (5000), SequenceNumber32 (6000)));
+  tcp.AppendOption (sack);
+  tcp.EnableChecksums ();
+  tcp.InitializeChecksum (Ipv4Address ("10.1.1.1"), Ipv4Address ("10.1.2.1"), 6);
+  return tcp;
+}
+
+/**
+ * Build the IPv4 header of a datagram.
+ *
+ * \param [in] payloadSize The size of the payload.
+ * \returns The header.
+ */
+static Ipv4Header
+MakeIpv4Header (uint32_t payloadSize)
+{
+  Ipv4Header ipv4;
+  ipv4.SetSource (Ipv4Address ("10.1.1.1"));
+  ipv4.SetDestination (Ipv4Address ("10.1.2.1"));
+  ipv4.SetProtocol (6);
+  ipv4.SetTtl (64);
+  ipv4.SetIdentification (1);
+  ipv4.SetPayloadSize (payloadSize);
+  ipv4.EnableChecksum ();
+  return ipv4;
+}
+
+/**
+ * Create a packet whose metadata is recorded in the given mode.
+ *
+ * \param [in] size The size of the payload.
+ * \param [in] mode The metadata mode.
+ * \returns The packet.
+ */
+static Ptr<Packet>
+MakePacket (uint32_t size, enum PacketMetadata::Mode mode)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  p->SetMetadataMode (mode);
+  return p;
+}
+
+/**
+ * Add the TCP and IPv4 headers to a segment, as done by the sender.
+ *
+ * \param [in] n The number of segments.
+ * \param [in] mode The metadata mode.
+ */
+static void
+BenchSerialize (uint32_t n, enum PacketMetadata::Mode mode)
+{
+  TcpHeader tcp = MakeTcpHeader ();
+  Ipv4Header ipv4 = MakeIpv4Header (SEGMENT_SIZE + tcp.GetSerializedSize ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = MakePacket (SEGMENT_SIZE, mode);
+      p->AddHeader (tcp);
+      p->AddHeader (ipv4);
+      g_bytes += p->GetSize ();
+    }
+}
+
+/**
+ * Add the TCP and IPv4 headers to a segment and remove them, with their
+ * checksums verified, as done by the sender and the receiver.
+ *
+ * \param [in] n The number of segments.
+ * \param [in] mode The metadata mode.
+ */
+static void
+BenchRoundTrip (uint32_t n, enum PacketMetadata::Mode mode)
+{
+  TcpHeader tcp = MakeTcpHeader ();
+  Ipv4Header ipv4 = MakeIpv4Header (SEGMENT_SIZE + tcp.GetSerializedSize ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = MakePacket (SEGMENT_SIZE, mode);
+      p->AddHeader (tcp);
+      p->AddHeader (ipv4);
+      Ptr<Packet> q = p->Copy ();
+      Ipv4Header rxIpv4;
+      rxIpv4.EnableChecksum ();
+      q->RemoveHeader (rxIpv4);
+      TcpHeader rxTcp;
+      rxTcp.EnableChecksums ();
+      rxTcp.InitializeChecksum (rxIpv4.GetSource (), rxIpv4.GetDestination (), 6);
+      q->RemoveHeader (rxTcp);
+      g_bytes += q->GetSize () + rxIpv4.IsChecksumOk () + rxTcp.IsChecksumOk ()
+        + rxTcp.HasOption (TcpOption::SACK);
+    }
+}
+
+/**
+ * Fragment a datagram larger than the MTU and reassemble it, as done by
+ * Ipv4L3Protocol.
+ *
+ * \param [in] n The number of datagrams.
+ * \param [in] mode The metadata mode.
+ */
+static void
+BenchFragment (uint32_t n, enum PacketMetadata::Mode mode)
+{
+  TcpHeader tcp = MakeTcpHeader ();
+  Ipv4Header ipv4 = MakeIpv4Header (SEGMENT_SIZE + tcp.GetSerializedSize ());
+  uint32_t fragmentSize = (MTU - ipv4.GetSerializedSize ()) & ~uint32_t (0x7);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = MakePacket (SEGMENT_SIZE, mode);
+      p->AddHeader (tcp);
+
+      // fragment
+      std::list<Ptr<Packet> > fragments;
+      uint32_t offset = 0;
+      while (offset < p->GetSize ())
+        {
+          uint32_t size = std::min (fragmentSize, p->GetSize () - offset);
+          Ptr<Packet> fragment = p->CreateFragment (offset, size);
+          Ipv4Header header = ipv4;
+          header.SetFragmentOffset (offset);
+          if (offset + size < p->GetSize ())
+            {
+              header.SetMoreFragments ();
+            }
+          else
+            {
+              header.SetLastFragment ();
+            }
+          header.SetPayloadSize (size);
+          fragment->AddHeader (header);
+          fragments.push_back (fragment);
+          offset += size;
+        }
+
+      // reassemble
+      Ptr<Packet> reassembled = Create<Packet> ();
+      for (std::list<Ptr<Packet> >::iterator j = fragments.begin (); j != fragments.end (); ++j)
+        {
+          Ipv4Header header;
+          header.EnableChecksum ();
+          (*j)->RemoveHeader (header);
+          reassembled->AddAtEnd (*j);
+        }
+      TcpHeader rxTcp;
+      reassembled->RemoveHeader (rxTcp);
+      g_bytes += reassembled->GetSize ();
+    }
+}
+
+/**
+ * Add, peek and remove the packet tags used by the sockets and the IP
+ * layer, and a byte tag.
+ *
+ * \param [in] n The number of packets.
+ * \param [in] mode The metadata mode.
+ */
+static void
+BenchTags (uint32_t n, enum PacketMetadata::Mode mode)
+{
+  SocketIpTtlTag ttl;
+  ttl.SetTtl (64);
+  SocketPriorityTag priority;
+  priority.SetPriority (3);
+  Ipv4PacketInfoTag info;
+  info.SetAddress (Ipv4Address ("10.1.1.1"));
+  info.SetRecvIf (1);
+  FlowIdTag flowId (7);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = MakePacket (SEGMENT_SIZE, mode);
+      p->AddPacketTag (ttl);
+      p->AddPacketTag (priority);
+      p->AddByteTag (flowId);
+      Ptr<Packet> q = p->Copy ();
+      q->AddPacketTag (info);
+      SocketIpTtlTag rxTtl;
+      SocketPriorityTag rxPriority;
+      Ipv4PacketInfoTag rxInfo;
+      SocketIpTosTag missing;
+      FlowIdTag rxFlowId;
+      g_bytes += q->PeekPacketTag (rxPriority) + q->PeekPacketTag (missing);
+      g_bytes += q->RemovePacketTag (rxTtl) + q->RemovePacketTag (rxInfo);
+      g_bytes += q->FindFirstMatchingByteTag (rxFlowId);
+    }
+}
+
+/**
+ * Forward a datagram along a path: each hop copies it, decrements the
+ * TTL and replaces its IPv4 header.
+ *
+ * \param [in] n The number of datagrams.
+ * \param [in] mode The metadata mode.
+ */
+static void
+BenchCopyChain (uint32_t n, enum PacketMetadata::Mode mode)
+{
+  TcpHeader tcp = MakeTcpHeader ();
+  Ipv4Header ipv4 = MakeIpv4Header (SEGMENT_SIZE + tcp.GetSerializedSize ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = MakePacket (SEGMENT_SIZE, mode);
+      p->AddHeader (tcp);
+      p->AddHeader (ipv4);
+      for (uint32_t hop = 0; hop < HOPS; hop++)
+        {
+          Ptr<Packet> q = p->Copy ();
+          Ipv4Header header;
+          q->RemoveHeader (header);
+          header.SetTtl (header.GetTtl () - 1);
+          q->AddHeader (header);
+          p = q;
+        }
+      g_bytes += p->GetSize ();
+    }
+}
+
+/** A benchmark case. */
+struct BenchCase
+{
+  /** The function running the case. */
+  void (*bench) (uint32_t n, enum PacketMetadata::Mode mode);
+  /** The name of the case. */
+  const char *name;
+};
+
+/** The cost of a benchmark case. */
+struct BenchResult
+{
+  double ns;          //!< Time per operation, in nanoseconds.
+  double allocations; //!< Allocations per operation.
+  double bytes;       //!< Bytes allocated per operation.
+};
+
+/**
+ * Run a benchmark case.
+ *
+ * \param [in] bench The case.
+ * \param [in] n The number of operations.
+ * \param [in] runs The number of runs: the fastest is reported.
+ * \param [in] mode The metadata mode.
+ * \returns The cost per operation.
+ */
+static BenchResult
+RunBench (const struct BenchCase &bench, uint32_t n, uint32_t runs, enum PacketMetadata::Mode mode)
+{
+  BenchResult result;
+  result.ns = std::numeric_limits<double>::max ();
+  for (uint32_t run = 0; run < runs; run++)
+    {
+      uint64_t allocations = g_allocations;
+      uint64_t bytes = g_allocatedBytes;
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      bench.bench (n, mode);
+      std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+      double ns = std::chrono::duration<double, std::nano> (end - start).count () / n;
+      result.ns = std::min (result.ns, ns);
+      result.allocations = static_cast<double> (g_allocations - allocations) / n;
+      result.bytes = static_cast<double> (g_allocatedBytes - bytes) / n;
+    }
+  return result;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 100000;
+  uint32_t runs = 3;
+  std::string metadata = "all";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the packet operations of a TCP/IPv4 stack.\n\n"
+             "Run each case on n packets, with the packet metadata disabled,\n"
+             "fully recorded or compact, and report the time and the number\n"
+             "of heap allocations per packet.");
+  cmd.AddValue ("n", "number of packets per case", n);
+  cmd.AddValue ("runs", "number of runs per case, the fastest is reported", runs);
+  cmd.AddValue ("metadata", "metadata modes to run: off, full, compact or all", metadata);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || runs == 0)
+    {
+      std::cerr << "Error-- n and runs must be positive" << std::endl;
+      return 1;
+    }
+  const struct
+  {
+    enum PacketMetadata::Mode mode;
+    const char *name;
+  } modes[] = {
+    { PacketMetadata::DISABLED, "off" },
+    { PacketMetadata::FULL, "full" },
+    { PacketMetadata::COMPACT, "compact" }
+  };
+  const struct BenchCase cases[] = {
+    { &BenchSerialize, "ipv4+tcp serialize" },
+    { &BenchRoundTrip, "ipv4+tcp round trip" },
+    { &BenchFragment, "fragment+reassemble" },
+    { &BenchTags, "tags" },
+    { &BenchCopyChain, "copy chain" }
+  };
+
+  std::cout << "# " << n << " packets per case, fastest of " << runs << " runs" << std::endl;
+  std::cout << std::left << std::setw (22) << "# case"
+            << std::setw (10) << "metadata"
+            << std::right << std::setw (12) << "ns/op"
+            << std::setw (12) << "allocs/op"
+            << std::setw (12) << "bytes/op"
+            << std::endl;
+  std::cout << std::fixed;
+  for (uint32_t i = 0; i < sizeof (cases) / sizeof (cases[0]); i++)
+    {
+      for (uint32_t j = 0; j < sizeof (modes) / sizeof (modes[0]); j++)
+        {
+          if (metadata != "all" && metadata != modes[j].name)
+            {
+              continue;
+            }
+          BenchResult result = RunBench (cases[i], n, runs, modes[j].mode);
+          std::cout << std::left << std::setw (22) << cases[i].name
+                    << std::setw (10) << modes[j].name
+                    << std::right << std::setw (12) << std::setprecision (1) << result.ns
+                    << std::setw (12) << std::setprecision (2) << result.allocations
+                    << std::setw (12) << std::setprecision (1) << result.bytes
+                    << std::endl;
+        }
+    }
+  // Print the benchmark output so that the compiler cannot discard it.
+  std::cerr << "# " << g_bytes << " bytes processed" << std::endl;
+  return 0;
+}
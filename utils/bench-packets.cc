@@ -339,6 +339,34 @@ runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 }
 
 
+static void
+benchPacketTags (uint32_t n)
+{
+  // a few small tags, such as the flow id, socket and priority tags
+  // which are carried through the stack
+  BenchTag<4> tag1;
+  BenchTag<5> tag2;
+  BenchTag<6> tag3;
+  BenchTag<8> tag4;
+  BenchTag<7> missing;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddPacketTag (tag1);
+      p->AddPacketTag (tag2);
+      p->AddPacketTag (tag3);
+      p->AddPacketTag (tag4);
+      Ptr<Packet> o = p->Copy ();
+      o->PeekPacketTag (tag1);
+      o->PeekPacketTag (tag4);
+      o->PeekPacketTag (missing);
+      o->RemovePacketTag (tag2);
+      o->ReplacePacketTag (tag3);
+      p->RemovePacketTag (tag4);
+    }
+}
+
 static void
 runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
 {
@@ -385,6 +413,7 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTags, n, minIterations, "Benchmark packet tags");
 
   return 0;
 }
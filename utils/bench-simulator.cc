@@ -18,9 +18,11 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <string.h>
 
@@ -43,6 +45,23 @@ int g_fwidth = 6;
 class Bench
 {
 public:
+  /// The event patterns
+  enum Workload
+  {
+    HOLD,     //!< Each event schedules the next one
+    CANCEL,   //!< As HOLD, and each event restarts a timer with Cancel
+    REMOVE,   //!< As HOLD, and each event restarts a timer with Remove
+    CONTEXT   //!< As HOLD, with events scheduled in another context
+  };
+
+  /// The timing of a run
+  struct Result
+  {
+    double init;     ///< initialization time, in s
+    double simu;     ///< simulation time, in s
+    uint32_t count;  ///< number of events run by the hold model
+  };
+
   /**
    * constructor
    * \param population the population
@@ -51,7 +70,9 @@ public:
   Bench (const uint32_t population, const uint32_t total)
     : m_population (population),
       m_total (total),
-      m_count (0)
+      m_count (0),
+      m_workload (HOLD),
+      m_contexts (1)
   {
   }
 
@@ -82,56 +103,80 @@ public:
     m_total = total;
   }
 
-  /// Run function
-  void RunBench (void);
+  /**
+   * Set the event pattern
+   * \param workload the event pattern
+   * \param contexts the number of contexts used by the CONTEXT pattern
+   */
+  void SetWorkload (enum Workload workload, uint32_t contexts)
+  {
+    m_workload = workload;
+    m_contexts = contexts;
+  }
+
+  /**
+   * Run function
+   * \returns the timing of the run
+   */
+  Result RunBench (void);
 private:
-  /// callback function
-  void Cb (void);
+  /**
+   * callback function
+   * \param i the index of the event in the population
+   */
+  void Cb (uint32_t i);
+  /// timer expiration, which does nothing
+  void Timeout (void);
 
   Ptr<RandomVariableStream> m_rand; ///< random variable
   uint32_t m_population; ///< population
   uint32_t m_total; ///< total
-  uint32_t m_count; ///< count 
+  uint32_t m_count; ///< count
+  enum Workload m_workload; ///< event pattern
+  uint32_t m_contexts; ///< number of contexts
+  std::vector<EventId> m_timers; ///< one timer per member of the population
 };
 
-void
+Bench::Result
 Bench::RunBench (void)
 {
-  SystemWallClockMs time;
-  double init, simu;
+  // SystemWallClockMs is too coarse for the small populations.
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start;
+  std::chrono::duration<double> init, simu;
 
   DEB ("initializing");
   m_count = 0;
+  m_timers.clear ();
+  if (m_workload == CANCEL || m_workload == REMOVE)
+    {
+      m_timers.resize (m_population);
+    }
 
-
-  time.Start ();
+  start = Clock::now ();
   for (uint32_t i = 0; i < m_population; ++i)
     {
       Time at = NanoSeconds (m_rand->GetValue ());
-      Simulator::Schedule (at, &Bench::Cb, this);
+      Simulator::Schedule (at, &Bench::Cb, this, i);
     }
-  init = time.End ();
-  init /= 1000;
-  DEB ("initialization took " << init << "s");
+  init = Clock::now () - start;
+  DEB ("initialization took " << init.count () << "s");
 
   DEB ("running");
-  time.Start ();
+  start = Clock::now ();
   Simulator::Run ();
-  simu = time.End ();
-  simu /= 1000;
-  DEB ("run took " << simu << "s");
-
-  LOG (std::setw (g_fwidth) << init <<
-       std::setw (g_fwidth) << (m_population / init) <<
-       std::setw (g_fwidth) << (init / m_population) <<
-       std::setw (g_fwidth) << simu <<
-       std::setw (g_fwidth) << (m_count / simu) <<
-       std::setw (g_fwidth) << (simu / m_count));
-
+  simu = Clock::now () - start;
+  DEB ("run took " << simu.count () << "s");
+
+  Result result;
+  result.init = init.count ();
+  result.simu = simu.count ();
+  result.count = m_count;
+  return result;
 }
 
 void
-Bench::Cb (void)
+Bench::Cb (uint32_t i)
 {
   if (m_count >= m_total)
     {
@@ -140,10 +185,35 @@ Bench::Cb (void)
   DEB ("event at " << Simulator::Now ().GetSeconds () << "s");
 
   Time after = NanoSeconds (m_rand->GetValue ());
-  Simulator::Schedule (after, &Bench::Cb, this);
+  switch (m_workload)
+    {
+    case HOLD:
+      Simulator::Schedule (after, &Bench::Cb, this, i);
+      break;
+    case CANCEL:
+      // A timer restart, as done by most protocol models: the cancelled
+      // event stays in the event list until it expires.
+      Simulator::Schedule (after, &Bench::Cb, this, i);
+      m_timers[i].Cancel ();
+      m_timers[i] = Simulator::Schedule (after * 10, &Bench::Timeout, this);
+      break;
+    case REMOVE:
+      Simulator::Schedule (after, &Bench::Cb, this, i);
+      Simulator::Remove (m_timers[i]);
+      m_timers[i] = Simulator::Schedule (after * 10, &Bench::Timeout, this);
+      break;
+    case CONTEXT:
+      Simulator::ScheduleWithContext (m_count % m_contexts, after, &Bench::Cb, this, i);
+      break;
+    }
   ++m_count;
 }
 
+void
+Bench::Timeout (void)
+{
+}
+
 
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
@@ -198,6 +268,138 @@ GetRandomStream (std::string filename)
   return stream;
 }
 
+/**
+ * Get one of the classic hold model distributions, with a mean of 100 ns.
+ *
+ * The bimodal and camel distributions are mixtures, which are sampled
+ * once into a table replayed by a DeterministicRandomVariable so that
+ * their cost is the same as the other distributions.
+ *
+ * \param name the distribution: exponential, uniform, triangular,
+ *        bimodal or camel
+ * \returns the random variable stream, or 0 if the name is unknown
+ */
+Ptr<RandomVariableStream>
+GetHoldDistribution (std::string name)
+{
+  const double mean = 100;
+  if (name == "exponential")
+    {
+      Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
+      erv->SetAttribute ("Mean", DoubleValue (mean));
+      return erv;
+    }
+  if (name == "uniform")
+    {
+      // uniform on [0, 2 mean]
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (0));
+      urv->SetAttribute ("Max", DoubleValue (2 * mean));
+      return urv;
+    }
+  if (name == "triangular")
+    {
+      // increasing density on [0, 1.5 mean]
+      Ptr<TriangularRandomVariable> trv = CreateObject<TriangularRandomVariable> ();
+      trv->SetAttribute ("Min", DoubleValue (0));
+      trv->SetAttribute ("Max", DoubleValue (1.5 * mean));
+      trv->SetAttribute ("Mean", DoubleValue (mean));
+      return trv;
+    }
+
+  Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+  std::vector<double> nsValues (1 << 20);
+  if (name == "bimodal")
+    {
+      // 90% on [0, 0.1 mean], 10% on [0, 19.1 mean]
+      for (std::vector<double>::iterator i = nsValues.begin (); i != nsValues.end (); ++i)
+        {
+          double max = urv->GetValue () < 0.9 ? 0.1 * mean : 19.1 * mean;
+          *i = urv->GetValue (0, max);
+        }
+    }
+  else if (name == "camel")
+    {
+      // two humps of width 0.1 mean, at 0.4 and 1.6 mean
+      for (std::vector<double>::iterator i = nsValues.begin (); i != nsValues.end (); ++i)
+        {
+          double hump = urv->GetValue () < 0.5 ? 0.35 * mean : 1.55 * mean;
+          *i = hump + urv->GetValue (0, 0.1 * mean);
+        }
+    }
+  else
+    {
+      return 0;
+    }
+  Ptr<DeterministicRandomVariable> drv = CreateObject<DeterministicRandomVariable> ();
+  drv->SetValueArray (&nsValues[0], nsValues.size ());
+  return drv;
+}
+
+/**
+ * Split a comma-separated list.
+ *
+ * \param list the list
+ * \returns the items of the list
+ */
+std::vector<std::string>
+Split (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream iss (list);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      if (item != "")
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+/// Print the header of the timing table
+void
+PrintHeader (void)
+{
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+       std::left << std::setw (3 * g_fwidth) << "Simulation:");
+  LOG (std::left << std::setw (g_fwidth) << "" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+  LOG (std::setfill ('-') <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::setfill (' ')
+       );
+}
+
+/**
+ * Print a row of the timing table
+ * \param population the population
+ * \param result the timing of the run
+ */
+void
+PrintResult (uint32_t population, const Bench::Result &result)
+{
+  LOG (std::setw (g_fwidth) << result.init <<
+       std::setw (g_fwidth) << (population / result.init) <<
+       std::setw (g_fwidth) << (result.init / population) <<
+       std::setw (g_fwidth) << result.simu <<
+       std::setw (g_fwidth) << (result.count / result.simu) <<
+       std::setw (g_fwidth) << (result.simu / result.count));
+}
 
 
 int main (int argc, char *argv[])
@@ -205,6 +407,7 @@ int main (int argc, char *argv[])
 
   bool schedCal  = false;
   bool schedHeap = false;
+  bool schedLadder = false;
   bool schedList = false;
   bool schedMap  = true;
 
@@ -213,6 +416,16 @@ int main (int argc, char *argv[])
   uint32_t runs  =       1;
   std::string filename = "";
 
+  std::string schedulers = "";
+  std::string distributions = "";
+  std::string workloads = "hold";
+  uint32_t contexts = 100;
+  bool sweep = false;
+  uint32_t minPop = 100;
+  uint32_t maxPop = 1000000;
+  uint32_t listMaxPop = 10000;
+  std::string csvFile = "";
+
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
@@ -221,9 +434,16 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "Alternatively, --schedulers, --dist and --workload take\n"
+             "comma-separated lists (or \"all\"), and every combination is run,\n"
+             "with the population sizes from --minPop to --maxPop by factors\n"
+             "of 10 if --sweep is set.  The results are also written as CSV\n"
+             "with --csv=\"<filename>\" (\"-\" for standard output).");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
@@ -232,75 +452,229 @@ int main (int argc, char *argv[])
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("schedulers", "schedulers to run: cal,heap,ladder,list,map or all", schedulers);
+  cmd.AddValue ("dist",  "hold distributions: exponential,uniform,triangular,bimodal,camel or all", distributions);
+  cmd.AddValue ("workload", "event patterns: hold,cancel,remove,context or all (default hold)", workloads);
+  cmd.AddValue ("contexts", "number of contexts of the context pattern (default 100)", contexts);
+  cmd.AddValue ("sweep", "sweep the population sizes from minPop to maxPop", sweep);
+  cmd.AddValue ("minPop", "smallest population of the sweep (default 1E2)", minPop);
+  cmd.AddValue ("maxPop", "largest population of the sweep (default 1E6)", maxPop);
+  cmd.AddValue ("listMaxPop", "largest population run with ListScheduler (default 1E4)", listMaxPop);
+  cmd.AddValue ("csv",   "CSV output file",               csvFile);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
+  std::string scheduler = "ns3::MapScheduler";
   if (schedCal)
     {
-      factory.SetTypeId ("ns3::CalendarScheduler");
+      scheduler = "ns3::CalendarScheduler";
     }
   if (schedHeap)
     {
-      factory.SetTypeId ("ns3::HeapScheduler");
+      scheduler = "ns3::HeapScheduler";
+    }
+  if (schedLadder)
+    {
+      scheduler = "ns3::LadderScheduler";
     }
   if (schedList)
     {
-      factory.SetTypeId ("ns3::ListScheduler");
+      scheduler = "ns3::ListScheduler";
     }
-  Simulator::SetScheduler (factory);
-
-  LOGME (std::setprecision (g_fwidth - 6));
-  DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
-  LOGME ("population: " << pop);
-  LOGME ("total events: " << total);
-  LOGME ("runs: " << runs);
-
-  Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  std::vector<std::string> schedulerList;
+  if (schedulers == "")
+    {
+      schedulerList.push_back (scheduler);
+    }
+  else
+    {
+      if (schedulers == "all")
+        {
+          schedulers = "cal,heap,ladder,list,map";
+        }
+      std::vector<std::string> names = Split (schedulers);
+      for (std::vector<std::string>::const_iterator i = names.begin (); i != names.end (); ++i)
+        {
+          if (*i == "cal")
+            {
+              schedulerList.push_back ("ns3::CalendarScheduler");
+            }
+          else if (*i == "heap")
+            {
+              schedulerList.push_back ("ns3::HeapScheduler");
+            }
+          else if (*i == "ladder")
+            {
+              schedulerList.push_back ("ns3::LadderScheduler");
+            }
+          else if (*i == "list")
+            {
+              schedulerList.push_back ("ns3::ListScheduler");
+            }
+          else if (*i == "map")
+            {
+              schedulerList.push_back ("ns3::MapScheduler");
+            }
+          else
+            {
+              LOGME ("unknown scheduler " << *i);
+              return 1;
+            }
+        }
+    }
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
+  std::vector<std::string> distributionList;
+  if (distributions == "all")
+    {
+      distributions = "exponential,uniform,triangular,bimodal,camel";
+    }
+  if (distributions == "")
+    {
+      distributionList.push_back (filename == "" ? "exponential" : "file");
+    }
+  else
+    {
+      distributionList = Split (distributions);
+    }
 
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
+  if (workloads == "all")
+    {
+      workloads = "hold,cancel,remove,context";
+    }
+  std::vector<std::string> workloadList = Split (workloads);
+  std::vector<Bench::Workload> workloadTypes;
+  for (std::vector<std::string>::const_iterator i = workloadList.begin (); i != workloadList.end (); ++i)
+    {
+      if (*i == "hold")
+        {
+          workloadTypes.push_back (Bench::HOLD);
+        }
+      else if (*i == "cancel")
+        {
+          workloadTypes.push_back (Bench::CANCEL);
+        }
+      else if (*i == "remove")
+        {
+          workloadTypes.push_back (Bench::REMOVE);
+        }
+      else if (*i == "context")
+        {
+          workloadTypes.push_back (Bench::CONTEXT);
+        }
+      else
+        {
+          LOGME ("unknown workload " << *i);
+          return 1;
+        }
+    }
 
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  std::vector<uint32_t> populations;
+  if (sweep)
+    {
+      for (uint64_t p = minPop; p <= maxPop; p *= 10)
+        {
+          populations.push_back (p);
+        }
+    }
+  else
     {
-      std::cout << std::setw (g_fwidth) << i;
+      populations.push_back (pop);
+    }
 
-      bench->RunBench ();
+  std::ofstream csvStream;
+  std::ostream *csv = 0;
+  if (csvFile == "-")
+    {
+      csv = &std::cout;
+    }
+  else if (csvFile != "")
+    {
+      csvStream.open (csvFile.c_str ());
+      csv = &csvStream;
+    }
+  if (csv != 0)
+    {
+      *csv << "scheduler,distribution,workload,population,events,run,"
+           << "init_time_s,init_rate_ev_per_s,run_time_s,run_rate_ev_per_s"
+           << std::endl;
     }
 
-  LOG ("");
-  Simulator::Destroy ();
-  delete bench;
+  LOGME (std::setprecision (g_fwidth - 6));
+  DEB ("debugging is ON");
+
+  for (std::vector<std::string>::const_iterator d = distributionList.begin (); d != distributionList.end (); ++d)
+    {
+      Ptr<RandomVariableStream> stream;
+      if (*d == "file")
+        {
+          stream = GetRandomStream (filename);
+        }
+      else
+        {
+          stream = GetHoldDistribution (*d);
+          if (stream == 0)
+            {
+              LOGME ("unknown distribution " << *d);
+              return 1;
+            }
+        }
+      for (std::vector<std::string>::const_iterator s = schedulerList.begin (); s != schedulerList.end (); ++s)
+        {
+          for (uint32_t w = 0; w < workloadTypes.size (); ++w)
+            {
+              for (std::vector<uint32_t>::const_iterator p = populations.begin (); p != populations.end (); ++p)
+                {
+                  if (*s == "ns3::ListScheduler" && *p > listMaxPop)
+                    {
+                      LOGME ("skipping " << *s << " with population " << *p);
+                      continue;
+                    }
+                  ObjectFactory factory (*s);
+                  Simulator::SetScheduler (factory);
+
+                  LOG ("");
+                  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+                  LOGME ("distribution: " << *d);
+                  LOGME ("workload: " << workloadList[w]);
+                  LOGME ("population: " << *p);
+                  LOGME ("total events: " << total);
+                  LOGME ("runs: " << runs);
+
+                  Bench *bench = new Bench (*p, total);
+                  bench->SetRandomStream (stream);
+                  bench->SetWorkload (workloadTypes[w], contexts);
+
+                  PrintHeader ();
+
+                  // prime
+                  DEB ("priming");
+                  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
+                  PrintResult (*p, bench->RunBench ());
+
+                  for (uint32_t i = 0; i < runs; i++)
+                    {
+                      std::cout << std::setw (g_fwidth) << i;
+
+                      Bench::Result result = bench->RunBench ();
+                      PrintResult (*p, result);
+                      if (csv != 0)
+                        {
+                          *csv << *s << "," << *d << "," << workloadList[w] << ","
+                               << *p << "," << result.count << "," << i << ","
+                               << result.init << "," << (*p / result.init) << ","
+                               << result.simu << "," << (result.count / result.simu)
+                               << std::endl;
+                        }
+                    }
+
+                  LOG ("");
+                  Simulator::Destroy ();
+                  delete bench;
+                }
+            }
+        }
+    }
   return 0;
 }
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program measures the cost of firing the trace sources of a packet
+// on its way through a device, with 0, 1, 2 or more sinks connected to
+// each of them.  It compares TracedCallback with a chain of Callbacks
+// stored in a std::list, which is how TracedCallback stored them up to
+// ns-3.30.
+// Sample usage:  ./waf --run 'bench-traced-callback --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/traced-callback.h"
+#include "ns3/packet.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+
+using namespace ns3;
+
+/**
+ * The TracedCallback implementation of ns-3.30: a std::list of Callbacks.
+ *
+ * \tparam T1 Type of the argument of the Callbacks.
+ */
+template <typename T1>
+class ListTracedCallback
+{
+public:
+  /**
+   * Append a Callback to the chain.
+   *
+   * \param [in] callback Callback to add to chain.
+   */
+  void ConnectWithoutContext (const Callback<void,T1> &callback)
+  {
+    m_callbackList.push_back (callback);
+  }
+  /**
+   * Invoke the chain of Callbacks.
+   *
+   * \param [in] a1 The argument of the Callbacks.
+   */
+  void operator() (T1 a1) const
+  {
+    for (typename std::list<Callback<void,T1> >::const_iterator i = m_callbackList.begin ();
+         i != m_callbackList.end (); i++)
+      {
+        (*i)(a1);
+      }
+  }
+
+private:
+  /** The chain of Callbacks. */
+  std::list<Callback<void,T1> > m_callbackList;
+};
+
+/**
+ * The trace sources fired for each packet by a typical device.
+ *
+ * \tparam TRACE The trace source type.
+ */
+template <typename TRACE>
+struct Device
+{
+  TRACE macTx;        //!< Packet received from the upper layer.
+  TRACE phyTxBegin;   //!< Transmission started.
+  TRACE phyTxEnd;     //!< Transmission finished.
+  TRACE phyRxEnd;     //!< Reception finished.
+  TRACE macRx;        //!< Packet forwarded to the upper layer.
+  TRACE sniffer;      //!< Promiscuous sniffer.
+
+  /**
+   * Fire all the trace sources.
+   *
+   * \param [in] p The packet.
+   */
+  void Forward (Ptr<const Packet> p)
+  {
+    macTx (p);
+    phyTxBegin (p);
+    phyTxEnd (p);
+    phyRxEnd (p);
+    macRx (p);
+    sniffer (p);
+  }
+  /**
+   * Connect a Callback to all the trace sources.
+   *
+   * \param [in] cb The Callback.
+   */
+  void Connect (Callback<void,Ptr<const Packet> > cb)
+  {
+    macTx.ConnectWithoutContext (cb);
+    phyTxBegin.ConnectWithoutContext (cb);
+    phyTxEnd.ConnectWithoutContext (cb);
+    phyRxEnd.ConnectWithoutContext (cb);
+    macRx.ConnectWithoutContext (cb);
+    sniffer.ConnectWithoutContext (cb);
+  }
+};
+
+/** The number of trace sources fired per packet. */
+static const uint32_t SOURCES = 6;
+
+/** Bytes seen by the sinks, so that the invocations are not optimized out. */
+static uint64_t g_bytes = 0;
+
+/**
+ * A trace sink.
+ *
+ * \param [in] p The packet.
+ */
+static void
+Sink (Ptr<const Packet> p)
+{
+  g_bytes += p->GetSize ();
+}
+
+/**
+ * Forward packets through a device.
+ *
+ * \tparam TRACE The trace source type.
+ * \param [in] n The number of packets.
+ * \param [in] sinks The number of sinks connected to each trace source.
+ * \returns The time per trace source invocation, in nanoseconds.
+ */
+template <typename TRACE>
+static double
+Bench (uint32_t n, uint32_t sinks)
+{
+  Device<TRACE> device;
+  for (uint32_t i = 0; i < sinks; i++)
+    {
+      device.Connect (MakeCallback (&Sink));
+    }
+  Ptr<const Packet> p = Create<Packet> (1000);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      device.Forward (p);
+    }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now ();
+  return std::chrono::duration<double, std::nano> (end - start).count () / n / SOURCES;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  uint32_t maxSinks = 4;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the invocation of trace sources.\n\n"
+             "Forward n packets through a device with 6 trace sources, with\n"
+             "0 to maxSinks sinks connected to each source, and report the\n"
+             "time per invocation of a trace source.");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("maxSinks", "maximum number of sinks per trace source", maxSinks);
+  cmd.Parse (argc, argv);
+
+  std::cout << "# " << n << " packets, " << SOURCES << " trace sources per packet"
+#ifdef NS3_TRACING_DISABLE
+            << ", tracing disabled"
+#endif
+            << std::endl;
+  std::cout << "#" << std::setw (5) << "sinks"
+            << std::setw (16) << "list (ns)"
+            << std::setw (16) << "traced (ns)"
+            << std::setw (10) << "speedup"
+            << std::endl;
+  std::cout << std::fixed;
+  for (uint32_t sinks = 0; sinks <= maxSinks; sinks == 0 ? sinks = 1 : sinks *= 2)
+    {
+      double list = Bench<ListTracedCallback<Ptr<const Packet> > > (n, sinks);
+      double traced = Bench<TracedCallback<Ptr<const Packet> > > (n, sinks);
+      std::cout << std::setw (6) << sinks
+                << std::setw (16) << std::setprecision (2) << list
+                << std::setw (16) << std::setprecision (2) << traced
+                << std::setw (10) << std::setprecision (1) << (traced > 0 ? list / traced : 0.0)
+                << std::endl;
+    }
+  // Print the sink output so that the compiler cannot discard it.
+  std::cerr << "# " << g_bytes << " bytes traced" << std::endl;
+  return 0;
+}